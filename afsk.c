@@ -0,0 +1,260 @@
+// afsk.c - AX.25 framer and AFSK1200 NCO for the FM path
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "afsk.h"
+#include "control.h"
+#include "platform.h"
+#include "dsp.h"
+
+#define Q32_PER_HZ      (4294967296.0 / (double)WAV_SAMPLE_RATE)
+#define MARK_STEP       ((uint32_t)(AFSK_MARK_HZ * Q32_PER_HZ))
+#define SPACE_STEP      ((uint32_t)(AFSK_SPACE_HZ * Q32_PER_HZ))
+#define HDLC_FLAG       0x7Eu
+
+typedef struct {
+    uint8_t  data[AFSK_MAX_FRAME + 2u];     // + FCS
+    uint16_t len;
+} frame_t;
+
+enum { PH_IDLE = 0, PH_HEAD, PH_DATA, PH_TAIL };
+
+static frame_t  q[AFSK_QUEUE];
+static uint32_t q_head, q_n;
+static uint16_t txdelay_ms = AFSK_TXDELAY_MS;
+
+// Bit generator
+static uint8_t  phase = PH_IDLE;
+static uint32_t flags_left;
+static uint32_t byte_i;
+static uint8_t  bit_i;
+static uint8_t  ones;               // consecutive 1s in the data (stuffing)
+static bool     stuff_next;
+
+// Modulator: bit clock (exact: +baud per sample, one bit per sample rate)
+static uint32_t bit_acc;
+static uint8_t  tone;               // 0 = mark, 1 = space
+static uint32_t nco_ph;
+
+static afsk_stats_t st;
+static uint32_t burst_samples, frame_bits, frame_stuffed;
+static bool     report;
+
+uint16_t afsk_fcs(const uint8_t *data, uint32_t len) {
+    uint16_t crc = 0xFFFFu;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++) crc = (crc & 1u) ? (uint16_t)((crc >> 1) ^ 0x8408u) : (uint16_t)(crc >> 1);
+    }
+    return (uint16_t)~crc;
+}
+
+static const char *enqueue(const uint8_t *frame, uint32_t len) {
+    if (q_n >= AFSK_QUEUE) { st.dropped++; return "queue full"; }
+    frame_t *f = &q[(q_head + q_n) % AFSK_QUEUE];
+    memcpy(f->data, frame, len);
+    const uint16_t fcs = afsk_fcs(frame, len);
+    f->data[len] = (uint8_t)fcs;
+    f->data[len + 1u] = (uint8_t)(fcs >> 8);
+    f->len = (uint16_t)(len + 2u);
+    q_n++;
+    return NULL;
+}
+
+const char *afsk_queue_raw(const uint8_t *frame, uint32_t len) {
+    if (len < 15u || len > AFSK_MAX_FRAME) return "frame length 15..330";
+    return enqueue(frame, len);
+}
+
+// "CALL[-SSID][*]" of n chars into a 7-byte address field
+static bool put_call(uint8_t *out, const char *s, uint32_t n, uint8_t ssid_bits) {
+    bool rep = false;
+    if (n && s[n - 1u] == '*') { rep = true; n--; }
+
+    uint32_t call_n = 0;
+    while (call_n < n && s[call_n] != '-') call_n++;
+    if (call_n < 1u || call_n > 6u) return false;
+
+    unsigned ssid = 0;
+    if (call_n < n) {
+        if (call_n + 1u >= n || n - call_n - 1u > 2u) return false;
+        for (uint32_t i = call_n + 1u; i < n; i++) {
+            if (s[i] < '0' || s[i] > '9') return false;
+            ssid = ssid * 10u + (unsigned)(s[i] - '0');
+        }
+        if (ssid > 15u) return false;
+    }
+
+    for (uint32_t i = 0; i < 6u; i++) {
+        char c = (i < call_n) ? s[i] : ' ';
+        if (c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+        if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == ' ')) return false;
+        out[i] = (uint8_t)((uint8_t)c << 1);
+    }
+    out[6] = (uint8_t)(ssid_bits | (ssid << 1) | (rep ? 0x80u : 0u));
+    return true;
+}
+
+// TNC2 monitor format: SRC>DST[,DIGI[*]...]:info
+const char *afsk_queue_tnc2(const char *tnc2) {
+    static uint8_t frame[AFSK_MAX_FRAME];
+
+    const char *colon = strchr(tnc2, ':');
+    const char *gt = strchr(tnc2, '>');
+    if (!colon || !gt || gt > colon) return "format SRC>DST[,PATH]:info";
+
+    const uint32_t info_n = (uint32_t)strlen(colon + 1);
+    if (info_n > 256u) return "info longer than 256";
+
+    // Destination first, then source, then the digipeaters
+    uint32_t n = 0;
+    const char *p = gt + 1;
+    const char *e = p;
+    while (e < colon && *e != ',') e++;
+    if (!put_call(&frame[0], p, (uint32_t)(e - p), 0xE0u)) return "bad destination";
+    if (!put_call(&frame[7], tnc2, (uint32_t)(gt - tnc2), 0x60u)) return "bad source";
+    n = 14u;
+
+    while (e < colon) {
+        p = e + 1;
+        e = p;
+        while (e < colon && *e != ',') e++;
+        if (n >= 7u * (2u + AFSK_MAX_DIGIS)) return "too many digipeaters";
+        if (!put_call(&frame[n], p, (uint32_t)(e - p), 0x60u)) return "bad path";
+        n += 7u;
+    }
+    frame[n - 1u] |= 0x01u;                 // end of address field
+
+    frame[n++] = 0x03;                      // UI
+    frame[n++] = 0xF0;                      // no layer 3
+    memcpy(&frame[n], colon + 1, info_n);
+    n += info_n;
+    return enqueue(frame, n);
+}
+
+void afsk_flush(const char *why) {
+    st.dropped += q_n;
+    q_n = 0;
+    if (phase != PH_IDLE) {
+        phase = PH_IDLE;
+        st.air_ms = burst_samples * 1000u / WAV_SAMPLE_RATE;
+    }
+    afsk_print(why);
+}
+
+void afsk_set_txdelay(uint32_t ms) {
+    if (ms < 30u) ms = 30u;
+    if (ms > 1000u) ms = 1000u;
+    txdelay_ms = (uint16_t)ms;
+}
+
+bool afsk_active(void) { return q_n > 0u || phase != PH_IDLE; }
+
+static void start_frame(uint32_t head_flags) {
+    phase = PH_HEAD;
+    flags_left = head_flags;
+    byte_i = 0;
+    bit_i = 0;
+    ones = 0;
+    stuff_next = false;
+    frame_bits = frame_stuffed = 0;
+}
+
+// Next on-air bit (before NRZI), -1 at the end of the burst
+static int next_bit(void) {
+    for (;;) {
+        switch (phase) {
+        case PH_HEAD:
+        case PH_TAIL: {
+            if (!flags_left) {
+                if (phase == PH_HEAD) { phase = PH_DATA; continue; }
+                phase = PH_IDLE;
+                return -1;
+            }
+            const int b = (HDLC_FLAG >> bit_i) & 1;
+            if (++bit_i == 8u) { bit_i = 0; flags_left--; }
+            frame_bits++;
+            return b;
+        }
+        case PH_DATA: {
+            const frame_t *f = &q[q_head];
+            if (stuff_next) {
+                stuff_next = false;
+                ones = 0;
+                frame_bits++;
+                frame_stuffed++;
+                return 0;
+            }
+            if (byte_i == f->len) {
+                // Frame done: the next one follows after a few flags
+                q_head = (q_head + 1u) % AFSK_QUEUE;
+                q_n--;
+                st.sent++;
+                st.bits = frame_bits;
+                st.stuffed = frame_stuffed;
+                if (q_n) { start_frame(AFSK_GAP_FLAGS); continue; }
+                phase = PH_TAIL;
+                flags_left = AFSK_TAIL_FLAGS;
+                bit_i = 0;
+                continue;
+            }
+            const int b = (f->data[byte_i] >> bit_i) & 1;
+            if (++bit_i == 8u) { bit_i = 0; byte_i++; }
+            if (b) { if (++ones == 5u) stuff_next = true; }
+            else ones = 0;
+            frame_bits++;
+            return b;
+        }
+        default:
+            return -1;
+        }
+    }
+}
+
+float afsk_sample(void) {
+    if (phase == PH_IDLE) {
+        if (!q_n) return 0.0f;
+        start_frame((txdelay_ms * AFSK_BAUD / 1000u + 7u) / 8u);
+        bit_acc = WAV_SAMPLE_RATE;          // fetch a bit now
+        burst_samples = 0;
+    }
+
+    bit_acc += AFSK_BAUD;
+    if (bit_acc >= WAV_SAMPLE_RATE) {
+        bit_acc -= WAV_SAMPLE_RATE;
+        const int b = next_bit();
+        if (b < 0) {
+            st.air_ms = burst_samples * 1000u / WAV_SAMPLE_RATE;
+            report = true;
+            return 0.0f;
+        }
+        if (!b) tone ^= 1u;                 // NRZI: 0 = change
+    }
+    burst_samples++;
+    nco_ph += tone ? SPACE_STEP : MARK_STEP;
+    return lut_sin(nco_ph);
+}
+
+void afsk_block(void) {
+    if (!report) return;
+    report = false;
+    afsk_print("sent");
+}
+
+void afsk_stats(afsk_stats_t *out) {
+    *out = st;
+    out->queued = (uint8_t)q_n;
+    out->on_air = phase != PH_IDLE;
+    out->txdelay_ms = txdelay_ms;
+}
+
+void afsk_print(const char *why) {
+    afsk_stats_t s;
+    afsk_stats(&s);
+    cdc_printf("!P why=%s q=%u air=%u sent=%lu drop=%lu bits=%lu stuff=%lu ms=%lu txd=%u\r\n",
+               why, s.queued, s.on_air ? 1u : 0u, (unsigned long)s.sent, (unsigned long)s.dropped,
+               (unsigned long)s.bits, (unsigned long)s.stuffed, (unsigned long)s.air_ms, s.txdelay_ms);
+}
@@ -0,0 +1,60 @@
+// afsk.h - AX.25 / AFSK1200 packet generator for the FM path
+//
+// Frames are queued from CDC ("pkt SRC>DST,PATH:info" in TNC2 notation,
+// or "pkt hex" with the raw address..info bytes) and sent by the
+// producer without going through USB audio or the DSP chain: HDLC flags,
+// bit stuffing and the FCS are added here, bits are NRZI coded and a
+// phase-continuous 1200 / 2200 Hz NCO supplies the FM modulating signal
+// sample by sample (peak = the configured FM deviation).
+//
+// Core0 only: frames are queued from the CDC handler and consumed by
+// txchain_fill_block(), both on the main loop.  host/afskcheck decodes
+// the generated command stream back into frames.
+
+#ifndef AFSK_H
+#define AFSK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define AFSK_BAUD           1200u
+#define AFSK_MARK_HZ        1200u
+#define AFSK_SPACE_HZ       2200u
+#define AFSK_MAX_FRAME      330u    // 10 addresses + control + PID + 256 info
+#define AFSK_QUEUE          4u
+#define AFSK_MAX_DIGIS      8u
+#define AFSK_TXDELAY_MS     300u    // flags before the first frame of a burst
+#define AFSK_GAP_FLAGS      4u      // between frames of one burst
+#define AFSK_TAIL_FLAGS     3u
+
+typedef struct {
+    uint8_t  queued;        // frames waiting, including the one on air
+    bool     on_air;
+    uint16_t txdelay_ms;
+    uint32_t sent;
+    uint32_t dropped;       // queue full / flushed
+    uint32_t bits;          // on-air bits of the last frame (flags, stuffing)
+    uint32_t stuffed;       // stuffed zeros in the last frame
+    uint32_t air_ms;        // last burst, first flag to last flag
+} afsk_stats_t;
+
+// Queue a frame.  Returns NULL or an error.
+const char *afsk_queue_tnc2(const char *tnc2);
+const char *afsk_queue_raw(const uint8_t *frame, uint32_t len);   // FCS added
+void        afsk_flush(const char *why);
+void        afsk_set_txdelay(uint32_t ms);
+
+// Producer: anything queued or on air (keys the FM carrier)
+bool        afsk_active(void);
+// Next 8 kHz sample of the modulating signal, +-1; 0 once the queue is empty
+float       afsk_sample(void);
+// After each block: reports finished bursts ("!P")
+void        afsk_block(void);
+
+// CRC-16/X.25 as AX.25 sends it (low byte first)
+uint16_t    afsk_fcs(const uint8_t *data, uint32_t len);
+
+void        afsk_stats(afsk_stats_t *out);
+void        afsk_print(const char *why);    // "!P" line
+
+#endif // AFSK_H
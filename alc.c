@@ -0,0 +1,99 @@
+// alc.c - closed-loop RF ALC for the SSB envelope
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "alc.h"
+#include "control.h"
+
+static bool     alc_on = false;
+static float    gain_db = 0.0f;
+static float    gain_lin = 1.0f;
+static float    ceiling_db = ALC_MAX_DB;
+static float    clip_avg, duty_avg, mean_avg;   // fractions / dB, smoothed
+static uint32_t n_blocks;
+static uint32_t report_ct;
+
+void alc_enable(bool on) {
+    alc_on = on;
+    report_ct = 0;
+    alc_print(on ? "on" : "off");
+}
+
+bool alc_enabled(void) { return alc_on; }
+
+static void set_gain(float db) {
+    if (db < ALC_MIN_DB) db = ALC_MIN_DB;
+    if (db > ceiling_db) db = ceiling_db;
+    gain_db = db;
+    gain_lin = powf(10.0f, gain_db / 20.0f);
+}
+
+void alc_reset(void) {
+    set_gain(0.0f);
+    clip_avg = duty_avg = mean_avg = 0.0f;
+    n_blocks = 0;
+    report_ct = 0;
+    alc_print("reset");
+}
+
+void alc_stats(alc_stats_t *out) {
+    out->enabled    = alc_on;
+    out->gain_db    = gain_db;
+    out->ceiling_db = ceiling_db;
+    out->clip_pct   = clip_avg * 100.0f;
+    out->duty_pct   = duty_avg * 100.0f;
+    out->mean_db    = mean_avg;
+    out->blocks     = n_blocks;
+}
+
+float alc_gain(void) { return alc_on ? gain_lin : 1.0f; }
+
+void alc_set_ceiling(float db) {
+    if (db < ALC_MIN_DB) db = ALC_MIN_DB;
+    if (db > ALC_MAX_DB) db = ALC_MAX_DB;
+    ceiling_db = db;
+    if (gain_db > ceiling_db) set_gain(gain_db);
+}
+
+void alc_print(const char *why) {
+    cdc_printf("!A on=%u why=%s gain=%+.1f max=%+.1f clip=%.1f duty=%.1f mean=%.1f blocks=%lu\r\n",
+               alc_on ? 1u : 0u, why, (double)gain_db, (double)ceiling_db, (double)(clip_avg * 100.0f),
+               (double)(duty_avg * 100.0f), (double)mean_avg, (unsigned long)n_blocks);
+}
+
+void alc_block(const alc_meas_t *m) {
+    // Measured with the loop off too, so "alc" shows where the static
+    // amp_gain sits; only the gain update needs the loop enabled.
+    if (m->n_voice < ALC_MIN_VOICE) return;
+
+    const float n = (float)m->n_voice;
+    const float clip = (float)m->n_clip / n;
+    const float duty = (float)m->n_duty / n;
+    const float mean = m->sum_db / n;
+
+    // A block is shorter than a syllable, so single blocks swing between
+    // peak and tail; the loop acts on ~8-block averages instead.
+    const float k = (n_blocks == 0) ? 1.0f : 0.125f;
+    clip_avg += (clip - clip_avg) * k;
+    duty_avg += (duty - duty_avg) * k;
+    mean_avg += (mean - mean_avg) * k;
+    n_blocks++;
+
+    float step = 0.0f;
+    if (!alc_on) {
+        // measure only
+    } else if (clip_avg > ALC_CLIP_HI) {
+        step = -ALC_ATTACK_DB;
+    } else if (clip_avg < ALC_CLIP_LO && -mean_avg > ALC_CREST_MIN_DB) {
+        step = (duty_avg > ALC_DUTY_HI) ? ALC_RISE_FAST_DB : ALC_RISE_DB;
+    }
+
+    if (step != 0.0f) set_gain(gain_db + step);
+
+    if (alc_on && ++report_ct >= ALC_REPORT_BLOCKS) {
+        report_ct = 0;
+        alc_print("track");
+    }
+}
@@ -0,0 +1,78 @@
+// alc.h - closed-loop RF ALC for the SSB envelope
+//
+// The static amp_gain maps the SSB envelope A onto the power range: too
+// low and voice sits in the pulse-density (duty) regime below
+// PWR_MIN_DBM, too high and p_raw clips at the power limit.  The producer
+// counts, per block of voiced samples, how many clipped at max power, how
+// many fell into the duty regime, and their mean level in dB below max.
+// The loop trims an extra envelope gain on top of amp_gain so that peaks
+// just touch the limit (clip fraction inside a target band) while the
+// crest factor stays above a floor, i.e. highest average power without
+// flattening the speech.  State is pushed as "!A" telemetry.  Portable:
+// host/alccheck drives it through txchain_fill_block().
+
+#ifndef ALC_H
+#define ALC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Voice detection: raw envelope above this counts as a voiced sample;
+// a block needs ALC_MIN_VOICE of them to be measured at all, so pauses
+// and silence hold the gain instead of winding it up.
+#define ALC_VOICE_A         0.002f
+#define ALC_MIN_VOICE       64u
+
+// Target profile (fractions of voiced samples, dB below max power)
+#define ALC_CLIP_HI         0.05f   // more clipping than this: back off
+#define ALC_CLIP_LO         0.01f   // less than this: room to go up ...
+#define ALC_CREST_MIN_DB    5.0f    // ... unless mean is already this close to max
+#define ALC_DUTY_HI         0.25f   // this much voice in the duty regime: rise faster
+
+// Gain steps per measured block (32 ms) and range
+#define ALC_ATTACK_DB       0.5f    // ~15 dB/s down
+#define ALC_RISE_DB         0.05f   // ~1.5 dB/s up
+#define ALC_RISE_FAST_DB    0.2f
+#define ALC_MIN_DB          (-20.0f)
+#define ALC_MAX_DB          20.0f
+
+#define ALC_REPORT_BLOCKS   32u     // "!A" every ~1 s while measuring
+
+// Per-block measurement, filled by the producer
+typedef struct {
+    uint32_t n_voice;       // voiced samples with TX gated on
+    uint32_t n_clip;        // ... whose p_raw reached the power limit
+    uint32_t n_duty;        // ... that fell into the duty regime
+    float    sum_db;        // sum of output level rel. max power (<= 0)
+} alc_meas_t;
+
+typedef struct {
+    bool     enabled;
+    float    gain_db;
+    float    ceiling_db;    // highest gain the loop may reach
+    float    clip_pct;      // smoothed over measured blocks (also when off)
+    float    duty_pct;
+    float    mean_db;       // smoothed mean level rel. max power
+    uint32_t blocks;        // measured blocks since reset
+} alc_stats_t;
+
+void  alc_enable(bool on);
+bool  alc_enabled(void);
+void  alc_reset(void);              // gain back to 0 dB, stats cleared
+void  alc_stats(alc_stats_t *out);
+
+// Upper bound on the loop gain, ALC_MAX_DB by default; a gain above it
+// is pulled down at once.  The mask guard lowers it when it backs off
+// amp_gain so the loop cannot win the gain back.  Kept over alc_reset().
+void  alc_set_ceiling(float db);
+
+// Linear envelope gain for the next block (1.0 when disabled)
+float alc_gain(void);
+
+// Called by the producer after every block
+void  alc_block(const alc_meas_t *m);
+
+// "!A" telemetry line / "alc" command output
+void  alc_print(const char *why);
+
+#endif // ALC_H
@@ -0,0 +1,123 @@
+// cmdlat.c - command-to-air latency of control changes
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cmdlat.h"
+#include "spscring.h"
+#include "control.h"
+#include "platform.h"
+#include "txchain.h"
+
+#define LAT_STALE_US    5000000ull  // never played (CW test, no producer)
+
+typedef struct {
+    uint32_t id;
+    char     cmd[8];
+    uint64_t t_cmd;
+    uint64_t t_commit;      // 0 = no block built with it yet
+} change_t;
+
+// Core0: changes in flight, oldest first
+static change_t pend[LAT_PENDING];
+static uint32_t pend_n;
+static uint32_t next_id = 1;
+
+// Newest change in each queued block: producer writes it before the
+// block is marked ready, Core1 reads it after
+static volatile uint32_t block_id[NUM_BLOCKS];
+
+// Core1 -> Core0: first block start of each new ID
+typedef struct { uint32_t id; uint64_t us; } air_t;
+SPSC_DEFINE(air_rb, air_t, LAT_AIR_RING)
+static air_rb_t air_q;
+static uint32_t c1_last;                    // Core1 only
+
+static cmdlat_stats_t st = { .target_ms = LAT_TARGET_MS };
+
+static void drop_oldest(void) {
+    memmove(&pend[0], &pend[1], (pend_n - 1u) * sizeof(pend[0]));
+    pend_n--;
+}
+
+void cmdlat_mark(const char *cmd) {
+    if (pend_n == LAT_PENDING) { drop_oldest(); st.dropped++; }
+    change_t *c = &pend[pend_n++];
+    c->id = next_id++;
+    strncpy(c->cmd, cmd, sizeof(c->cmd) - 1u);
+    c->cmd[sizeof(c->cmd) - 1u] = 0;
+    c->t_cmd = plat_us();
+    c->t_commit = 0;
+}
+
+uint32_t cmdlat_begin(void) { return next_id - 1u; }
+
+void cmdlat_commit(uint32_t blk, uint32_t id) {
+    block_id[blk % NUM_BLOCKS] = id;
+    const uint64_t now = plat_us();
+    for (uint32_t i = 0; i < pend_n && pend[i].id <= id; i++) {
+        if (!pend[i].t_commit) pend[i].t_commit = now;
+    }
+}
+
+void cmdlat_air(uint32_t blk) {
+    const uint32_t id = block_id[blk % NUM_BLOCKS];
+    if (id == c1_last) return;
+    c1_last = id;
+    (void)air_rb_push(&air_q, (air_t){ id, plat_us() });     // full: Core0 behind, the next start covers it
+}
+
+static void measured(const change_t *c, uint64_t t_air) {
+    const uint32_t commit = (uint32_t)(c->t_commit - c->t_cmd);
+    const uint32_t air = (uint32_t)(t_air - c->t_cmd);
+    st.n++;
+    st.air_sum_us += air;
+    if (commit > st.commit_max_us) st.commit_max_us = commit;
+    if (air > st.air_max_us) st.air_max_us = air;
+    const bool ok = air <= st.target_ms * 1000u;
+    if (!ok) st.over++;
+    st.last_id = c->id;
+    if (st.report) {
+        cdc_printf("!L id=%lu cmd=%s commit_us=%lu air_us=%lu ok=%u\r\n",
+                   (unsigned long)c->id, c->cmd, (unsigned long)commit, (unsigned long)air, ok ? 1u : 0u);
+    }
+}
+
+void cmdlat_poll(void) {
+    air_t a;
+    while (air_rb_pop(&air_q, &a)) {
+        while (pend_n && pend[0].id <= a.id && pend[0].t_commit) {
+            measured(&pend[0], a.us);
+            drop_oldest();
+        }
+    }
+
+    const uint64_t now = plat_us();
+    while (pend_n && now - pend[0].t_cmd > LAT_STALE_US) { drop_oldest(); st.dropped++; }
+}
+
+void cmdlat_set_report(bool on) { st.report = on; }
+
+void cmdlat_set_target(uint32_t ms) {
+    if (ms < 10u) ms = 10u;
+    if (ms > 5000u) ms = 5000u;
+    st.target_ms = (uint16_t)ms;
+}
+
+void cmdlat_reset(void) {
+    const bool report = st.report;
+    const uint16_t target = st.target_ms;
+    memset(&st, 0, sizeof(st));
+    st.report = report;
+    st.target_ms = target;
+}
+
+void cmdlat_stats(cmdlat_stats_t *out) { *out = st; }
+
+void cmdlat_print(const char *why) {
+    cdc_printf("!L why=%s n=%lu avg_us=%lu max_us=%lu commit_max_us=%lu over=%lu drop=%lu tgt_ms=%u report=%u\r\n",
+               why, (unsigned long)st.n, (unsigned long)(st.n ? st.air_sum_us / st.n : 0u),
+               (unsigned long)st.air_max_us, (unsigned long)st.commit_max_us,
+               (unsigned long)st.over, (unsigned long)st.dropped, st.target_ms, st.report ? 1u : 0u);
+}
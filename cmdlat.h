@@ -0,0 +1,61 @@
+// cmdlat.h - command-to-air latency of control changes
+//
+// A control change (freq, txpwr, tx, mode, ppm, set ...) is tagged with an
+// ID and a timestamp when cdc_handle_line() sees it.  Every block carries
+// the newest ID that was tagged before its production started, so:
+//
+//   commit  the first block built with the change is marked ready
+//           (waits for the block in production and, for "set", the
+//           redesign on the next block boundary)
+//   air     Core1 starts on that block (waits for the queue ahead of it)
+//
+// Both deltas are measured from the command and reported as "!L" once
+// the change is on air ("lat on"), with running totals and the count over
+// the target for "lat".  Core1 hands block starts back to Core0 through
+// a small SPSC ring; everything else runs on Core0 (core0_poll() in
+// main.c, which every audio mode reaches).
+// Portable: sxsim --load measures it over the simulated queue.
+
+#ifndef CMDLAT_H
+#define CMDLAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LAT_PENDING         8u      // changes in flight (older ones dropped)
+#define LAT_AIR_RING        8u      // Core1 -> Core0 block starts, power of 2
+#define LAT_TARGET_MS       300u    // default: full queue + one block, rounded up
+
+typedef struct {
+    bool     report;        // "!L" line per change
+    uint16_t target_ms;
+    uint32_t n;             // changes measured
+    uint32_t over;          // air latency above the target
+    uint32_t dropped;       // superseded before they were measured
+    uint32_t commit_max_us;
+    uint32_t air_max_us;
+    uint64_t air_sum_us;
+    uint32_t last_id;
+} cmdlat_stats_t;
+
+// CDC handler: tag a change once it is applied (cmd is copied, first 7 chars)
+void cmdlat_mark(const char *cmd);
+
+// Producer: ID to stamp on the block about to be built, then the block's
+// commit.  blk is the queue index (g_prod_block).
+uint32_t cmdlat_begin(void);
+void     cmdlat_commit(uint32_t blk, uint32_t id);
+
+// Core1: start of queue block blk
+void     cmdlat_air(uint32_t blk);
+
+// Core0, core0_poll(): match block starts to changes and report
+void     cmdlat_poll(void);
+
+void     cmdlat_set_report(bool on);
+void     cmdlat_set_target(uint32_t ms);
+void     cmdlat_reset(void);
+void     cmdlat_stats(cmdlat_stats_t *out);
+void     cmdlat_print(const char *why);     // "!L why=..." totals
+
+#endif // CMDLAT_H
@@ -0,0 +1,918 @@
+// control.c - runtime TX state, frequency plan and CDC command protocol
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+
+#include "control.h"
+#include "freqdisc.h"
+#include "dspgov.h"
+#include "alc.h"
+#include "testsig.h"
+#include "farrow.h"
+#include "kbench.h"
+#include "mscdisk.h"
+#include "txsched.h"
+#include "afsk.h"
+#include "cmdlat.h"
+#include "specmask.h"
+#include "rssiscan.h"
+#include "platform.h"
+
+// ==========================================================
+// Shared runtime state
+// ==========================================================
+volatile double   g_target_freq_hz = (double)BASE_FREQ_HZ;
+volatile float    g_ppm_correction = 0.0f;
+volatile float    g_ppm_disc = 0.0f;
+volatile uint8_t  g_cw_test_mode = 0;
+volatile int8_t   g_tx_power_max_dbm = PWR_MAX_DBM;
+volatile uint8_t  g_tx_enabled = 0;
+volatile uint8_t  g_tx_mode = 0;
+volatile uint8_t  g_tune_active = 0;
+volatile uint8_t  g_ptt_key = 0;
+volatile uint8_t  g_audio_src = 0;
+volatile uint8_t  g_audio_src_auto = 0;
+volatile uint32_t g_mode_change_at_ms = 0;
+
+volatile float    g_fm_deviation_hz = 2500.0f;
+volatile float    g_ctcss_freq = 0.0f;
+volatile uint8_t  g_roger_beep = 0;
+
+volatile boot_times_t g_boot;
+
+volatile audio_cfg_t g_cfg = AUDIO_CFG_DEFAULTS;
+volatile uint8_t     g_cfg_dirty = 1;
+
+void cfg_snapshot(audio_cfg_t *out) {
+    __compiler_memory_barrier();
+    memcpy(out, (const void*)&g_cfg, sizeof(*out));
+    __compiler_memory_barrier();
+}
+
+void cfg_commit(const audio_cfg_t *c) {
+    __compiler_memory_barrier();
+    memcpy((void*)&g_cfg, c, sizeof(*c));
+    g_cfg_dirty = 1;
+    __compiler_memory_barrier();
+}
+
+const char *mode_label(uint8_t m) {
+    switch (m) {
+        case TXM_CW:     return "CW";
+        case TXM_FM:     return "FM";
+        default:         return "USB";
+    }
+}
+
+// ==========================================================
+// Simple USB CDC command interface
+// ==========================================================
+int streqi(const char *a, const char *b) {
+    if (!a || !b) return 0;
+    while (*a && *b) {
+        char ca = *a++, cb = *b++;
+        if (ca >= 'A' && ca <= 'Z') ca = (char)(ca - 'A' + 'a');
+        if (cb >= 'A' && cb <= 'Z') cb = (char)(cb - 'A' + 'a');
+        if (ca != cb) return 0;
+    }
+    return (*a == 0 && *b == 0);
+}
+
+void cdc_write_str(const char *s) {
+    if (!plat_cdc_connected()) return;
+    plat_cdc_write(s);
+}
+
+void cdc_printf(const char *fmt, ...) {
+    if (!plat_cdc_connected()) return;
+    char b[256];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(b, sizeof(b), fmt, ap);
+    va_end(ap);
+    plat_cdc_write(b);
+}
+
+bool parse_bool(const char *s, uint8_t *out) {
+    if (!s) return false;
+    if (streqi(s, "1") || streqi(s, "on") || streqi(s, "true"))  { *out = 1; return true; }
+    if (streqi(s, "0") || streqi(s, "off")|| streqi(s, "false")) { *out = 0; return true; }
+    return false;
+}
+
+bool parse_f(const char *s, float *out) {
+    if (!s) return false;
+    char *e = NULL;
+    float v = strtof(s, &e);
+    if (e == s) return false;
+    *out = v;
+    return true;
+}
+
+// Unsigned decimal, whole token (host microsecond / UTC ms timestamps)
+static bool parse_u64(const char *s, uint64_t *out) {
+    if (!s || *s < '0' || *s > '9') return false;
+    char *e = NULL;
+    unsigned long long v = strtoull(s, &e, 10);
+    if (*e) return false;
+    *out = (uint64_t)v;
+    return true;
+}
+
+// "set <key> <value>" names for audio_cfg_t fields (also used by the
+// host tools for variants and presets).  Returns false for unknown keys.
+bool cfg_set_key(audio_cfg_t *c, const char *key, float f) {
+    if      (streqi(key, "bp_lo"))       c->bp_lo_hz = f;
+    else if (streqi(key, "bp_hi"))       c->bp_hi_hz = f;
+    else if (streqi(key, "bp_stages"))   c->bp_stages = (uint8_t)f;
+    else if (streqi(key, "eq_low_hz"))   c->eq_low_hz = f;
+    else if (streqi(key, "eq_low_db"))   c->eq_low_db = f;
+    else if (streqi(key, "eq_high_hz"))  c->eq_high_hz = f;
+    else if (streqi(key, "eq_high_db"))  c->eq_high_db = f;
+    else if (streqi(key, "comp_thr"))    c->comp_thr_db = f;
+    else if (streqi(key, "comp_ratio"))  c->comp_ratio = f;
+    else if (streqi(key, "comp_att"))    c->comp_attack_ms = f;
+    else if (streqi(key, "comp_rel"))    c->comp_release_ms = f;
+    else if (streqi(key, "comp_makeup")) c->comp_makeup_db = f;
+    else if (streqi(key, "comp_knee"))   c->comp_knee_db = f;
+    else if (streqi(key, "comp_outlim")) c->comp_out_limit = f;
+    else if (streqi(key, "comp_la"))     c->comp_lookahead_ms = f;
+    else if (streqi(key, "amp_gain"))    c->amp_gain = f;
+    else if (streqi(key, "amp_min_a"))   c->amp_min_a = f;
+    else if (streqi(key, "mic_agc_target"))   c->mic_agc_target = f;
+    else if (streqi(key, "mic_agc_max_gain")) c->mic_agc_max_gain = f;
+    else if (streqi(key, "mic_agc_attack"))   c->mic_agc_attack = f;
+    else if (streqi(key, "mic_agc_release"))  c->mic_agc_release = f;
+    else if (streqi(key, "mic_gate"))         c->mic_gate_thresh = f;
+    else if (streqi(key, "ssb_engine"))       c->ssb_engine = (uint8_t)f;
+    else return false;
+    return true;
+}
+
+bool cfg_get_key(const audio_cfg_t *c, const char *key, float *f) {
+    if      (streqi(key, "bp_lo"))       *f = c->bp_lo_hz;
+    else if (streqi(key, "bp_hi"))       *f = c->bp_hi_hz;
+    else if (streqi(key, "bp_stages"))   *f = (float)c->bp_stages;
+    else if (streqi(key, "eq_low_hz"))   *f = c->eq_low_hz;
+    else if (streqi(key, "eq_low_db"))   *f = c->eq_low_db;
+    else if (streqi(key, "eq_high_hz"))  *f = c->eq_high_hz;
+    else if (streqi(key, "eq_high_db"))  *f = c->eq_high_db;
+    else if (streqi(key, "comp_thr"))    *f = c->comp_thr_db;
+    else if (streqi(key, "comp_ratio"))  *f = c->comp_ratio;
+    else if (streqi(key, "comp_att"))    *f = c->comp_attack_ms;
+    else if (streqi(key, "comp_rel"))    *f = c->comp_release_ms;
+    else if (streqi(key, "comp_makeup")) *f = c->comp_makeup_db;
+    else if (streqi(key, "comp_knee"))   *f = c->comp_knee_db;
+    else if (streqi(key, "comp_outlim")) *f = c->comp_out_limit;
+    else if (streqi(key, "comp_la"))     *f = c->comp_lookahead_ms;
+    else if (streqi(key, "amp_gain"))    *f = c->amp_gain;
+    else if (streqi(key, "amp_min_a"))   *f = c->amp_min_a;
+    else if (streqi(key, "mic_agc_target"))   *f = c->mic_agc_target;
+    else if (streqi(key, "mic_agc_max_gain")) *f = c->mic_agc_max_gain;
+    else if (streqi(key, "mic_agc_attack"))   *f = c->mic_agc_attack;
+    else if (streqi(key, "mic_agc_release"))  *f = c->mic_agc_release;
+    else if (streqi(key, "mic_gate"))         *f = c->mic_gate_thresh;
+    else if (streqi(key, "ssb_engine"))       *f = (float)c->ssb_engine;
+    else return false;
+    return true;
+}
+
+// Format large Hz value as "XXXXXXXXXX.X" into caller's buffer.
+// Needed because newlib-nano's printf uses scientific notation for big doubles.
+void fmt_freq(char *buf, size_t len, double hz) {
+    uint64_t i = (uint64_t)hz;
+    uint32_t f = (uint32_t)((hz - (double)i) * 10.0 + 0.5);
+    if (f >= 10) { i++; f = 0; }
+    snprintf(buf, len, "%llu.%u", (unsigned long long)i, (unsigned)f);
+}
+
+void cfg_print(void) {
+    audio_cfg_t c;
+    cfg_snapshot(&c);
+
+    double corrected = get_corrected_freq_hz();
+    float fine = get_fine_tune_hz();
+
+    char freq_str[24], corr_str[24];
+    fmt_freq(freq_str, sizeof(freq_str), g_target_freq_hz);
+    fmt_freq(corr_str, sizeof(corr_str), corrected);
+
+    cdc_printf(
+        "CFG:\r\n"
+        "  freq=%s Hz (target)  ppm=%.3f  tx=%s  txpwr=%d dBm\r\n"
+        "  mode=%s  tune=%s\r\n"
+        "  corrected=%s Hz  base_steps=%lu  fine=%.1f Hz (auto)\r\n",
+        freq_str, g_ppm_correction, g_tx_enabled ? "ON" : "OFF", g_tx_power_max_dbm,
+        mode_label(g_tx_mode),
+        g_tune_active ? "ON" : "OFF",
+        corr_str, (unsigned long)get_base_steps(), fine);
+    cdc_printf(
+        "  enable bp=%u eq=%u comp=%u  ssb=%s\r\n"
+        "  bp_lo=%.1f bp_hi=%.1f bp_stages=%u (%u dB/oct)\r\n"
+        "  eq_low_hz=%.1f eq_low_db=%.1f\r\n"
+        "  eq_high_hz=%.1f eq_high_db=%.1f\r\n",
+        c.enable_bandpass, c.enable_eq, c.enable_comp,
+        c.ssb_engine == SSB_WEAVER ? "weaver" : "hilbert",
+        c.bp_lo_hz, c.bp_hi_hz, c.bp_stages, c.bp_stages * 12,
+        c.eq_low_hz, c.eq_low_db,
+        c.eq_high_hz, c.eq_high_db);
+    cdc_printf(     // one call per ~256 chars: cdc_printf() truncates longer lines
+        "  comp_thr=%.1f ratio=%.2f att=%.2fms rel=%.2fms makeup=%.1f knee=%.1f outlim=%.3f la=%.1fms\r\n"
+        "  amp_gain=%.3f amp_min_a=%.9f\r\n",
+        c.comp_thr_db, c.comp_ratio, c.comp_attack_ms, c.comp_release_ms, c.comp_makeup_db, c.comp_knee_db, c.comp_out_limit,
+        c.comp_lookahead_ms,
+        c.amp_gain, c.amp_min_a
+    );
+    cdc_printf(
+        "  mic_agc_target=%.3f mic_agc_max_gain=%.1f mic_agc_attack=%.4f mic_agc_release=%.5f\r\n"
+        "  mic_gate_thresh=%.4f  src=%s\r\n"
+        "  fm_dev=%.0f Hz  ctcss=%.1f Hz\r\n",
+        c.mic_agc_target, c.mic_agc_max_gain, c.mic_agc_attack, c.mic_agc_release,
+        c.mic_gate_thresh, g_audio_src ? "MIC" : "PC",
+        g_fm_deviation_hz, g_ctcss_freq
+    );
+}
+
+void boot_print(void) {
+    cdc_printf("BOOT: dsp=%lu radio=%lu rf_ready=%lu usb=%lu first_tx=%lu ms%s\r\n",
+               (unsigned long)g_boot.dsp_ms, (unsigned long)g_boot.radio_ms,
+               (unsigned long)g_boot.rf_ready_ms, (unsigned long)g_boot.usb_ms,
+               (unsigned long)g_boot.first_tx_ms,
+               g_audio_src_auto ? " (MIC until USB)" : "");
+}
+
+static void cmd_help(void) {
+    cdc_write_str(
+        "Commands:\r\n"
+        "  help\r\n"
+        "  get\r\n"
+        "  diag          - show SX1280 status\r\n"
+        "  boot          - boot milestones (time to RF-ready, USB, first TX)\r\n"
+        "  tx 0|1        - enable/disable TX (SSB modulation)\r\n"
+        "  mode usb|cw|fm - set modulation mode\r\n"
+        "  src pc|mic    - audio source (PC=USB audio, MIC=ADC0)\r\n"
+        "  tune 0|1      - toggle TUNE carrier\r\n"
+        "  cw            - start CW test transmission\r\n"
+        "  stop          - stop CW transmission\r\n"
+        "  freq <Hz>     - set frequency with sub-Hz precision (e.g. freq 2400100050.5)\r\n"
+        "  ppm <value>   - set PPM correction (e.g. ppm -0.5)\r\n"
+        "  disc [off|sof|pps] - automatic PPM discipline (USB SOF / PPS input)\r\n"
+        "  gov [auto|0-4] - DSP quality governor (0 = full quality)\r\n"
+        "  alc [on|off|reset] - closed-loop RF ALC (SSB envelope gain)\r\n"
+        "  mask [on|off|reset|lim <dBc>|band <lo_hz> <hi_hz>] - spectral mask guard (SSB)\r\n"
+        "  rs [bench] - USB resampler status / cost per output sample at each rate\r\n"
+        "  msc [sync] - USB storage volume status / flush the write cache when TX allows\r\n"
+        "  bench - time the DSP kernels and Core1 SPI commands on this core type (TX off)\r\n"
+        "  lat [on|off|reset|target <ms>] - command-to-air latency of control changes\r\n"
+        "  irq [reset] - per-core IRQ counts, handler times, Core1 lockouts / overruns, USB worker\r\n"
+        "  scan [on [lo_khz hi_khz [step_khz]]|off|settle <us>|reset] - RSSI band scan (parks TX)\r\n"
+        "  tsync [ping <host_us> | set <host_us> <dev_us> [rtt_us]] - host time handshake\r\n"
+        "  tx_at <utc_ms>|+<ms>|next <period_s> [len_ms] | off - scheduled TX start\r\n"
+        "  pkt SRC>DST[,PATH]:info | hex <bytes> | txdelay <ms> | flush - AX.25 AFSK1200 (FM)\r\n"
+        "  testsig tone <Hz> [amp] | two <Hz> <Hz> [amp] | multi [n] [amp]\r\n"
+        "          sweep <Hz> <Hz> [s] [amp] | noise [amp] | off\r\n"
+        "  testsig at src|mod | check [ms] - injection point, re-run self-check\r\n"
+        "  txpwr <-18..13> - set max TX power in dBm\r\n"
+        "  enable <bp|eq|comp> <0|1|on|off>\r\n"
+        "  set bp_lo <Hz>\r\n"
+        "  set bp_hi <Hz>\r\n"
+        "  set bp_stages <1-10>  (filter steepness: 12dB/oct per stage)\r\n"
+        "  set eq_low_hz <Hz>\r\n"
+        "  set eq_low_db <dB>\r\n"
+        "  set eq_high_hz <Hz>\r\n"
+        "  set eq_high_db <dB>\r\n"
+        "  set comp_thr <dB>\r\n"
+        "  set comp_ratio <R>\r\n"
+        "  set comp_att <ms>\r\n"
+        "  set comp_rel <ms>\r\n"
+        "  set comp_makeup <dB>\r\n"
+        "  set comp_knee <dB>\r\n"
+        "  set comp_outlim <0..1>\r\n"
+        "  set comp_la <0..7.8>          (limiter look-ahead ms, 0=hard clip)\r\n"
+        "  set amp_gain <float>\r\n"
+        "  set amp_min_a <float>\r\n"
+        "  set mic_agc_target <0..1>   (MIC AGC target level)\r\n"
+        "  set mic_agc_max_gain <1..200> (MIC AGC max gain)\r\n"
+        "  set mic_agc_attack <coeff>  (MIC AGC attack speed)\r\n"
+        "  set mic_agc_release <coeff> (MIC AGC release speed)\r\n"
+        "  set mic_gate <0..0.5>       (noise gate threshold, 0=off)\r\n"
+        "  set ssb_engine <0|1>        (SSB modulator: 0=Hilbert FIR, 1=Weaver)\r\n"
+        "  set fm_dev <200..100000>    (FM deviation in Hz)\r\n"
+        "  set ctcss <freq|0>          (CTCSS tone Hz, 0=off)\r\n"
+        "\r\n"
+        "Frequency is automatically split into PLL steps + fine DSP offset.\r\n"
+    );
+}
+
+// Periodic status push to CDC for GUI synchronization.
+// Sends a compact line that the GUI can parse to update its widgets.
+// Only sends when something changed, at most every 100 ms.
+void cdc_status_push_ex(bool force) {
+    static uint32_t last_push_ms = 0;
+    static uint8_t  last_mode = 0xFF;
+    static uint8_t  last_tune = 0xFF;
+    static uint8_t  last_tx   = 0xFF;
+    static uint8_t  last_src  = 0xFF;
+    static int8_t   last_pwr  = 127;
+    static float    last_ppm  = 9999.0f;
+    static double   last_freq = 0.0;
+    static float    last_fm_dev = -1.0f;
+    static float    last_ctcss  = -1.0f;
+
+    if (!plat_cdc_connected()) return;
+
+    uint8_t  cur_mode = g_tx_mode;
+    uint8_t  cur_tune = g_tune_active;
+    uint8_t  cur_tx   = g_tx_enabled;
+    uint8_t  cur_src  = g_audio_src;
+    int8_t   cur_pwr  = g_tx_power_max_dbm;
+    float    cur_ppm  = g_ppm_correction;
+    double   cur_freq = (double)g_target_freq_hz;
+    float    cur_fm_dev = g_fm_deviation_hz;
+    float    cur_ctcss  = g_ctcss_freq;
+
+    if (!force) {
+        // Check if anything changed
+        bool changed = (cur_mode != last_mode) || (cur_tune != last_tune) ||
+                       (cur_tx != last_tx) || (cur_src != last_src) ||
+                       (cur_pwr != last_pwr) ||
+                       (cur_ppm != last_ppm) || (cur_freq != last_freq) ||
+                       (cur_fm_dev != last_fm_dev) || (cur_ctcss != last_ctcss);
+
+        if (!changed) return;
+
+        uint32_t now = plat_ms();
+        if ((now - last_push_ms) < 100) return;
+    }
+
+    // Format freq with fmt_freq to avoid newlib-nano scientific notation
+    char freq_str[24];
+    fmt_freq(freq_str, sizeof(freq_str), cur_freq);
+
+    // PPM: format as fixed-point (4 decimals) to avoid float formatting issues
+    int ppm_neg = (cur_ppm < 0.0f);
+    float ppm_abs = ppm_neg ? -cur_ppm : cur_ppm;
+    uint32_t ppm_int = (uint32_t)ppm_abs;
+    uint32_t ppm_frac = (uint32_t)((ppm_abs - (float)ppm_int) * 10000.0f + 0.5f);
+    if (ppm_frac >= 10000) { ppm_int++; ppm_frac = 0; }
+
+    char status_buf[160];
+    // fm_dev: format as integer (no fractional Hz needed)
+    uint32_t fm_dev_int = (uint32_t)(cur_fm_dev + 0.5f);
+    // ctcss: format as X.Y (one decimal place)
+    uint32_t ctcss_int = (uint32_t)cur_ctcss;
+    uint32_t ctcss_frac = (uint32_t)((cur_ctcss - (float)ctcss_int) * 10.0f + 0.5f);
+    if (ctcss_frac >= 10) { ctcss_int++; ctcss_frac = 0; }
+
+    snprintf(status_buf, sizeof(status_buf),
+             "!S mode=%u tune=%u tx=%u src=%u pwr=%d ppm=%s%lu.%04lu freq=%s fm_dev=%lu ctcss=%lu.%lu\r\n",
+             cur_mode, cur_tune, cur_tx, cur_src, cur_pwr,
+             ppm_neg ? "-" : "", (unsigned long)ppm_int, (unsigned long)ppm_frac,
+             freq_str,
+             (unsigned long)fm_dev_int,
+             (unsigned long)ctcss_int, (unsigned long)ctcss_frac);
+    cdc_write_str(status_buf);
+
+    last_mode = cur_mode;
+    last_tune = cur_tune;
+    last_tx   = cur_tx;
+    last_src  = cur_src;
+    last_pwr  = cur_pwr;
+    last_ppm  = cur_ppm;
+    last_freq = cur_freq;
+    last_fm_dev = cur_fm_dev;
+    last_ctcss  = cur_ctcss;
+    last_push_ms = plat_ms();
+}
+
+// Hex bytes, optionally space separated
+static uint32_t parse_hex(const char *s, uint8_t *out, uint32_t max) {
+    uint32_t n = 0;
+    int hi = -1;
+    for (; *s; s++) {
+        int v;
+        if (*s >= '0' && *s <= '9')      v = *s - '0';
+        else if (*s >= 'a' && *s <= 'f') v = *s - 'a' + 10;
+        else if (*s >= 'A' && *s <= 'F') v = *s - 'A' + 10;
+        else if (*s == ' ')              continue;
+        else return 0;
+        if (hi < 0) { hi = v; continue; }
+        if (n == max) return 0;
+        out[n++] = (uint8_t)(hi << 4 | v);
+        hi = -1;
+    }
+    return hi < 0 ? n : 0;
+}
+
+// Packet: pkt [SRC>DST[,PATH]:info | hex <bytes> | txdelay <ms> | flush].
+// Takes the raw line: the info field may hold spaces.
+static void cmd_pkt(const char *arg) {
+    while (*arg == ' ' || *arg == '\t') arg++;
+    if (!*arg) { afsk_print("status"); return; }
+
+    if (streqi(arg, "flush")) { afsk_flush("flush"); return; }
+    if (!strncmp(arg, "txdelay ", 8)) {
+        float ms;
+        if (!parse_f(arg + 8, &ms) || ms < 0.0f) { cdc_write_str("ERR: pkt txdelay <30..1000 ms>\r\n"); return; }
+        afsk_set_txdelay((uint32_t)ms);
+        afsk_print("txdelay");
+        return;
+    }
+    if (g_tx_mode != TXM_FM) { cdc_write_str("ERR: pkt needs FM mode\r\n"); return; }
+
+    const char *err;
+    if (!strncmp(arg, "hex ", 4)) {
+        static uint8_t frame[AFSK_MAX_FRAME];
+        const uint32_t n = parse_hex(arg + 4, frame, sizeof(frame));
+        err = n ? afsk_queue_raw(frame, n) : "bad hex";
+    } else {
+        err = afsk_queue_tnc2(arg);
+    }
+    if (err) { cdc_printf("ERR: pkt %s\r\n", err); return; }
+    afsk_print("queued");
+}
+
+void cdc_handle_line(char *line) {
+    char *argv[6] = {0};
+    int argc = 0;
+
+    if (!strncmp(line, "pkt", 3) && (line[3] == ' ' || line[3] == 0)) { cmd_pkt(line + 3); return; }
+
+    for (char *t = strtok(line, " \t\r\n"); t && argc < 6; t = strtok(NULL, " \t\r\n")) {
+        argv[argc++] = t;
+    }
+    if (argc == 0 || argv[0][0] == '#') return;     // blank / preset comment
+
+    if (streqi(argv[0], "help")) { cmd_help(); return; }
+    if (streqi(argv[0], "get"))  { cfg_print(); return; }
+    if (streqi(argv[0], "status")) { cdc_status_push_ex(true); return; }
+    if (streqi(argv[0], "diag")) { plat_radio_diag(); return; }
+    if (streqi(argv[0], "boot")) { boot_print(); return; }
+
+    // PPM discipline: disc [off|sof|pps]
+    if (streqi(argv[0], "disc")) {
+        if (argc >= 2) {
+            uint8_t src;
+            if (streqi(argv[1], "off"))      src = FD_SRC_OFF;
+            else if (streqi(argv[1], "sof")) src = FD_SRC_SOF;
+            else if (streqi(argv[1], "pps")) src = FD_SRC_PPS;
+            else { cdc_write_str("ERR: disc off|sof|pps\r\n"); return; }
+            freqdisc_select(src);
+            cdc_printf("OK disc=%s\r\n", freqdisc_src_label(src));
+            return;
+        }
+        freqdisc_print();
+        return;
+    }
+
+    // DSP quality governor: gov [auto|0-4]
+    if (streqi(argv[0], "gov")) {
+        if (argc >= 2) {
+            uint8_t mode;
+            if (streqi(argv[1], "auto")) {
+                mode = GOV_AUTO;
+            } else {
+                char *end;
+                long v = strtol(argv[1], &end, 10);
+                if (*end || v < 0 || v >= (long)GOV_LEVELS) { cdc_write_str("ERR: gov auto|0-4\r\n"); return; }
+                mode = (uint8_t)v;
+            }
+            dspgov_set(mode);
+            if (mode == GOV_AUTO) cdc_printf("OK gov=auto\r\n");
+            else                  cdc_printf("OK gov=%u\r\n", mode);
+            return;
+        }
+        dspgov_print("status");
+        return;
+    }
+
+    // Test signal: testsig <sig> ... | off | at src|mod | check [ms]
+    if (streqi(argv[0], "testsig")) {
+        if (argc < 2) { testsig_print(); return; }
+        const char *k = argv[1];
+
+        if (streqi(k, "off")) {
+            testsig_stop();
+            cdc_printf("OK testsig=off\r\n");
+            return;
+        }
+        if (streqi(k, "at")) {
+            if (argc >= 3 && streqi(argv[2], "src"))      testsig_set_point(TS_AT_SRC);
+            else if (argc >= 3 && streqi(argv[2], "mod")) testsig_set_point(TS_AT_MOD);
+            else { cdc_write_str("ERR: testsig at src|mod\r\n"); return; }
+            cdc_printf("OK testsig at=%s\r\n", argv[2]);
+            return;
+        }
+        if (streqi(k, "check")) {
+            float ms = (float)TS_CHECK_MS;
+            if ((argc >= 3 && !parse_f(argv[2], &ms)) || ms < 1.0f) { cdc_write_str("ERR: testsig check [ms]\r\n"); return; }
+            if (!testsig_active()) { cdc_write_str("ERR: no test signal running\r\n"); return; }
+            testsig_check((uint32_t)ms);
+            cdc_printf("OK testsig check=%lu ms\r\n", (unsigned long)ms);
+            return;
+        }
+
+        // Positional numbers after the signal name; amp is always last
+        uint8_t sig;
+        int need, amp_at;
+        float v[3] = { 0.0f, 0.0f, 0.0f };
+        float amp = 0.0f;
+        if (streqi(k, "tone"))       { sig = TS_TONE;  need = 1; amp_at = 3; }
+        else if (streqi(k, "two"))   { sig = TS_TWO;   need = 2; amp_at = 4; }
+        else if (streqi(k, "multi")) { sig = TS_MULTI; need = 0; amp_at = 3; v[0] = 5.0f; }
+        else if (streqi(k, "sweep")) { sig = TS_SWEEP; need = 2; amp_at = 5; v[2] = 5.0f; }
+        else if (streqi(k, "noise")) { sig = TS_NOISE; need = 0; amp_at = 2; }
+        else { cdc_write_str("ERR: testsig tone|two|multi|sweep|noise|off|at|check\r\n"); return; }
+
+        bool ok = argc >= 2 + need;
+        for (int i = 2; ok && i < amp_at && i < argc; i++) ok = parse_f(argv[i], &v[i - 2]);
+        if (ok && argc > amp_at) ok = parse_f(argv[amp_at], &amp);
+        if (!ok || !testsig_start(sig, v[0], v[1], v[2], amp)) {
+            cdc_write_str("ERR: testsig bad parameters (10-3500 Hz, multi 2-8, amp <= 1)\r\n");
+            return;
+        }
+        cdc_printf("OK testsig=%s\r\n", k);
+        testsig_print();
+        return;
+    }
+
+    // USB resampler: rs [bench]
+    if (streqi(argv[0], "rs")) {
+        if (argc >= 2 && streqi(argv[1], "bench")) {
+            for (uint32_t i = 0; i < FARROW_N_RATES; i++) {
+                uint32_t macs = 0;
+                uint32_t ns = farrow_bench_ns(farrow_rates[i], WAV_SAMPLE_RATE, &macs);
+                cdc_printf("!R bench sr=%lu ns=%lu macs=%lu load=%.1f%%\r\n",
+                           (unsigned long)farrow_rates[i], (unsigned long)ns, (unsigned long)macs,
+                           (double)ns * WAV_SAMPLE_RATE / 1e7);
+            }
+            return;
+        }
+        plat_usb_rs_print();
+        return;
+    }
+
+    // USB storage: msc [sync]
+    if (streqi(argv[0], "msc")) {
+        if (argc >= 2 && streqi(argv[1], "sync")) {
+            if (!mscdisk_ready()) { cdc_write_str("ERR: no MSC volume\r\n"); return; }
+            mscdisk_sync();
+            cdc_write_str("OK msc sync\r\n");
+            return;
+        }
+        mscdisk_print("status");
+        return;
+    }
+
+    // Kernel benchmarks: bench (stalls the producer, so only with TX off)
+    if (streqi(argv[0], "bench")) {
+        if (g_tx_enabled || g_ptt_key || g_tune_active || g_cw_test_mode) {
+            cdc_write_str("ERR: bench needs TX off\r\n");
+            return;
+        }
+        kbench_run();
+        plat_bench_spi();
+        cdc_write_str("OK bench\r\n");
+        return;
+    }
+
+    // Command-to-air latency: lat [on|off|reset|target <ms>]
+    if (streqi(argv[0], "lat")) {
+        if (argc >= 2) {
+            if (streqi(argv[1], "on"))         cmdlat_set_report(true);
+            else if (streqi(argv[1], "off"))   cmdlat_set_report(false);
+            else if (streqi(argv[1], "reset")) cmdlat_reset();
+            else if (streqi(argv[1], "target") && argc >= 3) cmdlat_set_target((uint32_t)strtoul(argv[2], NULL, 10));
+            else { cdc_write_str("ERR: lat [on|off|reset|target <ms>]\r\n"); return; }
+            cmdlat_print(argv[1]);
+            return;
+        }
+        cmdlat_print("status");
+        return;
+    }
+
+    // RSSI band scan: scan [on [<lo_khz> <hi_khz> [<step_khz>]] | off | settle <us> | reset]
+    if (streqi(argv[0], "scan")) {
+        if (argc >= 2 && streqi(argv[1], "on")) {
+            if (g_tx_enabled || g_ptt_key || g_tune_active || txsched_busy()) {
+                cdc_write_str("ERR: scan needs TX off\r\n");
+                return;
+            }
+            uint32_t lo = SCAN_LO_KHZ, hi = SCAN_HI_KHZ, step = SCAN_STEP_KHZ;
+            if (argc >= 4) {
+                lo = (uint32_t)strtoul(argv[2], NULL, 10);
+                hi = (uint32_t)strtoul(argv[3], NULL, 10);
+                if (argc >= 5) step = (uint32_t)strtoul(argv[4], NULL, 10);
+            }
+            if (!rssiscan_start(lo, hi, step)) {
+                cdc_printf("ERR: scan range 2390000..2510000 kHz, at most %u bins\r\n", SCAN_MAX_BINS);
+                return;
+            }
+            cdc_printf("OK scan lo_khz=%lu hi_khz=%lu step_khz=%lu\r\n",
+                       (unsigned long)lo, (unsigned long)hi, (unsigned long)step);
+            return;
+        }
+        if (argc >= 2 && streqi(argv[1], "off")) {
+            if (rssiscan_wanted()) rssiscan_stop("off");
+            else cdc_write_str("OK scan=off\r\n");
+            return;
+        }
+        if (argc >= 3 && streqi(argv[1], "settle")) {
+            rssiscan_set_settle((uint32_t)strtoul(argv[2], NULL, 10));
+            rssiscan_print("settle");
+            return;
+        }
+        if (argc >= 2 && streqi(argv[1], "reset")) {
+            rssiscan_reset();
+            rssiscan_print("reset");
+            return;
+        }
+        if (argc >= 2) { cdc_write_str("ERR: scan [on [lo_khz hi_khz [step_khz]]|off|settle <us>|reset]\r\n"); return; }
+        rssiscan_print("status");
+        return;
+    }
+
+    // IRQ affinity: irq [reset]
+    if (streqi(argv[0], "irq")) {
+        plat_irq_print(argc >= 2 && streqi(argv[1], "reset"));
+        return;
+    }
+
+    // Host time handshake: tsync [ping <host_us> | set <host_us> <dev_us> [rtt_us]]
+    if (streqi(argv[0], "tsync")) {
+        if (argc >= 3 && streqi(argv[1], "ping")) {
+            txsched_ping(argv[2]);
+            return;
+        }
+        if (argc >= 4 && streqi(argv[1], "set")) {
+            uint64_t host_us, dev_us, rtt = 0;
+            if (!parse_u64(argv[2], &host_us) || !parse_u64(argv[3], &dev_us) ||
+                (argc >= 5 && !parse_u64(argv[4], &rtt)) || rtt > UINT32_MAX) {
+                cdc_write_str("ERR: tsync set <host_us> <dev_us> [rtt_us]\r\n");
+                return;
+            }
+            const char *err = txsched_sync(host_us, dev_us, (uint32_t)rtt);
+            if (err) { cdc_printf("ERR: tsync %s\r\n", err); return; }
+            txsched_print("sync");
+            return;
+        }
+        if (argc >= 2) { cdc_write_str("ERR: tsync [ping|set]\r\n"); return; }
+        txsched_print("status");
+        return;
+    }
+
+    // Scheduled TX: tx_at <utc_ms>|+<ms>|next <period_s> [len_ms] | off
+    if (streqi(argv[0], "tx_at")) {
+        if (argc < 2) { txsched_print("status"); return; }
+        if (streqi(argv[1], "off")) {
+            txsched_cancel("cancel");
+            cdc_write_str("OK tx_at off\r\n");
+            return;
+        }
+        if (g_tx_enabled || g_ptt_key) { cdc_write_str("ERR: TX already on\r\n"); return; }
+        if (g_tx_mode == TXM_CW || g_tune_active || g_cw_test_mode) {
+            cdc_write_str("ERR: tx_at needs USB or FM mode\r\n");
+            return;
+        }
+
+        const bool next = streqi(argv[1], "next");
+        const int len_at = next ? 3 : 2;
+        uint64_t t = 0, len = 0;
+        float period_s = 0.0f;
+        bool ok;
+        if (next)                 ok = argc >= 3 && parse_f(argv[2], &period_s) && period_s >= 1.0f && period_s <= 3600.0f;
+        else if (argv[1][0] == '+') ok = parse_u64(argv[1] + 1, &t) && t <= TXS_MAX_AHEAD_MS;
+        else                      ok = parse_u64(argv[1], &t);
+        if (ok && argc > len_at) ok = parse_u64(argv[len_at], &len) && len <= TXS_MAX_AHEAD_MS;
+        if (!ok) { cdc_write_str("ERR: tx_at <utc_ms>|+<ms>|next <period_s> [len_ms] | off\r\n"); return; }
+
+        const char *err;
+        if (next)                   err = txsched_arm_next((uint32_t)(period_s * 1000.0f + 0.5f), (uint32_t)len);
+        else if (argv[1][0] == '+') err = txsched_arm_in((uint32_t)t, (uint32_t)len);
+        else                        err = txsched_arm_at(t, (uint32_t)len);
+        if (err) { cdc_printf("ERR: tx_at %s\r\n", err); return; }
+        cdc_write_str("OK tx_at\r\n");
+        return;
+    }
+
+    // Spectral mask guard: mask [on|off|reset|lim <dBc>|band <lo_hz> <hi_hz>]
+    if (streqi(argv[0], "mask")) {
+        if (argc >= 2) {
+            float a, b;
+            if (streqi(argv[1], "on"))         specmask_enable(true);
+            else if (streqi(argv[1], "off"))   specmask_enable(false);
+            else if (streqi(argv[1], "reset")) specmask_reset();
+            else if (streqi(argv[1], "lim") && argc >= 3 && parse_f(argv[2], &a) && specmask_set_limit(a))
+                specmask_print("lim");
+            else if (streqi(argv[1], "band") && argc >= 4 && parse_f(argv[2], &a) && parse_f(argv[3], &b)
+                     && specmask_set_band(a, b))
+                specmask_print("band");
+            else cdc_write_str("ERR: mask on|off|reset|lim <-60..0>|band <lo_hz> <hi_hz> (+-4000)\r\n");
+            return;
+        }
+        specmask_print("status");
+        return;
+    }
+
+    // RF ALC: alc [on|off|reset]
+    if (streqi(argv[0], "alc")) {
+        if (argc >= 2) {
+            if (streqi(argv[1], "on"))         alc_enable(true);
+            else if (streqi(argv[1], "off"))   alc_enable(false);
+            else if (streqi(argv[1], "reset")) alc_reset();
+            else { cdc_write_str("ERR: alc on|off|reset\r\n"); return; }
+            cdc_printf("OK alc=%s\r\n", alc_enabled() ? "on" : "off");
+            return;
+        }
+        alc_print("status");
+        return;
+    }
+    if (streqi(argv[0], "cw"))   { g_tune_active = 1; cdc_printf("OK tune=ON (carrier_poll handles SPI)\r\n"); return; }
+    if (streqi(argv[0], "stop")) { g_tune_active = 0; cdc_printf("OK tune=OFF\r\n"); return; }
+
+    // Mode: mode usb|cw|fm
+    if (streqi(argv[0], "mode") && argc >= 2) {
+        uint8_t new_mode = g_tx_mode;
+        if (streqi(argv[1], "usb") || streqi(argv[1], "ssb")) {
+            new_mode = 0;
+            cdc_printf("OK mode=USB\r\n");
+        } else if (streqi(argv[1], "cw")) {
+            new_mode = 1;
+            cdc_printf("OK mode=CW\r\n");
+        } else if (streqi(argv[1], "fm")) {
+            new_mode = 2;
+            cdc_printf("OK mode=FM\r\n");
+        } else {
+            cdc_write_str("ERR: mode usb|cw|fm\r\n");
+            return;
+        }
+        if (new_mode != g_tx_mode) {
+            g_tx_mode = new_mode;
+            g_mode_change_at_ms = plat_ms();
+        }
+        cmdlat_mark(argv[0]);
+        return;
+    }
+
+    // Audio source: src pc|mic|adc
+    if (streqi(argv[0], "src") && argc >= 2) {
+        if (streqi(argv[1], "pc") || streqi(argv[1], "usb")) {
+            g_audio_src_auto = 0;   // explicit choice ends the boot fallback
+            g_audio_src = 0;
+            plat_mic_stop();
+            cdc_printf("OK src=PC\r\n");
+        } else if (streqi(argv[1], "mic") || streqi(argv[1], "adc")) {
+            g_audio_src_auto = 0;
+            g_audio_src = 1;
+            plat_mic_start();
+            cdc_printf("OK src=MIC\r\n");
+        } else {
+            cdc_write_str("ERR: src pc|mic\r\n");
+        }
+        return;
+    }
+
+    // Tune carrier: tune 0|1
+    if (streqi(argv[0], "tune") && argc >= 2) {
+        uint8_t v;
+        if (!parse_bool(argv[1], &v)) {
+            cdc_write_str("ERR: tune 0|1|on|off\r\n");
+            return;
+        }
+        g_tune_active = v;
+        // carrier_poll() will handle SPI transitions
+        cdc_printf("OK tune=%s\r\n", g_tune_active ? "ON" : "OFF");
+        return;
+    }
+
+    // TX enable/disable: tx 0|1
+    if (streqi(argv[0], "tx") && argc >= 2) {
+        uint8_t v;
+        if (!parse_bool(argv[1], &v)) { 
+            cdc_write_str("ERR: tx 0|1|on|off\r\n"); 
+            return; 
+        }
+        txsched_cancel("tx");      // manual keying overrides a schedule
+        g_tx_enabled = v;
+        cmdlat_mark(argv[0]);
+        cdc_printf("OK tx=%s\r\n", g_tx_enabled ? "ON" : "OFF");
+        return;
+    }
+
+    // Frequency command: freq <Hz> (supports decimal for sub-Hz precision)
+    if (streqi(argv[0], "freq") && argc >= 2) {
+        char *e = NULL;
+        double f = strtod(argv[1], &e);
+        if (e == argv[1] || f < 2300000000.0 || f > 2450000000.0) {
+            cdc_write_str("ERR: freq must be 2300000000-2450000000 Hz\r\n");
+            return;
+        }
+        g_target_freq_hz = f;
+        cmdlat_mark(argv[0]);
+        double corrected = get_corrected_freq_hz();
+        float fine = get_fine_tune_hz();
+        cdc_printf("OK freq=%.1f Hz (corrected=%.1f, steps=%lu, fine=%.1f Hz)\r\n", 
+                   g_target_freq_hz, corrected,
+                   (unsigned long)get_base_steps(), fine);
+        if (g_tune_active) plat_tune_apply();
+        return;
+    }
+
+    // PPM correction command: ppm <value>
+    if (streqi(argv[0], "ppm") && argc >= 2) {
+        float ppm;
+        if (!parse_f(argv[1], &ppm)) { 
+            cdc_write_str("ERR: bad PPM value\r\n"); 
+            return; 
+        }
+        if (ppm < -100.0f || ppm > 100.0f) {
+            cdc_write_str("ERR: ppm must be -100 to +100\r\n");
+            return;
+        }
+        g_ppm_correction = ppm;
+        cmdlat_mark(argv[0]);
+        double corrected = get_corrected_freq_hz();
+        float fine = get_fine_tune_hz();
+        cdc_printf("OK ppm=%.3f (corrected=%.1f Hz, steps=%lu, fine=%.1f Hz)\r\n", 
+                   g_ppm_correction, corrected,
+                   (unsigned long)get_base_steps(), fine);
+        if (g_tune_active) plat_tune_apply();
+        return;
+    }
+
+    // TX power command: txpwr <-18..13>
+    if (streqi(argv[0], "txpwr") && argc >= 2) {
+        float pwr;
+        if (!parse_f(argv[1], &pwr)) { 
+            cdc_write_str("ERR: bad txpwr value\r\n"); 
+            return; 
+        }
+        if (pwr < (float)PWR_MIN_DBM) pwr = (float)PWR_MIN_DBM;
+        if (pwr > (float)PWR_MAX_DBM) pwr = (float)PWR_MAX_DBM;
+        g_tx_power_max_dbm = (int8_t)pwr;
+        cmdlat_mark(argv[0]);
+        cdc_printf("OK txpwr=%d dBm\r\n", g_tx_power_max_dbm);
+        if (g_tune_active) plat_tune_apply();
+        return;
+    }
+
+    audio_cfg_t c;
+    cfg_snapshot(&c);
+
+    if (streqi(argv[0], "enable") && argc >= 3) {
+        uint8_t v;
+        if (!parse_bool(argv[2], &v)) { cdc_write_str("ERR: bad bool\r\n"); return; }
+
+        if (streqi(argv[1], "bp")) c.enable_bandpass = v;
+        else if (streqi(argv[1], "eq")) c.enable_eq = v;
+        else if (streqi(argv[1], "comp")) c.enable_comp = v;
+        else { cdc_write_str("ERR: enable bp|eq|comp\r\n"); return; }
+
+        cfg_commit(&c);
+        cmdlat_mark(argv[0]);
+        cdc_write_str("OK\r\n");
+        return;
+    }
+
+    if (streqi(argv[0], "set") && argc >= 3) {
+        float f;
+        if (!parse_f(argv[2], &f)) { cdc_write_str("ERR: bad number\r\n"); return; }
+
+        // FM deviation and CTCSS are volatile globals, not in audio_cfg_t
+        if (streqi(argv[1], "fm_dev")) {
+            if (f < 200.0f) f = 200.0f;
+            if (f > 100000.0f) f = 100000.0f;
+            g_fm_deviation_hz = f;
+            cmdlat_mark(argv[0]);
+            cdc_printf("OK fm_dev=%.0f Hz\r\n", g_fm_deviation_hz);
+            return;
+        }
+        if (streqi(argv[1], "ctcss")) {
+            if (f < 0.0f) f = 0.0f;
+            if (f > 300.0f) f = 300.0f;
+            g_ctcss_freq = f;
+            cmdlat_mark(argv[0]);
+            cdc_printf("OK ctcss=%.1f Hz\r\n", g_ctcss_freq);
+            return;
+        }
+        if (streqi(argv[1], "roger")) {
+            g_roger_beep = (f != 0.0f) ? 1 : 0;
+            cmdlat_mark(argv[0]);
+            cdc_printf("OK roger=%s\r\n", g_roger_beep ? "on" : "off");
+            return;
+        }
+
+        if (!cfg_set_key(&c, argv[1], f)) { cdc_write_str("ERR: unknown key\r\n"); return; }
+
+        cfg_commit(&c);
+        cmdlat_mark(argv[0]);
+        cdc_write_str("OK\r\n");
+        return;
+    }
+
+    cdc_write_str("ERR: unknown command (type 'help')\r\n");
+}
@@ -0,0 +1,123 @@
+// control.h - runtime TX state, frequency plan and CDC command protocol
+//
+// Owns the volatile globals shared between Core0 (UI, CDC, producer) and
+// Core1 (radio), the text command parser behind the CDC port and the
+// "!S" status push consumed by gui.py.  Portable: built into the firmware
+// and into the host simulator (host/sxsim.c).
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "dsp.h"
+#include "platform.h"
+
+// ---------------- RF/audio params ----------------
+#define BASE_FREQ_HZ        2400400000u
+#define WAV_SAMPLE_RATE     8000u
+
+#define PWR_MAX_DBM         (13)
+#define PWR_MIN_DBM         (-18)
+
+// TX mode symbolic constants
+#define TXM_USB     0
+#define TXM_CW      1
+#define TXM_FM      2
+
+// Guard window after any mode change — suppresses TX output on both
+// cores while the carrier state machine settles and Core1 resumes
+// cleanly.  Prevents clicks when the user scrolls the mode menu.
+#define MODE_CHANGE_GUARD_MS   120u
+
+// --- PLL step ---
+static const float PLL_STEP_HZ =
+    (float)(52000000.0 / (double)(1u << 18)); // ~198.364 Hz
+
+// --- Runtime RF config (adjustable via CDC) ---
+// Frequency stored as double for sub-Hz precision; automatically split into PLL steps + fine DSP offset
+extern volatile double   g_target_freq_hz;
+extern volatile float    g_ppm_correction;   // manual (user/persisted) correction
+extern volatile float    g_ppm_disc;         // added by the PPM discipline loop (freqdisc.c)
+extern volatile uint8_t  g_cw_test_mode;     // 1 = CW test active (blocks normal Core1 operation)
+extern volatile int8_t   g_tx_power_max_dbm; // Runtime TX power limit
+extern volatile uint8_t  g_tx_enabled;       // TX enable flag (for GUI TX button), default OFF
+extern volatile uint8_t  g_tx_mode;          // 0 = USB (SSB), 1 = CW, 2 = FM
+extern volatile uint8_t  g_tune_active;      // 1 = TUNE carrier active
+extern volatile uint8_t  g_ptt_key;          // 1 = PTT/KEY pressed (live)
+extern volatile uint8_t  g_audio_src;        // 0 = PC (USB audio), 1 = MIC (ADC0)
+extern volatile uint8_t  g_audio_src_auto;   // 1 = MIC only until USB enumerates (boot fallback)
+extern volatile uint32_t g_mode_change_at_ms;
+
+// --- FM mode parameters ---
+extern volatile float    g_fm_deviation_hz;  // FM deviation in Hz (±, default NBFM)
+extern volatile float    g_ctcss_freq;       // CTCSS tone freq (0 = off)
+extern volatile uint8_t  g_roger_beep;       // Roger beep on end of FM TX (0=off, 1=on)
+
+// --- Boot milestones (ms since reset, 0 = not reached), reported by "boot" ---
+typedef struct {
+    uint32_t dsp_ms;        // DSP tables loaded, filters designed
+    uint32_t radio_ms;      // SX1280 out of reset and configured
+    uint32_t rf_ready_ms;   // Core1 applying blocks, PA enabled
+    uint32_t usb_ms;        // USB enumerated
+    uint32_t first_tx_ms;   // first carrier keyed
+} boot_times_t;
+
+extern volatile boot_times_t g_boot;
+
+// --- DSP config (written by CDC, applied by the producer on block boundary) ---
+extern volatile audio_cfg_t g_cfg;
+extern volatile uint8_t     g_cfg_dirty;
+
+static inline bool tx_mode_guard_active(void) {
+    uint32_t now = plat_ms();
+    return (now - g_mode_change_at_ms) < MODE_CHANGE_GUARD_MS;
+}
+
+// Calculate corrected frequency with PPM (manual + disciplined)
+static inline double get_corrected_freq_hz(void) {
+    double ppm = (double)g_ppm_correction + (double)g_ppm_disc;
+    return g_target_freq_hz * (1.0 + ppm / 1000000.0);
+}
+
+// Get base PLL steps (integer part)
+static inline uint32_t get_base_steps(void) {
+    double corrected_hz = get_corrected_freq_hz();
+    return (uint32_t)(corrected_hz / (double)PLL_STEP_HZ);
+}
+
+// Get fine tune offset in Hz (fractional part that PLL can't reach)
+static inline float get_fine_tune_hz(void) {
+    double corrected_hz = get_corrected_freq_hz();
+    uint32_t base_steps = (uint32_t)(corrected_hz / (double)PLL_STEP_HZ);
+    double base_hz = (double)base_steps * (double)PLL_STEP_HZ;
+    return (float)(corrected_hz - base_hz);
+}
+
+// Config snapshot / commit (cross-core safe)
+void cfg_snapshot(audio_cfg_t *out);
+void cfg_commit(const audio_cfg_t *c);
+
+const char *mode_label(uint8_t m);
+
+// CDC text protocol
+#define CDC_LINE_MAX    384     // longest command line: a full APRS frame for "pkt"
+void cdc_write_str(const char *s);
+void cdc_printf(const char *fmt, ...);
+void cfg_print(void);
+void boot_print(void);
+void cdc_status_push_ex(bool force);
+static inline void cdc_status_push(void) { cdc_status_push_ex(false); }
+void cdc_handle_line(char *line);
+
+// Helpers
+int  streqi(const char *a, const char *b);
+bool parse_bool(const char *s, uint8_t *out);
+bool parse_f(const char *s, float *out);
+bool cfg_set_key(audio_cfg_t *c, const char *key, float f);
+bool cfg_get_key(const audio_cfg_t *c, const char *key, float *f);
+void fmt_freq(char *buf, size_t len, double hz);
+
+#endif // CONTROL_H
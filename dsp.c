@@ -0,0 +1,396 @@
+// dsp.c - audio DSP building blocks shared by firmware and host tools
+
+#include <string.h>
+
+#include "dsp.h"
+#include "interp_accel.h"
+
+// ==========================================================
+// Biquad designs
+// ==========================================================
+void biquad_init_lowpass_bw2(biquad_t *q, float fc, float fs) {
+    const float K  = tanf((float)M_PI * fc / fs);
+    const float K2 = K * K;
+    const float s2 = 1.41421356f;
+    const float norm = 1.0f / (1.0f + s2 * K + K2);
+
+    q->b0 = K2 * norm;
+    q->b1 = 2.0f * q->b0;
+    q->b2 = q->b0;
+
+    q->a1 = 2.0f * (K2 - 1.0f) * norm;
+    q->a2 = (1.0f - s2 * K + K2) * norm;
+
+    biquad_reset(q);
+}
+
+void biquad_init_highpass_bw2(biquad_t *q, float fc, float fs) {
+    const float K  = tanf((float)M_PI * fc / fs);
+    const float K2 = K * K;
+    const float s2 = 1.41421356f;
+    const float norm = 1.0f / (1.0f + s2 * K + K2);
+
+    q->b0 = 1.0f * norm;
+    q->b1 = -2.0f * q->b0;
+    q->b2 = q->b0;
+
+    q->a1 = 2.0f * (K2 - 1.0f) * norm;
+    q->a2 = (1.0f - s2 * K + K2) * norm;
+
+    biquad_reset(q);
+}
+
+void biquad_init_low_shelf(biquad_t *q, float fc, float fs, float gain_db) {
+    const float A = powf(10.0f, gain_db / 40.0f);
+    const float w0 = 2.0f * (float)M_PI * fc / fs;
+    const float cw = cosf(w0);
+    const float sw = sinf(w0);
+    const float alpha = sw * 0.5f * 1.41421356f;
+
+    float b0 =    A*((A+1.0f) - (A-1.0f)*cw + 2.0f*sqrtf(A)*alpha);
+    float b1 =  2.0f*A*((A-1.0f) - (A+1.0f)*cw);
+    float b2 =    A*((A+1.0f) - (A-1.0f)*cw - 2.0f*sqrtf(A)*alpha);
+    float a0 =        (A+1.0f) + (A-1.0f)*cw + 2.0f*sqrtf(A)*alpha;
+    float a1 =   -2.0f*((A-1.0f) + (A+1.0f)*cw);
+    float a2 =        (A+1.0f) + (A-1.0f)*cw - 2.0f*sqrtf(A)*alpha;
+
+    q->b0 = b0 / a0; q->b1 = b1 / a0; q->b2 = b2 / a0;
+    q->a1 = a1 / a0; q->a2 = a2 / a0;
+    biquad_reset(q);
+}
+
+void biquad_init_high_shelf(biquad_t *q, float fc, float fs, float gain_db) {
+    const float A = powf(10.0f, gain_db / 40.0f);
+    const float w0 = 2.0f * (float)M_PI * fc / fs;
+    const float cw = cosf(w0);
+    const float sw = sinf(w0);
+    const float alpha = sw * 0.5f * 1.41421356f;
+
+    float b0 =    A*((A+1.0f) + (A-1.0f)*cw + 2.0f*sqrtf(A)*alpha);
+    float b1 = -2.0f*A*((A-1.0f) + (A+1.0f)*cw);
+    float b2 =    A*((A+1.0f) + (A-1.0f)*cw - 2.0f*sqrtf(A)*alpha);
+    float a0 =        (A+1.0f) - (A-1.0f)*cw + 2.0f*sqrtf(A)*alpha;
+    float a1 =    2.0f*((A-1.0f) - (A+1.0f)*cw);
+    float a2 =        (A+1.0f) - (A-1.0f)*cw - 2.0f*sqrtf(A)*alpha;
+
+    q->b0 = b0 / a0; q->b1 = b1 / a0; q->b2 = b2 / a0;
+    q->a1 = a1 / a0; q->a2 = a2 / a0;
+    biquad_reset(q);
+}
+
+// Analog prototype: Chebyshev I poles for the stopband ripple, inverted
+// and scaled to the (prewarped) stop edge; zeros on the jw axis at
+// ws / cos(theta_k).  Bilinear transform per conjugate pair.
+void biquad_init_lowpass_cheby2(biquad_t *q, int n, float f_stop, float atten_db, float fs) {
+    const int order = 2 * n;
+    const double ws = tan(M_PI * (double)f_stop / (double)fs);
+    const double mu = asinh(sqrt(pow(10.0, (double)atten_db / 10.0) - 1.0)) / order;
+
+    for (int k = 0; k < n; k++) {
+        const double th = M_PI * (2 * k + 1) / (2.0 * order);
+        // Chebyshev I pole, then p = ws / pole
+        const double cr = -sinh(mu) * sin(th), ci = cosh(mu) * cos(th);
+        const double m2 = cr * cr + ci * ci;
+        const double pr = ws * cr / m2, pi = -ws * ci / m2;
+        // z = (1 + p) / (1 - p)
+        const double dr = 1.0 - pr, di = -pi, dm = dr * dr + di * di;
+        const double zr = ((1.0 + pr) * dr + pi * di) / dm;
+        const double zi = (pi * dr - (1.0 + pr) * di) / dm;
+        const double a1 = -2.0 * zr, a2 = zr * zr + zi * zi;
+        // Zero at j * wz maps to the unit circle
+        const double wz = ws / cos(th);
+        const double c1 = -2.0 * (1.0 - wz * wz) / (1.0 + wz * wz);
+        const double g = (1.0 + a1 + a2) / (2.0 + c1);     // unity at DC
+
+        q[k].b0 = (float)g;
+        q[k].b1 = (float)(g * c1);
+        q[k].b2 = (float)g;
+        q[k].a1 = (float)a1;
+        q[k].a2 = (float)a2;
+        biquad_reset(&q[k]);
+    }
+}
+
+// ==========================================================
+// Compressor + config sanitising
+// ==========================================================
+void compressor_reconfig(compressor_t *c, float fs, const audio_cfg_t *cfg) {
+    c->env = 0.0f;
+
+    const float att_s = cfg->comp_attack_ms  * 0.001f;
+    const float rel_s = cfg->comp_release_ms * 0.001f;
+    c->a_att = expf(-1.0f / (fmaxf(att_s, 1e-4f) * fs));
+    c->a_rel = expf(-1.0f / (fmaxf(rel_s, 1e-4f) * fs));
+
+    c->thr_db = cfg->comp_thr_db;
+    c->ratio  = fmaxf(cfg->comp_ratio, 1.0f);
+    c->makeup_lin = powf(10.0f, cfg->comp_makeup_db / 20.0f);
+    c->knee_db    = fmaxf(cfg->comp_knee_db, 0.0f);
+    c->g_lin      = c->makeup_lin;
+}
+
+void cfg_sanitize(audio_cfg_t *c, float fs) {
+    if (c->bp_lo_hz < 50.0f) c->bp_lo_hz = 50.0f;
+    float max_hi = fs * 0.45f;
+    if (c->bp_hi_hz > max_hi) c->bp_hi_hz = max_hi;
+    if (c->bp_hi_hz <= c->bp_lo_hz + 50.0f) c->bp_hi_hz = c->bp_lo_hz + 50.0f;
+
+    if (c->eq_low_hz < 50.0f) c->eq_low_hz = 50.0f;
+    if (c->eq_low_hz > fs * 0.45f) c->eq_low_hz = fs * 0.45f;
+
+    if (c->eq_high_hz < 50.0f) c->eq_high_hz = 50.0f;
+    if (c->eq_high_hz > fs * 0.45f) c->eq_high_hz = fs * 0.45f;
+
+    if (c->comp_ratio < 1.0f) c->comp_ratio = 1.0f;
+    if (c->comp_attack_ms < 0.1f) c->comp_attack_ms = 0.1f;
+    if (c->comp_release_ms < 1.0f) c->comp_release_ms = 1.0f;
+
+    if (c->comp_out_limit < 0.05f) c->comp_out_limit = 0.05f;
+    if (c->comp_out_limit > 0.999f) c->comp_out_limit = 0.999f;
+    const float la_max_ms = (float)(LIM_LA_MAX - 1u) * 1000.0f / fs;
+    if (!(c->comp_lookahead_ms >= 0.0f)) c->comp_lookahead_ms = 0.0f;
+    if (c->comp_lookahead_ms > la_max_ms) c->comp_lookahead_ms = la_max_ms;
+
+    if (c->amp_gain < 0.01f) c->amp_gain = 0.01f;
+    if (c->amp_min_a < 1e-9f) c->amp_min_a = 1e-9f;
+
+    // MIC AGC
+    if (c->mic_agc_target < 0.01f) c->mic_agc_target = 0.01f;
+    if (c->mic_agc_target > 1.0f) c->mic_agc_target = 1.0f;
+    if (c->mic_agc_max_gain < 1.0f) c->mic_agc_max_gain = 1.0f;
+    if (c->mic_agc_max_gain > 200.0f) c->mic_agc_max_gain = 200.0f;
+    if (c->mic_agc_attack < 0.0001f) c->mic_agc_attack = 0.0001f;
+    if (c->mic_agc_attack > 0.5f) c->mic_agc_attack = 0.5f;
+    if (c->mic_agc_release < 0.00001f) c->mic_agc_release = 0.00001f;
+    if (c->mic_agc_release > 0.1f) c->mic_agc_release = 0.1f;
+    if (c->mic_gate_thresh < 0.0f) c->mic_gate_thresh = 0.0f;
+    if (c->mic_gate_thresh > 0.5f) c->mic_gate_thresh = 0.5f;
+
+    // Clamp bp_stages to valid range
+    if (c->bp_stages < 1) c->bp_stages = 1;
+    if (c->bp_stages > AUDIO_BP_MAX_STAGES) c->bp_stages = AUDIO_BP_MAX_STAGES;
+
+    if (c->ssb_engine > SSB_WEAVER) c->ssb_engine = SSB_HILBERT;
+}
+
+// ==========================================================
+// Look-ahead limiter
+// ==========================================================
+#define LIM_MASK    (LIM_LA_MAX - 1u)
+
+void limiter_reset(limiter_t *l) {
+    memset(l->d, 0, sizeof(l->d));
+    for (uint32_t k = 0; k < LIM_LA_MAX; k++) l->g1[k] = l->g2[k] = 1.0f;
+    l->pk_h = l->pk_t = 0;
+    l->g = 1.0f;
+    l->i = 0;
+}
+
+void limiter_reconfig(limiter_t *l, float fs, const audio_cfg_t *cfg) {
+    uint32_t la = (uint32_t)(cfg->comp_lookahead_ms * 0.001f * fs + 0.5f);
+    if (la > LIM_LA_MAX - 1u) la = LIM_LA_MAX - 1u;
+    l->k_rel = 1.0f - expf(-1.0f / (LIM_RELEASE_MS * 0.001f * fs));
+    // Other settings keep the delay line; a zeroed limiter (g == 0) is set up
+    if (la == l->la && l->g > 0.0f) return;
+    l->la = la;
+    l->n1 = la / 2u;
+    l->n2 = la - l->n1;
+    limiter_reset(l);
+}
+
+void limiter_block(limiter_t *l, float *x, uint32_t n, float limit) {
+    const uint32_t la = l->la, n1 = l->n1, n2 = l->n2;
+    if (!la) {
+        for (uint32_t k = 0; k < n; k++) {
+            if (x[k] > limit) x[k] = limit;
+            if (x[k] < -limit) x[k] = -limit;
+        }
+        return;
+    }
+
+    float s1 = 0.0f, s2 = 0.0f;
+    for (uint32_t k = 1; k <= n1 + 1u; k++) s1 += l->g1[(l->i - k) & LIM_MASK];
+    for (uint32_t k = 1; k <= n2 + 1u; k++) s2 += l->g2[(l->i - k) & LIM_MASK];
+    const float inv1 = 1.0f / (float)(n1 + 1u);
+    const float inv2 = 1.0f / (float)(n2 + 1u);
+    const float k_rel = l->k_rel;
+    uint32_t h = l->pk_h, t = l->pk_t, i = l->i;
+    float g = l->g;
+
+    for (uint32_t k = 0; k < n; k++, i++) {
+        // Window max over the last la + 1 inputs: expire the head, then
+        // drop smaller peaks from the tail (they can never be the max)
+        const float a = fabsf(x[k]);
+        if (h != t && i - l->pk_i[h & LIM_MASK] > la) h++;
+        while (h != t && l->pk_v[(t - 1u) & LIM_MASK] <= a) t--;
+        l->pk_v[t & LIM_MASK] = a;
+        l->pk_i[t & LIM_MASK] = i;
+        t++;
+        const float pk = l->pk_v[h & LIM_MASK];
+        const float gt = pk > limit ? limit / pk : 1.0f;
+
+        s1 += gt - l->g1[(i - n1 - 1u) & LIM_MASK];
+        l->g1[i & LIM_MASK] = gt;
+        const float b1 = s1 * inv1;
+        s2 += b1 - l->g2[(i - n2 - 1u) & LIM_MASK];
+        l->g2[i & LIM_MASK] = b1;
+
+        const float rel = g + (1.0f - g) * k_rel;
+        g = s2 * inv2;
+        if (g > rel) g = rel;
+
+        float y = l->d[(i - la) & LIM_MASK] * g;
+        l->d[i & LIM_MASK] = x[k];
+        if (y > limit) y = limit;               // float rounding in the sums
+        if (y < -limit) y = -limit;
+        x[k] = y;
+    }
+    l->pk_h = h;
+    l->pk_t = t;
+    l->i = i;
+    l->g = g;
+}
+
+// ==========================================================
+// MIC AGC
+// ==========================================================
+#define MIC_AGC_MIN_GAIN    0.1f
+
+void mic_agc_init(mic_agc_t *m) {
+    m->env = 0.0f;
+    m->gain = 1.0f;
+}
+
+// y: DC-free mic sample in +-1.0.  Returns 0 while the envelope sits
+// below the gate threshold.
+float mic_agc_process(mic_agc_t *m, float y, const audio_cfg_t *cfg) {
+    // Envelope follower (peak detector)
+    float abs_y = (y >= 0.0f) ? y : -y;
+    if (abs_y > m->env) {
+        m->env += cfg->mic_agc_attack * (abs_y - m->env);
+    } else {
+        m->env += cfg->mic_agc_release * (abs_y - m->env);
+    }
+
+    // Noise gate: if envelope is below threshold, output silence
+    if (m->env < cfg->mic_gate_thresh) {
+        return 0.0f;
+    }
+
+    // Compute gain from envelope
+    if (m->env > 1e-6f) {
+        m->gain = cfg->mic_agc_target / m->env;
+        if (m->gain > cfg->mic_agc_max_gain) m->gain = cfg->mic_agc_max_gain;
+        if (m->gain < MIC_AGC_MIN_GAIN) m->gain = MIC_AGC_MIN_GAIN;
+    }
+
+    float out = y * m->gain;
+
+    // Hard limiter to prevent clipping
+    if (out > 1.0f) out = 1.0f;
+    if (out < -1.0f) out = -1.0f;
+
+    return out;
+}
+
+// ==========================================================
+// Hilbert
+// ==========================================================
+#if HILB_RING < HILBERT_TAPS
+#error "HILB_RING must hold HILBERT_TAPS samples"
+#endif
+
+void hilbert_reset(hilbert_t *hb) {
+    for (uint32_t i = 0; i < HILB_RING; i++) hb->buf[i] = 0.0f;
+    hb->idx = 0;
+}
+
+// Taps come precomputed from flash (dsp_tables.c); copy them to RAM so
+// the per-sample loop never waits on XIP.
+void hilbert_init(hilbert_t *hb) {
+    memcpy(hb->h, dsp_hilbert_taps, sizeof(hb->h));
+    hb->len = HILBERT_TAPS;
+    hilbert_reset(hb);
+}
+
+void hilbert_set_len(hilbert_t *hb, uint16_t taps) {
+    if (taps == hb->len) return;
+
+    const float *src;
+    switch (taps) {
+        case HILBERT_TAPS_MID: src = dsp_hilbert_taps_mid; break;
+        case HILBERT_TAPS_LOW: src = dsp_hilbert_taps_low; break;
+        default: taps = HILBERT_TAPS; src = dsp_hilbert_taps; break;
+    }
+    memcpy(hb->h, src, taps * sizeof(float));
+    hb->len = taps;
+}
+
+uint16_t hilbert_len(const hilbert_t *hb) { return hb->len; }
+
+// A shorter filter just uses the newest len samples of the ring.
+// The tap walk gets its byte offsets from INTERP0 on the device.
+float hilbert_process(hilbert_t *hb, float x, float *i_delayed) {
+    const int N = hb->len;
+    const uint32_t M = (uint32_t)(N - 1) / 2u;
+
+    hb->buf[hb->idx] = x;
+
+    float y = 0.0f;
+    const float *h = hb->h;
+    const char *ring = (const char *)hb->buf;
+    ring_walk_t w;
+    ring_walk_begin(&w, hb->idx, HILB_RING_LOG2);
+    for (int n = 0; n < N; n++) {
+        y += h[n] * *(const float *)(ring + ring_walk_next(&w));
+    }
+
+    *i_delayed = hb->buf[(hb->idx - M) & HILB_RING_MASK];
+    hb->idx = (hb->idx + 1u) & HILB_RING_MASK;
+
+    return y;
+}
+
+// ==========================================================
+// Weaver
+// ==========================================================
+// Band lo..hi mixes down to -B/2..+B/2 around the centre; the opposite
+// sideband lands at least lo + centre away, which sets the stop edge.
+void weaver_init(weaver_t *w, float lo_hz, float hi_hz, float fs) {
+    if (lo_hz < WEAVER_LO_MIN_HZ) lo_hz = WEAVER_LO_MIN_HZ;
+    if (hi_hz > WEAVER_HI_MAX_HZ) hi_hz = WEAVER_HI_MAX_HZ;
+    if (hi_hz < lo_hz + 200.0f) hi_hz = lo_hz + 200.0f;
+
+    const float fc = 0.5f * (lo_hz + hi_hz);
+    const float f_stop = 0.5f * (hi_hz - lo_hz) + 2.0f * lo_hz;
+    biquad_init_lowpass_cheby2(w->lp_i, WEAVER_SECTIONS, f_stop, WEAVER_STOP_DB, fs);
+    memcpy(w->lp_q, w->lp_i, sizeof(w->lp_q));
+    w->step = (uint32_t)((double)fc / (double)fs * 4294967296.0);
+    w->ph = 0;
+}
+
+void weaver_reset(weaver_t *w) {
+    for (int k = 0; k < WEAVER_SECTIONS; k++) {
+        biquad_reset(&w->lp_i[k]);
+        biquad_reset(&w->lp_q[k]);
+    }
+    w->ph = 0;
+}
+
+float weaver_process(weaver_t *w, float x, float *i_out) {
+    const float c = lut_sin(w->ph + 0x40000000u);
+    const float s = lut_sin(w->ph);
+    w->ph += w->step;
+
+    // x * e^(-j wc n), lowpassed: the band at baseband
+    float bi =  x * c;
+    float bq = -x * s;
+    for (int k = 0; k < WEAVER_SECTIONS; k++) {
+        bi = biquad_process(&w->lp_i[k], bi);
+        bq = biquad_process(&w->lp_q[k], bq);
+    }
+
+    // ... times 2 e^(+j wc n): back up, one sideband only
+    *i_out = 2.0f * (bi * c - bq * s);
+    return 2.0f * (bi * s + bq * c);
+}
@@ -0,0 +1,355 @@
+// dsp.h - audio DSP building blocks shared by firmware and host tools
+// Biquads, soft-knee compressor, MIC AGC, Hilbert FIR and the runtime
+// audio config.  No Pico SDK dependencies: everything here also compiles
+// natively.  All filter state lives in caller-owned structs, so any
+// number of chains can run side by side (host/sxrender).
+
+#ifndef DSP_H
+#define DSP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ================== AUDIO SHAPING (default values) ==================
+#define AUDIO_ENABLE_BANDPASS       1
+#define AUDIO_BP_LO_HZ              50.0f
+#define AUDIO_BP_HI_HZ              2700.0f
+#define AUDIO_BP_MAX_STAGES         10      // Max stages (compile-time allocation)
+#define AUDIO_BP_DEFAULT_STAGES     7       // Default stages (runtime adjustable, 1-10)
+// Each stage = 12 dB/octave, so 7 stages = 84 dB/oct, 10 stages = 120 dB/oct
+
+#define AUDIO_ENABLE_EQ             1
+#define EQ_LOW_SHELF_HZ             190.0f
+#define EQ_LOW_SHELF_DB             (-2.0f)
+#define EQ_HIGH_SHELF_HZ            1700.0f
+#define EQ_HIGH_SHELF_DB            (13.5f)
+// ===============================================
+
+// ================== COMPRESSION (default values) ==================
+#define AUDIO_ENABLE_COMPRESSOR     1
+#define COMP_THRESHOLD_DB           (-2.5f)
+#define COMP_RATIO                  (6.1f)
+#define COMP_ATTACK_MS              (41.1f)
+#define COMP_RELEASE_MS             (1595.0f)
+#define COMP_MAKEUP_DB              (0.0f)
+#define COMP_KNEE_DB                (16.5f)
+#define COMP_OUTPUT_LIMIT           (0.940f)
+#define COMP_LOOKAHEAD_MS           (4.0f)  // look-ahead limiter, 0 = hard clip at the output limit
+// ===============================================
+
+#define AMP_GAIN            2.9f
+#define AMP_MIN_A           0.000002f
+
+// --- Hilbert ---
+#define HILBERT_TAPS        247
+#define HILBERT_TAPS_MID    127     // shorter designs the DSP governor
+#define HILBERT_TAPS_LOW    63      // (dspgov.c) falls back to under load
+
+// --- Weaver SSB (alternative to the Hilbert FIR, cfg.ssb_engine) ---
+#define SSB_HILBERT         0
+#define SSB_WEAVER          1
+#define WEAVER_SECTIONS     4       // biquads per branch: 8th-order lowpass
+#define WEAVER_STOP_DB      60.0f   // opposite-sideband floor
+#define WEAVER_LO_MIN_HZ    300.0f  // band the mixers are centred on:
+#define WEAVER_HI_MAX_HZ    3000.0f // bp_lo..bp_hi limited to this
+
+// --- Sine LUT (test-signal NCOs) ---
+#define SIN_LUT_LOG2        10      // 1024 points + linear interp: spurs < -100 dBc
+
+#define GATE_A_REF          0.01f   // Noise gate threshold - higher with compressor
+#define GATE_SHAPE          1
+
+// ==========================================================
+// Biquad (transposed direct form II)
+// ==========================================================
+typedef struct {
+    float b0, b1, b2;
+    float a1, a2;
+    float z1, z2;
+} biquad_t;
+
+static inline void biquad_reset(biquad_t *q) { q->z1 = 0.0f; q->z2 = 0.0f; }
+
+static inline float biquad_process(biquad_t *q, float x) {
+    float y = q->b0 * x + q->z1;
+    q->z1 = q->b1 * x - q->a1 * y + q->z2;
+    q->z2 = q->b2 * x - q->a2 * y;
+    return y;
+}
+
+void biquad_init_lowpass_bw2(biquad_t *q, float fc, float fs);
+void biquad_init_highpass_bw2(biquad_t *q, float fc, float fs);
+void biquad_init_low_shelf(biquad_t *q, float fc, float fs, float gain_db);
+void biquad_init_high_shelf(biquad_t *q, float fc, float fs, float gain_db);
+// Inverse Chebyshev lowpass of order 2 * n: flat passband, atten_db
+// equiripple from f_stop up.  Unity DC gain.
+void biquad_init_lowpass_cheby2(biquad_t *q, int n, float f_stop, float atten_db, float fs);
+
+// ==========================================================
+// Compressor (soft knee, peak envelope)
+// ==========================================================
+typedef struct {
+    float env;
+    float a_att, a_rel;
+    float thr_db, ratio, makeup_lin, knee_db;
+    float g_lin;            // last gain, held between control-rate updates
+} compressor_t;
+
+static inline float compressor_gain_db(const compressor_t *c, float in_db) {
+    const float thr = c->thr_db;
+    const float r = c->ratio;
+
+    if (c->knee_db <= 0.0f) {
+        if (in_db <= thr) return 0.0f;
+        float out_db = thr + (in_db - thr) / r;
+        return out_db - in_db;
+    }
+
+    const float k = c->knee_db;
+    const float x0 = thr - k * 0.5f;
+    const float x1 = thr + k * 0.5f;
+
+    if (in_db <= x0) return 0.0f;
+    if (in_db >= x1) {
+        float out_db = thr + (in_db - thr) / r;
+        return out_db - in_db;
+    }
+
+    const float t = (in_db - x0) / (x1 - x0);
+    float out1 = thr + (x1 - thr) / r;
+    float g1 = out1 - x1;
+    return g1 * t * t;
+}
+
+static inline void compressor_track(compressor_t *c, float x) {
+    float ax = fabsf(x);
+    if (ax > c->env) c->env = c->a_att * c->env + (1.0f - c->a_att) * ax;
+    else            c->env = c->a_rel * c->env + (1.0f - c->a_rel) * ax;
+}
+
+static inline void compressor_update_gain(compressor_t *c) {
+    float env = fmaxf(c->env, 1e-8f);
+    float in_db = 20.0f * log10f(env);
+
+    float g_db = compressor_gain_db(c, in_db);
+    c->g_lin = powf(10.0f, g_db / 20.0f) * c->makeup_lin;
+}
+
+static inline float compressor_process(compressor_t *c, float x) {
+    compressor_track(c, x);
+    compressor_update_gain(c);
+    return x * c->g_lin;
+}
+
+// Control-rate variant: the envelope still runs every sample, but the
+// gain curve (log10f + powf) is only evaluated when update is set.  With
+// attack times of tens of ms, holding the gain for a few samples is
+// inaudible.
+static inline float compressor_process_cr(compressor_t *c, float x, bool update) {
+    compressor_track(c, x);
+    if (update) compressor_update_gain(c);
+    return x * c->g_lin;
+}
+
+// ==========================================================
+// Runtime-configurable DSP settings (over USB CDC)
+// ==========================================================
+typedef struct {
+    uint8_t enable_bandpass;
+    uint8_t enable_eq;
+    uint8_t enable_comp;
+
+    float bp_lo_hz;
+    float bp_hi_hz;
+    uint8_t bp_stages;      // 1-10, each stage = 12 dB/octave
+
+    float eq_low_hz;
+    float eq_low_db;
+    float eq_high_hz;
+    float eq_high_db;
+
+    float comp_thr_db;
+    float comp_ratio;
+    float comp_attack_ms;
+    float comp_release_ms;
+    float comp_makeup_db;
+    float comp_knee_db;
+    float comp_out_limit;
+    float comp_lookahead_ms;
+
+    float amp_gain;
+    float amp_min_a;
+
+    // MIC AGC (for ADC microphone input)
+    float mic_agc_target;    // Target envelope level (0..1)
+    float mic_agc_max_gain;  // Maximum gain (prevents noise pumping in silence)
+    float mic_agc_attack;    // Attack coefficient (0..1, higher = faster)
+    float mic_agc_release;   // Release coefficient (0..1, higher = faster)
+    float mic_gate_thresh;   // Noise gate threshold — below this, output is zero
+
+    uint8_t ssb_engine;      // SSB_HILBERT / SSB_WEAVER
+} audio_cfg_t;
+
+#define AUDIO_CFG_DEFAULTS {                        \
+    .enable_bandpass = AUDIO_ENABLE_BANDPASS,       \
+    .enable_eq       = AUDIO_ENABLE_EQ,             \
+    .enable_comp     = AUDIO_ENABLE_COMPRESSOR,     \
+                                                    \
+    .bp_lo_hz  = AUDIO_BP_LO_HZ,                    \
+    .bp_hi_hz  = AUDIO_BP_HI_HZ,                    \
+    .bp_stages = AUDIO_BP_DEFAULT_STAGES,           \
+                                                    \
+    .eq_low_hz  = EQ_LOW_SHELF_HZ,                  \
+    .eq_low_db  = EQ_LOW_SHELF_DB,                  \
+    .eq_high_hz = EQ_HIGH_SHELF_HZ,                 \
+    .eq_high_db = EQ_HIGH_SHELF_DB,                 \
+                                                    \
+    .comp_thr_db     = COMP_THRESHOLD_DB,           \
+    .comp_ratio      = COMP_RATIO,                  \
+    .comp_attack_ms  = COMP_ATTACK_MS,              \
+    .comp_release_ms = COMP_RELEASE_MS,             \
+    .comp_makeup_db  = COMP_MAKEUP_DB,              \
+    .comp_knee_db    = COMP_KNEE_DB,                \
+    .comp_out_limit  = COMP_OUTPUT_LIMIT,           \
+    .comp_lookahead_ms = COMP_LOOKAHEAD_MS,         \
+                                                    \
+    .amp_gain  = AMP_GAIN,                          \
+    .amp_min_a = AMP_MIN_A,                         \
+                                                    \
+    .mic_agc_target   = 0.75f,                      \
+    .mic_agc_max_gain = 1.0f,                       \
+    .mic_agc_attack   = 0.01f,                      \
+    .mic_agc_release  = 0.0001f,                    \
+    .mic_gate_thresh  = 0.005f,                     \
+                                                    \
+    .ssb_engine = SSB_HILBERT,                      \
+}
+
+void compressor_reconfig(compressor_t *c, float fs, const audio_cfg_t *cfg);
+void cfg_sanitize(audio_cfg_t *c, float fs);
+
+// ==========================================================
+// Look-ahead peak limiter (after the compressor, whole blocks)
+//
+// The audio is delayed by la samples while a sliding-window maximum
+// (monotonic deque) looks at what is coming.  Each sample's target gain
+// limit / peak-in-window goes through two moving averages whose lengths
+// add up to la, so the gain has come down along an S-curve by the time
+// the peak leaves the delay line and |out| <= limit holds without a
+// clip.  It recovers no faster than LIM_RELEASE_MS.  O(1) amortised per
+// sample; the running sums are re-added once per block so float
+// rounding cannot build up.
+// ==========================================================
+#define LIM_LA_MAX          64u     // ring size, power of two: la <= 63 (7.9 ms)
+#define LIM_RELEASE_MS      30.0f
+
+typedef struct {
+    float    d[LIM_LA_MAX];         // delayed audio
+    float    pk_v[LIM_LA_MAX];      // deque: peaks, decreasing from head ...
+    uint32_t pk_i[LIM_LA_MAX];      // ... and the sample each came in at
+    uint32_t pk_h, pk_t;            // free-running head / tail
+    float    g1[LIM_LA_MAX];        // target gains (first average)
+    float    g2[LIM_LA_MAX];        // first average (second average)
+    uint32_t n1, n2;                // average lengths - 1, n1 + n2 = la
+    float    k_rel;                 // release per sample
+    float    g;                     // gain applied last
+    uint32_t la;                    // look-ahead in samples, 0 = hard clip
+    uint32_t i;                     // samples seen
+} limiter_t;
+
+// Resets the delay line only when the look-ahead changes
+void limiter_reconfig(limiter_t *l, float fs, const audio_cfg_t *cfg);
+void limiter_reset(limiter_t *l);
+// In place: out = in delayed by la samples, |out| <= limit
+void limiter_block(limiter_t *l, float *x, uint32_t n, float limit);
+
+// ==========================================================
+// MIC AGC (peak envelope follower + noise gate + limiter)
+// ==========================================================
+typedef struct {
+    float env;
+    float gain;
+} mic_agc_t;
+
+void  mic_agc_init(mic_agc_t *m);
+float mic_agc_process(mic_agc_t *m, float y, const audio_cfg_t *cfg);
+
+// ==========================================================
+// Hilbert FIR (type III, Hamming window)
+// ==========================================================
+extern const float dsp_hilbert_taps[HILBERT_TAPS];   // dsp_tables.c
+extern const float dsp_hilbert_taps_mid[HILBERT_TAPS_MID];
+extern const float dsp_hilbert_taps_low[HILBERT_TAPS_LOW];
+
+// Delay line rounded up to a power of two so indices wrap with a mask
+// (and the SIO interpolator can walk it).
+#define HILB_RING_LOG2      8
+#define HILB_RING           (1u << HILB_RING_LOG2)
+#define HILB_RING_MASK      (HILB_RING - 1u)
+
+typedef struct {
+    float    h[HILBERT_TAPS];   // active taps, copied to RAM
+    float    buf[HILB_RING];
+    uint32_t idx;
+    uint16_t len;
+} hilbert_t;
+
+void  hilbert_init(hilbert_t *hb);
+void  hilbert_reset(hilbert_t *hb);
+float hilbert_process(hilbert_t *hb, float x, float *i_delayed);
+
+// Switch between HILBERT_TAPS / _MID / _LOW without clearing the delay
+// line; the I/Q group delay changes by the difference in half-lengths.
+void     hilbert_set_len(hilbert_t *hb, uint16_t taps);
+uint16_t hilbert_len(const hilbert_t *hb);
+
+// ==========================================================
+// Weaver SSB: quadrature mix to the band centre, lowpass both branches,
+// mix back.  The result is the analytic signal of the band, like the
+// Hilbert pair, for about a fifth of the multiplies and a few ms less
+// delay.  Band edges the 8 kHz lowpass cannot separate from the opposite
+// sideband (below WEAVER_LO_MIN_HZ) are narrowed to what it can.
+// ==========================================================
+typedef struct {
+    biquad_t lp_i[WEAVER_SECTIONS];
+    biquad_t lp_q[WEAVER_SECTIONS];
+    uint32_t ph, step;      // Q32 NCO at the band centre
+} weaver_t;
+
+void  weaver_init(weaver_t *w, float lo_hz, float hi_hz, float fs);
+void  weaver_reset(weaver_t *w);
+// Same convention as hilbert_process: returns Q, I in *i_out
+float weaver_process(weaver_t *w, float x, float *i_out);
+
+// ==========================================================
+// Sine LUT NCO: Q32 phase (fraction of a turn), linear interpolation
+// ==========================================================
+#define SIN_LUT_SIZE        (1u << SIN_LUT_LOG2)
+#define SIN_LUT_FRAC_BITS   (32u - SIN_LUT_LOG2)
+
+extern const float dsp_sin_lut[SIN_LUT_SIZE + 1u];  // dsp_tables.c, last = first
+
+static inline float lut_sin(uint32_t ph) {
+    uint32_t i = ph >> SIN_LUT_FRAC_BITS;
+    float f = (float)(ph & ((1u << SIN_LUT_FRAC_BITS) - 1u)) * (1.0f / (float)(1u << SIN_LUT_FRAC_BITS));
+    float a = dsp_sin_lut[i];
+    return a + (dsp_sin_lut[i + 1u] - a) * f;
+}
+
+static inline float duty_from_A(float A) {
+    if (A <= 0.0f) return 0.0f;
+    float r = A / GATE_A_REF;
+    if (r >= 1.0f) return 1.0f;
+#if GATE_SHAPE == 2
+    return r * r;
+#else
+    return r;
+#endif
+}
+
+#endif // DSP_H
@@ -0,0 +1,123 @@
+// dspgov.c - adaptive DSP quality governor
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dspgov.h"
+#include "dsp.h"
+#include "control.h"
+
+static const dspgov_profile_t profiles[GOV_LEVELS] = {
+    { AUDIO_BP_MAX_STAGES, HILBERT_TAPS,     1u             },
+    { AUDIO_BP_MAX_STAGES, HILBERT_TAPS,     GOV_COMP_DECIM },
+    { 5u,                  HILBERT_TAPS,     GOV_COMP_DECIM },
+    { 5u,                  HILBERT_TAPS_MID, GOV_COMP_DECIM },
+    { 3u,                  HILBERT_TAPS_LOW, GOV_COMP_DECIM },
+};
+
+static uint8_t  gov_mode = GOV_AUTO;
+static uint8_t  gov_level = GOV_START_LEVEL;
+static float    load_avg;           // smoothed load, percent
+static uint8_t  load_peak;
+static uint32_t over_ct, under_ct;
+static uint32_t hold;
+static uint32_t up_blocks = GOV_UP_BLOCKS;
+static uint32_t since_up = UINT32_MAX;
+static uint32_t since_down;
+static uint32_t n_downs, n_ups;
+static uint32_t last_und;
+static bool     have_und;
+
+void dspgov_set(uint8_t mode) {
+    if (mode != GOV_AUTO) {
+        if (mode >= GOV_LEVELS) mode = GOV_LEVELS - 1u;
+        gov_level = mode;
+    }
+    gov_mode = mode;
+    over_ct = under_ct = 0;
+    hold = GOV_HOLD_BLOCKS;
+    dspgov_print(mode == GOV_AUTO ? "auto" : "manual");
+}
+
+uint8_t dspgov_mode(void) { return gov_mode; }
+
+const dspgov_profile_t *dspgov_profile(void) { return &profiles[gov_level]; }
+
+void dspgov_stats(dspgov_stats_t *out) {
+    out->mode = gov_mode;
+    out->level = gov_level;
+    out->load_pct = (uint8_t)(load_avg + 0.5f);
+    out->peak_pct = load_peak;
+    out->downs = n_downs;
+    out->ups = n_ups;
+    out->up_blocks = up_blocks;
+}
+
+void dspgov_print(const char *why) {
+    const dspgov_profile_t *p = &profiles[gov_level];
+    cdc_printf("!G mode=%s lvl=%u why=%s load=%u peak=%u bpmax=%u hilb=%u cdec=%u up=%lu\r\n",
+               gov_mode == GOV_AUTO ? "auto" : "fixed", gov_level, why,
+               (unsigned)(load_avg + 0.5f), load_peak,
+               p->bp_max, p->hilb_taps, p->comp_decim, (unsigned long)up_blocks);
+    load_peak = 0;
+}
+
+static void step_down(const char *why) {
+    if (gov_level + 1u >= GOV_LEVELS) return;
+
+    // Pushed back down soon after a step up: the level above does not
+    // fit, so wait longer before trying it again.
+    if (since_up < 2u * up_blocks) {
+        up_blocks *= 2u;
+        if (up_blocks > GOV_UP_BLOCKS_MAX) up_blocks = GOV_UP_BLOCKS_MAX;
+    }
+    gov_level++;
+    n_downs++;
+    since_down = 0;
+    hold = GOV_HOLD_BLOCKS;
+    over_ct = under_ct = 0;
+    dspgov_print(why);
+}
+
+static void step_up(void) {
+    gov_level--;
+    n_ups++;
+    since_up = 0;
+    hold = GOV_HOLD_BLOCKS;
+    over_ct = under_ct = 0;
+    dspgov_print("headroom");
+}
+
+void dspgov_block(uint32_t busy_us, uint32_t deadline_us, uint32_t ready, uint32_t underruns) {
+    uint32_t pct = deadline_us ? (uint32_t)(((uint64_t)busy_us * 100u) / deadline_us) : 0u;
+    if (pct > 255u) pct = 255u;
+
+    load_avg += ((float)pct - load_avg) * 0.125f;
+    if (pct > load_peak) load_peak = (uint8_t)pct;
+
+    bool und = have_und && underruns != last_und;
+    last_und = underruns;
+    have_und = true;
+
+    if (gov_mode != GOV_AUTO) return;
+
+    if (since_up != UINT32_MAX) since_up++;
+    if (++since_down >= GOV_UP_BLOCKS_MAX && up_blocks > GOV_UP_BLOCKS) {
+        // Stable for a long time: let the backoff relax again
+        up_blocks /= 2u;
+        since_down = 0;
+    }
+
+    if (hold) { hold--; return; }
+
+    // Underruns and an empty queue only count against the DSP when it is
+    // a real share of the deadline; otherwise cutting quality cannot help.
+    bool behind = pct >= GOV_UP_PCT && (und || ready <= GOV_SLACK_BLOCKS);
+
+    over_ct  = (pct > GOV_DOWN_PCT) ? over_ct + 1u : 0u;
+    under_ct = (pct < GOV_UP_PCT && !und) ? under_ct + 1u : 0u;
+
+    if (behind)                         step_down(und ? "underrun" : "slack");
+    else if (over_ct >= GOV_DOWN_BLOCKS) step_down("load");
+    else if (gov_level > 0 && under_ct >= up_blocks) step_up();
+}
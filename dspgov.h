@@ -0,0 +1,74 @@
+// dspgov.h - adaptive DSP quality governor
+//
+// The producer reports how long each block took to compute (audio wait
+// excluded) against the block deadline (BLOCK_SAMPLES at 8 kHz = 32 ms),
+// plus queue slack and underruns.  Under sustained pressure the governor
+// steps down the costly DSP stages one level at a time in a fixed order;
+// after a long quiet stretch it steps back up.  Every decision is pushed
+// as a "!G" telemetry line.  Portable: host/govcheck drives it directly.
+
+#ifndef DSPGOV_H
+#define DSPGOV_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "platform.h"
+
+// Quality levels, cheapest quality loss first:
+//   0  full quality
+//   1  compressor gain at control rate (every GOV_COMP_DECIM samples)
+//   2  + bandpass capped at 5 stages per side (60 dB/oct)
+//   3  + Hilbert HILBERT_TAPS_MID
+//   4  + bandpass 3 stages, Hilbert HILBERT_TAPS_LOW
+#define GOV_LEVELS          5u
+#define GOV_AUTO            0xFFu   // dspgov_set(): adapt automatically
+
+#define GOV_COMP_DECIM      8u
+
+// Level at boot.  Without an FPU (Hazard3) the full chain cannot keep up,
+// so start cheapest and let the governor step up instead of underrunning
+// through every level first.
+#if SX_HAS_FPU
+#define GOV_START_LEVEL     0u
+#else
+#define GOV_START_LEVEL     (GOV_LEVELS - 1u)
+#endif
+
+// Thresholds in percent of the block deadline
+#define GOV_DOWN_PCT        75u     // step down above this ...
+#define GOV_DOWN_BLOCKS     4u      // ... for this many blocks in a row
+#define GOV_UP_PCT          45u     // step up below this ...
+#define GOV_UP_BLOCKS       64u     // ... for this many blocks (~2 s)
+#define GOV_UP_BLOCKS_MAX   1024u   // backoff ceiling after bounces (~33 s)
+#define GOV_HOLD_BLOCKS     16u     // ignore pressure right after a change
+#define GOV_SLACK_BLOCKS    1u      // ready blocks at or below this = behind
+
+typedef struct {
+    uint8_t  bp_max;        // cap on bandpass stages per side
+    uint16_t hilb_taps;     // Hilbert FIR length
+    uint8_t  comp_decim;    // compressor gain update interval (samples)
+} dspgov_profile_t;
+
+typedef struct {
+    uint8_t  mode;          // GOV_AUTO or pinned level
+    uint8_t  level;
+    uint8_t  load_pct;      // smoothed DSP load, % of block deadline
+    uint8_t  peak_pct;      // peak since the last report
+    uint32_t downs, ups;    // automatic decisions taken
+    uint32_t up_blocks;     // current step-up hold (grows after bounces)
+} dspgov_stats_t;
+
+void    dspgov_set(uint8_t mode);           // GOV_AUTO or 0..GOV_LEVELS-1
+uint8_t dspgov_mode(void);
+void    dspgov_stats(dspgov_stats_t *out);
+const dspgov_profile_t *dspgov_profile(void);
+
+// Called by the producer after every block: busy_us is compute time,
+// ready the blocks still queued for Core1 when the block was started.
+void dspgov_block(uint32_t busy_us, uint32_t deadline_us, uint32_t ready, uint32_t underruns);
+
+// "!G" telemetry line / "gov" command output
+void dspgov_print(const char *why);
+
+#endif // DSPGOV_H
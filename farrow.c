@@ -0,0 +1,196 @@
+// farrow.c - band-limited fractional resampler, host audio rate -> 8 kHz
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "farrow.h"
+#include "control.h"
+#include "platform.h"
+#include "dsp.h"
+
+const uint32_t farrow_rates[FARROW_N_RATES] = { 22050u, 32000u, 44100u, 48000u, 96000u };
+
+bool farrow_rate_ok(uint32_t in_rate) {
+    for (uint32_t i = 0; i < FARROW_N_RATES; i++)
+        if (farrow_rates[i] == in_rate) return true;
+    return false;
+}
+
+// Zeroth-order modified Bessel function (Kaiser window), series form
+static float bessel_i0(float x) {
+    float sum = 1.0f, term = 1.0f;
+    const float q = 0.25f * x * x;
+    for (int k = 1; k < 32; k++) {
+        term *= q / (float)(k * k);
+        sum += term;
+        if (term < 1e-7f * sum) break;
+    }
+    return sum;
+}
+
+// Kaiser window parameters for FARROW_ATTEN_DB
+static float kaiser_beta(void) {
+    const float a = FARROW_ATTEN_DB;
+    return (a > 50.0f) ? 0.1102f * (a - 8.7f) : 0.5842f * powf(a - 21.0f, 0.4f) + 0.07886f * (a - 21.0f);
+}
+
+// Taps for a transition of dw (cycles/sample), rounded up to even
+static uint32_t kaiser_len(float dw, uint32_t max) {
+    uint32_t n = (uint32_t)ceilf((FARROW_ATTEN_DB - 8.0f) / (2.285f * 2.0f * (float)M_PI * dw));
+    n = (n + 1u) & ~1u;
+    return n > max ? max : n;
+}
+
+// Windowed-sinc lowpass at continuous time t (samples) from the centre,
+// cutoff fc in cycles/sample, window span len samples
+static float lp_at(float t, float fc, float len, float beta, float i0b) {
+    const float r = 2.0f * t / len;
+    if (r <= -1.0f || r >= 1.0f) return 0.0f;
+    const float x = 2.0f * (float)M_PI * fc * t;
+    const float s = (fabsf(x) < 1e-6f) ? 2.0f * fc : 2.0f * fc * sinf(x) / x;
+    return s * bessel_i0(beta * sqrtf(1.0f - r * r)) / i0b;
+}
+
+bool farrow_design(farrow_t *f, uint32_t in_rate) {
+    bool ok = farrow_rate_ok(in_rate);
+    if (!ok) in_rate = 48000u;
+
+    memset(f, 0, sizeof(*f));
+    f->in_rate = in_rate;
+    f->dec = (in_rate >= 88000u) ? 4u : (in_rate >= 32000u) ? 2u : 1u;
+    f->mid_rate = in_rate / f->dec;
+
+    const float beta = kaiser_beta();
+    const float i0b = bessel_i0(beta);
+
+    // Stage 1: keep the passband, kill what folds below FARROW_STOP_HZ
+    // at the middle rate.
+    if (f->dec > 1u) {
+        const float fs = (float)in_rate;
+        const float stop = (float)f->mid_rate - FARROW_STOP_HZ;
+        const float fc = 0.5f * (FARROW_PASS_HZ + stop) / fs;
+        f->dtaps = (uint16_t)kaiser_len((stop - FARROW_PASS_HZ) / fs, FARROW_MAX_DTAPS);
+        float sum = 0.0f;
+        for (uint32_t j = 0; j < f->dtaps; j++) {
+            f->dh[j] = lp_at((float)j - 0.5f * (float)(f->dtaps - 1u), fc, (float)f->dtaps, beta, i0b);
+            sum += f->dh[j];
+        }
+        for (uint32_t j = 0; j < f->dtaps; j++) f->dh[j] /= sum;
+    }
+
+    // Stage 2: h(j - L/2 + mu) for tap j, fitted by a cubic through
+    // mu = 0, 1/3, 2/3, 1 (the response is smooth over one middle-rate
+    // sample, so the fit error sits well under the stopband).
+    const float fs = (float)f->mid_rate;
+    const float fc = 0.5f * (FARROW_PASS_HZ + FARROW_STOP_HZ) / fs;
+    f->taps = (uint16_t)kaiser_len((FARROW_STOP_HZ - FARROW_PASS_HZ) / fs, FARROW_MAX_TAPS);
+    const float L = (float)f->taps;
+    float dc = 0.0f;
+
+    for (uint32_t j = 0; j < f->taps; j++) {
+        const float t0 = (float)j - 0.5f * L;
+        const float y0 = lp_at(t0,               fc, L, beta, i0b);
+        const float y1 = lp_at(t0 + 1.0f / 3.0f, fc, L, beta, i0b);
+        const float y2 = lp_at(t0 + 2.0f / 3.0f, fc, L, beta, i0b);
+        const float y3 = lp_at(t0 + 1.0f,        fc, L, beta, i0b);
+
+        // Newton forward differences on a 1/3 grid -> power basis in mu
+        const float d1 = y1 - y0, d2 = y2 - 2.0f * y1 + y0, d3 = y3 - 3.0f * y2 + 3.0f * y1 - y0;
+        f->c[0][j] = y0;
+        f->c[1][j] = 3.0f * d1 - 1.5f * d2 + d3;
+        f->c[2][j] = 4.5f * d2 - 4.5f * d3;
+        f->c[3][j] = 4.5f * d3;
+        dc += y0;
+    }
+    // Unity gain at DC (the mu = 0 phase; the others match to ~1e-4)
+    for (uint32_t m = 0; m < 4u; m++)
+        for (uint32_t j = 0; j < f->taps; j++) f->c[m][j] /= dc;
+
+    return ok;
+}
+
+void farrow_reset(farrow_t *f) {
+    memset(f->din, 0, sizeof(f->din));
+    memset(f->mid, 0, sizeof(f->mid));
+    f->din_idx = f->mid_idx = 0;
+    f->dec_phase = 0;
+}
+
+static inline void mid_push(farrow_t *f, float y) {
+    f->mid_idx = (f->mid_idx + 1u) & (FARROW_RING - 1u);
+    f->mid[f->mid_idx] = y;
+    f->mid[f->mid_idx + FARROW_RING] = y;
+}
+
+bool farrow_push(farrow_t *f, float x) {
+    if (f->dec <= 1u) {
+        mid_push(f, x);
+        return true;
+    }
+
+    f->din_idx = (f->din_idx + 1u) & (FARROW_RING - 1u);
+    f->din[f->din_idx] = x;
+    f->din[f->din_idx + FARROW_RING] = x;
+    if (++f->dec_phase < f->dec) return false;
+    f->dec_phase = 0;
+
+    // Newest sample at din[idx + RING], older ones below it
+    const float *p = &f->din[f->din_idx + FARROW_RING];
+    float acc = 0.0f;
+    for (uint32_t j = 0; j < f->dtaps; j++) acc += f->dh[j] * p[-(int32_t)j];
+    mid_push(f, acc);
+    return true;
+}
+
+float farrow_out(const farrow_t *f, float mu) {
+    // Tap j weights the sample j behind the newest one
+    const float *p = &f->mid[f->mid_idx + FARROW_RING];
+    float a0 = 0.0f, a1 = 0.0f, a2 = 0.0f, a3 = 0.0f;
+    for (uint32_t j = 0; j < f->taps; j++) {
+        const float x = p[-(int32_t)j];
+        a0 += f->c[0][j] * x;
+        a1 += f->c[1][j] * x;
+        a2 += f->c[2][j] * x;
+        a3 += f->c[3][j] * x;
+    }
+    return ((a3 * mu + a2) * mu + a1) * mu + a0;
+}
+
+uint32_t farrow_macs(const farrow_t *f) {
+    // Stage 1 runs once per middle sample, mid_rate / 8 kHz of them per output
+    return 4u * f->taps + 3u + (uint32_t)f->dtaps * f->mid_rate / WAV_SAMPLE_RATE;
+}
+
+uint32_t farrow_bench_ns(uint32_t in_rate, uint32_t n_out, uint32_t *macs) {
+    static farrow_t f;
+    if (!farrow_design(&f, in_rate) || n_out == 0) return 0;
+    if (macs) *macs = farrow_macs(&f);
+
+    // Fixed step, 1 kHz tone; the Q16 phase mirrors the USB resampler
+    const uint32_t step = (uint32_t)(((uint64_t)f.mid_rate << 16) / WAV_SAMPLE_RATE);
+    const uint32_t tone = (uint32_t)(1000.0 * 4294967296.0 / (double)in_rate);
+    uint32_t ph = 0, nco = 0;
+    volatile float sink = 0.0f;
+
+    const uint64_t t0 = plat_us();
+    for (uint32_t n = 0; n < n_out; n++) {
+        ph += step;
+        for (uint32_t k = ph >> 16; k; k--) {
+            while (!farrow_push(&f, lut_sin(nco))) nco += tone;
+            nco += tone;
+        }
+        ph &= 0xFFFFu;
+        sink += farrow_out(&f, (float)ph * (1.0f / 65536.0f));
+    }
+    const uint64_t dt = plat_us() - t0;
+    (void)sink;
+    return (uint32_t)(dt * 1000u / n_out);
+}
+
+void farrow_print(const farrow_t *f, const char *why) {
+    cdc_printf("!R why=%s sr=%lu mid=%lu dec=%u dtaps=%u taps=%u macs=%lu pass=%.0f stop=%.0f\r\n",
+               why, (unsigned long)f->in_rate, (unsigned long)f->mid_rate, f->dec, f->dtaps,
+               f->taps, (unsigned long)farrow_macs(f), (double)FARROW_PASS_HZ, (double)FARROW_STOP_HZ);
+}
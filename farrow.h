@@ -0,0 +1,77 @@
+// farrow.h - band-limited fractional resampler, host audio rate -> 8 kHz
+//
+// Two stages, both designed at run time for the rate the host selects:
+//
+//   1. integer decimator (D = 1, 2 or 4) down to a 16-24 kHz middle
+//      rate, Kaiser-windowed FIR with a wide transition band: it only
+//      has to clear what would fold back below FARROW_STOP_HZ;
+//   2. Farrow interpolator at the middle rate: the anti-alias lowpass
+//      (pass FARROW_PASS_HZ, stop FARROW_STOP_HZ, Kaiser ~60 dB) is
+//      stored as a cubic polynomial in the fractional delay mu per tap,
+//      so any output instant costs four dot products and a Horner step
+//      and the step can drift freely (adaptive rate, PPM discipline).
+//
+// Tones above 5 kHz would alias onto 8 kHz - f < 3 kHz, i.e. into the SSB
+// passband; FARROW_STOP_HZ is chosen so those are suppressed.  Mono in,
+// mono out; the caller mixes the channels.  Portable: host/rscheck
+// measures passband ripple, alias rejection and cost per output sample.
+
+#ifndef FARROW_H
+#define FARROW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FARROW_PASS_HZ      3200.0f
+#define FARROW_STOP_HZ      5000.0f
+#define FARROW_ATTEN_DB     60.0f
+
+#define FARROW_MAX_TAPS     64u     // stage 2, at the middle rate
+#define FARROW_MAX_DTAPS    32u     // stage 1, at the input rate
+#define FARROW_RING         64u     // history length (power of two >= taps)
+
+// Rates the USB descriptor advertises, ascending
+#define FARROW_N_RATES      5u
+extern const uint32_t farrow_rates[FARROW_N_RATES];
+
+typedef struct {
+    uint32_t in_rate, mid_rate;
+    uint8_t  dec;                   // stage 1 factor
+    uint8_t  dec_phase;             // input samples since the last mid sample
+    uint16_t dtaps, taps;
+
+    float    dh[FARROW_MAX_DTAPS];
+    float    c[4][FARROW_MAX_TAPS]; // c[m][j]: mu^m coefficient of tap j
+
+    // Histories, written twice (i and i + FARROW_RING) so every dot
+    // product reads one contiguous run without index wrap.
+    float    din[2 * FARROW_RING];
+    float    mid[2 * FARROW_RING];
+    uint32_t din_idx, mid_idx;
+} farrow_t;
+
+bool     farrow_rate_ok(uint32_t in_rate);
+
+// Design both stages for in_rate and clear the history; false (and the
+// 48 kHz design) if in_rate is not one of farrow_rates.
+bool     farrow_design(farrow_t *f, uint32_t in_rate);
+void     farrow_reset(farrow_t *f);
+
+// Feed one input sample; true when it completed a middle-rate sample.
+bool     farrow_push(farrow_t *f, float x);
+
+// Output at mu in [0, 1) between the two middle-rate samples the filter
+// is centred on (fixed group delay of taps / 2 middle samples).
+float    farrow_out(const farrow_t *f, float mu);
+
+// Multiply-accumulates per 8 kHz output sample
+uint32_t farrow_macs(const farrow_t *f);
+
+// Time n_out outputs on a scratch instance: ns per output sample, and
+// the design's MACs per output in *macs (may be NULL)
+uint32_t farrow_bench_ns(uint32_t in_rate, uint32_t n_out, uint32_t *macs);
+
+// "!R" status line
+void     farrow_print(const farrow_t *f, const char *why);
+
+#endif // FARROW_H
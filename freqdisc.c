@@ -0,0 +1,299 @@
+// freqdisc.c - automatic PPM discipline against USB SOF or an external PPS
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "freqdisc.h"
+#include "control.h"
+#include "platform.h"
+
+static volatile uint8_t fd_src = FD_SRC_OFF;
+static bool fd_apply = FD_SHARED_REF;
+
+// ==========================================================
+// Edge accumulator (written by the edge inputs, possibly in IRQ context)
+// ==========================================================
+// ref_us is reference time since the epoch start, exact by construction
+// (frame count x 1 ms, or whole PPS seconds); loc is local time at the
+// same edge in ticks of loc_hz.  A new epoch starts whenever the edge
+// stream cannot be bridged (long gap, counter wrap, source change).
+static volatile uint32_t acc_seq;
+static volatile uint32_t acc_epoch;
+static volatile uint32_t acc_edges;
+static volatile uint64_t acc_ref_us;
+static volatile uint64_t acc_loc;
+static volatile uint32_t acc_loc_hz = 1000000u;
+
+static bool     edge_valid;
+static uint32_t edge_prev;        // last frame number / PPS tick
+static uint64_t edge_prev_us;     // SOF: local time of last edge
+static uint64_t edge_origin_us;   // SOF: local time of epoch start
+static int64_t  sof_phase_q8;     // SOF: smoothed (local - ref), 1/256 us
+
+// SOF timestamps carry a few us of IRQ latency jitter plus 1 us
+// quantisation.  Averaging the phase over ~64 frames cuts that by ~8x;
+// the constant lag it adds under a frequency offset cancels between the
+// two ends of a window.
+#define SOF_PHASE_AVG   64
+#define SOF_Q8_HZ       256000000u
+
+static void acc_publish(uint64_t ref_us, uint64_t loc, uint32_t loc_hz, bool new_epoch) {
+    acc_seq++;
+    __compiler_memory_barrier();
+    if (new_epoch) acc_epoch++;
+    acc_ref_us = ref_us;
+    acc_loc    = loc;
+    acc_loc_hz = loc_hz;
+    acc_edges++;
+    __compiler_memory_barrier();
+    acc_seq++;
+}
+
+void freqdisc_sof(uint32_t frame_no, uint64_t local_us) {
+    if (fd_src != FD_SRC_SOF) return;
+    frame_no &= 0x7FFu;
+
+    // Frame numbers wrap every 2048 ms; anything near that (suspend,
+    // long IRQ blackout) is ambiguous, so restart the epoch.
+    if (!edge_valid || (local_us - edge_prev_us) > 1000000u) {
+        edge_valid = true;
+        edge_prev = frame_no;
+        edge_prev_us = local_us;
+        edge_origin_us = local_us;
+        sof_phase_q8 = 0;
+        acc_publish(0, 0, SOF_Q8_HZ, true);
+        return;
+    }
+
+    uint32_t df = (frame_no - edge_prev) & 0x7FFu;
+    if (df == 0) return;
+    edge_prev = frame_no;
+    edge_prev_us = local_us;
+
+    uint64_t ref_us = acc_ref_us + (uint64_t)df * 1000u;
+    int64_t ph = ((int64_t)(local_us - edge_origin_us) - (int64_t)ref_us) * 256;
+    sof_phase_q8 += (ph - sof_phase_q8) / SOF_PHASE_AVG;
+    acc_publish(ref_us, (uint64_t)((int64_t)ref_us * 256 + sof_phase_q8), SOF_Q8_HZ, false);
+}
+
+void freqdisc_pps(uint32_t ticks, uint32_t tick_hz) {
+    if (fd_src != FD_SRC_PPS || tick_hz == 0) return;
+
+    if (!edge_valid) {
+        edge_valid = true;
+        edge_prev = ticks;
+        acc_publish(0, 0, tick_hz, true);
+        return;
+    }
+
+    // Whole seconds since the last pulse: tolerates missing pulses,
+    // ignores glitches shorter than half a second.
+    uint32_t dt = ticks - edge_prev;
+    uint32_t n = (uint32_t)(((uint64_t)dt + tick_hz / 2u) / tick_hz);
+    if (n == 0) return;
+    edge_prev = ticks;
+    if (n > 16u) {
+        acc_publish(0, 0, tick_hz, true);
+        return;
+    }
+    acc_publish(acc_ref_us + (uint64_t)n * 1000000u, acc_loc + dt, tick_hz, false);
+}
+
+// ==========================================================
+// Control loop (Core0)
+// ==========================================================
+static freqdisc_stats_t st;
+static bool     have_est;
+static uint8_t  good_ct, bad_ct;
+static bool     win_valid;
+static uint32_t win_epoch;
+static uint64_t win_ref0, win_loc0;
+static uint32_t last_edges;
+static uint32_t last_edge_ms;
+static uint32_t glide_ms;
+
+void freqdisc_select(uint8_t src) {
+    if (src > FD_SRC_PPS) src = FD_SRC_OFF;
+
+    fd_src = src;
+    edge_valid = false;
+    win_valid = false;
+    have_est = false;
+    good_ct = bad_ct = 0;
+
+    st.src = src;
+    st.state = (src == FD_SRC_OFF) ? FD_ST_OFF : FD_ST_ACQUIRE;
+    st.windows = st.rejects = st.edges = 0;
+    st.raw_ppm = 0.0f;
+    st.est_ppm = 0.0f;
+    st.rate_ppm = 0.0f;
+    last_edge_ms = plat_ms();
+    glide_ms = last_edge_ms;
+
+    // Back to the manual correction only when switched off; a source
+    // change keeps the current correction while re-acquiring.
+    if (src == FD_SRC_OFF) {
+        st.applied_ppm = 0.0f;
+        g_ppm_disc = 0.0f;
+    }
+
+    plat_disc_select(src);
+}
+
+uint8_t freqdisc_source(void) { return fd_src; }
+
+void freqdisc_stats(freqdisc_stats_t *out) {
+    *out = st;
+    out->apply = fd_apply;
+}
+
+const char *freqdisc_src_label(uint8_t src) {
+    switch (src) {
+        case FD_SRC_SOF: return "sof";
+        case FD_SRC_PPS: return "pps";
+        default:         return "off";
+    }
+}
+
+const char *freqdisc_state_label(uint8_t s) {
+    switch (s) {
+        case FD_ST_ACQUIRE:  return "acquire";
+        case FD_ST_LOCKED:   return "locked";
+        case FD_ST_HOLDOVER: return "holdover";
+        default:             return "off";
+    }
+}
+
+void freqdisc_set_apply(bool on) {
+    fd_apply = on;
+    if (!on) g_ppm_disc = 0.0f;
+}
+
+void freqdisc_print(void) {
+    cdc_printf("!F src=%s state=%s est=%+.4f rate=%+.5f raw=%+.4f corr=%+.4f apply=%u win=%lu rej=%lu edges=%lu\r\n",
+               freqdisc_src_label(st.src), freqdisc_state_label(st.state),
+               st.est_ppm, st.rate_ppm, st.raw_ppm, (float)g_ppm_disc, fd_apply ? 1u : 0u,
+               (unsigned long)st.windows, (unsigned long)st.rejects,
+               (unsigned long)st.edges);
+}
+
+static void fd_update(float y) {
+    st.windows++;
+    st.raw_ppm = y;
+
+    if (fabsf(y) > FD_MAX_PPM) { st.rejects++; return; }
+
+    if (!have_est) {
+        have_est = true;
+        st.est_ppm = y;
+        st.rate_ppm = 0.0f;
+        st.state = FD_ST_ACQUIRE;
+        good_ct = bad_ct = 0;
+    } else {
+        float r = y - (st.est_ppm + st.rate_ppm);
+
+        if (st.state == FD_ST_LOCKED && fabsf(r) > FD_UNLOCK_PPM) {
+            // Single outliers are dropped; a run of them means the clock
+            // really moved, so fall back to acquisition.
+            if (++bad_ct < FD_UNLOCK_WINDOWS) { st.rejects++; return; }
+            st.state = FD_ST_ACQUIRE;
+            st.est_ppm = y;
+            st.rate_ppm = 0.0f;
+            good_ct = bad_ct = 0;
+        } else {
+            bool locked = (st.state == FD_ST_LOCKED);
+            bad_ct = 0;
+            st.est_ppm += st.rate_ppm + (locked ? FD_ALPHA_LOCK : FD_ALPHA_ACQ) * r;
+            st.rate_ppm += (locked ? FD_BETA_LOCK : FD_BETA_ACQ) * r;
+
+            // Lock needs a quiet residual and the correction caught up
+            float lag = fabsf(-st.est_ppm - st.applied_ppm);
+            if (!locked) {
+                if (fabsf(r) < FD_LOCK_PPM && lag < FD_SLEW_LOCK_PPM) {
+                    if (++good_ct >= FD_LOCK_WINDOWS) st.state = FD_ST_LOCKED;
+                } else {
+                    good_ct = 0;
+                }
+            }
+        }
+    }
+
+    // A fast local clock makes the radio run high: correct the opposite way
+    float slew = (st.state == FD_ST_LOCKED) ? FD_SLEW_LOCK_PPM : FD_SLEW_ACQ_PPM;
+    float d = -st.est_ppm - st.applied_ppm;
+    if (d >  slew) d =  slew;
+    if (d < -slew) d = -slew;
+    st.applied_ppm += d;
+}
+
+// Move g_ppm_disc toward the target at a rate that covers one slew step
+// per window, so the carrier glides instead of jumping.
+static void fd_glide(uint32_t now) {
+    uint32_t dt = now - glide_ms;
+    glide_ms = now;
+    if (!fd_apply) return;
+
+    float cur = g_ppm_disc;
+    float d = st.applied_ppm - cur;
+    if (d == 0.0f) return;
+
+    float slew = (st.state == FD_ST_LOCKED) ? FD_SLEW_LOCK_PPM : FD_SLEW_ACQ_PPM;
+    float max = slew * (float)dt / (float)FD_WINDOW_MS;
+    if (d >  max) d =  max;
+    if (d < -max) d = -max;
+    g_ppm_disc = cur + d;
+}
+
+void freqdisc_poll(void) {
+    if (fd_src == FD_SRC_OFF) return;
+
+    uint32_t seq, epoch, edges, loc_hz;
+    uint64_t ref, loc;
+    do {
+        seq = acc_seq;
+        __compiler_memory_barrier();
+        epoch  = acc_epoch;
+        edges  = acc_edges;
+        ref    = acc_ref_us;
+        loc    = acc_loc;
+        loc_hz = acc_loc_hz;
+        __compiler_memory_barrier();
+    } while ((seq & 1u) || seq != acc_seq);
+
+    uint32_t now = plat_ms();
+    fd_glide(now);
+
+    if (edges != last_edges) {
+        st.edges += edges - last_edges;
+        last_edges = edges;
+        last_edge_ms = now;
+        if (st.state == FD_ST_HOLDOVER) st.state = FD_ST_ACQUIRE;
+    } else if ((now - last_edge_ms) > FD_LOSS_MS) {
+        if (st.state != FD_ST_HOLDOVER) {
+            st.state = FD_ST_HOLDOVER;
+            win_valid = false;
+            good_ct = 0;
+            freqdisc_print();
+        }
+        return;
+    }
+
+    if (!win_valid || epoch != win_epoch) {
+        win_valid = true;
+        win_epoch = epoch;
+        win_ref0 = ref;
+        win_loc0 = loc;
+        return;
+    }
+
+    if ((ref - win_ref0) < (uint64_t)FD_WINDOW_MS * 1000u) return;
+
+    double ref_s = (double)(ref - win_ref0) * 1e-6;
+    double loc_s = (double)(loc - win_loc0) / (double)loc_hz;
+    win_ref0 = ref;
+    win_loc0 = loc;
+
+    fd_update((float)((loc_s / ref_s - 1.0) * 1e6));
+    freqdisc_print();
+}
@@ -0,0 +1,86 @@
+// freqdisc.h - automatic PPM discipline against USB SOF or an external PPS
+//
+// Measures the local clock (the RP2350 crystal that times time_us_64 and
+// clk_sys) against a reference -- USB start-of-frame at 1 kHz (host
+// crystal accuracy) or a 1PPS input timestamped by PIO -- and steers
+// g_ppm_disc through a slow, slew-limited loop.  Portable: host/fdcheck
+// drives it with simulated edges.
+//
+// The estimate is the MCU crystal's error.  It only belongs on the carrier
+// when the SX1280 runs from the same reference; the LoRa1280F27-TCXO
+// clocks the radio from its own TCXO.  So unless FD_SHARED_REF is built
+// in (or freqdisc_set_apply() is called), the loop measures and reports
+// but leaves g_ppm_disc at 0.
+
+#ifndef FREQDISC_H
+#define FREQDISC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Reference sources
+#define FD_SRC_OFF      0
+#define FD_SRC_SOF      1
+#define FD_SRC_PPS      2
+
+// Loop states
+#define FD_ST_OFF       0   // no source selected
+#define FD_ST_ACQUIRE   1   // fast filter, wide slew
+#define FD_ST_LOCKED    2   // slow filter, narrow slew
+#define FD_ST_HOLDOVER  3   // reference lost, last correction held
+
+// Loop tuning
+#define FD_WINDOW_MS        8000u   // measurement window (reference time)
+#define FD_LOSS_MS          3000u   // no edges this long -> holdover
+// Alpha-beta estimator (offset + drift rate): tracks temperature ramps
+// without lag.  beta = alpha^2 / (2 - alpha).
+#define FD_ALPHA_ACQ        0.25f
+#define FD_BETA_ACQ         0.0357f
+#define FD_ALPHA_LOCK       0.125f
+#define FD_BETA_LOCK        0.00833f
+// Max correction change per window; g_ppm_disc glides there over the
+// next window instead of stepping (0.05 ppm = 120 Hz over 8 s at 2.4 GHz).
+#define FD_SLEW_ACQ_PPM     1.0f
+#define FD_SLEW_LOCK_PPM    0.05f
+#define FD_LOCK_PPM         0.5f    // |residual| below this counts toward lock
+#define FD_LOCK_WINDOWS     4u
+#define FD_UNLOCK_PPM       2.0f    // |residual| above this counts toward unlock
+#define FD_UNLOCK_WINDOWS   3u
+#define FD_MAX_PPM          100.0f  // raw windows beyond this are rejected
+
+#ifndef FD_SHARED_REF
+#define FD_SHARED_REF       0       // 1: radio and MCU share one reference
+#endif
+
+typedef struct {
+    uint8_t  src;
+    uint8_t  state;
+    float    est_ppm;       // filtered local clock offset (+ = local fast)
+    float    rate_ppm;      // estimated drift per window
+    float    raw_ppm;       // last window measurement
+    float    applied_ppm;   // correction target (g_ppm_disc glides to it when applying)
+    bool     apply;         // steering g_ppm_disc (shared reference)
+    uint32_t windows;       // windows evaluated
+    uint32_t rejects;       // windows rejected as outliers
+    uint32_t edges;         // reference edges seen
+} freqdisc_stats_t;
+
+void    freqdisc_select(uint8_t src);
+void    freqdisc_set_apply(bool on);    // off: report only, g_ppm_disc = 0
+uint8_t freqdisc_source(void);
+void    freqdisc_stats(freqdisc_stats_t *out);
+const char *freqdisc_src_label(uint8_t src);
+const char *freqdisc_state_label(uint8_t st);
+
+// Edge inputs (may be called from IRQ context)
+void freqdisc_sof(uint32_t frame_no, uint64_t local_us);   // 11-bit USB frame number
+void freqdisc_pps(uint32_t ticks, uint32_t tick_hz);        // up-counting PIO timestamp
+
+// Run the control loop; cheap when no window is complete.  Core0, from
+// core0_poll() in every audio mode, after draining the PPS FIFO.
+void freqdisc_poll(void);
+
+// "!F" telemetry line / "disc" command output
+void freqdisc_print(void);
+
+#endif // FREQDISC_H
@@ -10,7 +10,8 @@ License: CC BY-NC 4.0
 """
 
 import tkinter as tk
-from tkinter import ttk, messagebox
+from tkinter import ttk, messagebox, filedialog
+import os
 import threading
 import time
 import queue
@@ -28,6 +29,15 @@ except ImportError:
     HAS_SERIAL = False
 
 
+# ---- local DSP preview (host/build/libsxdsp, optional)
+try:
+    import sxdsp
+    HAS_SXDSP = sxdsp.available()
+except ImportError:
+    sxdsp = None
+    HAS_SXDSP = False
+
+
 # ============================================================
 # CONFIGURATION DATACLASS
 # ============================================================
@@ -44,6 +54,7 @@ class TxConfig:
     enable_bp: bool = True
     enable_eq: bool = True
     enable_comp: bool = True
+    ssb_weaver: bool = False
     # Bandpass
     bp_lo_hz: float = 50.0
     bp_hi_hz: float = 2700.0
@@ -61,6 +72,7 @@ class TxConfig:
     comp_makeup_db: float = 0.0
     comp_knee_db: float = 16.5
     comp_out_limit: float = 0.940
+    comp_lookahead_ms: float = 4.0
     # Power shaping
     amp_gain: float = 2.9
     amp_min_a: float = 0.000002
@@ -85,6 +97,7 @@ class SerialWorker:
         self.thread: Optional[threading.Thread] = None
         self.stop_evt = threading.Event()
         self.lock = threading.Lock()
+        self.ping_q: queue.Queue = queue.Queue()   # (host token, dev_us, rx time)
 
     def is_connected(self) -> bool:
         return self.ser is not None and self.ser.is_open
@@ -95,7 +108,11 @@ class SerialWorker:
         with self.lock:
             if self.is_connected():
                 return
-            self.ser = serial.Serial(port=port, baudrate=baud, timeout=0.1, write_timeout=0.5)
+            # URLs too: socket://host:7355 is sxbridge.py's TCP port
+            self.ser = serial.serial_for_url(port, baudrate=baud, timeout=0.1, write_timeout=0.5)
+            token = os.environ.get("SX1280_TOKEN")
+            if token and port.startswith("socket://"):
+                self.ser.write(f"@auth {token}\r\n".encode())
             self.stop_evt.clear()
             self.thread = threading.Thread(target=self._rx_loop, daemon=True)
             self.thread.start()
@@ -122,6 +139,30 @@ class SerialWorker:
             self.ser.write(data)
             self.ser.flush()
 
+    def time_sync(self, pings: int = 8) -> Optional[int]:
+        """Host-time handshake for tx_at: ping the device a few times and
+        send the best round trip's midpoint.  Returns that RTT in us."""
+        while not self.ping_q.empty():
+            self.ping_q.get_nowait()
+        best = None
+        for _ in range(pings):
+            t0 = time.time_ns() // 1000
+            self.send_line(f"tsync ping {t0}")
+            try:
+                host, dev, t1 = self.ping_q.get(timeout=0.5)
+            except queue.Empty:
+                continue
+            if host != str(t0) or dev is None:
+                continue
+            rtt = t1 - t0
+            if best is None or rtt < best[0]:
+                best = (rtt, (t0 + t1) // 2, int(dev))
+            time.sleep(0.02)
+        if best is None:
+            return None
+        self.send_line(f"tsync set {best[1]} {best[2]} {best[0]}")
+        return best[0]
+
     def _rx_loop(self):
         buf = bytearray()
         while not self.stop_evt.is_set():
@@ -130,13 +171,20 @@ class SerialWorker:
             if not s:
                 break
             try:
-                chunk = s.read(256)
+                # Read what is there (at least one byte) so ping replies are
+                # stamped as they arrive, not when 256 bytes have piled up
+                chunk = s.read(s.in_waiting or 1)
                 if chunk:
+                    t_rx = time.time_ns() // 1000
                     buf.extend(chunk)
                     while b"\n" in buf:
                         line, _, rest = buf.partition(b"\n")
                         buf = bytearray(rest)
                         txt = line.decode("utf-8", errors="replace").rstrip("\r")
+                        if txt.startswith("!C ping "):
+                            kv = dict(p.split("=", 1) for p in txt.split()[2:] if "=" in p)
+                            self.ping_q.put((kv.get("host"), kv.get("dev"), t_rx))
+                            continue
                         self.rx_queue.put(txt)
                 else:
                     time.sleep(0.01)
@@ -158,6 +206,10 @@ def list_serial_ports():
             ports.insert(0, (p.device, f"\u2605 {p.device} ({p.description})"))
         else:
             ports.append((p.device, f"{p.device} ({p.description})"))
+    # Extra port not enumerated by pyserial, e.g. the host simulator's pty
+    extra = os.environ.get("SX1280_PORT")
+    if extra:
+        ports.insert(0, (extra, f"\u2605 {extra} (SX1280_PORT)"))
     return ports
 
 
@@ -314,6 +366,13 @@ class SX1280ControlApp(ttk.Frame):
         self.worker = SerialWorker(self.rx_queue)
         self._status_updating = False
         self._heartbeat_id = None
+        self._tsync_id = None
+        self._pv_chain = sxdsp.Chain() if HAS_SXDSP else None
+        self._pv_in = None          # loaded WAV, 8 kHz
+        self._pv_out = None         # last render
+        self._pv_player = None
+        self._pv_live = None
+        self._pv_render_id = None
 
         self.debounced_send = Debouncer(master, 150, self._send_cmd_safe)
         self.freq_debouncer = Debouncer(master, 200, self._send_freq)
@@ -341,6 +400,7 @@ class SX1280ControlApp(ttk.Frame):
         self.en_bp_var = tk.BooleanVar(value=self.config.enable_bp)
         self.en_eq_var = tk.BooleanVar(value=self.config.enable_eq)
         self.en_comp_var = tk.BooleanVar(value=self.config.enable_comp)
+        self.ssb_weaver_var = tk.BooleanVar(value=self.config.ssb_weaver)
         self.bp_lo_var = tk.DoubleVar(value=self.config.bp_lo_hz)
         self.bp_hi_var = tk.DoubleVar(value=self.config.bp_hi_hz)
         self.bp_stages_var = tk.IntVar(value=self.config.bp_stages)
@@ -355,6 +415,7 @@ class SX1280ControlApp(ttk.Frame):
         self.comp_makeup_var = tk.DoubleVar(value=self.config.comp_makeup_db)
         self.comp_knee_var = tk.DoubleVar(value=self.config.comp_knee_db)
         self.comp_outlim_var = tk.DoubleVar(value=self.config.comp_out_limit)
+        self.comp_la_var = tk.DoubleVar(value=self.config.comp_lookahead_ms)
         self.amp_gain_var = tk.DoubleVar(value=self.config.amp_gain)
         self.amp_min_a_var = tk.StringVar(value=f"{self.config.amp_min_a:.9f}")
         self.mic_agc_target_var = tk.DoubleVar(value=self.config.mic_agc_target)
@@ -525,6 +586,9 @@ class SX1280ControlApp(ttk.Frame):
                         command=lambda: self._send_enable("eq", self.en_eq_var.get())).pack(side="left", padx=20)
         ttk.Checkbutton(enable_frame, text="Compressor", variable=self.en_comp_var,
                         command=lambda: self._send_enable("comp", self.en_comp_var.get())).pack(side="left", padx=20)
+        ttk.Checkbutton(enable_frame, text="Weaver SSB", variable=self.ssb_weaver_var,
+                        command=lambda: self._send_cmd_safe(
+                            f"set ssb_engine {'1' if self.ssb_weaver_var.get() else '0'}")).pack(side="left", padx=20)
 
         # === Bandpass ===
         bp_frame = ttk.LabelFrame(tab, text="Bandpass Filter", padding=10)
@@ -582,6 +646,9 @@ class SX1280ControlApp(ttk.Frame):
         LabeledScale(comp_frame, "Output limit", self.comp_outlim_var, 0.01, 0.999, 0.001,
                      lambda v: self.debounced_send.call(f"set comp_outlim {v:.3f}"),
                      "{:.3f}").pack(fill="x")
+        LabeledScale(comp_frame, "Look-ahead (ms)", self.comp_la_var, 0, 7.8, 0.125,
+                     lambda v: self.debounced_send.call(f"set comp_la {v:.3f}"),
+                     "{:.2f}").pack(fill="x")
 
         # === Power Shaping ===
         pwr_frame = ttk.LabelFrame(tab, text="Power Shaping", padding=10)
@@ -645,17 +712,39 @@ class SX1280ControlApp(ttk.Frame):
         self.ctcss_combo.bind("<<ComboboxSelected>>", self._on_ctcss_change)
         ttk.Label(ctcss_row, text="Hz").pack(side="left")
 
-        # === Spectrum Analyzer (placeholder) ===
-        spec_frame = ttk.LabelFrame(tab, text="Spectrum Analyzer", padding=10)
+        # === Band scan (SX1280 RSSI, "!Q" histogram) ===
+        spec_frame = ttk.LabelFrame(tab, text="Band Scan (RSSI, parks TX)", padding=10)
         spec_frame.grid(row=9, column=0, sticky="ew", pady=(0, 10))
         spec_frame.columnconfigure(0, weight=1)
 
-        # Simple placeholder canvas; real FFT plotting will be added later
-        self.spec_canvas = tk.Canvas(spec_frame, height=120, bg="black")
+        self.spec_canvas = tk.Canvas(spec_frame, height=140, bg="black")
         self.spec_canvas.pack(fill="x")
-        self.spec_canvas.create_text(8, 60, anchor="w", fill="#cccccc",
-                                     text="Spectrum analyzer display (placeholder)")
-        ttk.Button(spec_frame, text="Refresh", command=lambda: self._send_cmd_safe("get")).pack(side="right", padx=5, pady=5)
+        self.spec_canvas.create_text(8, 70, anchor="w", fill="#cccccc",
+                                     text="Scan to see levels (bars) and occupancy (orange) around the uplink")
+        self.scan_info_var = tk.StringVar(value="")
+        ttk.Label(spec_frame, textvariable=self.scan_info_var).pack(side="left", padx=5)
+        ttk.Button(spec_frame, text="Stop", command=lambda: self._send_cmd_safe("scan off")).pack(side="right", padx=5, pady=5)
+        ttk.Button(spec_frame, text="Scan", command=lambda: self._send_cmd_safe("scan on")).pack(side="right", padx=5, pady=5)
+
+        # === Local preview: firmware DSP on the PC (sxdsp.py / libsxdsp) ===
+        pv_frame = ttk.LabelFrame(tab, text="Local Preview (firmware DSP on this PC, nothing sent)", padding=10)
+        pv_frame.grid(row=10, column=0, sticky="ew", pady=(0, 10))
+        pv_frame.columnconfigure(0, weight=1)
+
+        self.pv_canvas = tk.Canvas(pv_frame, height=100, bg="black")
+        self.pv_canvas.pack(fill="x")
+        self.pv_info_var = tk.StringVar(value="Load a WAV to hear it as the downlink would, with the current settings"
+                                        if HAS_SXDSP else
+                                        "Build host/build/libsxdsp (cmake -S host -B host/build) to enable")
+        ttk.Label(pv_frame, textvariable=self.pv_info_var).pack(side="left", padx=5)
+        state = "normal" if HAS_SXDSP else "disabled"
+        live_state = "normal" if HAS_SXDSP and sxdsp.HAS_SOUNDDEVICE else "disabled"
+        self.pv_live_btn = ttk.Button(pv_frame, text="Live Mic", command=self._preview_live, state=live_state)
+        self.pv_live_btn.pack(side="right", padx=5, pady=5)
+        ttk.Button(pv_frame, text="Save...", command=self._preview_save, state=state).pack(side="right", padx=5, pady=5)
+        ttk.Button(pv_frame, text="Stop", command=self._preview_stop, state=state).pack(side="right", padx=5, pady=5)
+        ttk.Button(pv_frame, text="Play", command=self._preview_play, state=state).pack(side="right", padx=5, pady=5)
+        ttk.Button(pv_frame, text="Load WAV...", command=self._preview_load, state=state).pack(side="right", padx=5, pady=5)
 
     # ----------------------------------------------------------
     def _build_console_tab(self):
@@ -696,6 +785,7 @@ class SX1280ControlApp(ttk.Frame):
         btn_frame.grid(row=2, column=0, sticky="ew", pady=(5, 0))
         ttk.Button(btn_frame, text="Clear Log", command=self._clear_log).pack(side="left")
         ttk.Button(btn_frame, text="Send All Settings", command=self._send_all).pack(side="right")
+        ttk.Button(btn_frame, text="Load Preset...", command=self._load_preset).pack(side="right", padx=(0, 5))
 
     # === Connection Methods ===
 
@@ -725,6 +815,7 @@ class SX1280ControlApp(ttk.Frame):
             self.master.after(500, lambda: self._send_cmd_safe("get"))
             self.master.after(800, lambda: self._send_cmd_safe("status"))
             self._start_heartbeat()
+            self.master.after(1200, self._time_sync)
         except Exception as e:
             messagebox.showerror("Connection failed", str(e))
             self.status_var.set("\U0001f534 Connection failed")
@@ -733,6 +824,9 @@ class SX1280ControlApp(ttk.Frame):
         if self._heartbeat_id is not None:
             self.master.after_cancel(self._heartbeat_id)
             self._heartbeat_id = None
+        if self._tsync_id is not None:
+            self.master.after_cancel(self._tsync_id)
+            self._tsync_id = None
         self.worker.disconnect()
         self.status_var.set("\u26ab Disconnected")
         self._log("Disconnected", "info")
@@ -748,9 +842,28 @@ class SX1280ControlApp(ttk.Frame):
             pass
         self._heartbeat_id = self.master.after(2000, self._start_heartbeat)
 
+    def _time_sync(self):
+        """Keep the device's host-time offset fresh for tx_at (every minute;
+        the firmware learns the clock rate from the history)."""
+        if not self.worker.is_connected():
+            self._tsync_id = None
+            return
+
+        def run():
+            try:
+                rtt = self.worker.time_sync()
+                if rtt is None:
+                    self.rx_queue.put("[TSYNC] no ping replies")
+            except Exception as e:
+                self.rx_queue.put(f"[TSYNC ERROR] {e}")
+
+        threading.Thread(target=run, daemon=True).start()
+        self._tsync_id = self.master.after(60000, self._time_sync)
+
     # === Command Methods ===
 
     def _send_cmd_safe(self, cmd):
+        self._preview_cmd(cmd)
         try:
             if not self.worker.is_connected():
                 self._log(f"[NOT CONNECTED] {cmd}", "error")
@@ -894,6 +1007,33 @@ class SX1280ControlApp(ttk.Frame):
             self._send_cmd_safe(cmd)
             self.manual_cmd_var.set("")
 
+    def _dsp_lines(self):
+        """The DSP settings on screen as CDC commands (device and preview)."""
+        return [
+            f"txpwr {int(self.txpwr_var.get())}",
+            f"enable bp {'1' if self.en_bp_var.get() else '0'}",
+            f"enable eq {'1' if self.en_eq_var.get() else '0'}",
+            f"enable comp {'1' if self.en_comp_var.get() else '0'}",
+            f"set ssb_engine {'1' if self.ssb_weaver_var.get() else '0'}",
+            f"set bp_lo {self.bp_lo_var.get():.0f}",
+            f"set bp_hi {self.bp_hi_var.get():.0f}",
+            f"set bp_stages {int(self.bp_stages_var.get())}",
+            f"set eq_low_hz {self.eq_low_hz_var.get():.0f}",
+            f"set eq_low_db {self.eq_low_db_var.get():.1f}",
+            f"set eq_high_hz {self.eq_high_hz_var.get():.0f}",
+            f"set eq_high_db {self.eq_high_db_var.get():.1f}",
+            f"set comp_thr {self.comp_thr_var.get():.1f}",
+            f"set comp_ratio {self.comp_ratio_var.get():.1f}",
+            f"set comp_att {self.comp_att_var.get():.1f}",
+            f"set comp_rel {self.comp_rel_var.get():.0f}",
+            f"set comp_makeup {self.comp_makeup_var.get():.1f}",
+            f"set comp_knee {self.comp_knee_var.get():.1f}",
+            f"set comp_outlim {self.comp_outlim_var.get():.3f}",
+            f"set comp_la {self.comp_la_var.get():.3f}",
+            f"set amp_gain {self.amp_gain_var.get():.3f}",
+            f"set amp_min_a {self.amp_min_a_var.get()}",
+        ]
+
     def _send_all(self):
         try:
             khz = float(self.freq_khz_var.get())
@@ -907,28 +1047,144 @@ class SX1280ControlApp(ttk.Frame):
                 self._send_cmd_safe(f"ppm {ppm}")
         except Exception:
             pass
-        self._send_cmd_safe(f"txpwr {int(self.txpwr_var.get())}")
-        self._send_cmd_safe(f"enable bp {'1' if self.en_bp_var.get() else '0'}")
-        self._send_cmd_safe(f"enable eq {'1' if self.en_eq_var.get() else '0'}")
-        self._send_cmd_safe(f"enable comp {'1' if self.en_comp_var.get() else '0'}")
-        self._send_cmd_safe(f"set bp_lo {self.bp_lo_var.get():.0f}")
-        self._send_cmd_safe(f"set bp_hi {self.bp_hi_var.get():.0f}")
-        self._send_cmd_safe(f"set bp_stages {int(self.bp_stages_var.get())}")
-        self._send_cmd_safe(f"set eq_low_hz {self.eq_low_hz_var.get():.0f}")
-        self._send_cmd_safe(f"set eq_low_db {self.eq_low_db_var.get():.1f}")
-        self._send_cmd_safe(f"set eq_high_hz {self.eq_high_hz_var.get():.0f}")
-        self._send_cmd_safe(f"set eq_high_db {self.eq_high_db_var.get():.1f}")
-        self._send_cmd_safe(f"set comp_thr {self.comp_thr_var.get():.1f}")
-        self._send_cmd_safe(f"set comp_ratio {self.comp_ratio_var.get():.1f}")
-        self._send_cmd_safe(f"set comp_att {self.comp_att_var.get():.1f}")
-        self._send_cmd_safe(f"set comp_rel {self.comp_rel_var.get():.0f}")
-        self._send_cmd_safe(f"set comp_makeup {self.comp_makeup_var.get():.1f}")
-        self._send_cmd_safe(f"set comp_knee {self.comp_knee_var.get():.1f}")
-        self._send_cmd_safe(f"set comp_outlim {self.comp_outlim_var.get():.3f}")
-        self._send_cmd_safe(f"set amp_gain {self.amp_gain_var.get():.3f}")
-        self._send_cmd_safe(f"set amp_min_a {self.amp_min_a_var.get()}")
+        for line in self._dsp_lines():
+            self._send_cmd_safe(line)
         self._log("All settings sent", "info")
 
+    # === Local preview ===
+
+    def _preview_cmd(self, cmd):
+        """Mirror a command into the preview chain; re-render the WAV if it changed anything."""
+        if self._pv_chain is None:
+            return
+        if self._pv_chain.cmd(cmd) == 1 and self._pv_in is not None:
+            if self._pv_render_id is not None:
+                self.master.after_cancel(self._pv_render_id)
+            self._pv_render_id = self.master.after(300, self._preview_render)
+
+    def _preview_sync(self):
+        """Bring the preview chain to the settings on screen (they may have come from the device)."""
+        ch = self._pv_chain
+        for line in self._dsp_lines():
+            ch.cmd(line)
+        ch.cmd(f"mode {self.mode_var.get()}")
+        ch.cmd(f"set fm_dev {self.fm_dev_var.get():.0f}")
+        ctcss = self.ctcss_var.get()
+        ch.cmd(f"set ctcss {'0' if ctcss == 'Off' else ctcss}")
+        ch.cmd(f"src {self.src_var.get()}")
+
+    def _preview_load(self):
+        path = filedialog.askopenfilename(title="Preview WAV",
+                                          filetypes=[("WAV", "*.wav"), ("All files", "*")])
+        if not path:
+            return
+        try:
+            x = sxdsp.load_wav(path)
+        except OSError as e:
+            messagebox.showerror("Preview", str(e))
+            return
+        self._pv_in = x[:sxdsp.RATE * 120]       # two minutes is plenty to judge a setting
+        self._pv_name = os.path.basename(path)
+        self._preview_render()
+
+    def _preview_render(self):
+        self._pv_render_id = None
+        if self._pv_in is None:
+            return
+        ch = self._pv_chain
+        self._preview_sync()
+        ch.reset()
+        # PC audio goes in as is; the MIC AGC only runs for the ADC input
+        ch.cmd("src pc")
+        self._pv_out = ch.process(self._pv_in)
+        ch.cmd(f"src {self.src_var.get()}")
+        st = ch.stats()
+        self.pv_info_var.set(f"{self._pv_name}: {st['samples'] / sxdsp.RATE:.1f} s, "
+                             f"mean {st['mean_dbm']:.1f} dBm, clip {st['clip_pct']:.1f} %, "
+                             f"floor {st['floor_pct']:.1f} %, {st['x_realtime']:.0f}x real time")
+        self._preview_draw(self._pv_out)
+
+    def _preview_draw(self, y):
+        """Min/max envelope of the received audio, one column per pixel."""
+        c = self.pv_canvas
+        c.delete("all")
+        w = max(c.winfo_width(), 200)
+        h = int(c.cget("height"))
+        mid = h / 2
+        c.create_line(0, mid, w, mid, fill="#333333")
+        if not y:
+            return
+        per = max(1, len(y) // w)
+        for px in range(min(w, len(y) // per)):
+            seg = y[px * per:(px + 1) * per]
+            lo, hi = max(-1.0, min(seg)), min(1.0, max(seg))
+            color = "#ff5050" if hi >= 0.99 or lo <= -0.99 else "#40c040"
+            c.create_line(px, mid - hi * (mid - 2), px, mid - lo * (mid - 2) + 1, fill=color)
+
+    def _preview_play(self):
+        if self._pv_out is None:
+            return
+        self._preview_stop()
+        try:
+            self._pv_player = sxdsp.play(self._pv_out)
+        except OSError as e:
+            messagebox.showerror("Preview", str(e))
+
+    def _preview_stop(self):
+        if self._pv_live is not None:
+            self._pv_live.stop()
+            self._pv_live = None
+            self.pv_live_btn.configure(text="Live Mic")
+        if self._pv_chain is not None:
+            sxdsp.stop_playback(self._pv_player)
+        self._pv_player = None
+
+    def _preview_save(self):
+        if self._pv_out is None:
+            return
+        path = filedialog.asksaveasfilename(title="Save preview", defaultextension=".wav",
+                                            filetypes=[("WAV", "*.wav")])
+        if path:
+            sxdsp.write_wav(path, self._pv_out)
+
+    def _preview_live(self):
+        """PC microphone -> firmware chain -> speakers, as it would go out with src pc."""
+        if self._pv_live is not None:
+            self._preview_stop()
+            return
+        self._preview_stop()
+        self._preview_sync()
+        self._pv_chain.reset()
+        try:
+            self._pv_live = sxdsp.LiveMonitor(self._pv_chain)
+            self._pv_live.start()
+        except Exception as e:
+            self._pv_live = None
+            messagebox.showerror("Preview", str(e))
+            return
+        self.pv_live_btn.configure(text="Stop Live")
+        self.pv_info_var.set("Live: use headphones (speaker feedback)")
+
+    def _load_preset(self):
+        """Send a preset file (e.g. from host/sxopt) line by line, then re-read the config."""
+        path = filedialog.askopenfilename(title="Load preset",
+                                          filetypes=[("Preset", "*.txt"), ("All files", "*")])
+        if not path:
+            return
+        try:
+            with open(path, "r", encoding="utf-8") as f:
+                lines = [ln.strip() for ln in f]
+        except OSError as e:
+            messagebox.showerror("Load preset", str(e))
+            return
+        sent = 0
+        for ln in lines:
+            if ln and not ln.startswith("#"):
+                self._send_cmd_safe(ln)
+                sent += 1
+        self._send_cmd_safe("get")
+        self._log(f"Preset {os.path.basename(path)}: {sent} commands sent", "info")
+
     # === Logging ===
 
     def _log(self, msg, tag="recv"):
@@ -942,22 +1198,71 @@ class SX1280ControlApp(ttk.Frame):
         processed = 0
         max_per_cycle = 20
         latest_status = None
+        latest_scan = None
         try:
             while processed < max_per_cycle:
                 line = self.rx_queue.get_nowait()
                 processed += 1
                 if line.startswith("!S "):
                     latest_status = line  # keep only the newest status
+                elif line.startswith("!Q "):
+                    latest_scan = line
                 else:
                     self._log(line, "recv")
         except queue.Empty:
             pass
         if latest_status is not None:
             self._handle_status_push(latest_status)
+        if latest_scan is not None:
+            self._handle_scan(latest_scan)
         # Poll faster when queue had items, slower when idle
         delay = 10 if processed >= max_per_cycle else 50
         self.master.after(delay, self._poll_rx)
 
+    def _handle_scan(self, line):
+        """Draw a '!Q' band scan line: lvl = 2 hex digits of -dBm per bin,
+        occ = 1 hex digit of occupancy (0..F) per bin."""
+        kv = dict(p.split("=", 1) for p in line.split()[1:] if "=" in p)
+        try:
+            lo = int(kv["lo_khz"])
+            step = int(kv["step_khz"])
+            best = int(kv["best_khz"])
+            lvl = [-int(kv["lvl"][i:i + 2], 16) for i in range(0, len(kv.get("lvl", "")), 2)]
+            occ = [int(c, 16) / 15.0 for c in kv.get("occ", "")]
+        except (KeyError, ValueError):
+            return
+        self.scan_info_var.set(
+            f"{'scanning' if kv.get('on') == '1' else 'stopped'}  sweeps {kv.get('sweeps', '?')}  "
+            f"floor {kv.get('floor_dbm', '?')} dBm  best {best / 1000:.3f} MHz ({kv.get('best_dbm', '?')} dBm)")
+        c = self.spec_canvas
+        c.delete("all")
+        if not lvl:
+            return
+        w = max(c.winfo_width(), 100)
+        h = int(c["height"])
+        top_dbm, bot_dbm = -50.0, -110.0
+        bw = w / len(lvl)
+
+        def y_of(dbm):
+            f = (min(max(dbm, bot_dbm), top_dbm) - bot_dbm) / (top_dbm - bot_dbm)
+            return h - 14 - f * (h - 20)
+
+        # NB uplink segment
+        x0 = (2_400_050 - lo) / step * bw
+        x1 = (2_400_300 - lo) / step * bw + bw
+        c.create_rectangle(x0, 0, x1, h - 14, fill="#102030", outline="")
+        for i, (d, o) in enumerate(zip(lvl, occ + [0.0] * (len(lvl) - len(occ)))):
+            x = i * bw
+            c.create_rectangle(x + 1, y_of(d), x + bw - 1, h - 14, fill="#3da5ff", outline="")
+            if o > 0:
+                c.create_rectangle(x + 1, h - 14 - o * 12, x + bw - 1, h - 14, fill="#ff9f1a", outline="")
+        xb = (best - lo) / step * bw + bw / 2
+        c.create_line(xb, 0, xb, h - 14, fill="#40ff40", dash=(3, 2))
+        c.create_text(2, h - 2, anchor="sw", fill="#cccccc", text=f"{lo / 1000:.3f}")
+        c.create_text(w - 2, h - 2, anchor="se", fill="#cccccc",
+                      text=f"{(lo + (len(lvl) - 1) * step) / 1000:.3f} MHz")
+        c.create_text(2, 2, anchor="nw", fill="#cccccc", text=f"{top_dbm:.0f} dBm")
+
     def _handle_status_push(self, line):
         """Parse firmware status push and update GUI widgets.
 
@@ -1060,6 +1365,7 @@ def main():
     app = SX1280ControlApp(root)
 
     def on_close():
+        app._preview_stop()
         app.worker.disconnect()
         root.destroy()
 
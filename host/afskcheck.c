@@ -0,0 +1,263 @@
+// afskcheck.c - AX.25 / AFSK1200 packets (afsk.c) through the FM producer
+//
+//   afskcheck [-v]
+//
+// Queues frames with the "pkt" CDC command, runs the firmware producer
+// in FM mode and demodulates its sample commands the way a TNC would:
+// frequency offset -> mark/space energy over one bit -> clock recovery
+// -> NRZI -> HDLC (flags, unstuffing) -> FCS.  Checks the FCS against
+// the CRC-16/X.25 test vector, the TNC2 address encoding byte for byte,
+// that every frame of a burst (one full of 0x7E / 0xFF to exercise the
+// stuffing) decodes with a good FCS, that the carrier is keyed for the
+// burst only (no roger beep after it), the deviation, tone phase
+// continuity, and the refusals.  Exits non-zero on failure.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+#include "afsk.h"
+#include "hostutil.h"
+
+// ---------------- Platform ----------------
+static bool verbose;
+static uint64_t now_us;
+static char last_line[256];
+
+uint64_t plat_us(void) { return now_us; }
+uint32_t plat_ms(void) { return (uint32_t)(now_us / 1000u); }
+
+bool plat_cdc_connected(void) { return true; }
+void plat_cdc_write(const char *s) {
+    snprintf(last_line, sizeof(last_line), "%s", s);
+    if (verbose) printf("    %s", s);
+}
+
+// Voice on the audio input: must not reach the air during a packet
+float plat_audio_sample(uint32_t n, const audio_cfg_t *cfg) {
+    (void)cfg;
+    static uint32_t k;
+    (void)n;
+    return 0.5f * sinf(2.0f * (float)M_PI * 500.0f * (float)(k++) / (float)WAV_SAMPLE_RATE);
+}
+
+// ---------------- Capture ----------------
+#define MAX_SAMPLES     (WAV_SAMPLE_RATE * 8u)
+
+static float    cap_hz[MAX_SAMPLES];        // frequency offset, Hz
+static uint8_t  cap_on[MAX_SAMPLES];
+static uint32_t cap_n;
+
+static void run_blocks(uint32_t blocks) {
+    static sample_cmd_t blk[BLOCK_SAMPLES];
+    const int32_t base = (int32_t)get_base_steps();
+    const float fine_hz = get_fine_tune_hz();
+    for (uint32_t b = 0; b < blocks && cap_n + BLOCK_SAMPLES <= MAX_SAMPLES; b++) {
+        txchain_fill_block(blk);
+        for (uint32_t i = 0; i < BLOCK_SAMPLES; i++, cap_n++) {
+            cap_hz[cap_n] = (float)sample_cmd_q8(&blk[i], base) * PLL_STEP_HZ / FREQ_FRAC_ONE - fine_hz;
+            cap_on[cap_n] = blk[i].tx_on;
+        }
+        now_us += BLOCK_SAMPLES * 1000000ull / WAV_SAMPLE_RATE;
+    }
+}
+
+// ---------------- Demodulator ----------------
+#define MAX_FRAMES  8u
+
+typedef struct { uint8_t d[AFSK_MAX_FRAME + 2u]; uint32_t n; bool fcs_ok; } rx_frame_t;
+static rx_frame_t rx[MAX_FRAMES];
+static uint32_t   rx_n;
+
+static void hdlc_bit(int bit) {
+    static uint32_t bitstream;
+    static bool     in_frame;
+    static uint32_t bitbuf;
+    static uint8_t  buf[AFSK_MAX_FRAME + 2u];
+    static uint32_t len;
+
+    bitstream = (bitstream << 1) | (uint32_t)bit;
+    if ((bitstream & 0xFFu) == 0x7Eu) {
+        if (in_frame && len > 2u && rx_n < MAX_FRAMES) {
+            rx_frame_t *f = &rx[rx_n++];
+            memcpy(f->d, buf, len);
+            f->n = len;
+            const uint16_t fcs = afsk_fcs(buf, len - 2u);
+            f->fcs_ok = buf[len - 2u] == (uint8_t)fcs && buf[len - 1u] == (uint8_t)(fcs >> 8);
+        }
+        in_frame = true;
+        len = 0;
+        bitbuf = 0x80u;
+        return;
+    }
+    if ((bitstream & 0x7Fu) == 0x7Fu) { in_frame = false; return; }    // abort / idle
+    if (!in_frame) return;
+    if ((bitstream & 0x3Fu) == 0x3Eu) return;                          // stuffed zero
+    if (bitstream & 1u) bitbuf |= 0x100u;
+    if (bitbuf & 1u) {
+        if (len < sizeof(buf)) buf[len++] = (uint8_t)(bitbuf >> 1);
+        bitbuf = 0x80u;
+        return;
+    }
+    bitbuf >>= 1;
+}
+
+// Non-coherent mark/space detector over one bit, DPLL bit clock
+static void demod(const float *hz, uint32_t n, float dev_hz) {
+    enum { W = 7 };
+    const double wm = 2.0 * M_PI * AFSK_MARK_HZ / WAV_SAMPLE_RATE;
+    const double ws = 2.0 * M_PI * AFSK_SPACE_HZ / WAV_SAMPLE_RATE;
+    double ph = 0.0;
+    int prev_tone = 0, last_d = 0;
+
+    for (uint32_t i = W; i < n; i++) {
+        double mr = 0, mi = 0, sr = 0, si = 0;
+        for (uint32_t k = i - W + 1u; k <= i; k++) {
+            const double a = hz[k] / dev_hz;
+            mr += a * cos(wm * k); mi += a * sin(wm * k);
+            sr += a * cos(ws * k); si += a * sin(ws * k);
+        }
+        // The window trails the signal by half a bit
+        const int d = (sr * sr + si * si) > (mr * mr + mi * mi) ? 1 : 0;
+        if (d != last_d) {
+            const double err = (ph < 0.5) ? ph : ph - 1.0;      // transitions belong at 0
+            ph -= 0.4 * err;
+            last_d = d;
+        }
+        const double prev = ph;
+        ph += (double)AFSK_BAUD / WAV_SAMPLE_RATE;
+        if (ph >= 1.0) ph -= 1.0;
+        if (prev < 0.5 && ph >= 0.5) {
+            hdlc_bit(d == prev_tone ? 1 : 0);                   // NRZI
+            prev_tone = d;
+        }
+    }
+}
+
+// ---------------- Checks ----------------
+static void cmd(const char *s) {
+    static char line[CDC_LINE_MAX];
+    snprintf(line, sizeof(line), "%s", s);
+    last_line[0] = 0;
+    cdc_handle_line(line);
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-v")) verbose = check_verbose = true;
+        else { fprintf(stderr, "usage: afskcheck [-v]\n"); return 2; }
+    }
+
+    check(afsk_fcs((const uint8_t *)"123456789", 9) == 0x906Eu, "FCS: CRC-16/X.25 check value");
+
+    txchain_init();
+    g_roger_beep = 1;
+
+    // ---- Refusals ----
+    g_tx_mode = TXM_USB;
+    cmd("pkt N0CALL>APRS:hello");
+    check(!strncmp(last_line, "ERR: pkt needs FM", 17), "refused outside FM mode");
+    g_tx_mode = TXM_FM;
+    cmd("pkt N0CALLXX>APRS:x");
+    check(!strncmp(last_line, "ERR", 3), "7-character callsign refused");
+    cmd("pkt N0CALL-16>APRS:x");
+    check(!strncmp(last_line, "ERR", 3), "SSID 16 refused");
+    cmd("pkt N0CALL APRS x");
+    check(!strncmp(last_line, "ERR", 3), "missing > and : refused");
+
+    // ---- A burst of three frames ----
+    const float dev = g_fm_deviation_hz;
+    run_blocks(4);                                  // carrier off, voice ignored
+    const uint32_t t_queue = cap_n;
+    cmd("pkt N0CALL-9>APRS,WIDE1-1,WIDE2-1:!4903.50N/07201.75W-Test 123");
+    check(!strncmp(last_line, "!P why=queued q=1", 17), "TNC2 frame queued");
+
+    static char hexcmd[CDC_LINE_MAX];
+    static uint8_t raw[64];
+    uint32_t raw_n = 0;
+    {
+        // Addresses of "TEST>CQ" by hand, UI, then stuffing-heavy payload
+        static const uint8_t hdr[] = {
+            0x86, 0xA2, 0x40, 0x40, 0x40, 0x40, 0xE0,
+            0xA8, 0x8A, 0xA6, 0xA8, 0x40, 0x40, 0x61,
+            0x03, 0xF0,
+        };
+        memcpy(raw, hdr, sizeof(hdr));
+        raw_n = sizeof(hdr);
+        for (uint32_t i = 0; i < 32u; i++) raw[raw_n++] = (i & 1u) ? 0x7Eu : 0xFFu;
+        int p = snprintf(hexcmd, sizeof(hexcmd), "pkt hex ");
+        for (uint32_t i = 0; i < raw_n; i++) p += snprintf(hexcmd + p, sizeof(hexcmd) - (size_t)p, "%02x", raw[i]);
+    }
+    cmd(hexcmd);
+    check(!strncmp(last_line, "!P why=queued q=2", 17), "hex frame queued");
+    cmd("pkt N0CALL>APZ001:>status with spaces");
+    run_blocks(120);                                // ~3.8 s
+    afsk_stats_t st;
+    afsk_stats(&st);
+
+    demod(cap_hz, cap_n, dev);
+    check(rx_n == 3u, "three frames decoded");
+    bool fcs = rx_n > 0u;
+    for (uint32_t i = 0; i < rx_n; i++) fcs = fcs && rx[i].fcs_ok;
+    check(fcs, "every FCS good");
+
+    static const uint8_t want0[] = {
+        0x82, 0xA0, 0xA4, 0xA6, 0x40, 0x40, 0xE0,      // APRS (dest, C bit)
+        0x9C, 0x60, 0x86, 0x82, 0x98, 0x98, 0x72,      // N0CALL-9
+        0xAE, 0x92, 0x88, 0x8A, 0x62, 0x40, 0x62,      // WIDE1-1
+        0xAE, 0x92, 0x88, 0x8A, 0x64, 0x40, 0x63,      // WIDE2-1, last
+        0x03, 0xF0,
+    };
+    const char *info0 = "!4903.50N/07201.75W-Test 123";
+    check(rx_n > 0u && rx[0].n == sizeof(want0) + strlen(info0) + 2u &&
+          !memcmp(rx[0].d, want0, sizeof(want0)) && !memcmp(rx[0].d + sizeof(want0), info0, strlen(info0)),
+          "TNC2 addresses and info byte for byte");
+    check(rx_n > 1u && rx[1].n == raw_n + 2u && !memcmp(rx[1].d, raw, raw_n), "stuffing-heavy frame intact");
+    check(rx_n > 2u && rx[2].n >= 16u + 2u && !memcmp(rx[2].d + 16, ">status with spaces", 19),
+          "info with spaces intact");
+    check(st.sent == 3u && st.queued == 0u && !st.on_air, "queue empty after the burst");
+
+    // Keying: on from the first packet block to the end of the burst only
+    uint32_t first = 0, last = 0;
+    for (uint32_t i = t_queue; i < cap_n; i++) if (cap_on[i]) { if (!first) first = i; last = i; }
+    const uint32_t burst = last - first + 1u;
+    const uint32_t want_ms = st.air_ms;
+    if (verbose) printf("  burst %lu ms keyed, generator %lu ms, last frame %lu bits (%lu stuffed)\n",
+                        (unsigned long)(burst / 8u), (unsigned long)want_ms,
+                        (unsigned long)st.bits, (unsigned long)st.stuffed);
+    check(first == t_queue, "keyed from the next block");
+    check(burst / 8u >= want_ms && burst / 8u <= want_ms + 32u + 5u, "carrier drops after the burst (no roger beep)");
+    check(st.stuffed > 0u, "stuffed bits counted");
+
+    // Deviation and phase continuity of the tones
+    float peak = 0.0f;
+    for (uint32_t i = first; i < first + 4000u; i++) if (fabsf(cap_hz[i]) > peak) peak = fabsf(cap_hz[i]);
+    check(fabsf(peak - dev) <= PLL_STEP_HZ + 1.0f, "peak deviation = fm_dev");
+
+    cmd("pkt N0CALL>APRS:phase");
+    float prev = 0.0f, jump = 0.0f;
+    for (uint32_t i = 0; i < 20000u && afsk_active(); i++) {
+        const float x = afsk_sample();
+        if (i && fabsf(x - prev) > jump) jump = fabsf(x - prev);
+        prev = x;
+    }
+    check(jump <= 2.0f * (float)M_PI * AFSK_SPACE_HZ / WAV_SAMPLE_RATE + 0.01f, "tones phase continuous");
+    afsk_block();
+
+    // ---- Queue limit, mode change flushes ----
+    for (uint32_t i = 0; i < AFSK_QUEUE; i++) cmd("pkt N0CALL>APRS:q");
+    cmd("pkt N0CALL>APRS:one too many");
+    check(!strncmp(last_line, "ERR: pkt queue full", 19), "queue full refused");
+    g_tx_mode = TXM_USB;
+    run_blocks(1);
+    check(!afsk_active() && strstr(last_line, "why=mode"), "mode change flushes the queue");
+
+    afsk_print("final");
+    return check_result();
+}
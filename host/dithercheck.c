@@ -0,0 +1,203 @@
+// dithercheck.c - Q8 frequency commands dithered by Core1 per substep
+//
+//   dithercheck [--seconds S] [-v]
+//
+// sample_cmd_set_freq() must round any frequency to within 1/512 step and
+// sample_cmd_dither() must key exactly freq_frac extra steps in every 256
+// substeps.  Then the SSB chain sends a tone, a tone with fine tuning and
+// a two-tone, and each command stream goes through the RF model twice
+// (host/rfmodel.c): as Core1 now keys it, and re-dithered once per sample
+// at 8 kHz the way the producer used to.  Power away from the wanted
+// tones within +-8 kHz of the carrier is measured twice.  Once with the
+// power codes held at max, which isolates the frequency path: for a
+// single tone it must drop by at least 6 dB.  Once as keyed: there the
+// 8 kHz power-code dither sets the floor next to a tone, and it must not
+// rise.  The mean frequency must be no further off than before.  Also
+// reports how many frequency writes Core1 makes per second.  Exits
+// non-zero on failure.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+#include "rfmodel.h"
+#include "hostutil.h"
+
+// ---------------- Platform ----------------
+static bool verbose;
+
+bool plat_cdc_connected(void) { return true; }
+void plat_cdc_write(const char *s) { if (verbose) printf("    %s", s); }
+
+static float tone_hz[2];
+static float ph[2];
+
+float plat_audio_sample(uint32_t n, const audio_cfg_t *cfg) {
+    (void)n; (void)cfg;
+    float y = 0.0f;
+    for (int k = 0; k < 2; k++) {
+        if (tone_hz[k] <= 0.0f) continue;
+        ph[k] += 2.0f * (float)M_PI * tone_hz[k] / (float)WAV_SAMPLE_RATE;
+        if (ph[k] > (float)M_PI) ph[k] -= 2.0f * (float)M_PI;
+        y += 0.25f * sinf(ph[k]);
+    }
+    return y;
+}
+
+// ---------------- Helpers ----------------
+static void test_helpers(void) {
+    float worst = 0.0f;
+    for (int32_t i = -40000; i <= 40000; i++) {
+        const float steps = (float)i * 0.00137f;
+        sample_cmd_t c;
+        sample_cmd_set_freq(&c, 1000, steps);
+        const float back = (float)sample_cmd_q8(&c, 1000) / (float)FREQ_FRAC_ONE;
+        const float e = fabsf(back - steps);
+        if (e > worst) worst = e;
+    }
+    printf("set_freq: worst rounding %.5f step (limit %.5f)\n", (double)worst, 0.5 / FREQ_FRAC_ONE + 1e-4);
+    check(worst <= 0.5f / (float)FREQ_FRAC_ONE + 1e-4f, "Q8 rounding within half an LSB");
+
+    bool exact = true;
+    for (uint32_t f = 0; f < FREQ_FRAC_ONE; f++) {
+        const sample_cmd_t c = { .freq_steps = -7, .freq_frac = (uint8_t)f };
+        uint32_t acc = 0;
+        int32_t sum = 0;
+        for (uint32_t k = 0; k < FREQ_FRAC_ONE; k++) sum += sample_cmd_dither(&c, &acc) + 7;
+        if (sum != (int32_t)f || acc != 0u) exact = false;
+    }
+    check(exact, "dither keys freq_frac extra steps per 256 substeps");
+}
+
+// Dial on a whole PLL step plus fine_hz
+static void set_fine_tune_hz(float fine_hz) {
+    g_ppm_correction = 0.0f;
+    g_ppm_disc = 0.0f;
+    g_target_freq_hz = 12100000.0 * (double)PLL_STEP_HZ + (double)fine_hz;
+}
+
+// ---------------- Old vs new through the RF model ----------------
+typedef struct {
+    float    spur_db;       // power away from the tones, dBc
+    float    fspur_db;      // same, power codes held at max
+    float    ferr_hz;       // mean frequency minus the wanted one
+    uint32_t writes_s;      // frequency writes Core1 makes per second
+} side_t;
+
+// As the producer used to: whole steps, dithered once per sample
+static void old_dither(const sample_cmd_t *in, sample_cmd_t *out, int32_t base, float *acc) {
+    for (uint32_t i = 0; i < BLOCK_SAMPLES; i++) {
+        const float want = (float)sample_cmd_q8(&in[i], base) / (float)FREQ_FRAC_ONE;
+        int32_t n = (int32_t)floorf(want);
+        *acc += want - (float)n;
+        if (*acc >= 1.0f) { n++; *acc -= 1.0f; }
+        out[i] = in[i];
+        out[i].freq_steps = base + n;
+        out[i].freq_frac = 0;
+    }
+}
+
+// Power within +-8 kHz but more than 60 Hz from every wanted tone
+static float spur_db(const rf_acc_t *a, const float *f, int nf) {
+    const float edge = 8000.0f, guard = 60.0f;
+    double s = rf_band(a, -edge, edge);
+    for (int k = 0; k < nf; k++) s -= rf_band(a, f[k] - guard, f[k] + guard);
+    return (float)(10.0 * log10(fmax(s, 1e-12)));
+}
+
+static void run(const char *what, float t1, float t2, float fine_hz, float seconds, bool expect_drop) {
+    static rf_acc_t rf_new, rf_old, rf_fnew, rf_fold;
+    static sample_cmd_t blk[BLOCK_SAMPLES], oblk[BLOCK_SAMPLES];
+
+    tone_hz[0] = t1; tone_hz[1] = t2;
+    ph[0] = ph[1] = 0.0f;
+    set_fine_tune_hz(fine_hz);
+    txchain_init();
+    rf_reset(&rf_new);
+    rf_reset(&rf_old);
+    rf_reset(&rf_fnew);
+    rf_reset(&rf_fold);
+
+    const int32_t base = (int32_t)get_base_steps();
+    const uint32_t blocks = (uint32_t)(seconds * (float)WAV_SAMPLE_RATE / (float)BLOCK_SAMPLES);
+    float acc_old = 0.0f;
+    uint32_t acc_new = 0;
+    int32_t last_new = INT32_MAX, last_old = INT32_MAX;
+    uint32_t w_new = 0, w_old = 0, on = 0;
+    double fsum_new = 0.0, fsum_old = 0.0;
+
+    for (uint32_t b = 0; b < blocks; b++) {
+        txchain_fill_block(blk);
+        old_dither(blk, oblk, base, &acc_old);
+        if (b < 4u) continue;                       // chain settling
+        for (uint32_t i = 0; i < BLOCK_SAMPLES; i++) {
+            if (!blk[i].tx_on) continue;
+            on++;
+            for (uint32_t k = 0; k < DITHER_SUBSTEPS; k++) {
+                const int32_t s = sample_cmd_dither(&blk[i], &acc_new);
+                if (s != last_new) { w_new++; last_new = s; }
+                fsum_new += (double)(s - base);
+            }
+            if (oblk[i].freq_steps != last_old) { w_old++; last_old = oblk[i].freq_steps; }
+            fsum_old += (double)(oblk[i].freq_steps - base) * DITHER_SUBSTEPS;
+        }
+        rf_push(&rf_new, blk, BLOCK_SAMPLES, base);
+        rf_push(&rf_old, oblk, BLOCK_SAMPLES, base);
+        for (uint32_t i = 0; i < BLOCK_SAMPLES; i++) blk[i].p_dbm = oblk[i].p_dbm = PWR_MAX_DBM;
+        rf_push(&rf_fnew, blk, BLOCK_SAMPLES, base);
+        rf_push(&rf_fold, oblk, BLOCK_SAMPLES, base);
+    }
+
+    const float f[2] = { t1 + fine_hz, t2 + fine_hz };
+    const int nf = t2 > 0.0f ? 2 : 1;
+    const double secs = (double)on / WAV_SAMPLE_RATE;
+    side_t sn, so;
+    sn.spur_db = spur_db(&rf_new, f, nf);
+    so.spur_db = spur_db(&rf_old, f, nf);
+    sn.fspur_db = spur_db(&rf_fnew, f, nf);
+    so.fspur_db = spur_db(&rf_fold, f, nf);
+    // Single tone: the mean PLL frequency is the tone; two-tone has no such reference
+    const double want = nf == 1 ? (double)f[0] : 0.0;
+    sn.ferr_hz = (float)(fsum_new / (on * DITHER_SUBSTEPS) * PLL_STEP_HZ - want);
+    so.ferr_hz = (float)(fsum_old / (on * DITHER_SUBSTEPS) * PLL_STEP_HZ - want);
+    sn.writes_s = (uint32_t)(w_new / secs);
+    so.writes_s = (uint32_t)(w_old / secs);
+
+    printf("%-10s freq path %6.1f -> %6.1f dBc, keyed %6.1f -> %6.1f dBc   ", what,
+           (double)so.fspur_db, (double)sn.fspur_db, (double)so.spur_db, (double)sn.spur_db);
+    if (nf == 1) printf("mean err %5.1f -> %5.1f Hz   ", (double)so.ferr_hz, (double)sn.ferr_hz);
+    else         printf("%29s", "");
+    printf("writes/s %5lu -> %5lu\n", (unsigned long)so.writes_s, (unsigned long)sn.writes_s);
+
+    check(sn.fspur_db <= so.fspur_db + 0.5f, "frequency path: no more power away from the tones");
+    check(sn.spur_db <= so.spur_db + 0.5f, "as keyed: no more power away from the tones");
+    if (expect_drop) check(sn.fspur_db <= so.fspur_db - 6.0f, "single tone: frequency dither spurs at least 6 dB lower");
+    if (nf == 1) check(fabsf(sn.ferr_hz) <= fabsf(so.ferr_hz) + 0.5f, "mean frequency no further off");
+    check(sn.writes_s <= (uint32_t)(WAV_SAMPLE_RATE * DITHER_SUBSTEPS), "at most one write per substep");
+}
+
+int main(int argc, char **argv) {
+    float seconds = 10.0f;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-v")) verbose = check_verbose = true;
+        else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) seconds = strtof(argv[++i], NULL);
+        else { fprintf(stderr, "usage: dithercheck [--seconds S] [-v]\n"); return 2; }
+    }
+
+    g_tx_mode = TXM_USB;
+    g_tx_enabled = 1;
+    g_tx_power_max_dbm = PWR_MAX_DBM;
+
+    test_helpers();
+    run("tone", 1091.0f, 0.0f, 0.0f, seconds, true);
+    run("tone+fine", 1000.0f, 0.0f, 37.0f, seconds, true);
+    run("two-tone", 700.0f, 1900.0f, 0.0f, seconds, false);
+
+    return check_result();
+}
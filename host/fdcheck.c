@@ -0,0 +1,159 @@
+// fdcheck.c - run the PPM discipline loop (freqdisc.c) against simulated
+// reference edges and report acquisition and tracking
+//
+//   fdcheck [--src sof|pps] [--ppm P] [--drift P] [--period S] [--jitter US]
+//           [--miss F] [--dropout S] [--hours H] [-v]
+//
+// The local clock runs at P ppm plus a sinusoidal temperature drift of
+// +-drift ppm; SOF edges are timestamped in whole us plus jitter, PPS
+// edges with the PIO's 3-cycle resolution.  First, with the default
+// build, the loop must estimate the offset but leave g_ppm_disc at 0
+// (the radio has its own TCXO); the tracking run then applies it as a
+// shared-reference build would.  Exits non-zero if the report-only
+// phase touches the carrier, or the loop fails to lock or tracks worse
+// than the limits below.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+#include "freqdisc.h"
+
+#define LOCK_LIMIT_S        900.0   // must lock within this
+#define TRACK_LIMIT_PPM     0.10    // max |error| once locked (excl. holdover)
+
+// ---------------- Simulated platform ----------------
+static uint64_t sim_us;
+static bool     verbose;
+
+uint64_t plat_us(void) { return sim_us; }
+uint32_t plat_ms(void) { return (uint32_t)(sim_us / 1000u); }
+
+bool plat_cdc_connected(void) { return verbose; }
+void plat_cdc_write(const char *s) {
+    printf("%8.1f s  %s", (double)sim_us * 1e-6, s);
+}
+
+// Uniform in [-1, 1)
+static uint32_t rng = 0x2545F491u;
+static double urand(void) {
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    return (double)rng / 2147483648.0 - 1.0;
+}
+
+// Clean SOF edges for 120 s with the build's default apply setting
+static bool report_only(double ppm) {
+    freqdisc_select(FD_SRC_SOF);
+    double loc_us = 0.0;
+    bool touched = false;
+    for (uint64_t ms = 1; ms <= 120000u; ms++) {
+        loc_us += 1000.0 * (1.0 + ppm * 1e-6);
+        sim_us = ms * 1000u;
+        freqdisc_sof((uint32_t)ms & 0x7FFu, (uint64_t)floor(loc_us));
+        if ((ms % 10u) == 0) freqdisc_poll();
+        if (g_ppm_disc != 0.0f) touched = true;
+    }
+    freqdisc_stats_t s;
+    freqdisc_stats(&s);
+    freqdisc_select(FD_SRC_OFF);
+    printf("report only: est %+.3f ppm (true %+.3f), target %+.3f, carrier corr %+.3f\n",
+           (double)s.est_ppm, ppm, (double)s.applied_ppm, (double)g_ppm_disc);
+    return !s.apply && !touched && fabs((double)s.est_ppm - ppm) < 0.5;
+}
+
+int main(int argc, char **argv) {
+    uint8_t src = FD_SRC_SOF;
+    double ppm0 = 3.0, drift = 0.3, period_s = 1800.0;
+    double jitter_us = -1.0, miss = 0.001, dropout_s = 20.0, hours = 1.0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (!strcmp(a, "-v")) { verbose = true; continue; }
+        if (!v) { fprintf(stderr, "missing value for %s\n", a); return 2; }
+        i++;
+        if (!strcmp(a, "--src")) src = !strcmp(v, "pps") ? FD_SRC_PPS : FD_SRC_SOF;
+        else if (!strcmp(a, "--ppm")) ppm0 = atof(v);
+        else if (!strcmp(a, "--drift")) drift = atof(v);
+        else if (!strcmp(a, "--period")) period_s = atof(v);
+        else if (!strcmp(a, "--jitter")) jitter_us = atof(v);
+        else if (!strcmp(a, "--miss")) miss = atof(v);
+        else if (!strcmp(a, "--dropout")) dropout_s = atof(v);
+        else if (!strcmp(a, "--hours")) hours = atof(v);
+        else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+    }
+    if (jitter_us < 0.0) jitter_us = (src == FD_SRC_SOF) ? 2.0 : 0.05;
+
+    const uint32_t pps_tick_hz = 250000000u / 3u;
+    const double total_s = hours * 3600.0;
+    const double drop_at = total_s / 2.0;
+
+    const bool ro_ok = FD_SHARED_REF || report_only(ppm0);
+
+    sim_us = 0;
+    freqdisc_set_apply(true);       // as a shared-reference build
+    freqdisc_select(src);
+
+    double loc_us = 0.0;            // local clock, exact
+    double lock_at = -1.0;
+    double err_max = 0.0, err_sq = 0.0;
+    uint32_t err_n = 0, holdovers = 0;
+    uint8_t prev_state = FD_ST_OFF;
+
+    for (uint64_t ms = 1; (double)ms < total_s * 1000.0; ms++) {
+        double t = (double)ms * 1e-3;
+        double ppm_true = ppm0 + drift * sin(2.0 * M_PI * t / period_s);
+        loc_us += 1000.0 * (1.0 + ppm_true * 1e-6);
+        sim_us = ms * 1000u;
+
+        bool dropped = (t >= drop_at && t < drop_at + dropout_s);
+
+        if (!dropped && src == FD_SRC_SOF && (urand() + 1.0) * 0.5 >= miss) {
+            double ts = floor(loc_us + jitter_us * urand());
+            freqdisc_sof((uint32_t)ms & 0x7FFu, (uint64_t)ts);
+        }
+        if (!dropped && src == FD_SRC_PPS && (ms % 1000u) == 0 && (urand() + 1.0) * 0.5 >= miss) {
+            double ticks = (loc_us + jitter_us * urand()) * 1e-6 * (double)pps_tick_hz;
+            freqdisc_pps((uint32_t)(uint64_t)ticks, pps_tick_hz);
+        }
+
+        if ((ms % 10u) == 0) {
+            freqdisc_poll();
+
+            freqdisc_stats_t s;
+            freqdisc_stats(&s);
+            if (s.state == FD_ST_HOLDOVER && prev_state != FD_ST_HOLDOVER) holdovers++;
+            if (s.state == FD_ST_LOCKED && lock_at < 0.0) lock_at = t;
+            prev_state = s.state;
+
+            // Tracking error: applied correction should cancel the clock
+            if (lock_at >= 0.0 && s.state == FD_ST_LOCKED) {
+                double e = fabs((double)g_ppm_disc + ppm_true);
+                if (e > err_max) err_max = e;
+                err_sq += e * e;
+                err_n++;
+            }
+        }
+    }
+
+    freqdisc_stats_t s;
+    freqdisc_stats(&s);
+    printf("src=%s ppm=%+.3f drift=+-%.3f/%.0fs jitter=%.3fus miss=%.4f dropout=%.0fs sim=%.1fh\n",
+           freqdisc_src_label(src), ppm0, drift, period_s, jitter_us, miss, dropout_s, hours);
+    printf("lock: %s%.0f s, windows %lu, rejects %lu, holdovers %lu, final state %s\n",
+           lock_at < 0.0 ? "never " : "", lock_at < 0.0 ? 0.0 : lock_at,
+           (unsigned long)s.windows, (unsigned long)s.rejects,
+           (unsigned long)holdovers, freqdisc_state_label(s.state));
+    printf("tracking when locked: rms %.4f ppm, max %.4f ppm (limit %.2f)\n",
+           err_n ? sqrt(err_sq / err_n) : 0.0, err_max, TRACK_LIMIT_PPM);
+
+    bool ok = ro_ok && lock_at >= 0.0 && lock_at <= LOCK_LIMIT_S && err_max <= TRACK_LIMIT_PPM;
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+// gentables.c - generate dsp_tables.c (precomputed DSP tables kept in flash)
+//
+//   gentables > dsp_tables.c
+//
+// Computed in double and rounded once, so the table is slightly more
+// accurate than the old on-device cosf() loop it replaces.
+
+#include <stdio.h>
+#include <math.h>
+
+#include "dsp.h"
+
+// Type III Hilbert FIR of odd length n, Hamming window
+static void emit_hilbert(const char *name, const char *len_macro, int taps) {
+    const int M = (taps - 1) / 2;
+
+    printf("\n// Type III Hilbert FIR, Hamming window, %d taps\n", taps);
+    printf("const float %s[%s] = {\n", name, len_macro);
+    for (int n = 0; n < taps; n++) {
+        int k = n - M;
+        double h = 0.0;
+        if (k != 0 && (k & 1)) h = 2.0 / (M_PI * (double)k);
+        double w = 0.54 - 0.46 * cos(2.0 * M_PI * (double)n / (double)(taps - 1));
+
+        if ((n % 4) == 0) printf("   ");
+        printf(" %.9ef,", (float)(h * w));
+        if ((n % 4) == 3 || n == taps - 1) printf("\n");
+    }
+    printf("};\n");
+}
+
+// One turn of sine plus a guard point for the interpolation
+static void emit_sin_lut(void) {
+    printf("\n// sin(2*pi*i/%u), i = 0..%u\n", SIN_LUT_SIZE, SIN_LUT_SIZE);
+    printf("const float dsp_sin_lut[SIN_LUT_SIZE + 1u] = {\n");
+    for (unsigned i = 0; i <= SIN_LUT_SIZE; i++) {
+        double v = sin(2.0 * M_PI * (double)(i % SIN_LUT_SIZE) / (double)SIN_LUT_SIZE);
+        if ((i % 4) == 0) printf("   ");
+        printf(" %.9ef,", (float)v);
+        if ((i % 4) == 3 || i == SIN_LUT_SIZE) printf("\n");
+    }
+    printf("};\n");
+}
+
+int main(void) {
+    printf("// dsp_tables.c - precomputed DSP tables (generated by host/gentables, do not edit)\n");
+    printf("\n#include \"dsp.h\"\n");
+    printf("\n#if HILBERT_TAPS != %d || HILBERT_TAPS_MID != %d || HILBERT_TAPS_LOW != %d\n",
+           HILBERT_TAPS, HILBERT_TAPS_MID, HILBERT_TAPS_LOW);
+    printf("#error \"HILBERT_TAPS changed: regenerate with host/gentables\"\n");
+    printf("#endif\n");
+    printf("#if SIN_LUT_LOG2 != %d\n", SIN_LUT_LOG2);
+    printf("#error \"SIN_LUT_LOG2 changed: regenerate with host/gentables\"\n");
+    printf("#endif\n");
+
+    emit_hilbert("dsp_hilbert_taps", "HILBERT_TAPS", HILBERT_TAPS);
+    emit_hilbert("dsp_hilbert_taps_mid", "HILBERT_TAPS_MID", HILBERT_TAPS_MID);
+    emit_hilbert("dsp_hilbert_taps_low", "HILBERT_TAPS_LOW", HILBERT_TAPS_LOW);
+    emit_sin_lut();
+    return 0;
+}
@@ -0,0 +1,187 @@
+// govcheck.c - measure the DSP governor's quality levels and run its
+// decision logic against a simulated slow Core0
+//
+//   govcheck [--blocks N] [--load PCT] [--noise PCT] [--minutes M] [-v]
+//
+// Part 1 counts the work per sample at every level from the profile table
+// (bandpass biquad MACs, Hilbert taps, compressor gain evaluations) and
+// checks that each step down does no more of any and less in total.  It
+// also times txchain_fill_block() per level on this host (best of several
+// runs), for information only.  Part 2 scales the timed relative costs,
+// made non-increasing, so level 0 takes PCT % of the block deadline, feeds the
+// governor for M minutes, then drops the pressure and checks that it
+// settles below the step-down threshold without hunting and returns to
+// full quality.  Exits non-zero on failure.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+#include "dspgov.h"
+
+#define MAX_DOWNS_PER_HOUR  12      // hunting limit under steady pressure
+#define GAIN_OPS            30u     // compressor gain (log + pow) in MAC equivalents
+#define TIMING_REPS         5u
+
+// ---------------- Platform ----------------
+static bool verbose;
+static uint64_t sim_blocks;         // part 2 block counter (for log lines)
+
+bool plat_cdc_connected(void) { return verbose; }
+void plat_cdc_write(const char *s) {
+    printf("%8.1f s  %s", (double)sim_blocks * BLOCK_SAMPLES / WAV_SAMPLE_RATE, s);
+}
+
+static float aph1, aph2;
+float plat_audio_sample(uint32_t n, const audio_cfg_t *cfg) {
+    (void)n; (void)cfg;
+    const float fs = (float)WAV_SAMPLE_RATE;
+    aph1 += 2.0f * (float)M_PI * 700.0f / fs;
+    aph2 += 2.0f * (float)M_PI * 1900.0f / fs;
+    if (aph1 > (float)M_PI) aph1 -= 2.0f * (float)M_PI;
+    if (aph2 > (float)M_PI) aph2 -= 2.0f * (float)M_PI;
+    return 0.25f * (sinf(aph1) + sinf(aph2));
+}
+
+static uint32_t rng = 0x9E3779B9u;
+static double urand(void) {
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    return (double)rng / 2147483648.0 - 1.0;
+}
+
+static sample_cmd_t blk[BLOCK_SAMPLES];
+
+// Work per sample at the pinned level, from the profile and the chain config
+typedef struct {
+    uint32_t bp_macs;       // 2 biquads x 5 MACs per bandpass stage
+    uint32_t hilb_macs;
+    float    comp_ops;      // gain evaluations per sample x GAIN_OPS
+} work_t;
+
+static work_t level_work(const dspgov_profile_t *p, const audio_cfg_t *c) {
+    work_t w = { 0, 0, 0.0f };
+    uint32_t stages = c->bp_stages < p->bp_max ? c->bp_stages : p->bp_max;
+    if (c->enable_bandpass) w.bp_macs = 10u * stages;
+    w.hilb_macs = p->hilb_taps;
+    if (c->enable_comp) w.comp_ops = (float)GAIN_OPS / (float)(p->comp_decim ? p->comp_decim : 1u);
+    return w;
+}
+
+static float work_total(const work_t *w) { return (float)(w->bp_macs + w->hilb_macs) + w->comp_ops; }
+
+int main(int argc, char **argv) {
+    uint32_t blocks = 2000;
+    double load0 = 90.0, noise = 5.0, minutes = 10.0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (!strcmp(a, "-v")) { verbose = true; continue; }
+        if (!v) { fprintf(stderr, "missing value for %s\n", a); return 2; }
+        i++;
+        if (!strcmp(a, "--blocks")) blocks = (uint32_t)strtoul(v, NULL, 0);
+        else if (!strcmp(a, "--load")) load0 = atof(v);
+        else if (!strcmp(a, "--noise")) noise = atof(v);
+        else if (!strcmp(a, "--minutes")) minutes = atof(v);
+        else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+    }
+    if (blocks == 0) blocks = 1;
+
+    bool ok = true;
+    const uint32_t deadline_us = (uint32_t)(BLOCK_SAMPLES * 1000000ull / WAV_SAMPLE_RATE);
+
+    // ---- Part 1: real cost per level ----
+    txchain_init();
+    g_tx_enabled = 1;
+
+    // Best of TIMING_REPS runs per level, levels interleaved
+    double cost[GOV_LEVELS];
+    for (uint8_t lvl = 0; lvl < GOV_LEVELS; lvl++) cost[lvl] = 1e30;
+    for (uint32_t r = 0; r < TIMING_REPS; r++) {
+        for (uint8_t lvl = 0; lvl < GOV_LEVELS; lvl++) {
+            dspgov_set(lvl);
+            for (uint32_t i = 0; i < 16; i++) txchain_fill_block(blk);   // warm up
+
+            uint64_t t0 = plat_us();
+            for (uint32_t i = 0; i < blocks; i++) txchain_fill_block(blk);
+            const double c = (double)(plat_us() - t0) / blocks;
+            if (c < cost[lvl]) cost[lvl] = c;
+        }
+    }
+
+    audio_cfg_t cfg;
+    cfg_snapshot(&cfg);
+    work_t prev = { 0, 0, 0.0f };
+    printf("level  bpmax  hilb  cdec  ops/smp   us/block  rel\n");
+    for (uint8_t lvl = 0; lvl < GOV_LEVELS; lvl++) {
+        dspgov_set(lvl);
+        const dspgov_profile_t *p = dspgov_profile();
+        const work_t w = level_work(p, &cfg);
+        printf("%5u  %5u  %4u  %4u  %7.1f  %9.1f  %.2f\n", lvl, p->bp_max, p->hilb_taps,
+               p->comp_decim, (double)work_total(&w), cost[lvl], cost[lvl] / cost[0]);
+        if (lvl > 0 && (w.bp_macs > prev.bp_macs || w.hilb_macs > prev.hilb_macs ||
+                        w.comp_ops > prev.comp_ops || !(work_total(&w) < work_total(&prev)))) {
+            printf("  level %u does not do less work than level %u\n", lvl, lvl - 1);
+            ok = false;
+        }
+        prev = w;
+        // Timing noise must not make the simulated core faster at full quality
+        if (lvl > 0 && cost[lvl] > cost[lvl - 1]) cost[lvl] = cost[lvl - 1];
+    }
+
+    // ---- Part 2: governor decisions on a simulated slow core ----
+    const double scale = load0 / 100.0 * deadline_us / cost[0];
+    const uint64_t n_press = (uint64_t)(minutes * 60.0 * WAV_SAMPLE_RATE / BLOCK_SAMPLES);
+    const uint64_t n_relax = n_press;
+
+    dspgov_set(0);
+    dspgov_set(GOV_AUTO);
+
+    dspgov_stats_t s;
+    uint64_t first_settle = 0;
+    double settled_load = 0.0;
+    uint32_t settled_n = 0;
+    uint8_t  press_level = 0;
+
+    for (sim_blocks = 0; sim_blocks < n_press + n_relax; sim_blocks++) {
+        bool press = sim_blocks < n_press;
+        dspgov_stats(&s);
+        double c = press ? cost[s.level] * scale : 0.3 * deadline_us * cost[s.level] / cost[0];
+        c *= 1.0 + noise / 100.0 * urand();
+        dspgov_block((uint32_t)c, deadline_us, NUM_BLOCKS - 1u, 0);
+
+        if (press && sim_blocks >= n_press / 2) {
+            settled_load += c * 100.0 / deadline_us;
+            settled_n++;
+            press_level = s.level;
+        }
+        if (!press && first_settle == 0 && s.level == 0) first_settle = sim_blocks - n_press;
+    }
+
+    dspgov_stats(&s);
+    double hours = minutes / 60.0;
+    double settle_s = (double)first_settle * BLOCK_SAMPLES / WAV_SAMPLE_RATE;
+    double avg = settled_n ? settled_load / settled_n : 0.0;
+
+    printf("pressure: level-0 load %.0f%% (+-%.0f%%) for %.0f min\n", load0, noise, minutes);
+    printf("  steps down %lu, up %lu, settled at level %u, load %.0f%% (threshold %u%%)\n",
+           (unsigned long)s.downs, (unsigned long)s.ups, press_level, avg, GOV_DOWN_PCT);
+    printf("relaxed: back to level 0 after %.1f s, final level %u\n", settle_s, s.level);
+
+    // Over the threshold is only a failure while there is a level left
+    if (avg > GOV_DOWN_PCT && press_level + 1u < GOV_LEVELS) {
+        printf("  still over the step-down threshold\n");
+        ok = false;
+    }
+    if (s.downs > (uint32_t)(GOV_LEVELS + MAX_DOWNS_PER_HOUR * hours)) { printf("  hunting\n"); ok = false; }
+    if (s.level != 0) { printf("  did not return to full quality\n"); ok = false; }
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+// hostutil.c - shared helpers for the offline host tools
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "hostutil.h"
+
+bool cfg_parse_spec(const char *spec, audio_cfg_t *c) {
+    char buf[512];
+    char *save = NULL;
+    snprintf(buf, sizeof(buf), "%s", spec);
+    for (char *tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        char *eq = strchr(tok, '=');
+        float f;
+        if (!eq) { fprintf(stderr, "spec: expected key=val, got '%s'\n", tok); return false; }
+        *eq = '\0';
+        if (!parse_f(eq + 1, &f)) { fprintf(stderr, "spec: bad value for %s\n", tok); return false; }
+        if (!cfg_set_key(c, tok, f)) { fprintf(stderr, "spec: unknown key %s\n", tok); return false; }
+    }
+    cfg_sanitize(c, (float)WAV_SAMPLE_RATE);
+    return true;
+}
+
+bool check_verbose;
+static uint32_t check_fails;
+
+void check(bool ok, const char *what) {
+    if (!ok) { printf("  FAIL: %s\n", what); check_fails++; }
+    else if (check_verbose) printf("  ok: %s\n", what);
+}
+
+int check_result(void) {
+    printf("%s\n", check_fails ? "FAIL" : "PASS");
+    return check_fails ? 1 : 0;
+}
+
+static uint32_t rd_u32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint16_t rd_u16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+static bool wav_read(const char *path, float **out, uint32_t *n_out, uint32_t *rate, uint16_t *ch) {
+    FILE *f = fopen(path, "rb");
+    if (!f) { perror(path); return false; }
+
+    uint8_t hdr[12];
+    uint16_t fmt = 0, bits = 0;
+    *ch = 0; *rate = 0;
+    bool ok = false;
+
+    if (fread(hdr, 1, 12, f) != 12 || memcmp(hdr, "RIFF", 4) || memcmp(hdr + 8, "WAVE", 4)) {
+        fprintf(stderr, "%s: not a RIFF/WAVE file\n", path);
+        goto done;
+    }
+
+    for (;;) {
+        uint8_t ck[8];
+        if (fread(ck, 1, 8, f) != 8) { fprintf(stderr, "%s: no data chunk\n", path); goto done; }
+        uint32_t len = rd_u32(ck + 4);
+
+        if (!memcmp(ck, "fmt ", 4)) {
+            uint8_t b[40] = { 0 };
+            uint32_t take = len < sizeof(b) ? len : (uint32_t)sizeof(b);
+            if (fread(b, 1, take, f) != take) goto done;
+            if (len > take) fseek(f, (long)(len - take), SEEK_CUR);
+            fmt = rd_u16(b);
+            *ch = rd_u16(b + 2);
+            *rate = rd_u32(b + 4);
+            bits = rd_u16(b + 14);
+            if (fmt == 0xFFFEu && take >= 26u) fmt = rd_u16(b + 24);   // WAVE_FORMAT_EXTENSIBLE
+        } else if (!memcmp(ck, "data", 4)) {
+            if (!(fmt == 1 && bits == 16) && !(fmt == 3 && bits == 32)) {
+                fprintf(stderr, "%s: need 16-bit PCM or 32-bit float\n", path);
+                goto done;
+            }
+            if (*ch == 0 || *rate < 1000u) { fprintf(stderr, "%s: bad format chunk\n", path); goto done; }
+
+            const uint32_t bps = bits / 8u;
+            const uint32_t frames = len / (bps * *ch);
+            uint8_t *raw = malloc((size_t)frames * bps * *ch);
+            float *x = malloc((size_t)(frames ? frames : 1u) * sizeof(float));
+            if (!raw || !x) { free(raw); free(x); goto done; }
+            uint32_t got = (uint32_t)(fread(raw, bps * *ch, frames, f));
+
+            for (uint32_t i = 0; i < got; i++) {
+                float s = 0.0f;
+                for (uint32_t c = 0; c < *ch; c++) {
+                    const uint8_t *p = raw + ((size_t)i * *ch + c) * bps;
+                    if (fmt == 1) {
+                        s += (float)(int16_t)rd_u16(p) * (1.0f / 32768.0f);
+                    } else {
+                        uint32_t u = rd_u32(p);
+                        float v;
+                        memcpy(&v, &u, sizeof(v));
+                        s += v;
+                    }
+                }
+                x[i] = s / (float)*ch;
+            }
+            free(raw);
+            *out = x;
+            *n_out = got;
+            ok = true;
+            goto done;
+        } else {
+            fseek(f, (long)(len + (len & 1u)), SEEK_CUR);
+        }
+    }
+done:
+    fclose(f);
+    return ok;
+}
+
+// Anti-alias lowpass (Blackman-windowed sinc, cutoff 3.6 kHz) then the
+// same 4-point Hermite the firmware's USB resampler uses.
+#define AA_TAPS     63
+
+static float *resample_8k(const float *x, uint32_t n, uint32_t rate, uint32_t *n_out) {
+    float *y = NULL;
+    const float *src = x;
+    float *lp = NULL;
+
+    if (rate > WAV_SAMPLE_RATE) {
+        float h[AA_TAPS];
+        const float fc = 3600.0f / (float)rate;
+        float sum = 0.0f;
+        for (int k = 0; k < AA_TAPS; k++) {
+            const float m = (float)(k - AA_TAPS / 2);
+            const float w = 0.42f - 0.5f * cosf(2.0f * (float)M_PI * (float)k / (AA_TAPS - 1))
+                          + 0.08f * cosf(4.0f * (float)M_PI * (float)k / (AA_TAPS - 1));
+            h[k] = w * (m == 0.0f ? 2.0f * fc : sinf(2.0f * (float)M_PI * fc * m) / ((float)M_PI * m));
+            sum += h[k];
+        }
+        lp = malloc((size_t)(n ? n : 1u) * sizeof(float));
+        if (!lp) return NULL;
+        for (uint32_t i = 0; i < n; i++) {
+            float acc = 0.0f;
+            for (int k = 0; k < AA_TAPS; k++) {
+                const int64_t j = (int64_t)i + k - AA_TAPS / 2;
+                if (j >= 0 && j < (int64_t)n) acc += h[k] * x[j];
+            }
+            lp[i] = acc / sum;
+        }
+        src = lp;
+    }
+
+    const double step = (double)rate / (double)WAV_SAMPLE_RATE;
+    const uint32_t m = (uint32_t)((double)n / step);
+    y = malloc((size_t)(m ? m : 1u) * sizeof(float));
+    if (y) {
+        for (uint32_t i = 0; i < m; i++) {
+            const double pos = (double)i * step;
+            const int64_t j = (int64_t)pos;
+            const float t = (float)(pos - (double)j);
+            #define AT(k) src[((k) < 0) ? 0 : ((k) >= (int64_t)n ? (int64_t)n - 1 : (k))]
+            const float sm1 = AT(j - 1), s0 = AT(j), s1 = AT(j + 1), s2 = AT(j + 2);
+            #undef AT
+            const float c1 = 0.5f * (s1 - sm1);
+            const float c2 = sm1 - 2.5f * s0 + 2.0f * s1 - 0.5f * s2;
+            const float c3 = 0.5f * (s2 - sm1) + 1.5f * (s0 - s1);
+            y[i] = ((c3 * t + c2) * t + c1) * t + s0;
+        }
+        *n_out = m;
+    }
+    free(lp);
+    return y;
+}
+
+bool audio_load(const char *path, audio_t *a) {
+    float *x;
+    uint32_t n;
+    memset(a, 0, sizeof(*a));
+    if (!wav_read(path, &x, &n, &a->src_rate, &a->src_ch)) return false;
+    if (a->src_rate == WAV_SAMPLE_RATE) {
+        a->x = x;
+        a->n = n;
+        return true;
+    }
+    a->x = resample_8k(x, n, a->src_rate, &a->n);
+    free(x);
+    return a->x != NULL;
+}
+
+void audio_free(audio_t *a) {
+    free(a->x);
+    a->x = NULL;
+    a->n = 0;
+}
@@ -0,0 +1,37 @@
+// hostutil.h - shared helpers for the host tools
+//
+// WAV input resampled to the chain's 8 kHz and "key=val,key=val" config
+// specs using the CDC "set" key names (sxrender, sxopt, sxdsp), and the
+// pass/fail bookkeeping of the *check programs.
+
+#ifndef HOSTUTIL_H
+#define HOSTUTIL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "control.h"
+
+// Apply "key=val,key=val" on top of *c and sanitise; false (with a
+// message on stderr) on an unknown key or bad value.
+bool cfg_parse_spec(const char *spec, audio_cfg_t *c);
+
+// 16-bit PCM or 32-bit float WAV, any rate / channel count, mixed to mono
+// and resampled to WAV_SAMPLE_RATE (windowed-sinc lowpass + Hermite).
+typedef struct {
+    float   *x;         // 8 kHz mono
+    uint32_t n;
+    uint32_t src_rate;
+    uint16_t src_ch;
+} audio_t;
+
+bool audio_load(const char *path, audio_t *a);
+void audio_free(audio_t *a);
+
+// Self-checks: check() prints a failure (and a pass with check_verbose)
+// and counts it; check_result() prints PASS / FAIL and is the exit code.
+extern bool check_verbose;
+void check(bool ok, const char *what);
+int  check_result(void);
+
+#endif // HOSTUTIL_H
@@ -0,0 +1,87 @@
+// interp_model.h - register-level model of the RP2040/RP2350 SIO
+// interpolator, with the subset of the hardware/interp.h API the
+// firmware uses.  Lets host/interpcheck compile the hardware path of
+// interp_accel.h and compare it with the portable fallback.
+//
+// Per lane: input = CROSS_INPUT ? other lane's ACCUM : own ACCUM;
+// RESULT = BASE + (ADD_RAW ? input : (input >> SHIFT) & MASK).  Popping
+// any lane writes RESULT0/RESULT1 back into ACCUM0/ACCUM1.
+
+#ifndef INTERP_MODEL_H
+#define INTERP_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    uint8_t shift, mask_lsb, mask_msb;
+    bool    cross_input, add_raw, is_signed;
+} interp_config;
+
+typedef struct {
+    uint32_t      accum[2];
+    uint32_t      base[2];
+    interp_config ctrl[2];
+    uint8_t       claimed;
+} interp_hw_t;
+
+extern interp_hw_t interp_model[2];
+#define interp0 (&interp_model[0])
+#define interp1 (&interp_model[1])
+
+static inline interp_config interp_default_config(void) {
+    interp_config c = { 0, 0, 31, false, false, false };
+    return c;
+}
+
+static inline void interp_config_set_shift(interp_config *c, unsigned s) { c->shift = (uint8_t)s; }
+static inline void interp_config_set_mask(interp_config *c, unsigned lsb, unsigned msb) {
+    c->mask_lsb = (uint8_t)lsb;
+    c->mask_msb = (uint8_t)msb;
+}
+static inline void interp_config_set_cross_input(interp_config *c, bool x) { c->cross_input = x; }
+static inline void interp_config_set_add_raw(interp_config *c, bool x)     { c->add_raw = x; }
+static inline void interp_config_set_signed(interp_config *c, bool x)      { c->is_signed = x; }
+
+static inline void interp_set_config(interp_hw_t *i, unsigned lane, const interp_config *c) { i->ctrl[lane] = *c; }
+static inline void interp_set_base(interp_hw_t *i, unsigned lane, uint32_t v)        { i->base[lane] = v; }
+static inline void interp_set_accumulator(interp_hw_t *i, unsigned lane, uint32_t v) { i->accum[lane] = v; }
+static inline uint32_t interp_get_accumulator(interp_hw_t *i, unsigned lane)         { return i->accum[lane]; }
+
+// Like the SDK: claiming a lane twice is a programming error
+static inline void interp_claim_lane(interp_hw_t *i, unsigned lane) {
+    if (i->claimed & (1u << lane)) {
+        fprintf(stderr, "interp lane %u already claimed\n", lane);
+        abort();
+    }
+    i->claimed |= (uint8_t)(1u << lane);
+}
+
+static inline uint32_t interp_model_lane(const interp_hw_t *i, unsigned lane) {
+    const interp_config *c = &i->ctrl[lane];
+    uint32_t in = c->cross_input ? i->accum[lane ^ 1u] : i->accum[lane];
+    if (c->add_raw) return i->base[lane] + in;
+
+    uint32_t width = (uint32_t)c->mask_msb - c->mask_lsb + 1u;
+    uint32_t mask = (width >= 32u ? 0xFFFFFFFFu : ((1u << width) - 1u)) << c->mask_lsb;
+    uint32_t v = (in >> c->shift) & mask;
+    if (c->is_signed && c->mask_msb < 31u && (v & (1u << c->mask_msb)))
+        v |= ~((2u << c->mask_msb) - 1u);
+    return i->base[lane] + v;
+}
+
+static inline uint32_t interp_peek_lane_result(interp_hw_t *i, unsigned lane) {
+    return interp_model_lane(i, lane);
+}
+
+static inline uint32_t interp_pop_lane_result(interp_hw_t *i, unsigned lane) {
+    uint32_t r0 = interp_model_lane(i, 0);
+    uint32_t r1 = interp_model_lane(i, 1);
+    i->accum[0] = r0;
+    i->accum[1] = r1;
+    return lane ? r1 : r0;
+}
+
+#endif // INTERP_MODEL_H
@@ -0,0 +1,165 @@
+// interpcheck.c - check the SIO interpolator paths against the portable
+// fallbacks and the index arithmetic they replaced
+//
+//   interpcheck [--iters N]
+//
+// The hardware path of interp_accel.h runs against a register model of
+// the interpolator (interp_model.h, see interpcheck_hw.c); every offset
+// and phase must match the fallback and the original modulo / wrap-loop
+// code bit for bit.  The Hilbert FIR is compared with the old 247-entry
+// ring at every governor length.  Exits non-zero on any mismatch.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dsp.h"
+#include "interp_accel.h"   // SX_HOST_BUILD: portable fallback
+
+void     hw_ring_walk_begin(uint32_t idx, uint32_t ring_log2);
+uint32_t hw_ring_walk_next(void);
+void     hw_q16_phase_init(uint32_t step);
+void     hw_q16_phase_set_step(uint32_t step);
+void     hw_q16_phase_reset(void);
+uint32_t hw_q16_phase_advance(void);
+
+static uint32_t rng = 0x6D2B79F5u;
+static uint32_t rnd(void) {
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    return rng;
+}
+
+static uint32_t fails;
+static void fail(const char *what, uint32_t i, uint32_t got, uint32_t want) {
+    if (fails++ < 10) printf("  %s: step %lu got 0x%08lx want 0x%08lx\n", what,
+                             (unsigned long)i, (unsigned long)got, (unsigned long)want);
+}
+
+// ---- Ring walk: offsets of idx, idx-1, ... modulo 2^log2 ----
+static void check_ring_walk(uint32_t iters) {
+    for (uint32_t t = 0; t < iters; t++) {
+        uint32_t log2 = 4u + rnd() % 7u;              // 16..1024 entries
+        uint32_t ring = 1u << log2;
+        uint32_t idx = rnd() & (ring - 1u);
+        uint32_t len = 1u + rnd() % (2u * ring);
+
+        ring_walk_t w;
+        ring_walk_begin(&w, idx, log2);
+        hw_ring_walk_begin(idx, log2);
+        for (uint32_t n = 0; n < len; n++) {
+            uint32_t want = ((idx + ring * 4u - n) % ring) * 4u;   // old style modulo
+            uint32_t sw = ring_walk_next(&w);
+            uint32_t hw = hw_ring_walk_next();
+            if (sw != want) fail("ring fallback", n, sw, want);
+            if (hw != want) fail("ring interp", n, hw, want);
+        }
+    }
+}
+
+// ---- Q16 phase: against the old "+= step; while (>= 1<<16)" loop ----
+static void check_q16_phase(uint32_t iters) {
+    // Resampler steps for 22.05..96 kHz into 8 kHz, +-10 % adaptive trim
+    uint32_t step = (48000u << 16) / 8000u;
+    q16_phase_t p;
+    q16_phase_init(&p, step);
+    hw_q16_phase_init(step);
+
+    uint32_t ref = 0;
+    for (uint32_t i = 0; i < iters; i++) {
+        if ((rnd() & 63u) == 0) {
+            uint32_t sr = 22050u + rnd() % (96000u - 22050u);
+            step = (uint32_t)(((uint64_t)sr << 16) / 8000u);
+            step += (rnd() % (step / 5u)) - step / 10u;
+        }
+        if ((rnd() & 4095u) == 0) {
+            q16_phase_reset(&p);
+            hw_q16_phase_reset();
+            ref = 0;
+        }
+        q16_phase_set_step(&p, step);
+        hw_q16_phase_set_step(step);
+
+        ref += step;
+        uint32_t adv = 0;
+        while (ref >= (1u << 16)) { ref -= (1u << 16); adv++; }
+
+        uint32_t want = (adv << 16) | ref;
+        uint32_t sw = q16_phase_advance(&p);
+        uint32_t hw = hw_q16_phase_advance();
+        if (sw != want) fail("q16 fallback", i, sw, want);
+        if (hw != want) fail("q16 interp", i, hw, want);
+    }
+}
+
+// ---- Hilbert: new power-of-two ring vs the old 247-entry modulo ring ----
+static float ref_buf[HILBERT_TAPS];
+static uint32_t ref_idx;
+
+static float ref_hilbert(const float *h, int N, float x, float *i_delayed) {
+    const int M = (N - 1) / 2;
+    ref_buf[ref_idx] = x;
+    float y = 0.0f;
+    uint32_t idx = ref_idx;
+    for (int n = 0; n < N; n++) {
+        y += h[n] * ref_buf[idx];
+        if (idx == 0) idx = HILBERT_TAPS - 1;
+        else idx--;
+    }
+    *i_delayed = ref_buf[(ref_idx + HILBERT_TAPS - (uint32_t)M) % HILBERT_TAPS];
+    if (++ref_idx >= HILBERT_TAPS) ref_idx = 0;
+    return y;
+}
+
+static hilbert_t hb;
+
+static void check_hilbert(uint32_t iters) {
+    static const struct { uint16_t n; const float *h; } lens[] = {
+        { HILBERT_TAPS,     dsp_hilbert_taps },
+        { HILBERT_TAPS_MID, dsp_hilbert_taps_mid },
+        { HILBERT_TAPS_LOW, dsp_hilbert_taps_low },
+    };
+
+    for (uint32_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+        hilbert_init(&hb);
+        hilbert_set_len(&hb, lens[l].n);
+        memset(ref_buf, 0, sizeof(ref_buf));
+        ref_idx = 0;
+
+        for (uint32_t i = 0; i < iters; i++) {
+            float x = (float)(int32_t)rnd() / 2147483648.0f;
+            float i_new, i_ref;
+            float q_new = hilbert_process(&hb, x, &i_new);
+            float q_ref = ref_hilbert(lens[l].h, lens[l].n, x, &i_ref);
+            uint32_t a, b;
+            memcpy(&a, &q_new, 4); memcpy(&b, &q_ref, 4);
+            if (a != b) fail("hilbert Q", i, a, b);
+            memcpy(&a, &i_new, 4); memcpy(&b, &i_ref, 4);
+            if (a != b) fail("hilbert I", i, a, b);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t iters = 200000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--iters") && i + 1 < argc) iters = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else { fprintf(stderr, "usage: interpcheck [--iters N]\n"); return 2; }
+    }
+
+    uint32_t f0 = fails;
+    check_ring_walk(iters / 100u);
+    printf("ring walk:  %s\n", fails == f0 ? "ok" : "MISMATCH");
+
+    f0 = fails;
+    check_q16_phase(iters * 10u);
+    printf("q16 phase:  %s\n", fails == f0 ? "ok" : "MISMATCH");
+
+    f0 = fails;
+    check_hilbert(iters);
+    printf("hilbert:    %s\n", fails == f0 ? "ok" : "MISMATCH");
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,18 @@
+// interpcheck_hw.c - the hardware path of interp_accel.h, compiled
+// against the register model (interp_model.h) for host/interpcheck
+
+#define SX_INTERP_MODEL 1
+#include "interp_accel.h"
+
+interp_hw_t interp_model[2];
+
+static ring_walk_t hw_walk;
+static q16_phase_t hw_phase;
+
+void hw_ring_walk_begin(uint32_t idx, uint32_t ring_log2) { ring_walk_begin(&hw_walk, idx, ring_log2); }
+uint32_t hw_ring_walk_next(void) { return ring_walk_next(&hw_walk); }
+
+void hw_q16_phase_init(uint32_t step) { q16_phase_init(&hw_phase, step); }
+void hw_q16_phase_set_step(uint32_t step) { q16_phase_set_step(&hw_phase, step); }
+void hw_q16_phase_reset(void) { q16_phase_reset(&hw_phase); }
+uint32_t hw_q16_phase_advance(void) { return q16_phase_advance(&hw_phase); }
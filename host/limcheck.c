@@ -0,0 +1,341 @@
+// limcheck.c - look-ahead output limiter (limiter_t in dsp.c)
+//
+//   limcheck [-v] [--seconds S]
+//
+// Block by block against a brute-force model (window max by scanning,
+// averages by summing) at several look-aheads: same output, |out| never
+// above the limit, a quiet signal comes out unchanged and late by
+// exactly la samples.  Then tone bursts that jump to 3x the limit show
+// what the hard clip it replaces puts above 3 kHz, ahead of the
+// bandpass.  The whole SSB chain is keyed with compressor overshoot and
+// compared on the RF model with comp_la 0 and the default: the limiter
+// must engage without adding power outside the channel or losing mean
+// power (on air, that floor is set by the power stage and the PLL step
+// quantisation, not by this clip).  On silence the modulator state must
+// be reset la samples later than without look-ahead, also when that
+// falls in the next block.  Last, ns per sample at each
+// look-ahead on random and on falling-ramp input (the deque's worst
+// case): the cost must not grow with la.  Exits non-zero on failure.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+#include "rfmodel.h"
+#include "hostutil.h"
+
+// ---------------- Platform ----------------
+static bool verbose;
+
+bool plat_cdc_connected(void) { return verbose; }
+void plat_cdc_write(const char *s) { printf("    %s", s); }
+
+static uint32_t rng = 0x2545F491u;
+static float frand(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (float)(rng >> 8) * (1.0f / 16777216.0f);
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static const float Fs = (float)WAV_SAMPLE_RATE;
+#define LIMIT       0.9f
+
+static void lim_setup(limiter_t *l, float la_ms) {
+    audio_cfg_t c = AUDIO_CFG_DEFAULTS;
+    c.comp_lookahead_ms = la_ms;
+    cfg_sanitize(&c, Fs);
+    memset(l, 0, sizeof(*l));
+    limiter_reconfig(l, Fs, &c);
+}
+
+// Bursts with instant steps: quiet talk, then peaks up to 4x the limit
+static float burst_sample(uint32_t i) {
+    static float lvl, ph;
+    if (i % 97u == 0) lvl = frand() < 0.3f ? 4.0f * frand() : 0.3f * frand();
+    ph += 2.0f * (float)M_PI * (300.0f + 2000.0f * frand() * 0.01f) / Fs;
+    if (ph > (float)M_PI) ph -= 2.0f * (float)M_PI;
+    return lvl * sinf(ph);
+}
+
+// ---------------- Brute-force model ----------------
+#define REF_HIST    4096u
+
+typedef struct {
+    float    in[REF_HIST], gt[REF_HIST], b1[REF_HIST];
+    uint32_t i;
+    float    g;
+} ref_t;
+
+static float ref_step(ref_t *r, const limiter_t *l, float x, float limit) {
+    const uint32_t la = l->la, n1 = l->n1, n2 = l->n2, i = r->i++;
+    const uint32_t M = REF_HIST - 1u;
+    r->in[i & M] = x;
+    float pk = 0.0f;
+    for (uint32_t k = 0; k <= la && k <= i; k++) pk = fmaxf(pk, fabsf(r->in[(i - k) & M]));
+    r->gt[i & M] = pk > limit ? limit / pk : 1.0f;
+    double s = 0.0;
+    for (uint32_t k = 0; k <= n1; k++) s += k <= i ? r->gt[(i - k) & M] : 1.0f;
+    r->b1[i & M] = (float)(s / (double)(n1 + 1u));
+    s = 0.0;
+    for (uint32_t k = 0; k <= n2; k++) s += k <= i ? r->b1[(i - k) & M] : 1.0f;
+    float g = (float)(s / (double)(n2 + 1u));
+    const float rel = r->g + (1.0f - r->g) * l->k_rel;
+    if (g > rel) g = rel;
+    r->g = g;
+    float y = (i >= la ? r->in[(i - la) & M] : 0.0f) * g;
+    if (y > limit) y = limit;
+    if (y < -limit) y = -limit;
+    return y;
+}
+
+static void test_model(void) {
+    static const float la_ms[] = { 0.0f, 0.125f, 1.0f, 4.0f, 7.875f };
+    for (size_t m = 0; m < sizeof(la_ms) / sizeof(la_ms[0]); m++) {
+        static limiter_t l;
+        static ref_t r;
+        lim_setup(&l, la_ms[m]);
+        memset(&r, 0, sizeof(r));
+        r.g = 1.0f;
+
+        float err = 0.0f, over = 0.0f;
+        float x[BLOCK_SAMPLES];
+        for (uint32_t b = 0; b < 400u; b++) {
+            float want[BLOCK_SAMPLES];
+            for (uint32_t k = 0; k < BLOCK_SAMPLES; k++) {
+                x[k] = burst_sample(b * BLOCK_SAMPLES + k);
+                want[k] = l.la ? ref_step(&r, &l, x[k], LIMIT)
+                               : fmaxf(-LIMIT, fminf(LIMIT, x[k]));
+            }
+            limiter_block(&l, x, BLOCK_SAMPLES, LIMIT);
+            for (uint32_t k = 0; k < BLOCK_SAMPLES; k++) {
+                err  = fmaxf(err, fabsf(x[k] - want[k]));
+                over = fmaxf(over, fabsf(x[k]) - LIMIT);
+            }
+        }
+        if (verbose) printf("  la %2lu: max |out - model| %.2e\n", (unsigned long)l.la, (double)err);
+        char what[96];
+        snprintf(what, sizeof(what), "la %lu samples: matches the brute-force model", (unsigned long)l.la);
+        check(err < 1e-5f, what);
+        snprintf(what, sizeof(what), "la %lu samples: |out| <= limit", (unsigned long)l.la);
+        check(over <= 0.0f, what);
+
+        // Quiet signal: untouched, la samples late
+        lim_setup(&l, la_ms[m]);
+        float in[4u * BLOCK_SAMPLES], out[4u * BLOCK_SAMPLES];
+        for (uint32_t k = 0; k < 4u * BLOCK_SAMPLES; k++) in[k] = out[k] = 0.8f * LIMIT * sinf(0.37f * (float)k);
+        for (uint32_t b = 0; b < 4u; b++) limiter_block(&l, out + b * BLOCK_SAMPLES, BLOCK_SAMPLES, LIMIT);
+        err = 0.0f;
+        for (uint32_t k = l.la; k < 4u * BLOCK_SAMPLES; k++) err = fmaxf(err, fabsf(out[k] - in[k - l.la]));
+        snprintf(what, sizeof(what), "la %lu samples: below the limit passes unchanged, delayed by la", (unsigned long)l.la);
+        check(err < 1e-6f, what);
+    }
+}
+
+// ---------------- Splatter ----------------
+// Energy above 3 kHz (8th-order Butterworth highpass) over total energy, dB
+static float hf_share_db(const float *y, uint32_t n) {
+    biquad_t hp[4];
+    for (int k = 0; k < 4; k++) biquad_init_highpass_bw2(&hp[k], 3000.0f, Fs);
+    double e = 0.0, h = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+        float v = y[i];
+        for (int k = 0; k < 4; k++) v = biquad_process(&hp[k], v);
+        e += (double)y[i] * y[i];
+        h += (double)v * v;
+    }
+    return (float)(10.0 * log10(h / e + 1e-30));
+}
+
+static void test_audio(void) {
+    // 700 Hz bursts stepping from 0.1 to 3x the limit every 60 ms
+    const uint32_t n = 64u * BLOCK_SAMPLES;
+    static float clip[64u * BLOCK_SAMPLES], la[64u * BLOCK_SAMPLES];
+    for (uint32_t i = 0; i < n; i++) {
+        const float lvl = (i / 480u) % 2u ? 3.0f * LIMIT : 0.1f;
+        clip[i] = la[i] = lvl * sinf(2.0f * (float)M_PI * 700.0f * (float)i / Fs);
+    }
+    static limiter_t l0, l1;
+    lim_setup(&l0, 0.0f);
+    lim_setup(&l1, COMP_LOOKAHEAD_MS);
+    for (uint32_t b = 0; b < n / BLOCK_SAMPLES; b++) {
+        limiter_block(&l0, clip + b * BLOCK_SAMPLES, BLOCK_SAMPLES, LIMIT);
+        limiter_block(&l1, la + b * BLOCK_SAMPLES, BLOCK_SAMPLES, LIMIT);
+    }
+    const float d0 = hf_share_db(clip, n), d1 = hf_share_db(la, n);
+    printf("audio: 700 Hz bursts at 3x limit, power above 3 kHz: hard clip %6.1f dB, look-ahead %6.1f dB\n",
+           (double)d0, (double)d1);
+    check(d1 < d0 - 20.0f, "look-ahead puts at least 20 dB less above 3 kHz than the hard clip");
+}
+
+typedef struct {
+    float out_db;       // power more than 3 kHz from the carrier, dB rel. total
+    float mean_dbm;
+    float g_min;        // lowest limiter gain at a block end
+} air_t;
+
+// Syllables with a fast onset: the EQ lifts 1800 Hz and the compressor
+// (41 ms attack) lets the first tens of ms through above the limit
+static void run_chain(float la_ms, bool bp, uint32_t blocks, air_t *a) {
+    static txchain_t t;
+    static rf_acc_t rf;
+    audio_cfg_t c = AUDIO_CFG_DEFAULTS;
+    c.comp_lookahead_ms = la_ms;
+    c.enable_bandpass = bp;
+    txchain_ctx_init(&t, &c);
+    rf_reset(&rf);
+
+    tx_params_t p = {
+        .mode = TXM_USB, .tx_req = 1, .pwr_max_dbm = PWR_MAX_DBM,
+        .fm_dev_hz = 2500.0f, .base_steps = 0,
+    };
+    float audio[BLOCK_SAMPLES];
+    sample_cmd_t blk[BLOCK_SAMPLES];
+    uint32_t s = 0;
+    a->g_min = 1.0f;
+    for (uint32_t b = 0; b < blocks; b++) {
+        for (uint32_t k = 0; k < BLOCK_SAMPLES; k++, s++) {
+            const uint32_t pos = s % 2400u;             // 200 ms on, 100 ms off
+            const float env = pos < 1600u ? 1.0f : 0.0f;
+            const float t_s = (float)s / Fs;
+            audio[k] = env * 0.9f * (0.5f * sinf(2.0f * (float)M_PI * 600.0f * t_s) +
+                                     0.5f * sinf(2.0f * (float)M_PI * 1800.0f * t_s));
+        }
+        txchain_ctx_block(&t, &p, audio, blk);
+        if (t.lim.g < a->g_min) a->g_min = t.lim.g;
+        rf_push(&rf, blk, BLOCK_SAMPLES, 0);
+    }
+    const double all = rf_band(&rf, -RF_FS * 0.5f, RF_FS * 0.5f);
+    const double in = rf_band(&rf, -3000.0f, 3000.0f);
+    a->out_db = (float)(10.0 * log10((all - in) / all + 1e-30));
+    a->mean_dbm = rf_mean_dbm(&rf);
+}
+
+static void test_chain(float seconds) {
+    const uint32_t blocks = (uint32_t)(seconds * Fs / (float)BLOCK_SAMPLES);
+    for (int bp = 0; bp <= 1; bp++) {
+        air_t a0, a1;
+        run_chain(0.0f, bp, blocks, &a0);
+        run_chain(COMP_LOOKAHEAD_MS, bp, blocks, &a1);
+        printf("chain: bandpass %-3s  outside +-3 kHz: hard clip %6.1f dB, look-ahead %6.1f dB  "
+               "mean %5.1f / %5.1f dBm  limiter gain >= %.2f\n", bp ? "on" : "off",
+               (double)a0.out_db, (double)a1.out_db, (double)a0.mean_dbm, (double)a1.mean_dbm,
+               (double)a1.g_min);
+        char what[96];
+        snprintf(what, sizeof(what), "bandpass %s: the limiter engages", bp ? "on" : "off");
+        check(a1.g_min < 0.9f, what);
+        snprintf(what, sizeof(what), "bandpass %s: no more power outside the channel", bp ? "on" : "off");
+        check(a1.out_db <= a0.out_db + 0.5f, what);
+        snprintf(what, sizeof(what), "bandpass %s: mean power within 1 dB", bp ? "on" : "off");
+        check(fabsf(a1.mean_dbm - a0.mean_dbm) < 1.0f, what);
+    }
+}
+
+// ---------------- Silence reset ----------------
+// The modulator state is reset on silence where the silent sample leaves
+// the limiter.  fine_tune_phase restarts from 0 there and then counts
+// samples, so the block end shows where the reset fell.
+static uint32_t silence_reset_at(float la_ms, uint32_t lead) {
+    static txchain_t t;
+    audio_cfg_t c = AUDIO_CFG_DEFAULTS;
+    c.comp_lookahead_ms = la_ms;
+    txchain_ctx_init(&t, &c);
+
+    tx_params_t p = {
+        .mode = TXM_USB, .tx_req = 1, .pwr_max_dbm = PWR_MAX_DBM,
+        .fm_dev_hz = 2500.0f, .base_steps = 0, .fine_hz = 1.0f,
+    };
+    const uint32_t step = (uint32_t)(int32_t)(1.0f * 4294967296.0f / Fs);
+    float audio[BLOCK_SAMPLES];
+    sample_cmd_t blk[BLOCK_SAMPLES];
+    uint32_t s = 0;
+    for (uint32_t b = 0; b < 100u; b++) {
+        for (uint32_t k = 0; k < BLOCK_SAMPLES; k++, s++)
+            audio[k] = s < lead ? 0.3f * sinf(2.0f * (float)M_PI * 700.0f * (float)s / Fs) + 0.3f : 0.0f;
+        txchain_ctx_block(&t, &p, audio, blk);
+    }
+    return s - t.fine_tune_phase / step;
+}
+
+static void test_silence(void) {
+    static limiter_t l;
+    lim_setup(&l, COMP_LOOKAHEAD_MS);
+    bool ok = true;
+    uint32_t carried = 0;
+    for (uint32_t lead = 1; lead < BLOCK_SAMPLES; lead += 7u) {
+        const uint32_t r0 = silence_reset_at(0.0f, lead);
+        const uint32_t r1 = silence_reset_at(COMP_LOOKAHEAD_MS, lead);
+        if (verbose) printf("  silence after %3lu: reset at %lu (la 0), %lu (la %lu)\n", (unsigned long)lead,
+                            (unsigned long)r0, (unsigned long)r1, (unsigned long)l.la);
+        if (r0 <= lead || r1 != r0 + l.la) ok = false;
+        if (r0 % BLOCK_SAMPLES + l.la >= BLOCK_SAMPLES) carried++;
+    }
+    printf("silence reset: look-ahead %lu samples, %lu of the delayed resets in the next block\n",
+           (unsigned long)l.la, (unsigned long)carried);
+    check(ok, "silence reset follows the limiter delay");
+    check(carried > 0, "a delayed reset carried into the next block");
+}
+
+// ---------------- Cost ----------------
+static void test_cost(void) {
+    static const float la_ms[] = { 0.0f, 1.0f, 4.0f, 7.875f };
+    const uint32_t blocks = 4000u;
+    static float buf[BLOCK_SAMPLES];
+    double ns[2][4];
+    for (int kind = 0; kind < 2; kind++) {
+        for (size_t m = 0; m < 4; m++) {
+            static limiter_t l;
+            lim_setup(&l, la_ms[m]);
+            double best = 1e9;
+            for (int rep = 0; rep < 3; rep++) {
+                const double t0 = now_s();
+                for (uint32_t b = 0; b < blocks; b++) {
+                    // random, or a falling ramp: every sample stays in the deque
+                    for (uint32_t k = 0; k < BLOCK_SAMPLES; k++)
+                        buf[k] = kind ? 2.0f - (float)((b * BLOCK_SAMPLES + k) % 64u) * 0.01f
+                                      : 2.0f * frand() - 1.0f;
+                    limiter_block(&l, buf, BLOCK_SAMPLES, LIMIT);
+                }
+                const double dt = (now_s() - t0) * 1e9 / ((double)blocks * BLOCK_SAMPLES);
+                if (dt < best) best = dt;
+            }
+            ns[kind][m] = best;
+        }
+        printf("cost: %-12s ns/sample  clip %5.1f  la 8 %5.1f  la 32 %5.1f  la 63 %5.1f  (incl. input)\n",
+               kind ? "falling ramp" : "random", ns[kind][0], ns[kind][1], ns[kind][2], ns[kind][3]);
+        char what[80];
+        snprintf(what, sizeof(what), "%s: la 63 costs under 1.5x la 8 (O(1) per sample)",
+                 kind ? "falling ramp" : "random");
+        check(ns[kind][3] < 1.5 * ns[kind][1] + 2.0, what);
+    }
+}
+
+int main(int argc, char **argv) {
+    float seconds = 10.0f;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-v")) verbose = check_verbose = true;
+        else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) seconds = strtof(argv[++i], NULL);
+        else { fprintf(stderr, "usage: limcheck [-v] [--seconds S]\n"); return 2; }
+    }
+
+    test_model();
+    test_audio();
+    test_chain(seconds);
+    test_silence();
+    test_cost();
+
+    return check_result();
+}
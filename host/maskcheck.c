@@ -0,0 +1,228 @@
+// maskcheck.c - spectral mask guard (specmask.c) through the real SSB chain
+//
+//   maskcheck [--seconds S] [-v]
+//
+// The estimator first sees pure command streams: a carrier held at +5
+// PLL steps must read far inside the mask, one at -10 steps far outside.
+// Then syllable-shaped two-tone "speech" with some 3.6 kHz sibilance goes
+// through txchain_fill_block() with the guard polled from the queue wait
+// like the firmware main loop, and its out-of-band figure is compared with
+// the RF model (host/rfmodel.c) over its whole 64 kHz span.  With the
+// default settings it must not trip.  With the bandpass off and the high
+// shelf at +20 dB it must report only when off, and when on switch the
+// bandpass back on and end inside the mask.  Under a limit below the
+// modulator's own floor it must back amp_gain off by the cap and then
+// stop.  With the RF ALC on as well, starting quiet so the ALC wants to
+// rise, its gain must stay at or below where it was at the first trip
+// and the envelope gain end the full cap below that.
+// Also reports the work per poll call.  Exits non-zero on failure.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+#include "specmask.h"
+#include "alc.h"
+#include "rfmodel.h"
+#include "hostutil.h"
+
+// ---------------- Platform ----------------
+static bool verbose;
+
+bool plat_cdc_connected(void) { return true; }
+void plat_cdc_write(const char *s) {
+    if (verbose || !strncmp(s, "!E", 2)) printf("    %s", s);
+}
+
+// Syllables: 180 ms on, 70 ms off, raised-cosine shaped two-tone + sibilance
+static uint32_t t_samp;
+static float ph1, ph2, ph3;
+
+float plat_audio_sample(uint32_t n, const audio_cfg_t *cfg) {
+    (void)n; (void)cfg;
+    const float fs = (float)WAV_SAMPLE_RATE;
+    uint32_t pos = t_samp++ % 2000u;
+    if (pos >= 1440u) return 0.0f;
+    float env = 0.5f * (1.0f - cosf(2.0f * (float)M_PI * (float)pos / 1440.0f));
+    ph1 += 2.0f * (float)M_PI * 700.0f / fs;
+    ph2 += 2.0f * (float)M_PI * 1900.0f / fs;
+    if (ph1 > (float)M_PI) ph1 -= 2.0f * (float)M_PI;
+    ph3 += 2.0f * (float)M_PI * 3600.0f / fs;
+    if (ph2 > (float)M_PI) ph2 -= 2.0f * (float)M_PI;
+    if (ph3 > (float)M_PI) ph3 -= 2.0f * (float)M_PI;
+    return 0.3f * env * (sinf(ph1) + sinf(ph2) + 0.5f * sinf(ph3));
+}
+
+// Poll until the guard is idle again, like the queue wait would
+static uint32_t polls, poll_max_us;
+
+static void drain(void) {
+    for (uint32_t k = 0; k < 16u; k++) {
+        const uint64_t t0 = plat_us();
+        specmask_poll();
+        const uint32_t dt = (uint32_t)(plat_us() - t0);
+        if (dt > poll_max_us) poll_max_us = dt;
+        polls++;
+    }
+}
+
+// ---------------- Estimator on plain command streams ----------------
+static float carrier_oob(int32_t steps) {
+    specmask_reset();
+    sample_cmd_t blk[BLOCK_SAMPLES];
+    for (uint32_t i = 0; i < BLOCK_SAMPLES; i++)
+        blk[i] = (sample_cmd_t){ .freq_steps = 1000 + steps, .p_dbm = PWR_MAX_DBM, .tx_on = 1 };
+    for (uint32_t b = 0; b < SM_DECIM * SM_AVG; b++) {
+        specmask_capture(blk, 1000, TXM_USB);
+        drain();
+    }
+    specmask_stats_t st;
+    specmask_stats(&st);
+    return st.decisions ? st.oob_db : 99.0f;
+}
+
+static void test_carrier(void) {
+    specmask_enable(false);
+    const float in = carrier_oob(5), out = carrier_oob(-10);
+    printf("carrier: +5 steps (%+.0f Hz) oob %.1f dBc, -10 steps (%+.0f Hz) oob %.1f dBc\n",
+           5.0 * PLL_STEP_HZ, (double)in, -10.0 * PLL_STEP_HZ, (double)out);
+    check(in < -40.0f, "carrier inside the mask reads below -40 dBc");
+    check(out > -0.5f, "carrier outside the mask reads as all out of band");
+}
+
+// ---------------- Through the chain ----------------
+typedef struct {
+    float    est_db;        // guard's last decision
+    float    model_db;      // RF model, outside the same band over 64 kHz
+    uint32_t trips;
+    uint32_t spectra;
+    float    backoff;
+    uint8_t  bp;
+    float    amp_gain;
+    float    alc_trip_db;   // RF ALC gain at the first trip
+} run_t;
+
+static void run(const audio_cfg_t *c, bool on, float seconds, run_t *r) {
+    static rf_acc_t rf;
+    static sample_cmd_t blk[BLOCK_SAMPLES];
+    cfg_commit(c);
+    txchain_init();
+    specmask_enable(on);
+    specmask_reset();
+    rf_reset(&rf);
+
+    const uint32_t blocks = (uint32_t)(seconds * (float)WAV_SAMPLE_RATE / (float)BLOCK_SAMPLES);
+    uint32_t trips_seen = 0;
+    r->alc_trip_db = 0.0f;
+    for (uint32_t b = 0; b < blocks; b++) {
+        txchain_fill_block(blk);
+        drain();
+        // Model the spectrum the guard is judging, i.e. after its last action
+        specmask_stats_t st;
+        specmask_stats(&st);
+        if (st.trips != trips_seen) {
+            if (!trips_seen) {
+                alc_stats_t a;
+                alc_stats(&a);
+                r->alc_trip_db = a.gain_db;
+            }
+            trips_seen = st.trips;
+            rf_reset(&rf);
+        }
+        rf_push(&rf, blk, BLOCK_SAMPLES, (int32_t)get_base_steps());
+    }
+
+    specmask_stats_t st;
+    specmask_stats(&st);
+    const double in = rf_band(&rf, st.lo_hz, st.hi_hz);
+    audio_cfg_t now;
+    cfg_snapshot(&now);
+    r->est_db = st.oob_db;
+    r->model_db = (float)(10.0 * log10(1.0 - in + 1e-12));
+    r->trips = st.trips;
+    r->spectra = st.spectra;
+    r->backoff = st.backoff_db;
+    r->bp = now.enable_bandpass;
+    r->amp_gain = now.amp_gain;
+}
+
+static void print_run(const char *what, const run_t *r) {
+    printf("%-9s oob %6.1f dBc (RF model %6.1f)  spectra %3lu  trips %2lu  bp %u  amp_gain %.3f  backoff %.0f dB\n",
+           what, (double)r->est_db, (double)r->model_db, (unsigned long)r->spectra,
+           (unsigned long)r->trips, (unsigned)r->bp, (double)r->amp_gain, (double)r->backoff);
+}
+
+int main(int argc, char **argv) {
+    float seconds = 30.0f;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-v")) verbose = check_verbose = true;
+        else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) seconds = strtof(argv[++i], NULL);
+        else { fprintf(stderr, "usage: maskcheck [--seconds S] [-v]\n"); return 2; }
+    }
+
+    g_tx_mode = TXM_USB;
+    g_tx_enabled = 1;
+    g_tx_power_max_dbm = PWR_MAX_DBM;
+
+    test_carrier();
+
+    const audio_cfg_t def = AUDIO_CFG_DEFAULTS;
+    run_t r;
+    run(&def, true, seconds, &r);
+    print_run("default", &r);
+    check(r.trips == 0, "default settings stay inside the mask");
+    check(r.spectra > 0, "spectra analysed while keyed");
+    check(fabsf(r.est_db - r.model_db) < 3.0f, "estimate within 3 dB of the RF model");
+
+    audio_cfg_t bad = def;
+    bad.enable_bandpass = 0;
+    bad.eq_high_db = 20.0f;
+    run(&bad, false, seconds, &r);
+    print_run("bp off", &r);
+    check(r.trips > 0 && r.bp == 0 && r.backoff == 0.0f, "guard off: reports, changes nothing");
+    check(fabsf(r.est_db - r.model_db) < 3.0f, "estimate within 3 dB of the RF model");
+
+    run(&bad, true, seconds, &r);
+    print_run("bp off/on", &r);
+    check(r.bp == 1, "guard on: bandpass forced back on");
+    check(r.est_db <= SM_LIM_DB, "guard on: ends inside the mask");
+    check(r.model_db <= SM_LIM_DB, "guard on: RF model agrees");
+
+    specmask_set_limit(-30.0f);
+    run(&def, true, seconds, &r);
+    print_run("lim -30", &r);
+    check(r.backoff == SM_MAX_BACKOFF_DB, "unreachable limit: amp_gain backed off by the cap");
+    check(fabsf(r.amp_gain - def.amp_gain * powf(10.0f, -SM_MAX_BACKOFF_DB / 20.0f)) < 1e-3f,
+          "unreachable limit: and no further");
+
+    // Start quiet so the ALC wants to rise: it has to stop at the ceiling
+    audio_cfg_t quiet = def;
+    quiet.amp_gain = def.amp_gain * 0.25f;
+    alc_reset();
+    alc_enable(true);
+    run(&quiet, true, seconds, &r);
+    alc_stats_t a;
+    alc_stats(&a);
+    const float total_db = 20.0f * log10f(r.amp_gain / quiet.amp_gain) + a.gain_db;
+    print_run("lim+alc", &r);
+    printf("          ALC gain %+.1f dB at the first trip, %+.1f dB at the end: envelope gain %+.1f dB from the start\n",
+           (double)r.alc_trip_db, (double)a.gain_db, (double)total_db);
+    check(r.backoff == SM_MAX_BACKOFF_DB, "ALC on: amp_gain backed off by the cap");
+    check(a.gain_db <= r.alc_trip_db + 0.01f, "ALC on: the ALC does not rise past its gain at the first trip");
+    check(total_db <= r.alc_trip_db - SM_MAX_BACKOFF_DB + 0.01f, "ALC on: the back-off holds");
+    alc_enable(false);
+    alc_reset();
+    specmask_set_limit(SM_LIM_DB);
+
+    printf("work: %lu polls, longest %lu us on this host; per spectrum 1 synth + %u FFT + 1 accumulate calls\n",
+           (unsigned long)polls, (unsigned long)poll_max_us,
+           (unsigned)((SM_LOG2 + SM_PASSES_PER_POLL - 1u) / SM_PASSES_PER_POLL));
+
+    return check_result();
+}
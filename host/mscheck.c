@@ -0,0 +1,210 @@
+// mscheck.c - USB MSC flash volume (mscdisk.c) on a RAM flash image
+//
+//   mscheck [-v]
+//
+// Checks that a blank image is formatted as a FAT12 volume of the
+// advertised size and kept on re-init, that writes before the first
+// poll do not go busy (TX is off at boot), that nothing is erased while TX
+// is active (writes go busy once every cache slot is dirty), that the
+// cache reaches flash after the idle time / a sync once TX drops, that a
+// clean cache needs no locked poll (the TX state still reaches the write
+// path through mscdisk_pending()), that repeated writes to one sector
+// cost one erase and identical rewrites none, and that every byte reads
+// back.  Exits non-zero on failure.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+#include "mscdisk.h"
+#include "hostutil.h"
+
+// ---------------- Platform ----------------
+static bool verbose;
+static uint32_t now_ms;             // simulated clock
+
+uint64_t plat_us(void) { return (uint64_t)now_ms * 1000u; }
+uint32_t plat_ms(void) { return now_ms; }
+
+bool plat_cdc_connected(void) { return verbose; }
+void plat_cdc_write(const char *s) { printf("    %s", s); }
+
+// ---------------- Flash model ----------------
+static uint8_t  flash[MSC_VOLUME_BYTES];
+static uint8_t  shadow[MSC_VOLUME_BYTES];   // what the host believes it wrote
+static uint32_t erases[MSC_SECTORS];
+static bool     tx_on;
+static uint32_t erases_in_tx;
+
+static bool program(uint32_t sector, const uint8_t *data, void *ctx) {
+    (void)ctx;
+    if (tx_on) erases_in_tx++;
+    erases[sector]++;
+    memcpy(&flash[sector * MSC_SECTOR_SIZE], data, MSC_SECTOR_SIZE);
+    return true;
+}
+
+static const msc_backend_t be = { flash, program, NULL };
+
+static uint32_t total_erases(void) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < MSC_SECTORS; i++) n += erases[i];
+    return n;
+}
+
+// Main loop for ms milliseconds, polled every 1 ms like Core0: the
+// locked poll only when mscdisk_pending() says so
+static uint32_t locked_polls;
+
+static void run(uint32_t ms) {
+    for (uint32_t t = 0; t < ms; t++) {
+        now_ms++;
+        if (!mscdisk_pending(tx_on)) continue;
+        locked_polls++;
+        mscdisk_poll(tx_on);
+    }
+}
+
+// Host write of whole blocks, retrying busy like TinyUSB does
+static uint32_t host_write(uint32_t lba, const uint8_t *data, uint32_t n_blocks, uint32_t max_ms) {
+    uint32_t done = 0, busy = 0;
+    const uint32_t bytes = n_blocks * MSC_BLOCK_SIZE;
+    while (done < bytes && busy < max_ms) {
+        const int32_t r = mscdisk_write(lba, done, data + done, bytes - done);
+        if (r < 0) break;
+        if (r == 0) { busy++; run(1); continue; }
+        done += (uint32_t)r;
+    }
+    memcpy(&shadow[lba * MSC_BLOCK_SIZE], data, done);
+    return done / MSC_BLOCK_SIZE;
+}
+
+static bool readback(void) {
+    static uint8_t buf[MSC_SECTOR_SIZE];
+    for (uint32_t s = 0; s < MSC_SECTORS; s++) {
+        mscdisk_read(s * MSC_BLOCKS_PER_SECTOR, 0, buf, MSC_SECTOR_SIZE);
+        if (memcmp(buf, &shadow[s * MSC_SECTOR_SIZE], MSC_SECTOR_SIZE)) return false;
+    }
+    return true;
+}
+
+static uint32_t rng = 0x9E3779B9u;
+static uint8_t rnd8(void) {
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    return (uint8_t)rng;
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-v")) verbose = check_verbose = true;
+        else { fprintf(stderr, "usage: mscheck [-v]\n"); return 2; }
+    }
+    msc_stats_t st;
+
+    // ---- Blank flash: format goes to the cache, reaches flash when idle ----
+    memset(flash, 0xFF, sizeof(flash));
+    mscdisk_init(&be);
+    mscdisk_stats(&st);
+    check(st.formatted && st.dirty == 2, "blank image formatted into two dirty sectors");
+    mscdisk_read(0, 0, shadow, 16u * MSC_BLOCK_SIZE);   // host view of the metadata
+    memcpy(&shadow[16u * MSC_BLOCK_SIZE], &flash[16u * MSC_BLOCK_SIZE], sizeof(flash) - 16u * MSC_BLOCK_SIZE);
+
+    tx_on = true;
+    run(5000);
+    check(total_erases() == 0, "no flush while TX is on");
+    tx_on = false;
+    run(10);
+    check(total_erases() == 2, "format flushed right after TX drops");
+
+    const uint8_t *b = flash;
+    const uint32_t total = (uint32_t)(b[19] | (b[20] << 8));
+    const uint32_t spc = b[13], res = (uint32_t)(b[14] | (b[15] << 8)), nfat = b[16];
+    const uint32_t root = (uint32_t)(b[17] | (b[18] << 8)), spf = (uint32_t)(b[22] | (b[23] << 8));
+    const uint32_t clusters = (total - res - nfat * spf - root * 32u / MSC_BLOCK_SIZE) / spc;
+    check(b[510] == 0x55 && b[511] == 0xAA && total == MSC_BLOCKS, "boot sector signature and size");
+    check(clusters < 4085u && !memcmp(b + 54, "FAT12", 5), "FAT12 cluster count");
+    if (verbose) printf("  %lu blocks, %lu clusters of %lu KB\n", (unsigned long)total,
+                        (unsigned long)clusters, (unsigned long)(spc * MSC_BLOCK_SIZE / 1024u));
+
+    mscdisk_init(&be);
+    mscdisk_stats(&st);
+    check(!st.formatted && st.dirty == 0, "formatted image kept on re-init");
+
+    // TX is off at boot: before the first poll a full cache makes room by
+    // flushing from the USB path rather than going busy
+    static uint8_t early[(MSC_CACHE_SECTORS + 2u) * MSC_SECTOR_SIZE];
+    for (uint32_t i = 0; i < sizeof(early); i++) early[i] = rnd8();
+    uint32_t early_n = 0;
+    while (early_n < sizeof(early)) {
+        const int32_t r = mscdisk_write(1024u, early_n, early + early_n, sizeof(early) - early_n);
+        if (r <= 0) break;
+        early_n += (uint32_t)r;
+    }
+    memcpy(&shadow[1024u * MSC_BLOCK_SIZE], early, early_n);
+    check(early_n == sizeof(early), "writes before the first poll never go busy");
+    run(MSC_FLUSH_IDLE_MS + 100u);
+
+    locked_polls = 0;
+    run(1000);
+    check(locked_polls == 0, "clean cache: no poll takes the lock");
+
+    // ---- Copy a 64 KB "voice clip" while transmitting ----
+    static uint8_t clip[64u * 1024u];
+    for (uint32_t i = 0; i < sizeof(clip); i++) clip[i] = rnd8();
+    const uint32_t e0 = total_erases();
+    tx_on = true;
+    run(10);
+    const uint32_t got = host_write(64u, clip, sizeof(clip) / MSC_BLOCK_SIZE, 3000u);
+    mscdisk_stats(&st);
+    check(erases_in_tx == 0, "no erase while TX is on");
+    check(got == MSC_CACHE_SECTORS * MSC_BLOCKS_PER_SECTOR && st.busy > 0,
+          "writes go busy once the cache is all dirty");
+    tx_on = false;
+    const uint32_t rest = host_write(64u + got, clip + got * MSC_BLOCK_SIZE,
+                                     (uint32_t)(sizeof(clip) / MSC_BLOCK_SIZE) - got, 3000u);
+    check(got + rest == sizeof(clip) / MSC_BLOCK_SIZE, "rest of the copy after TX");
+    run(MSC_FLUSH_IDLE_MS + 100u);
+    mscdisk_stats(&st);
+    check(st.dirty == 0, "cache clean after the idle time");
+    check(total_erases() - e0 == sizeof(clip) / MSC_SECTOR_SIZE, "one erase per touched sector");
+    check(readback(), "read back matches (cached and flushed)");
+
+    // ---- Coalescing: FAT rewritten per cluster, then an identical rewrite ----
+    static uint8_t blk[MSC_BLOCK_SIZE];
+    const uint32_t e1 = total_erases();
+    for (uint32_t k = 0; k < 200; k++) {
+        memset(blk, (int)k, sizeof(blk));
+        host_write(6u, blk, 1, 10);
+        run(5);
+    }
+    run(MSC_FLUSH_IDLE_MS + 100u);
+    check(total_erases() - e1 == 1, "200 FAT updates cost one erase");
+    const uint32_t e2 = total_erases();
+    host_write(6u, blk, 1, 10);
+    run(MSC_FLUSH_IDLE_MS + 100u);
+    mscdisk_stats(&st);
+    check(total_erases() == e2 && st.skipped > 0, "identical rewrite skipped");
+
+    // ---- Sync: flush without waiting for the idle time ----
+    memset(blk, 0x5A, sizeof(blk));
+    host_write(200u, blk, 1, 10);
+    const uint32_t e3 = total_erases();
+    mscdisk_sync();
+    run(2);
+    check(total_erases() == e3 + 1, "sync flushes at once");
+    check(readback(), "final read back");
+    check(mscdisk_read(MSC_BLOCKS, 0, blk, MSC_BLOCK_SIZE) < 0, "read past the end refused");
+
+    mscdisk_print("final");
+    if (verbose) {
+        uint32_t worst = 0;
+        for (uint32_t i = 0; i < MSC_SECTORS; i++) if (erases[i] > worst) worst = erases[i];
+        printf("  erases %lu total, worst sector %lu\n", (unsigned long)total_erases(), (unsigned long)worst);
+    }
+    return check_result();
+}
@@ -0,0 +1,40 @@
+// platstub.c - default plat_* hooks for the host tools
+//
+// Linked into every tool through sxfw.  All definitions are weak: a tool
+// defines only the hooks it gives behaviour to (a simulated clock, CDC
+// output it checks, an audio source) and gets these for the rest.  The
+// defaults run on the host's monotonic clock, print nothing, feed silence
+// and ignore everything the device would do in hardware.  sxsim has its
+// own full set.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "platform.h"
+#include "txchain.h"
+
+#define PLAT_WEAK __attribute__((weak))
+
+PLAT_WEAK uint64_t plat_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)(ts.tv_nsec / 1000);
+}
+PLAT_WEAK uint32_t plat_ms(void) { return (uint32_t)(plat_us() / 1000u); }
+
+PLAT_WEAK bool plat_cdc_connected(void) { return false; }
+PLAT_WEAK void plat_cdc_write(const char *s) { (void)s; }
+PLAT_WEAK void plat_mic_start(void) { }
+PLAT_WEAK void plat_mic_stop(void) { }
+PLAT_WEAK void plat_tune_apply(void) { }
+PLAT_WEAK void plat_radio_diag(void) { }
+PLAT_WEAK void plat_disc_select(uint8_t src) { (void)src; }
+PLAT_WEAK void plat_usb_rs_print(void) { }
+PLAT_WEAK void plat_bench_spi(void) { }
+PLAT_WEAK void plat_irq_print(bool reset) { (void)reset; }
+
+PLAT_WEAK float plat_audio_sample(uint32_t n, const audio_cfg_t *cfg) {
+    (void)n; (void)cfg;
+    return 0.0f;
+}
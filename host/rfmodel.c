@@ -0,0 +1,141 @@
+// rfmodel.c - RF spectrum of a sample-command stream, as Core1 would key it
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "rfmodel.h"
+#include "control.h"
+
+void rf_reset(rf_acc_t *a) {
+    memset(a, 0, sizeof(*a));
+    for (uint32_t k = 0; k < RF_NFFT; k++)
+        a->win[k] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * (float)k / (float)RF_NFFT);
+    for (uint32_t k = 0; k < RF_NFFT / 2; k++) {
+        a->tw_re[k] = cosf(2.0f * (float)M_PI * (float)k / (float)RF_NFFT);
+        a->tw_im[k] = -sinf(2.0f * (float)M_PI * (float)k / (float)RF_NFFT);
+    }
+}
+
+// In-place radix-2 DIT FFT of length RF_NFFT
+static void fft(const rf_acc_t *a, float *re, float *im) {
+    for (uint32_t i = 1, j = 0; i < RF_NFFT; i++) {
+        uint32_t bit = RF_NFFT >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j |= bit;
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    for (uint32_t len = 2; len <= RF_NFFT; len <<= 1) {
+        const uint32_t half = len >> 1, stride = RF_NFFT / len;
+        for (uint32_t i = 0; i < RF_NFFT; i += len) {
+            for (uint32_t k = 0; k < half; k++) {
+                const float wr = a->tw_re[k * stride], wi = a->tw_im[k * stride];
+                const uint32_t p = i + k, q = p + half;
+                const float xr = re[q] * wr - im[q] * wi;
+                const float xi = re[q] * wi + im[q] * wr;
+                re[q] = re[p] - xr; im[q] = im[p] - xi;
+                re[p] += xr;        im[p] += xi;
+            }
+        }
+    }
+}
+
+// Welch frame over the buffer, then keep the newer half (50 % overlap)
+static void frame(rf_acc_t *a) {
+    float re[RF_NFFT], im[RF_NFFT];
+    for (uint32_t k = 0; k < RF_NFFT; k++) {
+        re[k] = a->re[k] * a->win[k];
+        im[k] = a->im[k] * a->win[k];
+    }
+    fft(a, re, im);
+    for (uint32_t k = 0; k < RF_NFFT; k++)
+        a->psd[k] += (double)re[k] * re[k] + (double)im[k] * im[k];
+    a->frames++;
+
+    memmove(a->re, a->re + RF_NFFT / 2, sizeof(float) * (RF_NFFT / 2));
+    memmove(a->im, a->im + RF_NFFT / 2, sizeof(float) * (RF_NFFT / 2));
+    a->fill = RF_NFFT / 2;
+}
+
+#if RF_OS % DITHER_SUBSTEPS
+#error "RF_OS must be a multiple of DITHER_SUBSTEPS"
+#endif
+
+void rf_push(rf_acc_t *a, const sample_cmd_t *c, uint32_t n, int32_t base_steps) {
+    for (uint32_t i = 0; i < n; i++) {
+        const float  mw = c[i].tx_on ? powf(10.0f, (float)c[i].p_dbm / 10.0f) : 0.0f;
+        const float  amp = sqrtf(mw);
+        double dph = 0.0;
+
+        a->sum_mw += mw;
+        a->n_samp++;
+
+        for (uint32_t k = 0; k < RF_OS; k++) {
+            if (k % (RF_OS / DITHER_SUBSTEPS) == 0u) {
+                const int32_t steps = sample_cmd_dither(&c[i], &a->f_acc) - base_steps;
+                dph = (double)steps * (double)PLL_STEP_HZ / (double)RF_FS;
+            }
+            a->phase += dph;
+            a->phase -= floor(a->phase);
+            const float ph = 2.0f * (float)M_PI * (float)a->phase;
+            a->re[a->fill] = amp * cosf(ph);
+            a->im[a->fill] = amp * sinf(ph);
+            if (++a->fill == RF_NFFT) frame(a);
+        }
+    }
+}
+
+float rf_mean_dbm(const rf_acc_t *a) {
+    if (!a->n_samp || a->sum_mw <= 0.0) return -99.0f;
+    return 10.0f * log10f((float)(a->sum_mw / (double)a->n_samp));
+}
+
+static float bin_hz(uint32_t k) {
+    return (k < RF_NFFT / 2) ? (float)k * RF_BIN_HZ : ((float)k - (float)RF_NFFT) * RF_BIN_HZ;
+}
+
+static double total(const rf_acc_t *a) {
+    double s = 0.0;
+    for (uint32_t k = 0; k < RF_NFFT; k++) s += a->psd[k];
+    return s;
+}
+
+double rf_band(const rf_acc_t *a, float lo_hz, float hi_hz) {
+    const double tot = total(a);
+    if (tot <= 0.0) return 0.0;
+    double s = 0.0;
+    for (uint32_t k = 0; k < RF_NFFT; k++) {
+        const float f = bin_hz(k);
+        if (f >= lo_hz && f <= hi_hz) s += a->psd[k];
+    }
+    return s / tot;
+}
+
+float rf_obw(const rf_acc_t *a, float frac, float *lo_hz, float *hi_hz) {
+    const double tot = total(a);
+    const double tail = tot * (1.0 - (double)frac) * 0.5;
+    float lo = 0.0f, hi = 0.0f;
+
+    if (tot > 0.0) {
+        // Walk from the negative edge up, then from the positive edge down
+        double s = 0.0;
+        for (uint32_t i = 0; i < RF_NFFT; i++) {
+            const uint32_t k = (i + RF_NFFT / 2) % RF_NFFT;
+            s += a->psd[k];
+            if (s > tail) { lo = bin_hz(k); break; }
+        }
+        s = 0.0;
+        for (uint32_t i = 0; i < RF_NFFT; i++) {
+            const uint32_t k = (RF_NFFT / 2 - 1u - i + RF_NFFT) % RF_NFFT;
+            s += a->psd[k];
+            if (s > tail) { hi = bin_hz(k); break; }
+        }
+    }
+    if (lo_hz) *lo_hz = lo;
+    if (hi_hz) *hi_hz = hi;
+    return hi - lo;
+}
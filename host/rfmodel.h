@@ -0,0 +1,52 @@
+// rfmodel.h - RF spectrum of a sample-command stream, as Core1 would key it
+//
+// Each command holds one power code for a sample period (125 us) and
+// DITHER_SUBSTEPS PLL steps dithered from its Q8 frequency exactly as
+// Core1 does (sample_cmd_dither()); the carrier phase is continuous.
+// The model rebuilds that complex envelope RF_OS times oversampled
+// around the carrier and averages a Hann-windowed Welch PSD, from which
+// the offline tools take occupied bandwidth, band powers, opposite
+// sideband and intermodulation.  One rf_acc_t per thread.
+
+#ifndef RFMODEL_H
+#define RFMODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "txchain.h"
+
+#define RF_OS       8u                      // oversampling: 64 kHz span
+#define RF_NFFT     4096u                   // 15.6 Hz bins
+#define RF_FS       ((float)WAV_SAMPLE_RATE * (float)RF_OS)
+#define RF_BIN_HZ   (RF_FS / (float)RF_NFFT)
+
+typedef struct {
+    float    win[RF_NFFT];                  // Hann window
+    float    tw_re[RF_NFFT / 2], tw_im[RF_NFFT / 2];
+    float    re[RF_NFFT], im[RF_NFFT];      // last RF_NFFT envelope samples
+    uint32_t fill;                          // valid samples in re/im
+    double   phase;                         // carrier phase, turns
+    uint32_t f_acc;                         // Core1 frequency sigma-delta
+    double   psd[RF_NFFT];                  // summed |X|^2, bin 0 = carrier
+    uint32_t frames;
+    double   sum_mw;                        // mean power bookkeeping
+    uint64_t n_samp;
+} rf_acc_t;
+
+void  rf_reset(rf_acc_t *a);             // also builds the window / twiddles
+
+// Append commands; freq_steps are taken relative to base_steps.
+void  rf_push(rf_acc_t *a, const sample_cmd_t *c, uint32_t n, int32_t base_steps);
+
+// Mean output power over everything pushed, dBm (TX off counts as zero)
+float rf_mean_dbm(const rf_acc_t *a);
+
+// Share of the spectral power in [lo_hz, hi_hz] relative to the carrier
+double rf_band(const rf_acc_t *a, float lo_hz, float hi_hz);
+
+// Bandwidth holding `frac` of the power, with (1 - frac) / 2 outside on
+// each side (frac 0.99 = ITU occupied bandwidth); optional edges in Hz.
+float rf_obw(const rf_acc_t *a, float frac, float *lo_hz, float *hi_hz);
+
+#endif // RFMODEL_H
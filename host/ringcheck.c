@@ -0,0 +1,287 @@
+// ringcheck.c - SPSC ring (spscring.h): unit tests and cross-thread throughput
+//
+//   ringcheck [-v] [-n ELEMENTS]
+//
+// Single-threaded: full / empty edges, drop and high-water counts, spans
+// stopping at the end of the storage, copies across the wrap, indices
+// running over 2^32, and a million random operations (push, pop, bulk
+// write / read, partial commit / release, flush) against a plain FIFO.
+// Then a producer and a consumer thread move a sequence through the
+// ring one element at a time, in 64-element copies and in place through
+// reserve / peek, next to the old hand-copied volatile ring; every
+// element must arrive once and in order.  Prints Melem/s per mode.
+// Exits non-zero on failure.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "platform.h"
+#include "spscring.h"
+#include "hostutil.h"
+
+static bool verbose;
+static uint32_t rng = 0x9E3779B9u;
+static uint32_t rnd(uint32_t n) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng % n;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// ---------------- Single-threaded ----------------
+SPSC_DEFINE(r16, uint32_t, 16u)
+
+static void test_edges(void) {
+    static r16_t rb;
+    uint32_t v, *p;
+
+    check(!r16_pop(&rb, &v) && r16_fill(&rb) == 0, "zeroed ring is empty");
+    bool ok = true;
+    for (uint32_t i = 0; i < 16u; i++) ok &= r16_push(&rb, i);
+    check(ok && r16_fill(&rb) == 16u, "all 16 slots usable");
+    check(!r16_push(&rb, 99u) && rb.q.drops == 1u, "push into a full ring drops and counts");
+    check(rb.q.hw == 16u, "high-water at capacity");
+    check(r16_reserve(&rb, 4u, &p) == 0, "no room reserved when full");
+    ok = true;
+    for (uint32_t i = 0; i < 16u; i++) ok &= r16_pop(&rb, &v) && v == i;
+    check(ok && !r16_pop(&rb, &v), "pop in order, then empty");
+
+    // w = r = 16 -> slot 0; move to slot 11 and look at the spans
+    r16_init(&rb);
+    for (uint32_t i = 0; i < 11u; i++) { r16_push(&rb, i); r16_pop(&rb, &v); }
+    check(r16_reserve(&rb, 100u, &p) == 5u && p == &rb.buf[11], "reserve stops at the end of the storage");
+    uint32_t src[20], dst[20];
+    for (uint32_t i = 0; i < 20u; i++) src[i] = 100u + i;
+    check(r16_write(&rb, src, 20u) == 16u && rb.q.drops == 4u, "write fills both spans, drops the rest");
+    check(r16_peek(&rb, 100u, &p) == 5u && *p == 100u, "peek stops at the end of the storage");
+    r16_release(&rb, 2u);
+    check(r16_read(&rb, dst, 20u) == 14u && dst[0] == 102u && dst[13] == 115u, "read across the wrap in order");
+
+    r16_push(&rb, 1u);
+    r16_push(&rb, 2u);
+    r16_flush(&rb);
+    check(r16_fill(&rb) == 0 && !r16_pop(&rb, &v), "flush empties");
+    check(r16_push(&rb, 7u) && r16_pop(&rb, &v) && v == 7u, "usable after flush");
+    r16_clear_stats(&rb);
+    check(rb.q.hw == 0 && rb.q.drops == 0, "clear_stats");
+}
+
+// Random operations against a plain FIFO, indices started near 2^32
+static void test_model(uint32_t start, uint32_t ops) {
+    static r16_t rb;
+    static uint32_t ref[1u << 20];
+    uint32_t ref_r = 0, ref_w = 0, next = 0, drops = 0;
+
+    r16_init(&rb);
+    rb.q.w = rb.q.r = rb.q.r_seen = rb.q.w_seen = start;
+
+    bool ok = true;
+    for (uint32_t k = 0; k < ops && ok; k++) {
+        uint32_t buf[24], *p, v, n;
+        const uint32_t fill = ref_w - ref_r;
+        switch (rnd(7)) {
+        case 0:                                         // push
+            if (r16_push(&rb, next)) ref[ref_w++ & 0xFFFFFu] = next;
+            else { ok &= fill == 16u; drops++; }
+            next++;
+            break;
+        case 1:                                         // pop
+            if (r16_pop(&rb, &v)) ok &= v == ref[ref_r++ & 0xFFFFFu];
+            else ok &= fill == 0;
+            break;
+        case 2:                                         // write
+            n = rnd(24);
+            for (uint32_t i = 0; i < n; i++) buf[i] = next + i;
+            v = r16_write(&rb, buf, n);
+            ok &= v == (n < 16u - fill ? n : 16u - fill);
+            for (uint32_t i = 0; i < v; i++) ref[ref_w++ & 0xFFFFFu] = next + i;
+            drops += n - v;
+            next += n;
+            break;
+        case 3:                                         // read
+            n = rnd(24);
+            v = r16_read(&rb, buf, n);
+            ok &= v == (n < fill ? n : fill);
+            for (uint32_t i = 0; i < v; i++) ok &= buf[i] == ref[ref_r++ & 0xFFFFFu];
+            break;
+        case 4:                                         // reserve, commit part
+            n = r16_reserve(&rb, rnd(24), &p);
+            v = n ? rnd(n + 1u) : 0;
+            for (uint32_t i = 0; i < v; i++) { p[i] = next; ref[ref_w++ & 0xFFFFFu] = next++; }
+            r16_commit(&rb, v);
+            break;
+        case 5:                                         // peek, release part
+            n = r16_peek(&rb, rnd(24), &p);
+            v = n ? rnd(n + 1u) : 0;
+            for (uint32_t i = 0; i < v; i++) ok &= p[i] == ref[ref_r++ & 0xFFFFFu];
+            r16_release(&rb, v);
+            break;
+        default:
+            if (!rnd(50)) { r16_flush(&rb); ref_r = ref_w; }
+            break;
+        }
+        ok &= r16_fill(&rb) == ref_w - ref_r && rb.q.hw <= 16u;
+    }
+    ok &= rb.q.drops == drops;
+    char what[96];
+    snprintf(what, sizeof(what), "%lu random operations match a FIFO (indices from 0x%08lX)",
+             (unsigned long)ops, (unsigned long)start);
+    check(ok, what);
+}
+
+// ---------------- Two threads ----------------
+#define XRING       1024u
+#define XBATCH      64u
+
+SPSC_DEFINE(xr, uint32_t, XRING)
+
+// The hand-copied ring the firmware used before (one spare slot,
+// volatile indices, compiler barrier only)
+static uint32_t old_buf[XRING];
+static volatile uint32_t old_w, old_r;
+
+static inline bool old_push(uint32_t v) {
+    uint32_t w = old_w;
+    uint32_t n = (w + 1u) & (XRING - 1u);
+    if (n == old_r) return false;
+    old_buf[w] = v;
+    __compiler_memory_barrier();
+    old_w = n;
+    return true;
+}
+
+static inline bool old_pop(uint32_t *out) {
+    uint32_t r = old_r;
+    if (r == old_w) return false;
+    *out = old_buf[r];
+    __compiler_memory_barrier();
+    old_r = (r + 1u) & (XRING - 1u);
+    return true;
+}
+
+enum { M_OLD, M_ELEM, M_COPY, M_SPAN, M_N };
+static const char *const mode_name[M_N] = { "old ring, push/pop", "push/pop", "write/read x64", "reserve/peek x64" };
+
+static xr_t xq;
+static uint32_t x_n;
+static int x_mode;
+
+static void *producer(void *arg) {
+    (void)arg;
+    uint32_t next = 0, buf[XBATCH], *p;
+    while (next < x_n) {
+        switch (x_mode) {
+        case M_OLD:
+            if (old_push(next)) next++;
+            else sched_yield();                         // full (the host may have one CPU)
+            break;
+        case M_ELEM:
+            if (xr_reserve(&xq, 1u, &p)) { *p = next++; xr_commit(&xq, 1u); }
+            else sched_yield();
+            break;
+        case M_COPY: {
+            uint32_t n = x_n - next < XBATCH ? x_n - next : XBATCH;
+            for (uint32_t i = 0; i < n; i++) buf[i] = next + i;
+            uint32_t done = 0;
+            while (done < n) {                          // write() would drop: place what fits
+                uint32_t *q;
+                uint32_t m = xr_reserve(&xq, n - done, &q);
+                memcpy(q, buf + done, m * sizeof(uint32_t));
+                xr_commit(&xq, m);
+                done += m;
+                if (!m) sched_yield();
+            }
+            next += n;
+            break;
+        }
+        case M_SPAN: {
+            uint32_t n = xr_reserve(&xq, x_n - next < XBATCH ? x_n - next : XBATCH, &p);
+            for (uint32_t i = 0; i < n; i++) p[i] = next++;
+            xr_commit(&xq, n);
+            if (!n) sched_yield();
+            break;
+        }
+        }
+    }
+    return NULL;
+}
+
+static bool consume(void) {
+    uint32_t next = 0, buf[XBATCH], *p, v;
+    bool ok = true;
+    while (next < x_n) {
+        switch (x_mode) {
+        case M_OLD:
+            if (old_pop(&v)) ok &= v == next++;
+            else sched_yield();
+            break;
+        case M_ELEM:
+            if (xr_pop(&xq, &v)) ok &= v == next++;
+            else sched_yield();
+            break;
+        case M_COPY: {
+            uint32_t n = xr_read(&xq, buf, XBATCH);
+            for (uint32_t i = 0; i < n; i++) ok &= buf[i] == next++;
+            if (!n) sched_yield();
+            break;
+        }
+        case M_SPAN: {
+            uint32_t n = xr_peek(&xq, XBATCH, &p);
+            for (uint32_t i = 0; i < n; i++) ok &= p[i] == next++;
+            xr_release(&xq, n);
+            if (!n) sched_yield();
+            break;
+        }
+        }
+    }
+    return ok;
+}
+
+static void test_threads(uint32_t n) {
+    x_n = n;
+    for (int m = 0; m < M_N; m++) {
+        x_mode = m;
+        xr_init(&xq);
+        old_w = old_r = 0;
+        pthread_t th;
+        const double t0 = now_s();
+        pthread_create(&th, NULL, producer, NULL);
+        const bool ok = consume();
+        pthread_join(th, NULL);
+        const double dt = now_s() - t0;
+        printf("ring: %-20s %7.1f Melem/s  %5.2f ns/elem  hw=%lu\n", mode_name[m],
+               (double)n / dt * 1e-6, dt * 1e9 / (double)n,
+               (unsigned long)(m == M_OLD ? 0u : xq.q.hw));
+        char what[80];
+        snprintf(what, sizeof(what), "%s: %lu elements once and in order", mode_name[m], (unsigned long)n);
+        check(ok && (m == M_OLD || xq.q.drops == 0), what);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = 1u << 24;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-v")) verbose = check_verbose = true;
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc) n = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else { fprintf(stderr, "usage: ringcheck [-v] [-n ELEMENTS]\n"); return 2; }
+    }
+
+    test_edges();
+    test_model(0u, 1000000u);
+    test_model(0xFFFFFF00u, 1000000u);
+    test_threads(n);
+
+    return check_result();
+}
@@ -0,0 +1,166 @@
+// scancheck.c - RSSI band scan (rssiscan.c) against an emulated SX1280
+//
+//   scancheck [-v]
+//
+// Scans a made-up band around the NB uplink (a local carrier inside it,
+// a bursty narrow source below it, the skirt of a Wi-Fi channel above)
+// on a simulated clock.  Checks that no command goes out while BUSY is
+// high and no RSSI is read before the PLL has locked, that the levels
+// and occupancy come out where the sources are, that the quiet end of
+// the uplink is picked, that the per-bin time is the settle time plus
+// the reads (bookkeeping hidden under the settle), and that a settle
+// time shorter than the lock is caught.  Exits non-zero on failure.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+#include "rssiscan.h"
+#include "sxemu.h"
+#include "hostutil.h"
+
+// ---------------- Platform ----------------
+static bool verbose;
+static uint64_t now_ns;             // simulated clock; every read costs 50 ns of CPU
+
+uint64_t plat_us(void) { now_ns += 50u; return now_ns / 1000u; }
+
+static char last_q[1024];           // last "!Q" line
+bool plat_cdc_connected(void) { return true; }
+void plat_cdc_write(const char *s) {
+    if (!strncmp(s, "!Q ", 3)) {
+        strncpy(last_q, s, sizeof(last_q) - 1u);
+        last_q[sizeof(last_q) - 1u] = 0;
+    }
+    if (verbose) printf("    %s", s);
+}
+
+static void spend(uint32_t ns) { now_ns += ns; }
+
+// ---------------- Band ----------------
+#define NOISE_DBM       (-100.0f)
+#define BIRDIE_KHZ      2400290.0
+#define BIRDIE_DBM      (-85.0f)
+
+static const sxemu_src_t band[] = {
+    { BIRDIE_KHZ, 0.0f,     BIRDIE_DBM, 0,     0.0f  },     // local carrier in the uplink
+    { 2399700.0,  0.0f,     -80.0f,     5000u, 0.25f },     // bursty narrow source
+    { 2410700.0,  20000.0f, -55.0f,     2000u, 0.40f },     // Wi-Fi channel, lower skirt in range
+};
+
+static sxemu_t emu = {
+    .src = band, .n_src = sizeof(band) / sizeof(band[0]),
+    .noise_dbm = NOISE_DBM, .lock_us = 40u, .spend = spend,
+};
+static const scan_backend_t be = { sxemu_xfer, sxemu_busy, &emu };
+
+static void scan_sweeps(uint32_t n) {
+    scan_stats_t st;
+    do {
+        rssiscan_poll();
+        rssiscan_stats(&st);
+    } while (st.sweeps < n && rssiscan_wanted());
+}
+
+static uint32_t bin_of(uint32_t khz) {
+    return (khz - SCAN_LO_KHZ) / SCAN_STEP_KHZ;
+}
+
+// Mean level / occupancy over bins [lo_khz, hi_khz]
+static void band_stats(uint32_t lo_khz, uint32_t hi_khz, float *dbm, float *o) {
+    float sl = 0.0f, so = 0.0f;
+    uint32_t n = 0;
+    for (uint32_t i = bin_of(lo_khz); i <= bin_of(hi_khz); i++, n++) {
+        int16_t a, p;
+        uint8_t oc;
+        rssiscan_bin(i, &a, &oc, &p);
+        sl += (float)a / 2.0f;
+        so += (float)oc / 255.0f;
+    }
+    *dbm = sl / (float)n;
+    *o = so / (float)n;
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-v")) verbose = check_verbose = true;
+        else { fprintf(stderr, "usage: scancheck [-v]\n"); return 2; }
+    }
+    scan_stats_t st;
+    float dbm, o;
+
+    // ---- Default range, default settle (> lock time) ----
+    sxemu_init(&emu);
+    check(rssiscan_start(SCAN_LO_KHZ, SCAN_HI_KHZ, SCAN_STEP_KHZ), "default range accepted");
+    check(!rssiscan_start(SCAN_LO_KHZ, SCAN_LO_KHZ + SCAN_MAX_BINS * SCAN_STEP_KHZ, SCAN_STEP_KHZ),
+          "more than SCAN_MAX_BINS refused");
+    check(rssiscan_start(SCAN_LO_KHZ, SCAN_HI_KHZ, SCAN_STEP_KHZ), "restart");
+    rssiscan_begin(&be);
+    scan_sweeps(300);
+    rssiscan_stats(&st);
+
+    check(st.sweeps >= 300, "300 sweeps");
+    check(emu.busy_violations == 0, "no command while BUSY");
+    check(emu.early_reads == 0, "no RSSI read before PLL lock");
+    check(emu.unknown == 0, "only known commands");
+    check(emu.bw_param == SX_GFSK_BR_0_125_BW_0_3 && emu.mode == SXEMU_RX, "narrowest GFSK filter, RX");
+
+    band_stats(2400250u, 2400325u, &dbm, &o);
+    if (verbose) printf("  carrier bins:  %.1f dBm, occupancy %.2f\n", (double)dbm, (double)o);
+    check(fabsf(dbm - BIRDIE_DBM) < 2.0f && o > 0.9f, "local carrier: level and full occupancy");
+
+    band_stats(2400050u, 2400100u, &dbm, &o);
+    if (verbose) printf("  uplink bottom: %.1f dBm, occupancy %.2f\n", (double)dbm, (double)o);
+    check(fabsf(dbm - NOISE_DBM) < 2.0f && o < 0.1f, "quiet end of the uplink at the floor");
+
+    band_stats(2400875u, 2401000u, &dbm, &o);
+    if (verbose) printf("  Wi-Fi skirt:   %.1f dBm, occupancy %.2f\n", (double)dbm, (double)o);
+    check(o > 0.25f && o < 0.55f, "Wi-Fi skirt occupancy near its 40% duty");
+
+    band_stats(2399650u, 2399750u, &dbm, &o);
+    if (verbose) printf("  burst source:  %.1f dBm, occupancy %.2f\n", (double)dbm, (double)o);
+    check(o > 0.10f && o < 0.50f, "bursty source occupancy near its 25% duty");
+
+    check(st.best_khz >= SCAN_NB_LO_KHZ && st.best_khz < (uint32_t)BIRDIE_KHZ - 150u,
+          "best spot in the uplink, clear of the carrier");
+    check(fabsf((float)st.floor_dbm2 / 2.0f - NOISE_DBM) < 3.0f, "floor at the noise level");
+
+    const float bin_us = (float)st.sweep_us / (float)st.bins;
+    const float ideal_us = (float)(SCAN_SETTLE_US + (SCAN_READS - 1u) * SCAN_READ_GAP_US);
+    printf("scan: %lu bins, %.1f us/bin (settle %u + reads %u), %.0f bins/s, sweep %.2f ms, best %lu kHz at %d dBm\n",
+           (unsigned long)st.bins, (double)bin_us, SCAN_SETTLE_US,
+           (SCAN_READS - 1u) * SCAN_READ_GAP_US, 1e6 / (double)bin_us,
+           (double)st.sweep_us / 1000.0, (unsigned long)st.best_khz, st.best_dbm2 / 2);
+    check(bin_us < ideal_us + 10.0f, "per-bin time within 10 us of settle + reads");
+
+    rssiscan_print("check");
+    char *lvl = strstr(last_q, " lvl="), *oc = strstr(last_q, " occ=");
+    check(lvl && oc && (uint32_t)(oc - lvl - 5) == 2u * st.bins &&
+          strlen(oc + 5) == st.bins + 2u, "!Q carries 2 hex digits of level and 1 of occupancy per bin");
+
+    rssiscan_stop("off");
+    check(!rssiscan_wanted() && strstr(last_q, "why=off on=0"), "stop reports and clears the request");
+    rssiscan_end();
+
+    // ---- Settle shorter than the PLL lock: the emulator must catch it ----
+    sxemu_init(&emu);
+    rssiscan_set_settle(10u);
+    rssiscan_start(SCAN_LO_KHZ, SCAN_HI_KHZ, SCAN_STEP_KHZ);
+    rssiscan_begin(&be);
+    scan_sweeps(20);
+    rssiscan_stats(&st);
+    if (verbose) printf("  settle 10 us: %lu of %lu reads before lock\n",
+                        (unsigned long)emu.early_reads, (unsigned long)emu.rssi_reads);
+    check(emu.early_reads > emu.rssi_reads / 2u, "short settle reads before lock");
+    rssiscan_stop("off");
+    rssiscan_end();
+    rssiscan_set_settle(SCAN_SETTLE_US);
+
+    return check_result();
+}
@@ -0,0 +1,283 @@
+// schedcheck.c - tx_at (txsched.c) against simulated clocks
+//
+//   schedcheck [-v]
+//
+// Simulates the three clocks involved: the host's system time (UTC, the
+// reference), the host controller's SOF (a few tens of ppm off it) and
+// the device's local us timer (off both), with IRQ latency on the SOF
+// stamps, occasional very late edges and a suspend gap.  The host side
+// of the handshake runs over a CDC link with random, asymmetric delays
+// and keeps its best round trip.  A producer keys blocks through
+// txsched_keyed() and a simulated Core1 drains them per dither substep
+// through txsched_gate().  The producer keeps the queue full (PC audio)
+// or, paced by the MIC timer, only one block ahead; txsched_poll() runs
+// every millisecond either way, as core0_poll() does from both waits.
+//
+// Checks, for each clock set-up: the first sample on air lands within
+// 1 ms of the requested UTC instant (true host time, not the device's
+// own estimate) and the reported error matches what actually happened,
+// nothing goes out before the start or after the end, a cancel stops RF
+// at once, and the host-clock rate learnt from two syncs holds the start
+// after five minutes without a resync.  With no producer backlog the
+// slot still lands and the gate opens again for PTT afterwards.  Exits
+// non-zero on failure.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+#include "txsched.h"
+#include "hostutil.h"
+
+// ---------------- Simulated clocks ----------------
+#define EPOCH_US    1760870400000000ull     // UTC of host time 0 (a 15 s boundary)
+#define LOCAL0_US   5000000.0               // device uptime at host time 0
+#define STEP_US     31.25                   // Core1 dither substep
+
+static bool   verbose;
+static double H;                            // host time, us
+static double ppm_loc, ppm_sof;             // device timer / SOF vs host time
+static double loc_h0, loc_l0 = LOCAL0_US;   // device timer at the last ppm change
+
+static double loc_of(double h) { return loc_l0 + (h - loc_h0) * (1.0 + ppm_loc * 1e-6); }
+
+uint64_t plat_us(void) { return (uint64_t)loc_of(H); }
+
+// CDC: keep the last line for the handshake
+static char last_line[256];
+bool plat_cdc_connected(void) { return true; }
+void plat_cdc_write(const char *s) {
+    snprintf(last_line, sizeof(last_line), "%s", s);
+    if (verbose) printf("    %s", s);
+}
+
+static uint32_t rng = 0x2545F491u;
+static double urand(void) {
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    return (double)rng / 4294967296.0;
+}
+
+// ---------------- Device model ----------------
+static uint64_t sof_k;                      // next SOF frame
+static double   sof_h;                      // ... and its host time
+static double   sof_off_until;              // suspend: no SOF before this
+static uint32_t late_edges;
+
+static uint8_t  q_keyed[NUM_BLOCKS];        // queued blocks: keyed or not
+static uint32_t q_head, q_n;
+static uint32_t q_depth = NUM_BLOCKS;       // blocks the producer keeps queued
+static uint32_t sub_ct;                     // substeps into the current block
+static double   next_poll;
+
+// Air log for the current run
+static double   first_on, last_on;
+static uint64_t on_subs;
+
+static void device_step(void) {
+    // SOF edges up to now, stamped with IRQ latency
+    // An IRQ held off for milliseconds (flash op, long ISR) is serviced
+    // once, reads the newest frame number and stamps it late.
+    while (sof_h <= H) {
+        double svc = sof_h + 1.0 + 7.0 * urand();
+        if (urand() < 0.002) { svc += 2000.0 + 1500.0 * urand(); late_edges++; }
+        while (sof_h <= svc) {
+            sof_h += 1000.0 * (1.0 + ppm_sof * 1e-6);
+            sof_k++;
+        }
+        if (svc < sof_off_until) continue;
+        txsched_sof((uint32_t)(sof_k - 1u) & 0x7FFu, (uint64_t)loc_of(svc));
+    }
+
+    // Producer keeps the queue at its depth
+    while (q_n < q_depth) {
+        q_keyed[(q_head + q_n) % NUM_BLOCKS] = txsched_keyed() ? 1u : 0u;
+        q_n++;
+    }
+
+    // Core1: one substep of the head block (audio always present)
+    const bool on = txsched_gate((uint32_t)plat_us(), q_keyed[q_head] != 0);
+    if (on) {
+        if (first_on < 0.0) first_on = H;
+        last_on = H;
+        on_subs++;
+    }
+    if (++sub_ct == BLOCK_SAMPLES * DITHER_SUBSTEPS) {
+        sub_ct = 0;
+        q_head = (q_head + 1u) % NUM_BLOCKS;
+        q_n--;
+    }
+
+    if (H >= next_poll) {
+        next_poll = H + 1000.0;
+        txsched_poll(q_n * TXS_BLOCK_MS);
+    }
+}
+
+static void run_to(double h) {
+    while (H < h) {
+        H += STEP_US;
+        device_step();
+    }
+}
+
+// ---------------- Host side of the handshake ----------------
+static double link_delay(void) {
+    double d = 250.0 + 1250.0 * urand();            // frame + host stack
+    if (urand() < 0.2) d += 2000.0 + 6000.0 * urand();   // scheduler hiccup
+    return d;
+}
+
+static uint32_t host_sync(int pings) {
+    double best_rtt = 1e18;
+    uint64_t best_host = 0, best_dev = 0;
+    char tok[32];
+
+    for (int i = 0; i < pings; i++) {
+        const double h1 = H;
+        run_to(H + link_delay());
+        snprintf(tok, sizeof(tok), "%llu", (unsigned long long)(EPOCH_US + (uint64_t)h1));
+        txsched_ping(tok);
+        const char *d = strstr(last_line, "dev=");
+        const uint64_t dev = d ? strtoull(d + 4, NULL, 10) : 0;
+        run_to(H + link_delay());
+        const double rtt = H - h1;
+        if (rtt < best_rtt) {
+            best_rtt = rtt;
+            best_host = EPOCH_US + (uint64_t)((h1 + H) * 0.5);
+            best_dev = dev;
+        }
+        run_to(H + 20000.0);
+    }
+    const char *err = txsched_sync(best_host, best_dev, (uint32_t)best_rtt);
+    if (err) printf("  sync: %s\n", err);
+    return (uint32_t)best_rtt;
+}
+
+// ---------------- Checks ----------------
+static void air_reset(void) {
+    first_on = last_on = -1.0;
+    on_subs = 0;
+}
+
+static void wait_idle(void) {
+    txsched_stats_t s;
+    do { run_to(H + 10000.0); txsched_stats(&s); } while (s.state != TXS_IDLE);
+}
+
+// One scheduled over: start/end vs true host time, reported error
+static void slot_run(const char *name, double lim_us) {
+    txsched_stats_t s;
+    air_reset();
+    const char *err = txsched_arm_next(15000u, 12640u);
+    check(!err, "tx_at next 15 armed");
+    if (err) { printf("  %s\n", err); return; }
+    txsched_stats(&s);
+    const double start = (double)(s.start_ms * 1000u - EPOCH_US);
+    const double end = start + 12640e3;
+    wait_idle();
+    txsched_stats(&s);
+
+    const double e_start = first_on - start;
+    const double e_end = last_on + STEP_US - end;
+    // The device reports against its own idea of the start (local us);
+    // the rest of the true error is the sync
+    const double rep = s.err_us / (1.0 + ppm_loc * 1e-6);
+    printf("  %-22s start %+7.0f us  end %+7.0f us  reported %+5ld us  q=%lu ms  rate %+6.2f ppm\n",
+           name, e_start, e_end, (long)s.err_us, (unsigned long)s.queue_ms, (double)s.rate_ppm);
+
+    char what[96];
+    snprintf(what, sizeof(what), "%s: start within %.0f us of UTC", name, lim_us);
+    check(first_on >= 0.0 && fabs(e_start) <= lim_us, what);
+    snprintf(what, sizeof(what), "%s: end within %.0f us", name, lim_us);
+    check(fabs(e_end) <= lim_us, what);
+    snprintf(what, sizeof(what), "%s: nothing on air outside the slot", name);
+    check(first_on >= start - lim_us && last_on <= end + lim_us &&
+          fabs((double)on_subs * STEP_US - 12640e3) < 2.0 * lim_us + 64.0, what);
+    snprintf(what, sizeof(what), "%s: reported error within a substep", name);
+    check(s.fired && fabs(rep) <= STEP_US + 1.0, what);
+}
+
+// New crystal offsets, clocks continuous across the change
+static void set_clocks(double loc_ppm, double sof_ppm) {
+    loc_l0 = loc_of(H);
+    loc_h0 = H;
+    ppm_loc = loc_ppm;
+    ppm_sof = sof_ppm;
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-v")) verbose = check_verbose = true;
+        else { fprintf(stderr, "usage: schedcheck [-v]\n"); return 2; }
+    }
+    txsched_stats_t s;
+
+    // Device timer 30 ppm fast, host controller SOF 25 ppm slow of UTC
+    set_clocks(+30.0, -25.0);
+
+    // ---- Before any sync: UTC starts refused, relative start works ----
+    run_to(2e6);
+    check(txsched_arm_at(EPOCH_US / 1000u + 10000u, 0) != NULL, "UTC start refused before tsync");
+    check(txsched_arm_in(100u, 0) != NULL, "start inside the keying lead refused");
+    air_reset();
+    check(!txsched_arm_in(2000u, 500u), "tx_at +2000 500 armed unsynced");
+    const double rel_start = H + 2000e3;
+    wait_idle();
+    check(fabs((first_on - rel_start) - 2000e3 * 25e-6) < 200.0, "relative start on the device clock");
+
+    // ---- Sync, then an FT8 slot ----
+    uint32_t rtt = host_sync(8);
+    if (verbose) printf("  best rtt %lu us\n", (unsigned long)rtt);
+    slot_run("next slot after sync", 1000.0);
+
+    // Cancel mid-over: RF stops at once
+    air_reset();
+    check(!txsched_arm_next(15000u, 0), "open-ended slot armed");
+    txsched_stats(&s);
+    const double st0 = (double)(s.start_ms * 1000u - EPOCH_US);
+    run_to(st0 + 3e6);
+    const double t_cancel = H;
+    txsched_cancel("cancel");
+    wait_idle();
+    check(first_on > 0.0 && last_on <= t_cancel + STEP_US, "cancel stops RF at once");
+
+    // ---- Resyncs once a minute teach the host-vs-SOF rate ----
+    for (int i = 0; i < 3; i++) {
+        run_to(H + 60e6);
+        host_sync(8);
+    }
+    txsched_stats(&s);
+    check(fabs(s.rate_ppm - ppm_sof) < 5.0, "host vs SOF rate learnt from the resyncs");
+    run_to(H + 300e6);
+    slot_run("5 min without resync", 2000.0);      // 7.5 ms off without the rate
+
+    // ---- Suspend gap: SOF frame count restarts, resync recovers ----
+    sof_off_until = H + 2.5e6;
+    run_to(H + 3e6);
+    host_sync(8);
+    slot_run("after SOF gap", 1000.0);
+
+    // ---- MIC pacing: no backlog, the gate must still close out ----
+    q_depth = 1;
+    host_sync(8);
+    slot_run("MIC, no backlog", 1000.0);
+    txsched_stats(&s);
+    check(s.state == TXS_IDLE && s.queue_ms <= TXS_BLOCK_MS, "MIC, no backlog: slot done, queue short");
+    check(txsched_gate((uint32_t)plat_us(), true), "MIC, no backlog: PTT keys again after the slot");
+    q_depth = NUM_BLOCKS;
+
+    txsched_stats(&s);
+    check(s.rebases == 1, "SOF gap counted as one rebase");
+    check(s.late > 0 && s.late <= late_edges, "late SOF stamps rejected");
+    if (verbose) printf("  edges %lu late %lu (injected %lu) rebases %lu\n", (unsigned long)s.edges,
+                        (unsigned long)s.late, (unsigned long)late_edges, (unsigned long)s.rebases);
+
+    txsched_print("final");
+    return check_result();
+}
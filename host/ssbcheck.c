@@ -0,0 +1,200 @@
+// ssbcheck.c - SSB modulators: Hilbert FIR (each governor length) vs Weaver
+//
+//   ssbcheck [-v]
+//
+// Drives each modulator with single tones across the voice band and
+// projects its I/Q output on e^(+jwn) (wanted sideband) and e^(-jwn)
+// (opposite sideband).  Per engine:
+//
+//   osb     worst opposite sideband 300..2700 Hz, dB below the wanted
+//   ripple  wanted-sideband gain spread 400..2600 Hz, dB
+//   delay   group delay at 500 / 1500 / 2500 Hz, ms (audio to RF)
+//   cost    multiplies and measured ns per sample, the modulator alone
+//           and the whole SSB chain (bandpass, compressor, polar)
+//
+// Fails when the Weaver engine is not at least twice as cheap as the
+// 247-tap Hilbert, or its opposite sideband is above -40 dB or its
+// ripple above 1 dB in that band.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+#include "control.h"
+#include "dsp.h"
+#include "txchain.h"
+
+// ---------------- Platform ----------------
+static bool verbose;
+
+bool plat_cdc_connected(void) { return verbose; }
+void plat_cdc_write(const char *s) { printf("    %s", s); }
+
+#define FS          ((double)WAV_SAMPLE_RATE)
+#define SETTLE      1024u           // samples dropped before measuring
+#define MEASURE     8000u           // 1 s: whole cycles for any integer Hz
+#define BENCH_N     200000u
+
+#define OSB_MAX_DB      -40.0
+#define RIPPLE_MAX_DB    1.0
+#define COST_RATIO_MIN   2.0
+
+typedef struct {
+    const char *name;
+    uint8_t     engine;             // SSB_*
+    uint16_t    taps;               // Hilbert length
+} engine_t;
+
+static const engine_t engines[] = {
+    { "hilb247", SSB_HILBERT, HILBERT_TAPS },
+    { "hilb127", SSB_HILBERT, HILBERT_TAPS_MID },
+    { "hilb63",  SSB_HILBERT, HILBERT_TAPS_LOW },
+    { "weaver",  SSB_WEAVER,  0 },
+};
+#define N_ENGINES   (sizeof(engines) / sizeof(engines[0]))
+
+typedef struct {
+    hilbert_t hb;
+    weaver_t  wv;
+    uint8_t   engine;
+} mod_t;
+
+static void mod_init(mod_t *m, const engine_t *e) {
+    const audio_cfg_t cfg = AUDIO_CFG_DEFAULTS;
+    m->engine = e->engine;
+    hilbert_init(&m->hb);
+    if (e->engine == SSB_HILBERT) hilbert_set_len(&m->hb, e->taps);
+    weaver_init(&m->wv, cfg.bp_lo_hz, cfg.bp_hi_hz, (float)FS);
+}
+
+static inline float mod_process(mod_t *m, float x, float *i) {
+    return (m->engine == SSB_WEAVER) ? weaver_process(&m->wv, x, i)
+                                     : hilbert_process(&m->hb, x, i);
+}
+
+// Tone at f_hz through a fresh modulator: wanted and opposite sideband
+// as complex amplitudes relative to the input e^(jwn)
+typedef struct { double wr, wi, or_, oi; } proj_t;
+
+static proj_t tone(const engine_t *e, double f_hz) {
+    static mod_t m;
+    mod_init(&m, e);
+    const double w = 2.0 * M_PI * f_hz / FS;
+    proj_t p = { 0, 0, 0, 0 };
+    for (uint32_t n = 0; n < SETTLE + MEASURE; n++) {
+        float I;
+        const float Q = mod_process(&m, (float)cos(w * n), &I);
+        if (n < SETTLE) continue;
+        const double c = cos(w * n), s = sin(w * n);
+        // (I + jQ) e^(-jwn) and (I + jQ) e^(+jwn)
+        p.wr  += I * c + Q * s;  p.wi += Q * c - I * s;
+        p.or_ += I * c - Q * s;  p.oi += Q * c + I * s;
+    }
+    p.wr /= MEASURE; p.wi /= MEASURE; p.or_ /= MEASURE; p.oi /= MEASURE;
+    return p;
+}
+
+static double db(double re, double im) { return 10.0 * log10(re * re + im * im + 1e-30); }
+
+// Group delay from the wanted-sideband phase slope, ms
+static double delay_ms(const engine_t *e, double f_hz) {
+    const double df = 5.0;
+    const proj_t a = tone(e, f_hz - df), b = tone(e, f_hz + df);
+    double dph = atan2(b.wi, b.wr) - atan2(a.wi, a.wr);
+    while (dph > M_PI) dph -= 2.0 * M_PI;
+    while (dph < -M_PI) dph += 2.0 * M_PI;
+    return -dph / (2.0 * M_PI * 2.0 * df) * 1000.0;
+}
+
+static double bench_mod_ns(const engine_t *e) {
+    static mod_t m;
+    static float in[BLOCK_SAMPLES];
+    for (uint32_t i = 0; i < BLOCK_SAMPLES; i++) in[i] = 0.5f * sinf(0.785f * (float)i);
+    mod_init(&m, e);
+    volatile float sink = 0.0f;
+    float acc = 0.0f, I;
+    const uint64_t t0 = plat_us();
+    for (uint32_t n = 0; n < BENCH_N; n++) {
+        acc += mod_process(&m, in[n & (BLOCK_SAMPLES - 1u)], &I);
+        acc += I;
+    }
+    const uint64_t dt = plat_us() - t0;
+    sink = acc;
+    (void)sink;
+    return (double)dt * 1000.0 / BENCH_N;
+}
+
+// Whole SSB producer at full quality with this engine
+static double bench_chain_ns(const engine_t *e) {
+    static txchain_t t;
+    static float in[BLOCK_SAMPLES];
+    static sample_cmd_t blk[BLOCK_SAMPLES];
+    for (uint32_t i = 0; i < BLOCK_SAMPLES; i++) in[i] = 0.5f * sinf(0.785f * (float)i);
+
+    audio_cfg_t cfg = AUDIO_CFG_DEFAULTS;
+    cfg.ssb_engine = e->engine;
+    txchain_ctx_init(&t, &cfg);
+    if (e->engine == SSB_HILBERT) t.hilb_taps = e->taps;
+    const tx_params_t p = { .mode = TXM_USB, .tx_req = 1, .pwr_max_dbm = PWR_MAX_DBM };
+
+    const uint32_t blocks = BENCH_N / BLOCK_SAMPLES;
+    const uint64_t t0 = plat_us();
+    for (uint32_t b = 0; b < blocks; b++) txchain_ctx_block(&t, &p, in, blk);
+    const uint64_t dt = plat_us() - t0;
+    return (double)dt * 1000.0 / (blocks * BLOCK_SAMPLES);
+}
+
+static uint32_t macs(const engine_t *e) {
+    // Biquad 5 per branch and section, mixers 2 down + 4 up, gain 2
+    if (e->engine == SSB_WEAVER) return 2u * 5u * WEAVER_SECTIONS + 8u;
+    return e->taps;
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-v")) verbose = true;
+        else { fprintf(stderr, "usage: ssbcheck [-v]\n"); return 2; }
+    }
+
+    uint32_t fails = 0;
+    double mod_ns[N_ENGINES];
+
+    printf("engine    osb dB  ripple dB  delay ms @500/1500/2500   macs  ns/sample  chain ns\n");
+    for (uint32_t k = 0; k < N_ENGINES; k++) {
+        const engine_t *e = &engines[k];
+        double osb = -200.0, gmin = 1e9, gmax = -1e9;
+        for (double f = 300.0; f <= 2700.0; f += 100.0) {
+            const proj_t p = tone(e, f);
+            const double want = db(p.wr, p.wi), opp = db(p.or_, p.oi) - want;
+            if (opp > osb) osb = opp;
+            if (f >= 400.0 && f <= 2600.0) {
+                if (want < gmin) gmin = want;
+                if (want > gmax) gmax = want;
+            }
+            if (verbose) printf("    %s %4.0f Hz  want %+6.2f dB  opp %7.1f dB\n", e->name, f, want, opp);
+        }
+        const double ripple = gmax - gmin;
+        const double d1 = delay_ms(e, 500.0), d2 = delay_ms(e, 1500.0), d3 = delay_ms(e, 2500.0);
+        mod_ns[k] = bench_mod_ns(e);
+        const double chain_ns = bench_chain_ns(e);
+
+        printf("%-8s %7.1f %9.2f    %5.2f / %5.2f / %5.2f     %5lu  %9.1f  %8.1f\n",
+               e->name, osb, ripple, d1, d2, d3, (unsigned long)macs(e), mod_ns[k], chain_ns);
+
+        if (e->engine == SSB_WEAVER) {
+            if (osb > OSB_MAX_DB) { printf("  FAIL: weaver opposite sideband %.1f dB\n", osb); fails++; }
+            if (ripple > RIPPLE_MAX_DB) { printf("  FAIL: weaver ripple %.2f dB\n", ripple); fails++; }
+            if (mod_ns[0] < COST_RATIO_MIN * mod_ns[k]) {
+                printf("  FAIL: weaver only %.1fx cheaper than %s\n", mod_ns[0] / mod_ns[k], engines[0].name);
+                fails++;
+            }
+        }
+    }
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    return fails ? 1 : 0;
+}
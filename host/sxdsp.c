@@ -0,0 +1,250 @@
+// sxdsp.c - the firmware TX chain as a shared library, for local preview
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "sxdsp.h"
+#include "hostutil.h"
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+
+// ---------------- Receiver ----------------
+#define RX_OS       4u                      // envelope at 32 kHz
+#define RX_TAPS     191u                    // Hann: ~500 Hz transition at 32 kHz
+#define RX_LO_HZ    150.0f
+#define RX_HI_HZ    3000.0f
+
+#if RX_OS % DITHER_SUBSTEPS
+#error "RX_OS must be a multiple of DITHER_SUBSTEPS"
+#endif
+
+struct sxdsp {
+    audio_cfg_t cfg;
+    tx_params_t p;
+    txchain_t   tx;
+    bool        mic;                        // src mic: MIC AGC in front, as in the firmware
+    mic_agc_t   agc;
+
+    float    in[BLOCK_SAMPLES];
+    uint32_t in_n;
+    float    fifo[2u * BLOCK_SAMPLES];      // demodulated, one block of latency
+    uint32_t f_r, f_n;
+
+    float    h_re[RX_TAPS], h_im[RX_TAPS];
+    float    z_re[2u * RX_TAPS], z_im[2u * RX_TAPS];   // doubled history
+    uint32_t z_pos;
+    double   phase;                         // carrier phase, turns
+    uint32_t f_acc;                         // Core1 frequency sigma-delta
+
+    sxdsp_stats_t st;
+    double   p_sum;
+};
+
+static void design_rx(sxdsp_t *d) {
+    const float fs = (float)WAV_SAMPLE_RATE * (float)RX_OS;
+    const float half = 0.5f * (RX_HI_HZ - RX_LO_HZ);
+    const float fc = 0.5f * (RX_HI_HZ + RX_LO_HZ);
+    const float m = 0.5f * (float)(RX_TAPS - 1u);
+    float sum = 0.0f;
+    for (uint32_t k = 0; k < RX_TAPS; k++) {
+        const float t = (float)k - m;
+        const float x = 2.0f * half / fs * t;
+        const float sinc = t == 0.0f ? 1.0f : sinf((float)M_PI * x) / ((float)M_PI * x);
+        const float w = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * (float)k / (float)(RX_TAPS - 1u));
+        d->h_re[k] = w * sinc;
+        sum += d->h_re[k];
+    }
+    for (uint32_t k = 0; k < RX_TAPS; k++) {
+        const float lp = d->h_re[k] / sum;  // unity gain in the passband
+        const float ph = 2.0f * (float)M_PI * fc / fs * ((float)k - m);
+        d->h_re[k] = lp * cosf(ph);
+        d->h_im[k] = lp * sinf(ph);
+    }
+}
+
+static void rx_clear(sxdsp_t *d) {
+    memset(d->fifo, 0, sizeof(d->fifo));
+    d->f_r = 0;
+    d->f_n = BLOCK_SAMPLES;
+    d->in_n = 0;
+    memset(d->z_re, 0, sizeof(d->z_re));
+    memset(d->z_im, 0, sizeof(d->z_im));
+    d->z_pos = 0;
+    d->phase = 0.0;
+    d->f_acc = 0;
+}
+
+// Sample commands -> what a receiver on the downlink puts out
+static void demod(sxdsp_t *d, const sample_cmd_t *blk) {
+    const float p_max = powf(10.0f, (float)d->p.pwr_max_dbm / 20.0f);
+    for (uint32_t i = 0; i < BLOCK_SAMPLES; i++) {
+        const sample_cmd_t *c = &blk[i];
+        const double f_hz = (double)sample_cmd_q8(c, d->p.base_steps) * (double)PLL_STEP_HZ / FREQ_FRAC_ONE;
+        const float amp = c->tx_on ? powf(10.0f, (float)c->p_dbm / 20.0f) / p_max : 0.0f;
+
+        d->st.samples++;
+        if (c->tx_on) {
+            d->st.on++;
+            d->p_sum += c->p_dbm;
+            if (c->p_dbm <= PWR_MIN_DBM) d->st.at_min++;
+        }
+
+        float y;
+        if (d->p.mode == TXM_FM) {
+            y = c->tx_on ? (float)(f_hz / (double)d->p.fm_dev_hz) : 0.0f;
+        } else {
+            // Keyed as Core1 does: the Q8 frequency dithered per substep
+            double dph = 0.0;
+            for (uint32_t k = 0; k < RX_OS; k++) {
+                if (k % (RX_OS / DITHER_SUBSTEPS) == 0u) {
+                    const int32_t steps = sample_cmd_dither(c, &d->f_acc) - d->p.base_steps;
+                    dph = (double)steps * (double)PLL_STEP_HZ / ((double)WAV_SAMPLE_RATE * RX_OS);
+                }
+                d->phase += dph;
+                d->phase -= floor(d->phase);
+                const float ph = 2.0f * (float)M_PI * (float)d->phase;
+                const uint32_t at = d->z_pos;
+                d->z_re[at] = d->z_re[at + RX_TAPS] = amp * cosf(ph);
+                d->z_im[at] = d->z_im[at + RX_TAPS] = amp * sinf(ph);
+                d->z_pos = at + 1u == RX_TAPS ? 0u : at + 1u;
+            }
+            // Oldest sample first from z_pos: h[RX_TAPS-1-j] * z[pos + j]
+            const float *zr = &d->z_re[d->z_pos], *zi = &d->z_im[d->z_pos];
+            float acc = 0.0f;
+            for (uint32_t j = 0; j < RX_TAPS; j++) {
+                const uint32_t k = RX_TAPS - 1u - j;
+                acc += d->h_re[k] * zr[j] - d->h_im[k] * zi[j];
+            }
+            y = acc;
+        }
+        if (fabsf(y) > d->st.peak) d->st.peak = fabsf(y);
+        d->fifo[(d->f_r + d->f_n++) % (2u * BLOCK_SAMPLES)] = y;
+    }
+}
+
+// ---------------- API ----------------
+sxdsp_t *sxdsp_new(void) {
+    sxdsp_t *d = calloc(1, sizeof(*d));
+    if (!d) return NULL;
+    static const audio_cfg_t defaults = AUDIO_CFG_DEFAULTS;
+    d->cfg = defaults;
+    d->p = (tx_params_t){
+        .mode = TXM_USB, .tx_req = 1, .guard = 0, .roger_beep = 0,
+        .pwr_max_dbm = PWR_MAX_DBM, .fm_dev_hz = 2500.0f, .ctcss_hz = 0.0f,
+        .base_steps = 0, .fine_hz = 0.0f,
+    };
+    design_rx(d);
+    sxdsp_reset(d);
+    return d;
+}
+
+void sxdsp_free(sxdsp_t *d) { free(d); }
+
+void sxdsp_reset(sxdsp_t *d) {
+    txchain_ctx_init(&d->tx, &d->cfg);
+    mic_agc_init(&d->agc);
+    rx_clear(d);
+    memset(&d->st, 0, sizeof(d->st));
+    d->p_sum = 0.0;
+}
+
+int sxdsp_cmd(sxdsp_t *d, const char *line) {
+    char buf[128];
+    char *argv[4];
+    int argc = 0;
+    snprintf(buf, sizeof(buf), "%s", line);
+    for (char *s = strtok(buf, " \t\r\n"); s && argc < 4; s = strtok(NULL, " \t\r\n")) argv[argc++] = s;
+    if (argc < 2) return 0;
+
+    float f;
+    if (streqi(argv[0], "mode")) {
+        if (streqi(argv[1], "usb") || streqi(argv[1], "ssb")) d->p.mode = TXM_USB;
+        else if (streqi(argv[1], "fm")) d->p.mode = TXM_FM;
+        else return streqi(argv[1], "cw") ? 0 : -1;     // CW is a carrier, nothing to hear
+        rx_clear(d);
+        return 1;
+    }
+    if (streqi(argv[0], "src")) {
+        if (streqi(argv[1], "mic")) d->mic = true;
+        else if (streqi(argv[1], "pc")) d->mic = false;
+        else return -1;
+        return 1;
+    }
+    if (streqi(argv[0], "txpwr")) {
+        if (!parse_f(argv[1], &f)) return -1;
+        if (f < (float)PWR_MIN_DBM) f = (float)PWR_MIN_DBM;
+        if (f > (float)PWR_MAX_DBM) f = (float)PWR_MAX_DBM;
+        d->p.pwr_max_dbm = (int8_t)f;
+        return 1;
+    }
+    if (argc < 3) return 0;
+    if (streqi(argv[0], "enable")) {
+        if (!parse_f(argv[2], &f)) return -1;
+        const uint8_t v = f != 0.0f;
+        if (streqi(argv[1], "bp")) d->cfg.enable_bandpass = v;
+        else if (streqi(argv[1], "eq")) d->cfg.enable_eq = v;
+        else if (streqi(argv[1], "comp")) d->cfg.enable_comp = v;
+        else return -1;
+        txchain_ctx_set_cfg(&d->tx, &d->cfg);
+        return 1;
+    }
+    if (streqi(argv[0], "set")) {
+        if (!parse_f(argv[2], &f)) return -1;
+        if (streqi(argv[1], "fm_dev")) {
+            d->p.fm_dev_hz = f < 200.0f ? 200.0f : f > 100000.0f ? 100000.0f : f;
+            return 1;
+        }
+        if (streqi(argv[1], "ctcss")) {
+            d->p.ctcss_hz = f < 0.0f ? 0.0f : f > 300.0f ? 300.0f : f;
+            return 1;
+        }
+        if (!cfg_set_key(&d->cfg, argv[1], f)) return 0;
+        cfg_sanitize(&d->cfg, (float)WAV_SAMPLE_RATE);
+        txchain_ctx_set_cfg(&d->tx, &d->cfg);
+        return 1;
+    }
+    return 0;
+}
+
+int sxdsp_get(sxdsp_t *d, const char *key, float *v) {
+    return cfg_get_key(&d->cfg, key, v) ? 1 : 0;
+}
+
+void sxdsp_process(sxdsp_t *d, const float *in, float *out, uint32_t n) {
+    const uint64_t t0 = plat_us();
+    sample_cmd_t blk[BLOCK_SAMPLES];
+    for (uint32_t i = 0; i < n; i++) {
+        float x = in ? in[i] : 0.0f;
+        if (d->mic) x = mic_agc_process(&d->agc, x, &d->cfg);
+        d->in[d->in_n++] = x;
+        if (d->in_n == BLOCK_SAMPLES) {
+            d->in_n = 0;
+            txchain_ctx_block(&d->tx, &d->p, d->in, blk);
+            d->st.voiced  += d->tx.alc.n_voice;
+            d->st.clipped += d->tx.alc.n_clip;
+            demod(d, blk);
+        }
+        out[i] = d->fifo[d->f_r];
+        d->f_r = (d->f_r + 1u) % (2u * BLOCK_SAMPLES);
+        d->f_n--;
+    }
+    d->st.ns += (plat_us() - t0) * 1000u;
+    d->st.mean_dbm = d->st.on ? (float)(d->p_sum / d->st.on) : (float)PWR_MIN_DBM;
+}
+
+void sxdsp_stats(const sxdsp_t *d, sxdsp_stats_t *st) { *st = d->st; }
+
+float *sxdsp_wav_load(const char *path, uint32_t *n) {
+    audio_t a;
+    if (!audio_load(path, &a)) { *n = 0; return NULL; }
+    *n = a.n;
+    return a.x;
+}
+
+void sxdsp_wav_free(float *x) { free(x); }
@@ -0,0 +1,55 @@
+// sxdsp.h - the firmware TX chain as a shared library, for local preview
+//
+// libsxdsp is built from the same sources as the firmware (dsp.c,
+// txchain.c, control.c) and exposes one chain instance per handle with
+// a plain C ABI for ctypes (sxdsp.py next to gui.py).  Audio goes in at
+// 8 kHz, runs through MIC AGC (src mic), bandpass, EQ, compressor and
+// the SSB / FM modulator exactly as on Core0, and the resulting sample
+// commands are received again the way a listener on the downlink would
+// hear them:
+//
+//   USB   complex envelope (PLL steps held per sample, power code) at
+//         4x, through a 150-3000 Hz single-sideband receive filter,
+//         real part, decimated back to 8 kHz
+//   FM    instantaneous frequency / deviation
+//
+// so PLL step quantisation, the power floor and clipping at txpwr are
+// heard as they go on air.  Settings come as the CDC lines the GUI sends
+// ("set", "enable", "mode", "txpwr", "src"); anything else is ignored.
+// Output is one block (32 ms) behind the input.
+
+#ifndef SXDSP_H
+#define SXDSP_H
+
+#include <stdint.h>
+
+typedef struct sxdsp sxdsp_t;
+
+typedef struct {
+    uint32_t samples;       // commands produced
+    uint32_t on;            // ... with TX gated on
+    uint32_t voiced;        // ALC measure: voiced samples
+    uint32_t clipped;       // ... at the power limit
+    uint32_t at_min;        // on at the power floor (PWR_MIN_DBM)
+    float    mean_dbm;      // mean power while on
+    float    peak;          // largest |output| sample
+    uint64_t ns;            // time spent in sxdsp_process()
+} sxdsp_stats_t;
+
+sxdsp_t *sxdsp_new(void);
+void     sxdsp_free(sxdsp_t *d);
+void     sxdsp_reset(sxdsp_t *d);                   // clear state and stats, keep settings
+
+// One CDC command line: 1 applied, 0 not a chain setting, -1 bad value
+int      sxdsp_cmd(sxdsp_t *d, const char *line);
+int      sxdsp_get(sxdsp_t *d, const char *key, float *v);    // "set" keys
+
+// n samples in (+-1.0, 8 kHz) -> n samples out; in == NULL is silence
+void     sxdsp_process(sxdsp_t *d, const float *in, float *out, uint32_t n);
+void     sxdsp_stats(const sxdsp_t *d, sxdsp_stats_t *st);
+
+// WAV file (16-bit PCM / float, any rate) as 8 kHz mono; free with sxdsp_wav_free
+float   *sxdsp_wav_load(const char *path, uint32_t *n);
+void     sxdsp_wav_free(float *x);
+
+#endif // SXDSP_H
@@ -0,0 +1,160 @@
+// sxemu.c - SX1280 behind its SPI port, for the host tools
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "sxemu.h"
+#include "platform.h"
+#include "control.h"
+#include "rssiscan.h"
+
+// BUSY time per command, us (datasheet order of magnitude)
+#define BUSY_SHORT_US   2u
+#define BUSY_CFG_US     5u
+#define BUSY_MODE_US    20u
+
+void sxemu_init(sxemu_t *e) {
+    e->mode = SXEMU_STBY;
+    e->packet_type = 0;
+    e->bw_param = 0;
+    e->steps = 0;
+    e->busy_until = e->lock_at = 0;
+    e->stale_khz = 0.0;
+    e->rng = 0x2545F491u;
+    e->cmds = e->retunes = e->rssi_reads = 0;
+    e->busy_violations = e->early_reads = e->unknown = 0;
+    if (!e->spi_hz) e->spi_hz = 18000000u;
+}
+
+static float urand(sxemu_t *e) {
+    e->rng ^= e->rng << 13;
+    e->rng ^= e->rng >> 17;
+    e->rng ^= e->rng << 5;
+    return (float)(e->rng >> 8) * (1.0f / 16777216.0f);
+}
+
+double sxemu_khz(const sxemu_t *e) {
+    return (double)e->steps * (double)PLL_STEP_HZ / 1000.0;
+}
+
+float sxemu_rx_bw_khz(const sxemu_t *e) {
+    switch (e->bw_param) {
+        case SX_GFSK_BR_0_125_BW_0_3:
+        case 0xC7:                          // 0.25 Mb/s, 0.3 MHz
+            return 300.0f;
+        case 0xAA: case 0x8B: case 0x8D:    // 0.4 / 0.5 Mb/s
+            return 600.0f;
+        default:
+            return 1200.0f;
+    }
+}
+
+float sxemu_level_dbm(const sxemu_t *e, double f_khz, uint64_t t_us) {
+    const double half = 0.5 * (double)sxemu_rx_bw_khz(e);
+    double mw = pow(10.0, (double)e->noise_dbm / 10.0);
+    for (uint32_t i = 0; i < e->n_src; i++) {
+        const sxemu_src_t *s = &e->src[i];
+        if (s->period_us) {
+            const uint64_t ph = (t_us + (uint64_t)i * 7919u) % s->period_us;
+            if ((float)ph >= s->duty * (float)s->period_us) continue;
+        }
+        double share;
+        if (s->bw_khz < 1.0f) {
+            share = fabs(s->f_khz - f_khz) <= half ? 1.0 : 0.0;
+        } else {
+            const double lo = fmax(s->f_khz - 0.5 * s->bw_khz, f_khz - half);
+            const double hi = fmin(s->f_khz + 0.5 * s->bw_khz, f_khz + half);
+            share = hi > lo ? (hi - lo) / (double)s->bw_khz : 0.0;
+        }
+        mw += share * pow(10.0, (double)s->dbm / 10.0);
+    }
+    return (float)(10.0 * log10(mw));
+}
+
+bool sxemu_busy(void *ctx) {
+    const sxemu_t *e = (const sxemu_t *)ctx;
+    return plat_us() < e->busy_until;
+}
+
+void sxemu_xfer(const uint8_t *tx, uint8_t *rx, uint32_t n, void *ctx) {
+    sxemu_t *e = (sxemu_t *)ctx;
+    if (rx) memset(rx, 0, n);
+    if (!n) return;
+
+    if (plat_us() < e->busy_until) e->busy_violations++;
+    if (e->spend) e->spend(n * 8u * 1000000000u / e->spi_hz + 300u);
+    const uint64_t now = plat_us();
+    e->cmds++;
+
+    uint32_t busy = 0;
+    switch (tx[0]) {
+    case 0x80:                                          // SetStandby
+        e->mode = SXEMU_STBY;
+        busy = BUSY_SHORT_US;
+        break;
+    case SX_OP_SET_PACKET_TYPE:
+        if (n >= 2) e->packet_type = tx[1];
+        busy = BUSY_CFG_US;
+        break;
+    case SX_OP_SET_MOD_PARAMS:
+        if (n >= 2) e->bw_param = tx[1];
+        busy = BUSY_CFG_US;
+        break;
+    case SX_OP_SET_RF_FREQUENCY:
+        if (n >= 4) {
+            if (e->mode == SXEMU_RX) {
+                // RSSI keeps following the old frequency until relocked
+                if (now >= e->lock_at) e->stale_khz = sxemu_khz(e);
+                e->lock_at = now + e->lock_us;
+            }
+            e->steps = ((uint32_t)tx[1] << 16) | ((uint32_t)tx[2] << 8) | tx[3];
+            e->retunes++;
+        }
+        busy = BUSY_SHORT_US;
+        break;
+    case SX_OP_SET_RX:
+        e->mode = SXEMU_RX;
+        e->stale_khz = 0.0;                             // nothing yet: floor
+        e->lock_at = now + e->lock_us;
+        busy = BUSY_MODE_US;
+        break;
+    case 0x8E:                                          // SetTxParams
+        busy = BUSY_SHORT_US;
+        break;
+    case 0xD1:                                          // SetTxContinuousWave
+        e->mode = SXEMU_TX;
+        busy = BUSY_MODE_US;
+        break;
+    case 0xC0:                                          // GetStatus
+        if (rx && n >= 2) {
+            static const uint8_t m[] = { 2, 4, 5, 6 };  // STDBY_RC, FS, RX, TX
+            rx[1] = (uint8_t)(m[e->mode] << 5);
+        }
+        break;
+    case SX_OP_GET_RSSI_INST:
+        e->rssi_reads++;
+        if (rx && n >= 3) {
+            float dbm;
+            if (e->mode != SXEMU_RX) {
+                dbm = -127.5f;
+            } else if (now < e->lock_at) {
+                e->early_reads++;
+                dbm = e->stale_khz > 0.0 ? sxemu_level_dbm(e, e->stale_khz, now) : e->noise_dbm;
+            } else {
+                dbm = sxemu_level_dbm(e, sxemu_khz(e), now);
+            }
+            dbm += 1.5f * (urand(e) + urand(e) - 1.0f);   // measurement spread
+            long v = lroundf(-2.0f * dbm);
+            if (v < 0) v = 0;
+            if (v > 255) v = 255;
+            rx[2] = (uint8_t)v;
+        }
+        break;
+    default:
+        e->unknown++;
+        break;
+    }
+    e->busy_until = plat_us() + busy;
+}
@@ -0,0 +1,72 @@
+// sxemu.h - SX1280 behind its SPI port, for the host tools
+//
+// Decodes the command frames the firmware sends (standby, packet type,
+// modulation, SetRfFrequency, SetRx, GetRssiInst), drives BUSY for the
+// time each command keeps the chip busy and answers GetRssiInst from a
+// made-up band: a noise floor plus sources that are on continuously or
+// in bursts.  The receiver integrates every source inside its filter;
+// after a retune in RX the PLL needs lock_us, and until then RssiInst
+// still shows the old frequency.  Counts the protocol errors a driver
+// can make: commands sent while BUSY and RSSI read before lock.
+//
+// Time is plat_us(); a simulated clock can pass `spend` to be advanced
+// by the SPI transfer time of each frame.
+
+#ifndef SXEMU_H
+#define SXEMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    double   f_khz;         // centre
+    float    bw_khz;        // occupied width (power spread evenly)
+    float    dbm;           // total power while on
+    uint32_t period_us;     // 0 = continuous
+    float    duty;          // share of period_us it is on
+} sxemu_src_t;
+
+typedef struct {
+    // Setup
+    const sxemu_src_t *src;
+    uint32_t n_src;
+    float    noise_dbm;     // in the receive filter
+    uint32_t lock_us;       // PLL relock after SetRfFrequency in RX
+    uint32_t spi_hz;
+    void   (*spend)(uint32_t ns);
+
+    // Chip state
+    uint8_t  mode;          // SXEMU_* below
+    uint8_t  packet_type, bw_param;
+    uint32_t steps;
+    uint64_t busy_until, lock_at;
+    double   stale_khz;     // what RSSI shows until the PLL locks
+    uint32_t rng;
+
+    // Counters
+    uint32_t cmds, retunes, rssi_reads;
+    uint32_t busy_violations;   // frame started while BUSY was high
+    uint32_t early_reads;       // GetRssiInst before lock
+    uint32_t unknown;
+} sxemu_t;
+
+#define SXEMU_STBY  0
+#define SXEMU_FS    1
+#define SXEMU_RX    2
+#define SXEMU_TX    3
+
+void  sxemu_init(sxemu_t *e);                   // keeps the setup fields
+
+// scan_backend_t hooks; ctx is the sxemu_t
+void  sxemu_xfer(const uint8_t *tx, uint8_t *rx, uint32_t n, void *ctx);
+bool  sxemu_busy(void *ctx);
+
+// Receive filter width (kHz) of the current modulation parameters
+float sxemu_rx_bw_khz(const sxemu_t *e);
+
+// Level in the receive filter at f_khz and time t_us, no measurement noise
+float sxemu_level_dbm(const sxemu_t *e, double f_khz, uint64_t t_us);
+
+double sxemu_khz(const sxemu_t *e);             // tuned frequency
+
+#endif // SXEMU_H
@@ -0,0 +1,423 @@
+// sxopt.c - automatic DSP parameter search against simulated RF metrics
+//
+//   sxopt [-j N] [--gens G] [--pop L] [--sigma S] [--seed N] [--txpwr DBM]
+//         [--base "key=val,..."] [--param key=lo:hi]...
+//         [--obw-min HZ] [--obw-max HZ] [--osb-max DB] [--imd-max DBC]
+//         [--w-obw W] [--w-osb W] [--w-imd W] [-o preset.txt] [file.wav ...]
+//
+// Every candidate audio_cfg_t runs through the real TX chain (USB) twice:
+// once on the speech material (WAV files, or a built-in synthetic voice
+// when none are given) and once on a 700 + 1900 Hz two-tone.  The sample
+// commands go through the RF model (rfmodel.h) and are scored as
+//
+//   mean power (dBm)  - w_obw * 99 % occupied bandwidth outside
+//                               [obw_min, obw_max] (per 100 Hz)
+//                     - w_osb * excess opposite-sideband level (dB)
+//                     - w_imd * excess two-tone IMD3 (dBc)
+//
+// so the search buys average power only inside the bandwidth, sideband
+// and linearity limits (the lower bandwidth bound keeps it from buying
+// them by cutting the voice band).  The optimiser is a (1+lambda) evolution
+// strategy in normalised parameter space with 1/5-success step-size
+// control; each generation's lambda candidates are evaluated on a pool
+// of threads, each with its own txchain_t and RF accumulator.  Results
+// do not depend on -j.  The winner is written as a preset: "set" lines
+// that can be sent over CDC as they are (gui.py "Load Preset...").
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+#include "hostutil.h"
+#include "rfmodel.h"
+
+// ---------------- Search space ----------------
+#define MAX_PARAMS      16
+#define MAX_POP         256
+
+typedef struct {
+    const char *key;
+    float lo, hi;
+} param_t;
+
+// Default dimensions: the knobs that trade loudness against splatter
+static const param_t default_params[] = {
+    { "bp_lo",       50.0f,  500.0f },
+    { "bp_hi",     2000.0f, 3200.0f },
+    { "eq_low_db",  -12.0f,    6.0f },
+    { "eq_high_hz", 800.0f, 2500.0f },
+    { "eq_high_db",   0.0f,   18.0f },
+    { "comp_thr",   -30.0f,    0.0f },
+    { "comp_ratio",   1.0f,   12.0f },
+    { "comp_knee",    0.0f,   24.0f },
+    { "comp_makeup",  0.0f,   20.0f },
+    { "amp_gain",     0.5f,    5.0f },
+};
+
+static param_t params[MAX_PARAMS];
+static int     n_params;
+
+static audio_cfg_t base_cfg;
+
+// Normalised point -> config
+static void point_cfg(const float *x, audio_cfg_t *c) {
+    *c = base_cfg;
+    for (int d = 0; d < n_params; d++)
+        cfg_set_key(c, params[d].key, params[d].lo + x[d] * (params[d].hi - params[d].lo));
+    cfg_sanitize(c, (float)WAV_SAMPLE_RATE);
+}
+
+// ---------------- Scoring ----------------
+#define TT_F1_HZ        700.0f
+#define TT_F2_HZ        1900.0f
+#define TT_AMPL         0.5f            // peak of the two-tone at the input
+#define TT_SECONDS      2u
+#define TT_SETTLE       16u             // blocks before the RF model listens
+#define TONE_TOL_HZ     40.0f           // Hann main lobe + PLL step dither
+
+static int8_t tx_pwr = PWR_MAX_DBM;
+static float  obw_min = 2200.0f, obw_max = 2800.0f, osb_max = -25.0f, imd_max = -25.0f;
+static float  w_obw = 1.0f, w_osb = 1.0f, w_imd = 1.0f;
+
+static audio_t speech, twotone;
+
+typedef struct {
+    float score;
+    float pmean;    // dBm, speech
+    float obw;      // Hz, speech, 99 %
+    float osb;      // dB, speech, LSB / USB power in the voice band
+    float imd;      // dBc, two-tone, worse IMD3 product vs one tone
+} metrics_t;
+
+typedef struct {
+    txchain_t t;
+    rf_acc_t  rf;
+} worker_ctx_t;
+
+static void run(worker_ctx_t *w, const audio_cfg_t *c, const audio_t *a, uint32_t settle) {
+    const tx_params_t p = {
+        .mode = TXM_USB, .tx_req = 1, .pwr_max_dbm = tx_pwr, .fm_dev_hz = 2500.0f,
+    };
+    float in[BLOCK_SAMPLES];
+    sample_cmd_t blk[BLOCK_SAMPLES];
+
+    txchain_ctx_init(&w->t, c);
+    rf_reset(&w->rf);
+    for (uint32_t pos = 0, b = 0; pos < a->n; pos += BLOCK_SAMPLES, b++) {
+        for (uint32_t i = 0; i < BLOCK_SAMPLES; i++)
+            in[i] = (pos + i < a->n) ? a->x[pos + i] : 0.0f;
+        txchain_ctx_block(&w->t, &p, in, blk);
+        if (b >= settle) rf_push(&w->rf, blk, BLOCK_SAMPLES, 0);
+    }
+}
+
+static float db(double x) { return 10.0f * log10f((float)(x > 1e-12 ? x : 1e-12)); }
+
+static void evaluate(worker_ctx_t *w, const audio_cfg_t *c, metrics_t *m) {
+    run(w, c, &speech, 0);
+    m->pmean = rf_mean_dbm(&w->rf);
+    m->obw = rf_obw(&w->rf, 0.99f, NULL, NULL);
+    m->osb = db(rf_band(&w->rf, -3000.0f, -200.0f)) - db(rf_band(&w->rf, 200.0f, 3000.0f));
+
+    run(w, c, &twotone, TT_SETTLE);
+    const double t1 = rf_band(&w->rf, TT_F1_HZ - TONE_TOL_HZ, TT_F1_HZ + TONE_TOL_HZ);
+    const double t2 = rf_band(&w->rf, TT_F2_HZ - TONE_TOL_HZ, TT_F2_HZ + TONE_TOL_HZ);
+    const float  lo3 = 2.0f * TT_F1_HZ - TT_F2_HZ, hi3 = 2.0f * TT_F2_HZ - TT_F1_HZ;
+    const double i3 = fmax(rf_band(&w->rf, lo3 - TONE_TOL_HZ, lo3 + TONE_TOL_HZ),
+                           rf_band(&w->rf, hi3 - TONE_TOL_HZ, hi3 + TONE_TOL_HZ));
+    m->imd = db(i3) - db(0.5 * (t1 + t2));
+
+    m->score = m->pmean
+             - w_obw * (fmaxf(0.0f, m->obw - obw_max) + fmaxf(0.0f, obw_min - m->obw)) / 100.0f
+             - w_osb * fmaxf(0.0f, m->osb - osb_max)
+             - w_imd * fmaxf(0.0f, m->imd - imd_max);
+}
+
+// ---------------- Stimuli ----------------
+static bool make_twotone(audio_t *a) {
+    a->n = TT_SECONDS * WAV_SAMPLE_RATE;
+    a->x = malloc(sizeof(float) * a->n);
+    if (!a->x) return false;
+    for (uint32_t i = 0; i < a->n; i++) {
+        const float t = (float)i / (float)WAV_SAMPLE_RATE;
+        a->x[i] = 0.5f * TT_AMPL * (sinf(2.0f * (float)M_PI * TT_F1_HZ * t) +
+                                    sinf(2.0f * (float)M_PI * TT_F2_HZ * t));
+    }
+    return true;
+}
+
+// Voiced syllables: glottal-like harmonic series (1/k) on a gliding
+// 110-190 Hz pitch, 220 ms on / 90 ms off, raised-cosine shaped, with a
+// slow level walk so the compressor has something to do.
+static bool make_voice(audio_t *a, uint32_t seconds) {
+    a->n = seconds * WAV_SAMPLE_RATE;
+    a->x = malloc(sizeof(float) * a->n);
+    if (!a->x) return false;
+    const float fs = (float)WAV_SAMPLE_RATE;
+    const uint32_t syl = (uint32_t)(0.22f * fs), gap = (uint32_t)(0.09f * fs);
+    float ph = 0.0f;
+    for (uint32_t i = 0; i < a->n; i++) {
+        const uint32_t k = i / (syl + gap), pos = i % (syl + gap);
+        const float f0 = 150.0f + 40.0f * sinf(0.7f * (float)k + 0.05f * (float)pos / fs * 40.0f);
+        const float lvl = 0.35f * (1.0f + 0.6f * sinf(0.37f * (float)k));
+        ph += 2.0f * (float)M_PI * f0 / fs;
+        if (ph > 2.0f * (float)M_PI) ph -= 2.0f * (float)M_PI;
+        float v = 0.0f;
+        for (int h = 1; h * f0 < 3600.0f; h++) v += sinf((float)h * ph) / (float)h;
+        const float env = (pos < syl) ? 0.5f * (1.0f - cosf(2.0f * (float)M_PI * (float)pos / (float)syl)) : 0.0f;
+        a->x[i] = 0.25f * lvl * env * v;
+    }
+    return true;
+}
+
+// Concatenate the WAV files into one speech buffer
+static bool load_speech(char **files, int n_files) {
+    for (int f = 0; f < n_files; f++) {
+        audio_t a;
+        if (!audio_load(files[f], &a)) return false;
+        float *x = realloc(speech.x, sizeof(float) * (speech.n + a.n));
+        if (!x) { audio_free(&a); return false; }
+        memcpy(x + speech.n, a.x, sizeof(float) * a.n);
+        speech.x = x;
+        speech.n += a.n;
+        audio_free(&a);
+    }
+    return true;
+}
+
+// ---------------- Parallel evaluation ----------------
+static worker_ctx_t *ctxs;
+static long          n_threads;
+static audio_cfg_t   cand_cfg[MAX_POP];
+static metrics_t     cand_m[MAX_POP];
+static int           n_cand;
+static atomic_int    next_cand;
+
+static void *worker(void *arg) {
+    worker_ctx_t *w = arg;
+    for (int k; (k = atomic_fetch_add(&next_cand, 1)) < n_cand; )
+        evaluate(w, &cand_cfg[k], &cand_m[k]);
+    return NULL;
+}
+
+static void evaluate_all(int n) {
+    pthread_t th[64];
+    const long nt = (n_threads < n) ? n_threads : n;
+    n_cand = n;
+    atomic_store(&next_cand, 0);
+    for (long i = 0; i < nt; i++) pthread_create(&th[i], NULL, worker, &ctxs[i]);
+    for (long i = 0; i < nt; i++) pthread_join(th[i], NULL);
+}
+
+// ---------------- Optimiser ----------------
+static uint64_t rng_state = 0x2545F4914F6CDD1Dull;
+
+static double rnd_u(void) {
+    rng_state ^= rng_state << 13; rng_state ^= rng_state >> 7; rng_state ^= rng_state << 17;
+    return (double)(rng_state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static float rnd_n(void) {
+    double u1 = rnd_u(), u2 = rnd_u();
+    if (u1 < 1e-300) u1 = 1e-300;
+    return (float)(sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2));
+}
+
+static void print_metrics(const char *what, const metrics_t *m) {
+    printf("%-10s score %6.2f  pmean %6.2f dBm  obw %5.0f Hz  osb %6.1f dB  imd3 %6.1f dBc\n",
+           what, (double)m->score, (double)m->pmean, (double)m->obw, (double)m->osb, (double)m->imd);
+}
+
+// Everything the DSP search can touch; mic_* stay with the user
+static const char *const preset_keys[] = {
+    "bp_lo", "bp_hi", "bp_stages", "eq_low_hz", "eq_low_db", "eq_high_hz", "eq_high_db",
+    "comp_thr", "comp_ratio", "comp_att", "comp_rel", "comp_makeup", "comp_knee",
+    "comp_outlim", "comp_la", "amp_gain",
+};
+
+static bool write_preset(const char *path, const audio_cfg_t *c, const metrics_t *m) {
+    FILE *f = fopen(path, "w");
+    if (!f) { perror(path); return false; }
+    fprintf(f, "# sxopt preset: score %.2f, pmean %.2f dBm, obw %.0f Hz, osb %.1f dB, imd3 %.1f dBc\n",
+            (double)m->score, (double)m->pmean, (double)m->obw, (double)m->osb, (double)m->imd);
+    for (size_t k = 0; k < sizeof(preset_keys) / sizeof(preset_keys[0]); k++) {
+        float v = 0.0f;
+        cfg_get_key(c, preset_keys[k], &v);
+        fprintf(f, "set %s %.4g\n", preset_keys[k], (double)v);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool add_param(const char *spec) {
+    char key[32];
+    float lo, hi;
+    if (n_params >= MAX_PARAMS) { fprintf(stderr, "too many --param\n"); return false; }
+    if (sscanf(spec, "%31[^=]=%f:%f", key, &lo, &hi) != 3 || hi <= lo) {
+        fprintf(stderr, "--param wants key=lo:hi, got '%s'\n", spec);
+        return false;
+    }
+    audio_cfg_t probe = base_cfg;
+    if (!cfg_set_key(&probe, key, lo)) { fprintf(stderr, "--param: unknown key %s\n", key); return false; }
+    params[n_params].key = strdup(key);
+    params[n_params].lo = lo;
+    params[n_params].hi = hi;
+    n_params++;
+    return true;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "usage: sxopt [-j N] [--gens G] [--pop L] [--sigma S] [--seed N] [--txpwr DBM]\n"
+        "             [--base \"key=val,...\"] [--param key=lo:hi]...\n"
+        "             [--obw-min HZ] [--obw-max HZ] [--osb-max DB] [--imd-max DBC]\n"
+        "             [--w-obw W] [--w-osb W] [--w-imd W] [-o preset.txt] [file.wav ...]\n");
+}
+
+int main(int argc, char **argv) {
+    static const audio_cfg_t defaults = AUDIO_CFG_DEFAULTS;
+    int gens = 30, pop = 16;
+    float sigma = 0.15f;
+    const char *out = NULL;
+    char **files = calloc((size_t)argc, sizeof(*files));
+    int n_files = 0;
+    if (!files) return 1;
+
+    n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    base_cfg = defaults;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (a[0] != '-') { files[n_files++] = argv[i]; continue; }
+        if (!v) { fprintf(stderr, "missing value for %s\n", a); usage(); return 2; }
+        i++;
+        if      (!strcmp(a, "-j"))        n_threads = atol(v);
+        else if (!strcmp(a, "-o"))        out = v;
+        else if (!strcmp(a, "--gens"))    gens = atoi(v);
+        else if (!strcmp(a, "--pop"))     pop = atoi(v);
+        else if (!strcmp(a, "--sigma"))   sigma = (float)atof(v);
+        else if (!strcmp(a, "--seed"))    rng_state ^= (uint64_t)strtoull(v, NULL, 0) * 0x9E3779B97F4A7C15ull;
+        else if (!strcmp(a, "--obw-min")) obw_min = (float)atof(v);
+        else if (!strcmp(a, "--obw-max")) obw_max = (float)atof(v);
+        else if (!strcmp(a, "--osb-max")) osb_max = (float)atof(v);
+        else if (!strcmp(a, "--imd-max")) imd_max = (float)atof(v);
+        else if (!strcmp(a, "--w-obw"))   w_obw = (float)atof(v);
+        else if (!strcmp(a, "--w-osb"))   w_osb = (float)atof(v);
+        else if (!strcmp(a, "--w-imd"))   w_imd = (float)atof(v);
+        else if (!strcmp(a, "--base"))  { if (!cfg_parse_spec(v, &base_cfg)) return 2; }
+        else if (!strcmp(a, "--param")) { if (!add_param(v)) return 2; }
+        else if (!strcmp(a, "--txpwr")) {
+            int d = atoi(v);
+            if (d < PWR_MIN_DBM || d > PWR_MAX_DBM) { fprintf(stderr, "txpwr out of range\n"); return 2; }
+            tx_pwr = (int8_t)d;
+        } else { fprintf(stderr, "unknown option %s\n", a); usage(); return 2; }
+    }
+    if (pop < 1 || pop > MAX_POP || gens < 0 || sigma <= 0.0f) { usage(); return 2; }
+    if (n_threads < 1) n_threads = 1;
+    if (n_threads > 64) n_threads = 64;
+
+    if (n_params == 0) {
+        n_params = (int)(sizeof(default_params) / sizeof(default_params[0]));
+        memcpy(params, default_params, sizeof(default_params));
+    }
+
+    if (n_files ? !load_speech(files, n_files) : !make_voice(&speech, 8u)) return 1;
+    if (!make_twotone(&twotone)) return 1;
+    if (speech.n < RF_NFFT) { fprintf(stderr, "speech material too short\n"); return 1; }
+
+    ctxs = malloc(sizeof(*ctxs) * (size_t)n_threads);
+    if (!ctxs) return 1;
+
+    printf("%d parameters, pop %d, %d generations, %ld threads, %.1f s speech%s\n",
+           n_params, pop, gens, n_threads, (double)speech.n / WAV_SAMPLE_RATE,
+           n_files ? "" : " (synthetic)");
+
+    // Start from the base config, clamped into the search box
+    float parent[MAX_PARAMS];
+    for (int d = 0; d < n_params; d++) {
+        float v = params[d].lo;
+        cfg_get_key(&base_cfg, params[d].key, &v);
+        v = (v - params[d].lo) / (params[d].hi - params[d].lo);
+        parent[d] = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+    }
+
+    cand_cfg[0] = base_cfg;
+    cfg_sanitize(&cand_cfg[0], (float)WAV_SAMPLE_RATE);
+    point_cfg(parent, &cand_cfg[1]);
+    evaluate_all(2);
+    print_metrics("base", &cand_m[0]);
+    print_metrics("start", &cand_m[1]);
+
+    metrics_t best_m = cand_m[1];
+    audio_cfg_t best_cfg = cand_cfg[1];
+    bool best_is_base = false;
+    if (cand_m[0].score > best_m.score) {
+        best_m = cand_m[0];
+        best_cfg = cand_cfg[0];
+        best_is_base = true;
+    }
+
+    const uint64_t t0 = plat_us();
+    float kids[MAX_POP][MAX_PARAMS];
+    for (int g = 0; g < gens; g++) {
+        for (int k = 0; k < pop; k++) {
+            for (int d = 0; d < n_params; d++) {
+                float x = parent[d] + sigma * rnd_n();
+                kids[k][d] = x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+            }
+            point_cfg(kids[k], &cand_cfg[k]);
+        }
+        evaluate_all(pop);
+
+        int wins = 0, bk = -1;
+        for (int k = 0; k < pop; k++) {
+            if (cand_m[k].score > best_m.score) {
+                wins++;
+                if (bk < 0 || cand_m[k].score > cand_m[bk].score) bk = k;
+            }
+        }
+        if (bk >= 0) {
+            memcpy(parent, kids[bk], sizeof(float) * (size_t)n_params);
+            best_m = cand_m[bk];
+            best_cfg = cand_cfg[bk];
+            best_is_base = false;
+        }
+
+        // 1/5 success rule: widen while children keep winning, else narrow
+        sigma *= ((float)wins / (float)pop > 0.2f) ? 1.22f : 0.82f;
+        if (sigma < 0.005f) sigma = 0.005f;
+        if (sigma > 0.5f) sigma = 0.5f;
+
+        char what[16];
+        snprintf(what, sizeof(what), "gen %d", g + 1);
+        printf("%-6s sigma %.3f  wins %2d  ", what, (double)sigma, wins);
+        print_metrics("best", &best_m);
+        fflush(stdout);
+    }
+    const double secs = (double)(plat_us() - t0) * 1e-6;
+
+    printf("%d evaluations in %.1f s\n", gens * pop, secs);
+    print_metrics(best_is_base ? "base kept" : "final", &best_m);
+    for (int d = 0; d < n_params && !best_is_base; d++)
+        printf("  %-12s %8.2f\n", params[d].key,
+               (double)(params[d].lo + parent[d] * (params[d].hi - params[d].lo)));
+
+    if (out && !write_preset(out, &best_cfg, &best_m)) return 1;
+    if (out) printf("preset written to %s\n", out);
+
+    audio_free(&speech);
+    audio_free(&twotone);
+    free(ctxs);
+    free(files);
+    return 0;
+}
@@ -0,0 +1,235 @@
+// sxrender.c - offline batch renderer: WAV files x DSP variants -> sample commands
+//
+//   sxrender [-j N] [-o DIR] [--csv] [--mode usb|fm] [--txpwr DBM]
+//            [--variant "key=val,key=val" ...] file.wav ...
+//
+// Every (file, variant) pair is one job.  A pool of worker threads runs
+// the real TX chain on each job with its own txchain_t, so N jobs render
+// on N cores with no shared state.  Variants use the CDC "set" key names
+// (comp_ratio=4,eq_high_db=8, ...); no --variant renders the defaults.
+//
+// Input is 16-bit PCM or 32-bit float WAV, any rate and channel count:
+// channels are mixed down and the audio is resampled to 8 kHz (Hermite
+// cubic after a windowed-sinc anti-alias lowpass).  With -o, each job
+// writes DIR/<file>.v<k>.cmd (8-byte little-endian records: int32
+// freq_steps relative to the carrier, int8 p_dbm, uint8 tx_on, uint8
+// freq_frac (1/256 step on top), 1 pad byte) or .csv with --csv.  A summary line per job goes to stdout.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+#include "hostutil.h"
+
+// ---------------- Options ----------------
+#define MAX_VARIANTS    64
+
+static const char  *out_dir;
+static bool         out_csv;
+static uint8_t      tx_mode = TXM_USB;
+static int8_t       tx_pwr = PWR_MAX_DBM;
+static audio_cfg_t  variants[MAX_VARIANTS];
+static const char  *variant_spec[MAX_VARIANTS];
+static int          n_variants;
+
+// "key=val,key=val" on top of the defaults
+static bool parse_variant(const char *spec, audio_cfg_t *c) {
+    static const audio_cfg_t defaults = AUDIO_CFG_DEFAULTS;
+    *c = defaults;
+    return cfg_parse_spec(spec, c);
+}
+
+// ---------------- Jobs ----------------
+typedef struct {
+    int      file, variant;
+    bool     ok;
+    uint32_t n, on, at_max, at_min;
+    double   psum, fsum, fsumsq;
+    uint32_t voiced, clipped;
+    double   secs;
+} job_t;
+
+static const char **files;
+static audio_t     *audio;
+static job_t       *jobs;
+static int          n_jobs;
+static atomic_int   next_job;
+
+static const char *base_name(const char *path) {
+    const char *s = strrchr(path, '/');
+    return s ? s + 1 : path;
+}
+
+static void render(txchain_t *t, job_t *j) {
+    const audio_t *a = &audio[j->file];
+    FILE *out = NULL;
+
+    if (out_dir) {
+        char name[1024];
+        snprintf(name, sizeof(name), "%s/%s.v%d.%s", out_dir, base_name(files[j->file]),
+                 j->variant, out_csv ? "csv" : "cmd");
+        out = fopen(name, out_csv ? "w" : "wb");
+        if (!out) { perror(name); return; }
+        if (out_csv) fprintf(out, "freq_steps,p_dbm,tx_on,freq_frac\n");
+    }
+
+    tx_params_t p = {
+        .mode = tx_mode, .tx_req = 1, .guard = 0, .roger_beep = 0,
+        .pwr_max_dbm = tx_pwr, .fm_dev_hz = 2500.0f, .ctcss_hz = 0.0f,
+        .base_steps = 0, .fine_hz = 0.0f,
+    };
+    txchain_ctx_init(t, &variants[j->variant]);
+
+    const uint64_t t0 = plat_us();
+    float in[BLOCK_SAMPLES];
+    sample_cmd_t blk[BLOCK_SAMPLES];
+
+    for (uint32_t pos = 0; pos < a->n; pos += BLOCK_SAMPLES) {
+        for (uint32_t i = 0; i < BLOCK_SAMPLES; i++)
+            in[i] = (pos + i < a->n) ? a->x[pos + i] : 0.0f;
+        txchain_ctx_block(t, &p, in, blk);
+        j->voiced  += t->alc.n_voice;
+        j->clipped += t->alc.n_clip;
+
+        for (uint32_t i = 0; i < BLOCK_SAMPLES; i++) {
+            const sample_cmd_t *c = &blk[i];
+            j->n++;
+            if (c->tx_on) {
+                j->on++;
+                j->psum += c->p_dbm;
+                const double f = (double)sample_cmd_q8(c, 0) / FREQ_FRAC_ONE;
+                j->fsum += f;
+                j->fsumsq += f * f;
+                if (c->p_dbm >= tx_pwr) j->at_max++;
+                if (c->p_dbm <= PWR_MIN_DBM) j->at_min++;
+            }
+            if (!out) continue;
+            if (out_csv) {
+                fprintf(out, "%ld,%d,%u,%u\n", (long)c->freq_steps, c->p_dbm, c->tx_on, c->freq_frac);
+            } else {
+                const uint32_t u = (uint32_t)c->freq_steps;
+                const uint8_t rec[8] = { (uint8_t)u, (uint8_t)(u >> 8), (uint8_t)(u >> 16),
+                                         (uint8_t)(u >> 24), (uint8_t)c->p_dbm, c->tx_on, c->freq_frac, 0 };
+                fwrite(rec, 1, sizeof(rec), out);
+            }
+        }
+    }
+    j->secs = (double)(plat_us() - t0) * 1e-6;
+    j->ok = true;
+    if (out) fclose(out);
+}
+
+static void *worker(void *arg) {
+    (void)arg;
+    // ~3 KB of filter / Hilbert state per chain, one per thread
+    txchain_t *t = malloc(sizeof(*t));
+    if (!t) return NULL;
+    for (int k; (k = atomic_fetch_add(&next_job, 1)) < n_jobs; )
+        if (audio[jobs[k].file].x) render(t, &jobs[k]);
+    free(t);
+    return NULL;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "usage: sxrender [-j N] [-o DIR] [--csv] [--mode usb|fm] [--txpwr DBM]\n"
+        "                [--variant \"key=val,...\"]... file.wav ...\n");
+}
+
+int main(int argc, char **argv) {
+    long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int n_files = 0;
+    files = calloc((size_t)argc, sizeof(*files));
+    if (!files) return 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (a[0] != '-') { files[n_files++] = a; continue; }
+        if (!strcmp(a, "--csv")) { out_csv = true; continue; }
+        if (!v) { fprintf(stderr, "missing value for %s\n", a); usage(); return 2; }
+        i++;
+        if (!strcmp(a, "-j")) n_threads = atol(v);
+        else if (!strcmp(a, "-o")) out_dir = v;
+        else if (!strcmp(a, "--txpwr")) {
+            int d = atoi(v);
+            if (d < PWR_MIN_DBM || d > PWR_MAX_DBM) { fprintf(stderr, "txpwr out of range\n"); return 2; }
+            tx_pwr = (int8_t)d;
+        } else if (!strcmp(a, "--mode")) {
+            if (streqi(v, "usb")) tx_mode = TXM_USB;
+            else if (streqi(v, "fm")) tx_mode = TXM_FM;
+            else { fprintf(stderr, "mode must be usb or fm\n"); return 2; }
+        } else if (!strcmp(a, "--variant")) {
+            if (n_variants >= MAX_VARIANTS) { fprintf(stderr, "too many variants\n"); return 2; }
+            if (!parse_variant(v, &variants[n_variants])) return 2;
+            variant_spec[n_variants++] = v;
+        } else { fprintf(stderr, "unknown option %s\n", a); usage(); return 2; }
+    }
+    if (n_files == 0) { usage(); return 2; }
+    if (n_variants == 0) {
+        parse_variant("", &variants[0]);
+        variant_spec[n_variants++] = "defaults";
+    }
+
+    audio = calloc((size_t)n_files, sizeof(*audio));
+    n_jobs = n_files * n_variants;
+    jobs = calloc((size_t)n_jobs, sizeof(*jobs));
+    if (!audio || !jobs) return 1;
+
+    for (int f = 0; f < n_files; f++)
+        if (!audio_load(files[f], &audio[f])) fprintf(stderr, "%s: skipped\n", files[f]);
+    for (int k = 0; k < n_jobs; k++) {
+        jobs[k].file = k / n_variants;
+        jobs[k].variant = k % n_variants;
+    }
+
+    if (n_threads > n_jobs) n_threads = n_jobs;
+    if (n_threads < 1) n_threads = 1;
+    pthread_t *th = calloc((size_t)n_threads, sizeof(*th));
+    if (!th) return 1;
+
+    const uint64_t t0 = plat_us();
+    for (long i = 0; i < n_threads; i++) pthread_create(&th[i], NULL, worker, NULL);
+    for (long i = 0; i < n_threads; i++) pthread_join(th[i], NULL);
+    const double wall = (double)(plat_us() - t0) * 1e-6;
+
+    printf("file                     var  secs   on%%   pmean  at-max%% at-min%% clip%%  fmean   fstd   speed\n");
+    int failed = 0;
+    double audio_s = 0.0;
+    for (int k = 0; k < n_jobs; k++) {
+        const job_t *j = &jobs[k];
+        if (!j->ok) { failed++; continue; }
+        const double secs = (double)j->n / WAV_SAMPLE_RATE;
+        const double on = j->on ? (double)j->on : 1.0;
+        const double fm = j->fsum / on;
+        const double var = j->fsumsq / on - fm * fm;
+        audio_s += secs;
+        printf("%-24.24s %3d %6.1f %5.1f %6.1f  %6.1f  %6.1f %5.1f %6.0f %6.0f %6.0fx\n",
+               base_name(files[j->file]), j->variant, secs, 100.0 * j->on / (j->n ? j->n : 1),
+               j->on ? j->psum / on : (double)PWR_MIN_DBM,
+               100.0 * j->at_max / on, 100.0 * j->at_min / on,
+               j->voiced ? 100.0 * j->clipped / j->voiced : 0.0,
+               fm * PLL_STEP_HZ, sqrt(var > 0.0 ? var : 0.0) * PLL_STEP_HZ,
+               j->secs > 0.0 ? secs / j->secs : 0.0);
+    }
+    for (int v = 0; v < n_variants && n_variants > 1; v++)
+        printf("v%d = %s\n", v, variant_spec[v]);
+    printf("%d jobs, %ld threads, %.1f s audio in %.2f s (%.0fx realtime)\n",
+           n_jobs - failed, n_threads, audio_s, wall, wall > 0.0 ? audio_s / wall : 0.0);
+
+    free(th);
+    for (int f = 0; f < n_files; f++) audio_free(&audio[f]);
+    free(audio);
+    free(jobs);
+    free(files);
+    return failed ? 1 : 0;
+}
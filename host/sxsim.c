@@ -0,0 +1,584 @@
+// sxsim.c - host-built firmware simulator behind a pseudo-terminal
+//
+// Runs the firmware's portable logic (control.c, txchain.c, dsp.c) natively
+// and exposes the CDC command protocol on a pty, so gui.py and scripts can
+// talk to it exactly like to /dev/ttyACM0.  The radio side is a simulated
+// Core1 that drains the block queue at 8 kHz wall-clock rate.
+//
+//   sxsim [--link PATH] [--audio two-tone|tone:HZ|noise|silence] [--usb-rate HZ] [--clock-ppm P] [-v]
+//   sxsim --load [--count N] [--push N]
+//
+// --load runs the device in a thread, connects to its own pty as a client
+// and reports command round-trip latency and status-push throughput.
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "platform.h"
+#include "control.h"
+#include "txchain.h"
+#include "freqdisc.h"
+#include "farrow.h"
+#include "txsched.h"
+#include "cmdlat.h"
+#include "specmask.h"
+#include "rssiscan.h"
+#include "sxemu.h"
+
+// ==========================================================
+// Platform hooks
+// ==========================================================
+static struct timespec t0;
+static int  pty_master = -1;
+static bool verbose = false;
+static volatile bool running = true;
+
+static uint32_t tx_dropped_bytes = 0;
+
+uint64_t plat_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)(ts.tv_sec - t0.tv_sec) * 1000000ull +
+           (uint64_t)((ts.tv_nsec - t0.tv_nsec) / 1000);
+}
+
+uint32_t plat_ms(void) { return (uint32_t)(plat_us() / 1000u); }
+
+// A pty master reports POLLHUP while no client has the slave open, which
+// is the closest analogue of tud_cdc_connected() (DTR asserted).
+bool plat_cdc_connected(void) {
+    struct pollfd p = { .fd = pty_master, .events = 0 };
+    if (poll(&p, 1, 0) < 0) return false;
+    return (p.revents & POLLHUP) == 0;
+}
+
+void plat_cdc_write(const char *s) {
+    size_t len = strlen(s);
+    while (len) {
+        ssize_t w = write(pty_master, s, len);
+        if (w <= 0) {
+            // Like the TinyUSB FIFO: a client that stops reading loses data
+            tx_dropped_bytes += (uint32_t)len;
+            return;
+        }
+        s += w;
+        len -= (size_t)w;
+    }
+}
+
+void plat_mic_start(void)   { if (verbose) fprintf(stderr, "[SIM] mic start\n"); }
+void plat_mic_stop(void)    { if (verbose) fprintf(stderr, "[SIM] mic stop\n"); }
+void plat_tune_apply(void)  { if (verbose) fprintf(stderr, "[SIM] tune apply\n"); }
+void plat_disc_select(uint8_t src) { if (verbose) fprintf(stderr, "[SIM] disc %s\n", freqdisc_src_label(src)); }
+
+// ---------------- Simulated reference edges ----------------
+// The host clock is the reference; the simulated local clock runs
+// clock_ppm fast.  SOF every 1 ms, PPS every second (3-cycle PIO ticks).
+static double   clock_ppm = 0.0;
+static uint64_t ref_last_ms = 0;
+
+static void ref_poll(void) {
+    const uint32_t pps_tick_hz = 250000000u / 3u;
+    uint64_t now_ms = plat_us() / 1000u;
+
+    while (ref_last_ms < now_ms) {
+        ref_last_ms++;
+        double loc_us = (double)ref_last_ms * 1000.0 * (1.0 + clock_ppm * 1e-6);
+        freqdisc_sof((uint32_t)ref_last_ms & 0x7FFu, (uint64_t)loc_us);
+        txsched_sof((uint32_t)ref_last_ms & 0x7FFu, ref_last_ms * 1000u);  // plat_us is the tx_at local clock
+        if ((ref_last_ms % 1000u) == 0)
+            freqdisc_pps((uint32_t)(uint64_t)(loc_us * 1e-6 * pps_tick_hz), pps_tick_hz);
+    }
+    freqdisc_poll();
+
+    uint32_t ready = 0;
+    for (uint32_t i = 0; i < NUM_BLOCKS; i++) if (g_block_ready[i]) ready++;
+    txsched_poll(ready * TXS_BLOCK_MS);
+}
+
+// ---------------- Simulated audio source ----------------
+enum { AUD_TWO_TONE, AUD_TONE, AUD_NOISE, AUD_SILENCE };
+static int   audio_kind = AUD_TWO_TONE;
+static float audio_tone_hz = 1000.0f;
+static float aph1 = 0.0f, aph2 = 0.0f;
+static uint32_t noise_state = 0x12345678u;
+
+// --usb-rate: generate at a host rate and go through the firmware's
+// USB resampler (farrow.h) at a fixed step instead of straight at 8 kHz
+static uint32_t usb_rate = 0;
+static farrow_t usb_fr;
+static uint32_t usb_ph, usb_step;
+
+static float source_sample(float fs) {
+    float x = 0.0f;
+
+    switch (audio_kind) {
+        case AUD_TWO_TONE:
+            aph1 += 2.0f * (float)M_PI * 700.0f / fs;
+            aph2 += 2.0f * (float)M_PI * 1900.0f / fs;
+            if (aph1 > (float)M_PI) aph1 -= 2.0f * (float)M_PI;
+            if (aph2 > (float)M_PI) aph2 -= 2.0f * (float)M_PI;
+            x = 0.25f * (sinf(aph1) + sinf(aph2));
+            break;
+        case AUD_TONE:
+            aph1 += 2.0f * (float)M_PI * audio_tone_hz / fs;
+            if (aph1 > (float)M_PI) aph1 -= 2.0f * (float)M_PI;
+            x = 0.5f * sinf(aph1);
+            break;
+        case AUD_NOISE:
+            noise_state = noise_state * 1664525u + 1013904223u;
+            x = 0.3f * ((float)(int32_t)noise_state / 2147483648.0f);
+            break;
+        default:
+            break;
+    }
+    return x;
+}
+
+float plat_audio_sample(uint32_t n, const audio_cfg_t *cfg) {
+    (void)n; (void)cfg;
+    if (!usb_rate) return source_sample((float)WAV_SAMPLE_RATE);
+
+    usb_ph += usb_step;
+    for (uint32_t k = usb_ph >> 16; k; k--)
+        while (!farrow_push(&usb_fr, source_sample((float)usb_rate))) { }
+    usb_ph &= 0xFFFFu;
+    return farrow_out(&usb_fr, (float)usb_ph * (1.0f / 65536.0f));
+}
+
+void plat_usb_rs_print(void) {
+    if (usb_rate) farrow_print(&usb_fr, "status");
+    else cdc_printf("ERR: no USB audio (start sxsim with --usb-rate)\r\n");
+}
+
+void plat_bench_spi(void) { }   // no SPI bus in the simulator
+void plat_irq_print(bool reset) { (void)reset; cdc_write_str("ERR: no IRQs in the simulator\r\n"); }
+
+// ==========================================================
+// Simulated Core1: drain blocks at 8 kHz
+// ==========================================================
+static uint64_t radio_next_us = 0;
+static uint32_t radio_pos = 0;
+static uint64_t radio_samples = 0;
+static uint64_t radio_txon = 0;
+static int32_t  radio_steps_min = INT32_MAX, radio_steps_max = INT32_MIN;
+
+static void radio_poll(void) {
+    if (!g_core1_start) return;
+
+    uint64_t now = plat_us();
+    if (radio_next_us == 0) radio_next_us = now;
+
+    const uint64_t ts_us = 1000000ull / WAV_SAMPLE_RATE;
+    while (radio_next_us <= now) {
+        uint32_t b = g_cons_block;
+        if (!g_block_ready[b]) {
+            g_underruns++;
+            radio_next_us += ts_us;
+            continue;
+        }
+
+        if (radio_pos == 0) cmdlat_air(b);
+        const sample_cmd_t *c = &g_blocks[b][radio_pos];
+        if (!g_boot.rf_ready_ms) g_boot.rf_ready_ms = plat_ms();
+        radio_samples++;
+        if (txsched_gate((uint32_t)radio_next_us, c->tx_on)) {
+            if (!g_boot.first_tx_ms) g_boot.first_tx_ms = plat_ms();
+            radio_txon++;
+            if (c->freq_steps < radio_steps_min) radio_steps_min = c->freq_steps;
+            if (c->freq_steps > radio_steps_max) radio_steps_max = c->freq_steps;
+        }
+
+        if (++radio_pos >= BLOCK_SAMPLES) {
+            radio_pos = 0;
+            __compiler_memory_barrier();
+            g_block_ready[b] = 0;
+            __compiler_memory_barrier();
+            g_cons_block = (b + 1u) % NUM_BLOCKS;
+        }
+        radio_next_us += ts_us;
+    }
+}
+
+void plat_radio_diag(void) {
+    cdc_printf("SIM radio: samples=%llu txon=%llu underruns=%lu steps=[%ld..%ld] dropped_tx=%lu\r\n",
+               (unsigned long long)radio_samples, (unsigned long long)radio_txon,
+               (unsigned long)g_underruns,
+               (long)(radio_txon ? radio_steps_min : 0),
+               (long)(radio_txon ? radio_steps_max : 0),
+               (unsigned long)tx_dropped_bytes);
+}
+
+// ==========================================================
+// RSSI scan against an emulated SX1280 and a made-up band
+// ==========================================================
+static const sxemu_src_t sim_band[] = {
+    { 2400290.0, 0.0f,     -85.0f, 0,     0.0f  },      // local carrier in the uplink
+    { 2399700.0, 0.0f,     -80.0f, 5000u, 0.25f },      // bursty narrow source
+    { 2410700.0, 20000.0f, -55.0f, 2000u, 0.40f },      // Wi-Fi channel
+};
+static sxemu_t sim_sx = {
+    .src = sim_band, .n_src = sizeof(sim_band) / sizeof(sim_band[0]),
+    .noise_dbm = -100.0f, .lock_us = 40u,
+};
+static const scan_backend_t sim_scan_be = { sxemu_xfer, sxemu_busy, &sim_sx };
+
+// The device's carrier state machine, minus parking Core1
+static void scan_poll(void) {
+    scan_stats_t s;
+    rssiscan_stats(&s);
+    if (s.want && !s.active) {
+        sxemu_init(&sim_sx);
+        rssiscan_begin(&sim_scan_be);
+    } else if (!s.want && s.active) {
+        rssiscan_end();
+    }
+    if (s.want) {
+        if (g_tx_enabled || g_ptt_key || g_tune_active) rssiscan_stop("tx");
+        else rssiscan_poll();
+    }
+}
+
+// ==========================================================
+// Device main loop (mirrors main() after boot)
+// ==========================================================
+static void cdc_task(void) {
+    static char line[CDC_LINE_MAX];
+    static uint32_t pos = 0;
+    char buf[256];
+
+    if (!plat_cdc_connected()) return;
+
+    ssize_t r = read(pty_master, buf, sizeof(buf));
+    for (ssize_t i = 0; i < r; i++) {
+        char ch = buf[i];
+        if (ch == '\r' || ch == '\n') {
+            if (pos > 0) {
+                line[pos] = 0;
+                cdc_handle_line(line);
+                pos = 0;
+            }
+        } else if (pos < sizeof(line) - 1) {
+            line[pos++] = ch;
+        }
+    }
+}
+
+static void *device_main(void *arg) {
+    (void)arg;
+    uint8_t greeted = 0;
+    uint32_t prebuf_count = 0;
+
+    txchain_init();
+    g_boot.dsp_ms = plat_ms();
+    g_boot.radio_ms = g_boot.dsp_ms;
+
+    while (running) {
+        uint32_t b = g_prod_block;
+
+        while (running && g_block_ready[b]) {
+            radio_poll();
+            ref_poll();
+            cmdlat_poll();
+            specmask_poll();
+            scan_poll();
+            cdc_task();
+            cdc_status_push();
+
+            // Reconnect re-greets, like plugging the USB cable back in
+            if (!plat_cdc_connected()) greeted = 0;
+            else if (!g_boot.usb_ms) g_boot.usb_ms = plat_ms();
+
+            usleep(250);
+        }
+
+        if (!greeted && plat_cdc_connected()) {
+            greeted = 1;
+            cdc_write_str("\r\nSX1280_SDR control ready. Type 'help'.\r\n");
+            cfg_print();
+            boot_print();
+        }
+
+        txchain_fill_block(g_blocks[b]);
+
+        __compiler_memory_barrier();
+        g_block_ready[b] = 1;
+        __compiler_memory_barrier();
+        g_prod_block = (b + 1u) % NUM_BLOCKS;
+
+        if (!g_core1_start && ++prebuf_count >= NUM_BLOCKS / 2) g_core1_start = 1;
+    }
+    return NULL;
+}
+
+// ==========================================================
+// Load client: command RTT and status-push throughput
+// ==========================================================
+typedef struct {
+    int  fd;
+    char buf[512];
+    size_t len;
+    uint32_t push_lines;
+    uint64_t push_bytes;
+} client_t;
+
+// Read one line (without CR/LF) with a timeout.  "!S " pushes are counted
+// and returned like any other line so the caller can skip them.
+static bool client_line(client_t *c, char *out, size_t cap, int timeout_ms) {
+    for (;;) {
+        char *nl = memchr(c->buf, '\n', c->len);
+        if (nl) {
+            size_t n = (size_t)(nl - c->buf);
+            size_t k = n;
+            while (k && (c->buf[k - 1] == '\r')) k--;
+            if (k >= cap) k = cap - 1;
+            memcpy(out, c->buf, k);
+            out[k] = 0;
+            memmove(c->buf, nl + 1, c->len - n - 1);
+            c->len -= n + 1;
+            if (strncmp(out, "!S ", 3) == 0) {
+                c->push_lines++;
+                c->push_bytes += n + 1;
+            }
+            return true;
+        }
+        if (c->len == sizeof(c->buf)) c->len = 0;   // overlong garbage
+
+        struct pollfd p = { .fd = c->fd, .events = POLLIN };
+        if (poll(&p, 1, timeout_ms) <= 0) return false;
+        ssize_t r = read(c->fd, c->buf + c->len, sizeof(c->buf) - c->len);
+        if (r <= 0) return false;
+        c->len += (size_t)r;
+    }
+}
+
+static void client_send(client_t *c, const char *cmd) {
+    char tmp[128];
+    int n = snprintf(tmp, sizeof(tmp), "%s\r\n", cmd);
+    if (write(c->fd, tmp, (size_t)n) != n) perror("write");
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct { uint32_t n, max, over; uint64_t sum; } lat_acc_t;
+
+// "!L id= cmd= commit_us= air_us= ok=" into the totals
+static bool lat_line(lat_acc_t *a, const char *line) {
+    unsigned long air, good;
+    if (sscanf(line, "!L id=%*u cmd=%*s commit_us=%*u air_us=%lu ok=%lu", &air, &good) != 2) return false;
+    a->n++;
+    a->sum += air;
+    if (air > a->max) a->max = (uint32_t)air;
+    if (!good) a->over++;
+    return true;
+}
+
+static int run_load(const char *slave, uint32_t count, uint32_t pushes) {
+    client_t c = { 0 };
+    c.fd = open(slave, O_RDWR | O_NOCTTY);
+    if (c.fd < 0) { perror(slave); return 1; }
+
+    struct termios tio;
+    tcgetattr(c.fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(c.fd, TCSANOW, &tio);
+
+    // Wait for the greeting + config dump to settle
+    char line[512];
+    while (client_line(&c, line, sizeof(line), 200)) { }
+
+    static const char *const cmds[] = {
+        "freq 2400250000", "set amp_gain 3.0", "txpwr 10", "ppm 0.5",
+        "set comp_thr -20", "freq 2400300000", "set amp_gain 2.9", "ppm 0",
+    };
+    const uint32_t ncmd = sizeof(cmds) / sizeof(cmds[0]);
+
+    uint32_t *rtt = calloc(count, sizeof(uint32_t));
+    if (!rtt) return 1;
+    uint32_t ok = 0, timeouts = 0;
+
+    // Command-to-air latency: one "!L" line per change that reached Core1
+    client_send(&c, "lat on");
+    while (client_line(&c, line, sizeof(line), 200)) { }
+    lat_acc_t lat = { 0 };
+
+    c.push_lines = 0;
+    c.push_bytes = 0;
+    uint64_t start = plat_us();
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t t_send = plat_us();
+        client_send(&c, cmds[i % ncmd]);
+        bool got = false;
+        while (client_line(&c, line, sizeof(line), 1000)) {
+            if (lat_line(&lat, line)) continue;
+            if (strncmp(line, "OK", 2) == 0 || strncmp(line, "ERR", 3) == 0) { got = true; break; }
+        }
+        if (!got) { timeouts++; continue; }
+        rtt[ok++] = (uint32_t)(plat_us() - t_send);
+    }
+    double cmd_s = (double)(plat_us() - start) / 1e6;
+    uint32_t side_pushes = c.push_lines;
+
+    // The last changes are still queued: let them reach the air
+    while (client_line(&c, line, sizeof(line), 500)) lat_line(&lat, line);
+    client_send(&c, "lat off");
+    while (client_line(&c, line, sizeof(line), 200)) { }
+
+    // Rejected commands change nothing on air and must not be timed
+    static const char *const bad[] = { "freq 1", "ppm 999", "txpwr x", "tx maybe", "mode lsb", "set nokey 1" };
+    client_send(&c, "lat reset");
+    for (uint32_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) client_send(&c, bad[i]);
+    while (client_line(&c, line, sizeof(line), 500)) { }
+    client_send(&c, "lat");
+    unsigned long rej_n = 1, rej_drop = 1;
+    while (client_line(&c, line, sizeof(line), 200)) {
+        sscanf(line, "!L why=status n=%lu avg_us=%*u max_us=%*u commit_max_us=%*u over=%*u drop=%lu", &rej_n, &rej_drop);
+    }
+
+    // Push throughput: keep "status" requests pipelined and count the
+    // forced "!S" lines coming back.
+    c.push_lines = 0;
+    c.push_bytes = 0;
+    start = plat_us();
+    uint32_t sent = 0;
+    const uint32_t window = 8;
+    while (c.push_lines < pushes) {
+        while (sent < pushes && sent - c.push_lines < window) {
+            client_send(&c, "status");
+            sent++;
+        }
+        if (!client_line(&c, line, sizeof(line), 1000)) break;
+    }
+    double push_s = (double)(plat_us() - start) / 1e6;
+
+    printf("commands: %lu ok, %lu timeouts, %.0f cmd/s\n",
+           (unsigned long)ok, (unsigned long)timeouts, ok / (cmd_s > 0 ? cmd_s : 1));
+    if (ok) {
+        qsort(rtt, ok, sizeof(uint32_t), cmp_u32);
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < ok; i++) sum += rtt[i];
+        printf("rtt us: min %lu avg %lu p50 %lu p99 %lu max %lu\n",
+               (unsigned long)rtt[0], (unsigned long)(sum / ok),
+               (unsigned long)rtt[ok / 2], (unsigned long)rtt[(ok * 99u) / 100u],
+               (unsigned long)rtt[ok - 1]);
+    }
+    printf("change pushes during commands: %lu (%.1f/s, rate limit 10/s)\n",
+           (unsigned long)side_pushes, side_pushes / (cmd_s > 0 ? cmd_s : 1));
+    printf("status pushes: %lu/%lu in %.3f s, %.0f lines/s, %.0f B/s\n",
+           (unsigned long)c.push_lines, (unsigned long)pushes, push_s,
+           c.push_lines / (push_s > 0 ? push_s : 1), c.push_bytes / (push_s > 0 ? push_s : 1));
+    printf("command-to-air: %lu changes, avg %lu us, max %lu us, %lu over %u ms\n",
+           (unsigned long)lat.n, (unsigned long)(lat.n ? lat.sum / lat.n : 0u),
+           (unsigned long)lat.max, (unsigned long)lat.over, LAT_TARGET_MS);
+    printf("rejected commands timed: %lu (must be 0)\n", rej_n + rej_drop);
+    printf("radio: %llu samples, %lu underruns, %lu tx bytes dropped\n",
+           (unsigned long long)radio_samples, (unsigned long)g_underruns,
+           (unsigned long)tx_dropped_bytes);
+
+    free(rtt);
+    close(c.fd);
+    return (timeouts || c.push_lines < pushes || !lat.n || lat.over || rej_n || rej_drop) ? 1 : 0;
+}
+
+// ==========================================================
+// main
+// ==========================================================
+static void on_signal(int sig) { (void)sig; running = false; }
+
+static void usage(void) {
+    fprintf(stderr,
+        "usage: sxsim [--link PATH] [--audio two-tone|tone:HZ|noise|silence] [--usb-rate HZ] [--clock-ppm P] [-v]\n"
+        "       sxsim --load [--count N] [--push N] [--audio ...]\n");
+}
+
+int main(int argc, char **argv) {
+    const char *link_path = NULL;
+    bool load = false;
+    uint32_t count = 1000, pushes = 1000;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (!strcmp(a, "--link") && i + 1 < argc) link_path = argv[++i];
+        else if (!strcmp(a, "--load")) load = true;
+        else if (!strcmp(a, "--count") && i + 1 < argc) count = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(a, "--push") && i + 1 < argc) pushes = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(a, "-v")) verbose = true;
+        else if (!strcmp(a, "--clock-ppm") && i + 1 < argc) clock_ppm = strtod(argv[++i], NULL);
+        else if (!strcmp(a, "--usb-rate") && i + 1 < argc) {
+            usb_rate = (uint32_t)strtoul(argv[++i], NULL, 10);
+            if (!farrow_design(&usb_fr, usb_rate)) { fprintf(stderr, "unsupported --usb-rate\n"); return 2; }
+            usb_step = (uint32_t)(((uint64_t)usb_fr.mid_rate << 16) / WAV_SAMPLE_RATE);
+        }
+        else if (!strcmp(a, "--audio") && i + 1 < argc) {
+            const char *s = argv[++i];
+            if (!strcmp(s, "two-tone")) audio_kind = AUD_TWO_TONE;
+            else if (!strcmp(s, "noise")) audio_kind = AUD_NOISE;
+            else if (!strcmp(s, "silence")) audio_kind = AUD_SILENCE;
+            else if (!strncmp(s, "tone:", 5)) { audio_kind = AUD_TONE; audio_tone_hz = strtof(s + 5, NULL); }
+            else { usage(); return 2; }
+        } else { usage(); return 2; }
+    }
+    if (count == 0) count = 1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    pty_master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (pty_master < 0 || grantpt(pty_master) || unlockpt(pty_master)) {
+        perror("posix_openpt");
+        return 1;
+    }
+    fcntl(pty_master, F_SETFL, fcntl(pty_master, F_GETFL) | O_NONBLOCK);
+    const char *slave = ptsname(pty_master);
+
+    // Raw line discipline so clients that do not configure the port
+    // (cat, plain open()) see the same bytes as over CDC.
+    int sfd = open(slave, O_RDWR | O_NOCTTY);
+    if (sfd >= 0) {
+        struct termios tio;
+        tcgetattr(sfd, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(sfd, TCSANOW, &tio);
+        close(sfd);
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    if (load) {
+        pthread_t dev;
+        pthread_create(&dev, NULL, device_main, NULL);
+        int rc = run_load(slave, count, pushes);
+        running = false;
+        pthread_join(dev, NULL);
+        return rc;
+    }
+
+    if (link_path) {
+        unlink(link_path);
+        if (symlink(slave, link_path)) perror(link_path);
+    }
+    fprintf(stderr, "sxsim: CDC on %s%s%s\n", slave,
+            link_path ? " -> " : "", link_path ? link_path : "");
+
+    device_main(NULL);
+
+    if (link_path) unlink(link_path);
+    return 0;
+}
@@ -0,0 +1,135 @@
+// interp_accel.h - SIO interpolator helpers for the per-sample hot loops
+//
+// Two accelerators, each with a portable fallback that produces the
+// same integers bit for bit (host/interpcheck compares them against a
+// register model of the interpolator):
+//
+//   ring walk   INTERP0, Core0.  Walks a power-of-two float ring backwards
+//               and returns byte offsets, so the Hilbert FIR inner loop
+//               is one SIO read + one load per tap, no index wrap.
+//               Reprogrammed on every walk: no state survives between
+//               calls, so anything else on Core0 may use INTERP0 too.
+//
+//   Q16 phase   INTERP1 lane 0, Core0, owned by the USB resampler.  Each
+//               advance returns frac(phase) + step; the integer part is
+//               the number of input samples to consume, and the lane mask
+//               drops it from the accumulator on the next advance.
+//
+// Both run in the Core0 main loop only; IRQ handlers must not touch the
+// interpolators (they would need interp_save/interp_restore).  Core1's
+// interpolators are left free.
+
+#ifndef INTERP_ACCEL_H
+#define INTERP_ACCEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if SX_INTERP_MODEL
+#include "interp_model.h"       // host/interpcheck: register-level model
+#define SX_USE_INTERP   1
+#elif !SX_HOST_BUILD
+#include "hardware/interp.h"
+#define SX_USE_INTERP   1
+#else
+#define SX_USE_INTERP   0
+#endif
+
+// Fallback state lives in the caller; the hardware path ignores it.
+typedef struct { uint32_t pos, mask; } ring_walk_t;
+typedef struct { uint32_t ph, step; } q16_phase_t;
+
+// ==========================================================
+// Ring walk (INTERP0)
+// ==========================================================
+// ring_log2: ring length as a power of two (elements of 4 bytes).
+// First ring_walk_next() returns the offset of element idx, then idx-1,
+// idx-2, ... modulo the ring length.
+
+#if SX_USE_INTERP
+
+static inline void ring_walk_begin(ring_walk_t *w, uint32_t idx, uint32_t ring_log2) {
+    (void)w;
+
+    // Lane 0: raw accumulator, steps back one float per pop
+    interp_config c0 = interp_default_config();
+    interp_config_set_add_raw(&c0, true);
+    interp_set_config(interp0, 0, &c0);
+    interp_set_base(interp0, 0, (uint32_t)-4);
+    interp_set_accumulator(interp0, 0, idx << 2);
+
+    // Lane 1: lane 0's accumulator masked to the ring (byte offsets)
+    interp_config c1 = interp_default_config();
+    interp_config_set_cross_input(&c1, true);
+    interp_config_set_mask(&c1, 2, ring_log2 + 1u);
+    interp_set_config(interp0, 1, &c1);
+    interp_set_base(interp0, 1, 0);
+}
+
+static inline uint32_t ring_walk_next(ring_walk_t *w) {
+    (void)w;
+    return interp_pop_lane_result(interp0, 1);
+}
+
+#else
+
+static inline void ring_walk_begin(ring_walk_t *w, uint32_t idx, uint32_t ring_log2) {
+    w->pos = idx << 2;
+    w->mask = ((1u << ring_log2) - 1u) << 2;
+}
+
+static inline uint32_t ring_walk_next(ring_walk_t *w) {
+    uint32_t off = w->pos & w->mask;
+    w->pos -= 4u;
+    return off;
+}
+
+#endif
+
+// ==========================================================
+// Q16 phase accumulator (INTERP1 lane 0)
+// ==========================================================
+// q16_phase_advance() returns frac(phase) + step: >> 16 is the number of
+// input samples to consume, & 0xFFFF the new fraction.
+
+#if SX_USE_INTERP
+
+static inline void q16_phase_init(q16_phase_t *p, uint32_t step) {
+    (void)p;
+    interp_claim_lane(interp1, 0);
+    interp_config c = interp_default_config();
+    interp_config_set_mask(&c, 0, 15);
+    interp_set_config(interp1, 0, &c);
+    interp_set_base(interp1, 0, step);
+    interp_set_accumulator(interp1, 0, 0);
+}
+
+static inline void q16_phase_set_step(q16_phase_t *p, uint32_t step) {
+    (void)p;
+    interp_set_base(interp1, 0, step);
+}
+
+static inline void q16_phase_reset(q16_phase_t *p) {
+    (void)p;
+    interp_set_accumulator(interp1, 0, 0);
+}
+
+static inline uint32_t q16_phase_advance(q16_phase_t *p) {
+    (void)p;
+    return interp_pop_lane_result(interp1, 0);
+}
+
+#else
+
+static inline void q16_phase_init(q16_phase_t *p, uint32_t step) { p->step = step; p->ph = 0; }
+static inline void q16_phase_set_step(q16_phase_t *p, uint32_t step) { p->step = step; }
+static inline void q16_phase_reset(q16_phase_t *p) { p->ph = 0; }
+
+static inline uint32_t q16_phase_advance(q16_phase_t *p) {
+    p->ph = (p->ph & 0xFFFFu) + p->step;
+    return p->ph;
+}
+
+#endif
+
+#endif // INTERP_ACCEL_H
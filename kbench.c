@@ -0,0 +1,160 @@
+// kbench.c - per-sample DSP kernel benchmarks, same code on every core type
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "kbench.h"
+#include "platform.h"
+#include "control.h"
+#include "dsp.h"
+#include "dspgov.h"
+#include "txchain.h"
+#include "farrow.h"
+
+#define KB_N        8192u           // calls per single-kernel run
+#define KB_BLOCKS   16u             // blocks per whole-chain run
+
+// Scratch state, never the producer's
+static hilbert_t    kb_hilb;
+static weaver_t     kb_weav;
+static biquad_t     kb_bq;
+static compressor_t kb_comp;
+static limiter_t    kb_lim;
+static txchain_t    kb_chain;
+static float        kb_in[BLOCK_SAMPLES];
+static sample_cmd_t kb_blk[BLOCK_SAMPLES];
+static volatile float kb_sink;      // keeps the results live
+
+void kbench_print(const char *k, uint32_t n, uint64_t total_ns) {
+    if (!n) return;
+    const uint32_t hz = plat_cpu_hz();
+    const double ns = (double)total_ns / (double)n;
+    const double cyc = ns * (double)hz * 1e-9;
+    cdc_printf("!K isa=%s fpu=%u mhz=%lu k=%s n=%lu ns=%.0f cyc=%.0f load=%.2f\r\n",
+               SX_ISA, (unsigned)SX_HAS_FPU, (unsigned long)(hz / 1000000u), k,
+               (unsigned long)n, ns, cyc, ns * (double)WAV_SAMPLE_RATE * 1e-7);
+}
+
+// Test input: 1 kHz at -6 dBFS
+static void fill_input(void) {
+    uint32_t ph = 0;
+    const uint32_t step = (uint32_t)(1000.0 * 4294967296.0 / (double)WAV_SAMPLE_RATE);
+    for (uint32_t i = 0; i < BLOCK_SAMPLES; i++, ph += step)
+        kb_in[i] = 0.5f * lut_sin(ph);
+}
+
+static void bench_sin(void) {
+    float acc = 0.0f;
+    uint32_t ph = 0;
+    const uint64_t t0 = plat_us();
+    for (uint32_t n = 0; n < KB_N; n++, ph += 0x01234567u) acc += lut_sin(ph);
+    const uint64_t dt = plat_us() - t0;
+    kb_sink = acc;
+    kbench_print("sin", KB_N, dt * 1000u);
+}
+
+static void bench_biquad(void) {
+    biquad_init_lowpass_bw2(&kb_bq, 2700.0f, (float)WAV_SAMPLE_RATE);
+    float acc = 0.0f;
+    const uint64_t t0 = plat_us();
+    for (uint32_t n = 0; n < KB_N; n++) acc += biquad_process(&kb_bq, kb_in[n & (BLOCK_SAMPLES - 1u)]);
+    const uint64_t dt = plat_us() - t0;
+    kb_sink = acc;
+    kbench_print("biquad", KB_N, dt * 1000u);
+}
+
+// Per-sample compressor: envelope, log10f / powf gain law
+static void bench_comp(void) {
+    const audio_cfg_t cfg = AUDIO_CFG_DEFAULTS;
+    compressor_reconfig(&kb_comp, (float)WAV_SAMPLE_RATE, &cfg);
+    float acc = 0.0f;
+    const uint64_t t0 = plat_us();
+    for (uint32_t n = 0; n < KB_N; n++) acc += compressor_process(&kb_comp, kb_in[n & (BLOCK_SAMPLES - 1u)]);
+    const uint64_t dt = plat_us() - t0;
+    kb_sink = acc;
+    kbench_print("comp", KB_N, dt * 1000u);
+}
+
+// Look-ahead limiter at the default look-ahead, input 2x over the limit
+static void bench_lim(void) {
+    const audio_cfg_t cfg = AUDIO_CFG_DEFAULTS;
+    static float buf[BLOCK_SAMPLES];
+    memset(&kb_lim, 0, sizeof(kb_lim));
+    limiter_reconfig(&kb_lim, (float)WAV_SAMPLE_RATE, &cfg);
+    float acc = 0.0f;
+    uint64_t dt = 0;
+    for (uint32_t b = 0; b < KB_N / BLOCK_SAMPLES; b++) {
+        for (uint32_t i = 0; i < BLOCK_SAMPLES; i++) buf[i] = 4.0f * kb_in[i];
+        const uint64_t t0 = plat_us();
+        limiter_block(&kb_lim, buf, BLOCK_SAMPLES, cfg.comp_out_limit);
+        dt += plat_us() - t0;
+        acc += buf[0];
+    }
+    kb_sink = acc;
+    kbench_print("lim", KB_N, dt * 1000u);
+}
+
+static void bench_hilbert(uint16_t taps, const char *name) {
+    hilbert_init(&kb_hilb);
+    hilbert_set_len(&kb_hilb, taps);
+    float acc = 0.0f, i_d;
+    const uint64_t t0 = plat_us();
+    for (uint32_t n = 0; n < KB_N; n++) {
+        acc += hilbert_process(&kb_hilb, kb_in[n & (BLOCK_SAMPLES - 1u)], &i_d);
+        acc += i_d;
+    }
+    const uint64_t dt = plat_us() - t0;
+    kb_sink = acc;
+    kbench_print(name, KB_N, dt * 1000u);
+}
+
+static void bench_weaver(void) {
+    weaver_init(&kb_weav, AUDIO_BP_LO_HZ, AUDIO_BP_HI_HZ, (float)WAV_SAMPLE_RATE);
+    float acc = 0.0f, i_w;
+    const uint64_t t0 = plat_us();
+    for (uint32_t n = 0; n < KB_N; n++) {
+        acc += weaver_process(&kb_weav, kb_in[n & (BLOCK_SAMPLES - 1u)], &i_w);
+        acc += i_w;
+    }
+    const uint64_t dt = plat_us() - t0;
+    kb_sink = acc;
+    kbench_print("weaver", KB_N, dt * 1000u);
+}
+
+// Whole SSB producer per sample at one governor profile
+static void bench_chain(uint8_t bp_max, uint16_t hilb, uint8_t cdec, const char *name) {
+    const tx_params_t p = {
+        .mode = TXM_USB, .tx_req = 1, .pwr_max_dbm = PWR_MAX_DBM,
+    };
+    txchain_ctx_init(&kb_chain, NULL);
+    kb_chain.bp_max = bp_max;
+    kb_chain.hilb_taps = hilb;
+    kb_chain.comp_decim = cdec;
+
+    const uint64_t t0 = plat_us();
+    for (uint32_t b = 0; b < KB_BLOCKS; b++) txchain_ctx_block(&kb_chain, &p, kb_in, kb_blk);
+    const uint64_t dt = plat_us() - t0;
+    kb_sink = (float)kb_blk[BLOCK_SAMPLES - 1u].freq_steps;
+    kbench_print(name, KB_BLOCKS * BLOCK_SAMPLES, dt * 1000u);
+}
+
+void kbench_run(void) {
+    fill_input();
+    bench_sin();
+    bench_biquad();
+    bench_comp();
+    bench_lim();
+    bench_hilbert(HILBERT_TAPS, "hilb247");
+    bench_hilbert(HILBERT_TAPS_MID, "hilb127");
+    bench_hilbert(HILBERT_TAPS_LOW, "hilb63");
+    bench_weaver();
+
+    uint32_t macs = 0;
+    const uint32_t ns = farrow_bench_ns(48000u, KB_N, &macs);
+    kbench_print("farrow48", KB_N, (uint64_t)ns * KB_N);
+
+    // Governor level 0 and level GOV_LEVELS - 1 (dspgov.c profiles)
+    bench_chain(AUDIO_BP_MAX_STAGES, HILBERT_TAPS, 1u, "chain0");
+    bench_chain(3u, HILBERT_TAPS_LOW, GOV_COMP_DECIM, "chain4");
+}
@@ -0,0 +1,27 @@
+// kbench.h - per-sample DSP kernel benchmarks, same code on every core type
+//
+// Times the kernels the producer runs per 8 kHz sample on the core that
+// calls it and reports each as a "!K" line:
+//
+//   !K isa=arm fpu=1 mhz=150 k=hilb247 n=8192 ns=1830 cyc=274 load=1.5
+//
+// ns / cyc are per call (per sample for "chain*"), load is the share of
+// one 125 us sample period.  isa / fpu come from platform.h, so the same
+// command on a pico2 and a pico2_riscv build gives directly comparable
+// numbers; the Core1 SPI command timing is appended by plat_bench_spi().
+// Portable: on the host (sxsim "bench") mhz and cyc are 0.
+
+#ifndef KBENCH_H
+#define KBENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Run every kernel on the calling core and print its "!K" line.
+// Blocks the caller for roughly 0.1-2 s depending on the core type.
+void kbench_run(void);
+
+// Shared "!K" line for one kernel: n calls took total_ns nanoseconds
+void kbench_print(const char *k, uint32_t n, uint64_t total_ns);
+
+#endif // KBENCH_H
@@ -8,6 +8,7 @@
 
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
+#include "pico/mutex.h"
 
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
@@ -16,6 +17,9 @@
 #include "hardware/adc.h"
 #include "hardware/flash.h"
 #include "hardware/sync.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/structs/usb.h"
 #include "pico/flash.h"
 
 // TinyUSB
@@ -26,66 +30,37 @@
 // OLED display
 #include "ssd1306.h"
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+// PPS timestamping (generated from pps_capture.pio)
+#include "pps_capture.pio.h"
+
+// Portable firmware logic (also built natively, see host/)
+#include "platform.h"
+#include "dsp.h"
+#include "control.h"
+#include "txchain.h"
+#include "freqdisc.h"
+#include "alc.h"
+#include "interp_accel.h"
+#include "farrow.h"
+#include "kbench.h"
+#include "mscdisk.h"
+#include "txsched.h"
+#include "afsk.h"
+#include "cmdlat.h"
+#include "specmask.h"
+#include "rssiscan.h"
+#include "spscring.h"
 
 // ================== MODE ==================
 #define FIXED_POWER_CW_MODE     0
 #define FIXED_TX_POWER_DBM      (13)
 // ==========================================
 
-// ================== TEST MODE ==================
-#define USE_TEST_TONE       0
-#define USE_TWO_TONE_TEST   1
-
-#define TEST_TONE_HZ        1000.0f
-#define TEST_TONE2_HZ       1900.0f
-
-#define TEST_TONE_AMPL      0.35f
-#define TEST_BLOCK_SAMPLES  8000u
-// ===============================================
-
-// ================== DITHER SPEED-UP ==================
-#define DITHER_SUBSTEPS     4
-// ===============================================
-
-// ================== BUFFERING ==================
-#define BLOCK_SAMPLES       256u
-#define NUM_BLOCKS          8u   // increased from 2 to prevent underruns
-// ===============================================
-
 // ================== UNDERRUN DIAGNOSTICS ==================
 #define UNDERRUN_LED_ENABLE   1
 #define UNDERRUN_LED_PULSE_MS 20u
 // ===============================================
 
-// ================== AUDIO SHAPING (default values) ==================
-#define AUDIO_ENABLE_BANDPASS       1
-#define AUDIO_BP_LO_HZ              50.0f
-#define AUDIO_BP_HI_HZ              2700.0f
-#define AUDIO_BP_MAX_STAGES         10      // Max stages (compile-time allocation)
-#define AUDIO_BP_DEFAULT_STAGES     7       // Default stages (runtime adjustable, 1-10)
-// Each stage = 12 dB/octave, so 7 stages = 84 dB/oct, 10 stages = 120 dB/oct
-
-#define AUDIO_ENABLE_EQ             1
-#define EQ_LOW_SHELF_HZ             190.0f
-#define EQ_LOW_SHELF_DB             (-2.0f)
-#define EQ_HIGH_SHELF_HZ            1700.0f
-#define EQ_HIGH_SHELF_DB            (13.5f)
-// ===============================================
-
-// ================== COMPRESSION (default values) ==================
-#define AUDIO_ENABLE_COMPRESSOR     1
-#define COMP_THRESHOLD_DB           (-2.5f)
-#define COMP_RATIO                  (6.1f)
-#define COMP_ATTACK_MS              (41.1f)
-#define COMP_RELEASE_MS             (1595.0f)
-#define COMP_MAKEUP_DB              (0.0f)
-#define COMP_KNEE_DB                (16.5f)
-#define COMP_OUTPUT_LIMIT           (0.940f)
-// ===============================================
-
 // ================== MODULE VARIANT ==================
 // Set to 1 if using LoRa1280F27-TCXO module
 // Set to 0 if using LoRa1280F27 or LoRa1281F27 (standard crystal)
@@ -123,6 +98,9 @@ static const uint32_t PIN_PTT_KEY = 5;   // PTT / CW key
 // ---------------- ADC microphone input ----------------
 static const uint32_t PIN_ADC_MIC = 26;  // ADC0 = GPIO26
 
+// ---------------- Optional 1PPS input (GPS), PIO-timestamped ----------------
+static const uint32_t PIN_PPS = 8;
+
 // ---------------- SPI config ----------------
 #define SX_SPI spi0
 static const uint32_t SX_SPI_BAUD = 18000000;
@@ -134,41 +112,8 @@ static const uint32_t SX_SPI_BAUD = 18000000;
 #define OPCODE_SET_TX_PARAMS       0x8E
 #define OPCODE_SET_TX_CW           0xD1
 
-// ---------------- RF/audio params ----------------
-#define BASE_FREQ_HZ        2400400000u
-#define WAV_SAMPLE_RATE     8000u
-
-#define PWR_MAX_DBM         (13)
-#define PWR_MIN_DBM         (-18)
-
-#define AMP_GAIN            2.9f
-#define AMP_MIN_A           0.000002f
-
 #define RAMP_TIME           0xE0     // 20 us
 
-// --- Runtime RF config (adjustable via CDC) ---
-// Frequency stored as double for sub-Hz precision; automatically split into PLL steps + fine DSP offset
-static volatile double g_target_freq_hz = (double)BASE_FREQ_HZ;
-static volatile float g_ppm_correction = 0.0f;
-static volatile uint8_t g_cw_test_mode = 0;  // 1 = CW test active (blocks normal Core1 operation)
-static volatile int8_t g_tx_power_max_dbm = PWR_MAX_DBM;  // Runtime TX power limit
-static volatile uint8_t g_tx_enabled = 0;  // TX enable flag (for GUI TX button), default OFF
-static volatile uint8_t g_tx_mode = 0;     // 0 = USB (SSB), 1 = CW, 2 = FM
-static volatile uint8_t g_tune_active = 0; // 1 = TUNE carrier active
-static volatile uint8_t g_ptt_key = 0;     // 1 = PTT/KEY pressed (live)
-static volatile uint8_t g_audio_src = 0;   // 0 = PC (USB audio), 1 = MIC (ADC0)
-
-// Guard window after any mode change — suppresses TX output on both
-// cores while the carrier state machine settles and Core1 resumes
-// cleanly.  Prevents clicks when the user scrolls the mode menu.
-#define MODE_CHANGE_GUARD_MS   120u
-static volatile uint32_t g_mode_change_at_ms = 0;
-
-static inline bool tx_mode_guard_active(void) {
-    uint32_t now = to_ms_since_boot(get_absolute_time());
-    return (now - g_mode_change_at_ms) < MODE_CHANGE_GUARD_MS;
-}
-
 // Debug counters — surfaced on OLED to find why TX doesn't engage
 static volatile uint32_t g_dbg_prod_txon = 0;   // samples with tx_on=1 in last prod block
 static volatile uint32_t g_dbg_core1_txcw = 0;  // total SetTxCW commands sent by Core1
@@ -177,19 +122,26 @@ static volatile uint32_t g_dbg_cons_blocks = 0; // total blocks consumed by Core
 static volatile uint8_t  g_dbg_core1_alive = 0; // 1 = Core1 reached main loop
 static volatile uint32_t g_dbg_core1_iters = 0; // Core1 while(true) iterations
 static volatile uint32_t g_dbg_busy_timeouts = 0; // sx_wait_busy() timeouts
+
+// Core1 SetRfFrequency timing in CPU cycles (BUSY waits included), one
+// window of SPI_WIN commands at a time, published for "bench"
+#define SPI_WIN 4096u
+static volatile uint32_t g_spi_win_n = 0;
+static volatile uint32_t g_spi_win_sum = 0;
+static volatile uint32_t g_spi_win_max = 0;
 static volatile uint32_t g_dbg_core1_bc = 0; // breadcrumb: last location Core1 was at
 static volatile int      g_dbg_save_rc = 99;  // last flash_safe_execute return code (99=never tried)
 static volatile uint32_t g_dbg_save_ok = 0;   // number of successful saves
 
-// TX mode symbolic constants
-#define TXM_USB     0
-#define TXM_CW      1
-#define TXM_FM      2
-
-// --- FM mode parameters ---
-static volatile float g_fm_deviation_hz = 2500.0f;  // FM deviation in Hz (±, default NBFM)
-static volatile float g_ctcss_freq = 0.0f;          // CTCSS tone freq (0 = off)
-static volatile uint8_t g_roger_beep = 0;           // Roger beep on end of FM TX (0=off, 1=on)
+// IRQ affinity report ("irq"): counts indexed by the core that took the
+// IRQ, longest handler time, Core1 lockouts and Core1 sample overruns
+#define IRQ_AUDIT_BLOCKS 32u    // Core1 re-checks its NVIC every ~1 s
+static volatile uint32_t g_irq_usb_n[2], g_irq_usb_max_us, g_irq_usb_t0;
+static volatile uint32_t g_irq_tmr_n[2], g_irq_tmr_max_us;
+static volatile uint32_t g_irq_lock_n, g_irq_lock_max_us;  // Core1 parked for flash
+static volatile uint32_t g_irq_c1_over_n, g_irq_c1_over_max_us;
+static volatile uint32_t g_irq_c1_stray;    // IRQs Core1 found enabled and turned off
+static volatile uint64_t g_irq_c1_en;       // Core1 NVIC enables at the last audit
 
 // --- Tune-digit cursor on main screen ---
 // Tune step table: 100 Hz, 1 kHz, 10 kHz, 100 kHz, 1 MHz.  Index selects
@@ -238,28 +190,6 @@ static volatile menu_item_t g_menu_cursor = MENU_MODE;
 static volatile uint8_t     g_menu_editing = 0;  // 1 when encoder edits selected item
 static volatile uint32_t    g_menu_scroll_top = 0; // top visible menu row
 
-// Forward decl (used by CDC help output well before the UI section)
-static const char *mode_label(uint8_t m);
-
-// --- Hilbert ---
-#define HILBERT_TAPS        247
-
-// --- PLL step ---
-static const float PLL_STEP_HZ =
-    (float)(52000000.0 / (double)(1u << 18)); // ~198.364 Hz
-
-// --- FM modulation ---
-#define FM_DEVIATION_HZ     2500.0f  // ±2.5 kHz deviation (NBFM)
-
-#define F_OFF_LIMIT_HZ      3500.0f
-#define SILENCE_SECONDS     2u
-
-#define GATE_A_REF          0.01f   // Noise gate threshold - higher with compressor
-#define GATE_SHAPE          1
-
-#define IQ_GAIN_CORR        1.00f
-#define IQ_PHASE_CORR_DEG   0.0f
-
 // ==========================================================
 // Persistent configuration in last flash sector
 // ==========================================================
@@ -284,7 +214,8 @@ typedef struct __attribute__((packed)) {
     float    ctcss_freq;
     uint8_t  _reserved0;       // was: freedv_mode
     uint8_t  roger_beep;       // 0=off 1=on (FM only)
-    uint8_t  _reserved[2];
+    uint8_t  disc_src;         // FD_SRC_* PPM discipline reference (was reserved, 0 = off)
+    uint8_t  alc_on;           // closed-loop RF ALC enabled (was reserved, 0 = off)
     uint32_t crc32;            // CRC32 over everything above
 } persist_cfg_t;
 
@@ -293,6 +224,8 @@ _Static_assert(sizeof(persist_cfg_t) <= FLASH_PAGE_SIZE,
 
 static volatile uint8_t  g_persist_dirty       = 0;   // set when anything worth saving changed
 static volatile uint32_t g_persist_dirty_since = 0;   // ms of last change
+static uint8_t           g_persist_disc_src    = FD_SRC_OFF;  // applied after USB init
+static bool              g_persist_alc_on      = false;       // ditto
 
 static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len) {
     crc ^= 0xFFFFFFFFu;
@@ -318,12 +251,14 @@ static void persist_collect(persist_cfg_t *c) {
     c->freq_hz         = g_target_freq_hz;
     c->tx_mode         = g_tx_mode;
     c->tx_power_dbm    = g_tx_power_max_dbm;
-    c->audio_src       = g_audio_src;
+    c->audio_src       = g_audio_src_auto ? 0 : g_audio_src;  // boot MIC fallback is not a user choice
     c->tune_digit_idx  = g_tune_digit_idx;
     c->ppm_correction  = g_ppm_correction;
     c->fm_deviation_hz = g_fm_deviation_hz;
     c->ctcss_freq      = g_ctcss_freq;
     c->roger_beep      = g_roger_beep;
+    c->disc_src        = freqdisc_source();
+    c->alc_on          = alc_enabled() ? 1 : 0;
     c->crc32           = persist_cfg_crc(c);
 }
 
@@ -362,6 +297,9 @@ static void persist_apply(const persist_cfg_t *c) {
     g_ctcss_freq = ct;
 
     g_roger_beep = (c->roger_beep != 0) ? 1 : 0;
+
+    g_persist_disc_src = (c->disc_src <= FD_SRC_PPS) ? c->disc_src : FD_SRC_OFF;
+    g_persist_alc_on   = (c->alc_on != 0);
 }
 
 static bool persist_load(void) {
@@ -381,12 +319,25 @@ static bool persist_load(void) {
 // (or anything it calls) tried to fetch instructions from flash the
 // device would lock up.  flash_range_erase / flash_range_program are
 // already RAM-resident in the SDK.
-static void __not_in_flash_func(persist_flash_op)(void *param) {
+static void SX_RAMFUNC(persist_flash_op)(void *param) {
     const uint8_t *page = (const uint8_t *)param;
     flash_range_erase(CFG_FLASH_OFFSET, FLASH_SECTOR_SIZE);
     flash_range_program(CFG_FLASH_OFFSET, page, FLASH_PAGE_SIZE);
 }
 
+// flash_safe_execute() with the lockout timed: the whole call is how long
+// Core1 sits parked in its lockout IRQ (the only one it takes).
+static int flash_exec_locked(void (*op)(void *), void *param) {
+    uint32_t t0 = time_us_32();
+    int r = flash_safe_execute(op, param, 100);
+    if (r == PICO_OK) {
+        uint32_t dt = time_us_32() - t0;
+        g_irq_lock_n++;
+        if (dt > g_irq_lock_max_us) g_irq_lock_max_us = dt;
+    }
+    return r;
+}
+
 // Save takes ~20 ms (erase) + ~1 ms (program).  Uses the SDK's
 // flash_safe_execute() which handles Core1 lockout + IRQ disable
 // correctly (our old manual sequence could hang if Core1 or DMA
@@ -399,7 +350,7 @@ static void persist_save_now(void) {
     memset(page, 0xFF, sizeof(page));
     memcpy(page, &c, sizeof(c));
 
-    int r = flash_safe_execute(persist_flash_op, page, 100);
+    int r = flash_exec_locked(persist_flash_op, page);
     g_dbg_save_rc = r;
     if (r == PICO_OK) {
         g_persist_dirty = 0;
@@ -433,21 +384,6 @@ static void persist_maybe_autosave(void) {
 }
 
 
-// ---------------- Command buffer ----------------
-typedef struct {
-    int32_t  freq_steps;
-    int8_t   p_dbm;
-    uint8_t  tx_on;
-} sample_cmd_t;
-
-static sample_cmd_t g_blocks[NUM_BLOCKS][BLOCK_SAMPLES];
-
-static volatile uint32_t g_prod_block = 0;
-static volatile uint32_t g_cons_block = 0;
-static volatile uint8_t  g_block_ready[NUM_BLOCKS] = {0};
-static volatile uint32_t g_underruns = 0;
-static volatile uint8_t  g_core1_start = 0; 
-
 // ==========================================================
 // USB AUDIO IN (from PC) -> ringbuffer -> resampler to 8k mono
 // ==========================================================
@@ -463,29 +399,89 @@ typedef struct { int16_t l, r; } stereo16_t;
 #error "USB_RB_FRAMES must be power-of-two"
 #endif
 
-static stereo16_t g_usb_rb[USB_RB_FRAMES];
-static volatile uint32_t g_usb_w = 0;
-static volatile uint32_t g_usb_r = 0;
+// USB worker -> resampler (spscring.h)
+SPSC_DEFINE(usb_rb, stereo16_t, USB_RB_FRAMES)
+static usb_rb_t g_usb_rb;
 
 static volatile uint32_t g_usb_sample_rate_hz = 48000u; // current host SR
 
-static inline uint32_t usb_rb_next(uint32_t x) { return (x + 1u) & (USB_RB_FRAMES - 1u); }
+// ==========================================================
+// USB worker state: TinyUSB runs in a low-priority IRQ on Core0
+// ==========================================================
+// TinyUSB's task, the UAC OUT drain and the CDC RX copy run in a spare user
+// IRQ at the lowest priority, made pending at the end of every USBCTRL
+// IRQ and by a 1 ms tick (the pico_stdio_usb pattern).  The DSP loop only
+// pops g_usb_rb and g_cdc_rx.  Thread code that calls into TinyUSB (CDC
+// writes, MSC flush) holds g_usb_mutex; the worker try-locks it and
+// skips that run if it is taken, then usb_unlock() kicks it again.
+// A run is bounded by the event queue, not by a budget TinyUSB lacks:
+// tud_task_ext(0, ...) never waits and handles the CFG_TUD_TASK_QUEUE_SZ
+// events queued so far plus what USBCTRL adds at bus rate meanwhile, so
+// one run is a few transfers.  Runs over USB_WORKER_BUDGET_US are counted.
+#ifndef USB_WORKER_TICK_US
+#define USB_WORKER_TICK_US  1000
+#endif
+#ifndef USB_WORKER_BUDGET_US
+#define USB_WORKER_BUDGET_US 500    // runs longer than this are counted ("over")
+#endif
+#define CDC_RX_SIZE         512u    // Must be power-of-two
+#if (CDC_RX_SIZE & (CDC_RX_SIZE - 1u)) != 0
+#error "CDC_RX_SIZE must be power-of-two"
+#endif
 
-static inline bool usb_rb_push(stereo16_t s) {
-    uint32_t w = g_usb_w;
-    uint32_t n = usb_rb_next(w);
-    if (n == g_usb_r) return false; // full
-    g_usb_rb[w] = s;
-    g_usb_w = n;
+static mutex_t g_usb_mutex;
+static int     g_usbw_irq = -1;
+static struct repeating_timer g_usbw_timer;
+
+// Worker -> cdc_task()
+SPSC_DEFINE(cdc_rx, uint8_t, CDC_RX_SIZE)
+static cdc_rx_t g_cdc_rx;
+
+// Worker stats ("!U"): runs, lock skips, run time, kick -> run latency
+static volatile bool     g_usbw_busy;
+static volatile bool     g_usbw_kicked;
+static volatile uint32_t g_usbw_kick_t;
+static volatile uint32_t g_usbw_runs, g_usbw_skips, g_usbw_over;
+static volatile uint64_t g_usbw_sum_us;
+static volatile uint32_t g_usbw_max_us, g_usbw_lat_max_us;
+
+static inline void usb_worker_kick(void) {
+    if (g_usbw_irq < 0) return;
+    if (!g_usbw_kicked) {
+        g_usbw_kick_t = time_us_32();
+        g_usbw_kicked = true;
+    }
+    irq_set_pending((uint)g_usbw_irq);
+}
+
+// Thread side of TinyUSB.  Inside the worker (TinyUSB callbacks) the lock
+// is already held: thread code cannot run while the worker does, so busy
+// here means "called from the worker".
+static inline bool usb_lock(void) {
+    if (g_usbw_busy) return false;
+    mutex_enter_blocking(&g_usb_mutex);
     return true;
 }
 
-static inline bool usb_rb_pop(stereo16_t *out) {
-    uint32_t r = g_usb_r;
-    if (r == g_usb_w) return false; // empty
-    *out = g_usb_rb[r];
-    g_usb_r = usb_rb_next(r);
-    return true;
+static inline void usb_unlock(bool locked) {
+    if (!locked) return;
+    mutex_exit(&g_usb_mutex);
+    usb_worker_kick();      // catch up on a run skipped while we held it
+}
+
+static void usb_worker_print(bool reset) {
+    if (reset) {
+        g_usbw_runs = g_usbw_skips = g_usbw_over = 0;
+        g_usbw_sum_us = 0;
+        g_usbw_max_us = g_usbw_lat_max_us = 0;
+    }
+    const uint32_t runs = g_usbw_runs;
+    cdc_printf("!U why=%s irq=%d runs=%lu skip=%lu avg_us=%lu max_us=%lu over=%lu lat_max_us=%lu rx=%lu\r\n",
+               reset ? "reset" : "status", g_usbw_irq,
+               (unsigned long)runs, (unsigned long)g_usbw_skips,
+               (unsigned long)(runs ? g_usbw_sum_us / runs : 0u),
+               (unsigned long)g_usbw_max_us, (unsigned long)g_usbw_over, (unsigned long)g_usbw_lat_max_us,
+               (unsigned long)cdc_rx_fill(&g_cdc_rx));
 }
 
 static inline int16_t clamp16(int32_t x) {
@@ -500,36 +496,14 @@ static inline int16_t clamp16(int32_t x) {
 // Main loop pops samples non-blocking (like USB path).
 // ==========================================================
 #define MIC_RB_SIZE 1024u  // Must be power-of-two
-#if (MIC_RB_SIZE & (MIC_RB_SIZE - 1u)) != 0
-#error "MIC_RB_SIZE must be power-of-two"
-#endif
-
-static int16_t g_mic_rb[MIC_RB_SIZE];
-static volatile uint32_t g_mic_w = 0;
-static volatile uint32_t g_mic_r = 0;
-
-static inline uint32_t mic_rb_next(uint32_t x) { return (x + 1u) & (MIC_RB_SIZE - 1u); }
-
-static inline bool mic_rb_push(int16_t s) {
-    uint32_t w = g_mic_w;
-    uint32_t n = mic_rb_next(w);
-    if (n == g_mic_r) return false; // full — drop
-    g_mic_rb[w] = s;
-    g_mic_w = n;
-    return true;
-}
 
-static inline bool mic_rb_pop(int16_t *out) {
-    uint32_t r = g_mic_r;
-    if (r == g_mic_w) return false; // empty
-    *out = g_mic_rb[r];
-    g_mic_r = mic_rb_next(r);
-    return true;
-}
+SPSC_DEFINE(mic_rb, int16_t, MIC_RB_SIZE)
+static mic_rb_t g_mic_rb;
 
 // Timer ISR: lightweight ADC read + DC removal at 8 kHz
 static bool mic_timer_callback(struct repeating_timer *t) {
     (void)t;
+    const uint32_t t0 = time_us_32();
 
     // DC removal state (lives only in ISR context)
     static float dc_prev_x = 0.0f;
@@ -547,8 +521,11 @@ static bool mic_timer_callback(struct repeating_timer *t) {
 
     // Scale to int16 and push to ring buffer
     int16_t s = clamp16((int32_t)(y * 32767.0f));
-    mic_rb_push(s);
+    mic_rb_push(&g_mic_rb, s);    // full: dropped (counted)
 
+    g_irq_tmr_n[get_core_num()]++;
+    const uint32_t dt = time_us_32() - t0;
+    if (dt > g_irq_tmr_max_us) g_irq_tmr_max_us = dt;
     return true;  // keep repeating
 }
 
@@ -557,9 +534,8 @@ static volatile bool g_mic_timer_running = false;
 
 static void mic_timer_start(void) {
     if (g_mic_timer_running) return;
-    // Flush ring buffer
-    g_mic_w = 0;
-    g_mic_r = 0;
+    // Flush ring buffer (timer stopped: no producer)
+    mic_rb_init(&g_mic_rb);
     // Negative period = exact interval (accounts for callback duration)
     add_repeating_timer_us(-125, mic_timer_callback, NULL, &g_mic_timer);
     g_mic_timer_running = true;
@@ -571,156 +547,105 @@ static void mic_timer_stop(void) {
     g_mic_timer_running = false;
 }
 
-// Read host audio (PCM16LE stereo), push to ringbuffer
-static void usb_audio_pump(void);
+// Resampler: host SR stereo -> 8 kHz mono (farrow.h: decimator + Farrow
+// interpolator with anti-alias lowpass, designed for the host's rate).
+// With smoothed adaptive rate to prevent buffer overflow and pitch artifacts.
+// Single instance: it drains the USB ring and owns INTERP1 lane 0.
+typedef struct {
+    uint32_t    src_rate;
+    uint32_t    base_step_q16;      // middle-rate samples per output, Q16
+    uint32_t    smooth_step_q16;    // Smoothed step for gradual changes
+    q16_phase_t phase;              // INTERP1 lane 0 on the device
+    bool        phase_init;
+    stereo16_t  last;               // held when the ring runs dry
+    farrow_t    fr;
+} usb_resampler_t;
 
-// Resampler: host SR stereo -> 8 kHz mono
-// With smoothed adaptive rate to prevent buffer overflow and pitch artifacts
-static int16_t usb_audio_get_mono_8k(void) {
-    static uint32_t src_rate = 48000u;
-    static uint32_t base_step_q16 = 0;
-    static uint32_t smooth_step_q16 = 0;  // Smoothed step for gradual changes
-    static uint32_t phase_q16 = 0;
+static usb_resampler_t g_usb_rs;
 
-    static stereo16_t s0 = {0,0};
-    static stereo16_t s1 = {0,0};
-    static stereo16_t s2 = {0,0};  // Extra sample for cubic interpolation
-    static stereo16_t sm1 = {0,0}; // s[-1] for cubic
-    static bool primed = false;
+static int16_t usb_audio_get_mono_8k(void) {
+    usb_resampler_t *rs = &g_usb_rs;
 
     uint32_t sr = g_usb_sample_rate_hz;
     if (!sr) sr = 48000u;
 
-    if (sr != src_rate || base_step_q16 == 0) {
-        src_rate = sr;
-        base_step_q16 = (uint32_t)(((uint64_t)src_rate << 16) / (uint32_t)WAV_SAMPLE_RATE);
-        smooth_step_q16 = base_step_q16;
+    if (sr != rs->src_rate || rs->base_step_q16 == 0) {
+        rs->src_rate = sr;
+        farrow_design(&rs->fr, sr);
+        rs->base_step_q16 = (uint32_t)(((uint64_t)rs->fr.mid_rate << 16) / (uint32_t)WAV_SAMPLE_RATE);
+        rs->smooth_step_q16 = rs->base_step_q16;
+        rs->last = (stereo16_t){0,0};
+        if (rs->phase_init) q16_phase_reset(&rs->phase);
+        farrow_print(&rs->fr, "rate");
     }
 
     // *** Adaptive rate with heavy smoothing ***
-    uint32_t usb_w = g_usb_w;
-    uint32_t usb_r = g_usb_r;
-    uint32_t fill = (usb_w >= usb_r) ? (usb_w - usb_r) : (USB_RB_FRAMES - usb_r + usb_w);
+    uint32_t fill = usb_rb_fill(&g_usb_rb);
     
     const uint32_t target_fill = USB_RB_FRAMES / 2;
-    uint32_t target_step = base_step_q16;
+    uint32_t target_step = rs->base_step_q16;
     
     if (fill > target_fill) {
         uint32_t excess = fill - target_fill;
-        uint32_t adj = (base_step_q16 * excess) / (USB_RB_FRAMES * 10);
-        target_step = base_step_q16 + adj;
+        uint32_t adj = (rs->base_step_q16 * excess) / (USB_RB_FRAMES * 10);
+        target_step = rs->base_step_q16 + adj;
     } else if (fill < target_fill) {
         uint32_t deficit = target_fill - fill;
-        uint32_t adj = (base_step_q16 * deficit) / (USB_RB_FRAMES * 10);
-        target_step = base_step_q16 - adj;
+        uint32_t adj = (rs->base_step_q16 * deficit) / (USB_RB_FRAMES * 10);
+        target_step = rs->base_step_q16 - adj;
     }
     
     // Heavy smoothing: move only 1/256 of the way to target each sample
     // This prevents audible pitch wobble
-    if (smooth_step_q16 < target_step) {
-        uint32_t diff = target_step - smooth_step_q16;
-        smooth_step_q16 += (diff >> 8) + 1;
-        if (smooth_step_q16 > target_step) smooth_step_q16 = target_step;
-    } else if (smooth_step_q16 > target_step) {
-        uint32_t diff = smooth_step_q16 - target_step;
-        smooth_step_q16 -= (diff >> 8) + 1;
-        if (smooth_step_q16 < target_step) smooth_step_q16 = target_step;
-    }
-
-    if (!primed) {
-        if (!usb_rb_pop(&sm1)) sm1 = (stereo16_t){0,0};
-        if (!usb_rb_pop(&s0)) s0 = (stereo16_t){0,0};
-        if (!usb_rb_pop(&s1)) s1 = (stereo16_t){0,0};
-        if (!usb_rb_pop(&s2)) s2 = (stereo16_t){0,0};
-        phase_q16 = 0;
-        primed = true;
-    }
-
-    phase_q16 += smooth_step_q16;
-    while (phase_q16 >= (1u << 16)) {
-        phase_q16 -= (1u << 16);
-        sm1 = s0;
-        s0 = s1;
-        s1 = s2;
-        if (!usb_rb_pop(&s2)) s2 = s1;  // Hold last value if empty
-    }
-
-    // Cubic Hermite interpolation for smoother audio
-    float t = (float)phase_q16 / 65536.0f;
-    float t2 = t * t;
-    float t3 = t2 * t;
-    
-    // Hermite basis functions
-    float h00 = 2*t3 - 3*t2 + 1;
-    float h10 = t3 - 2*t2 + t;
-    float h01 = -2*t3 + 3*t2;
-    float h11 = t3 - t2;
-    
-    // Left channel
-    float m0_l = (float)(s1.l - sm1.l) * 0.5f;
-    float m1_l = (float)(s2.l - s0.l) * 0.5f;
-    float l = h00 * s0.l + h10 * m0_l + h01 * s1.l + h11 * m1_l;
-    
-    // Right channel
-    float m0_r = (float)(s1.r - sm1.r) * 0.5f;
-    float m1_r = (float)(s2.r - s0.r) * 0.5f;
-    float r = h00 * s0.r + h10 * m0_r + h01 * s1.r + h11 * m1_r;
-
-    float mono = (l + r) * 0.5f;
+    if (rs->smooth_step_q16 < target_step) {
+        uint32_t diff = target_step - rs->smooth_step_q16;
+        rs->smooth_step_q16 += (diff >> 8) + 1;
+        if (rs->smooth_step_q16 > target_step) rs->smooth_step_q16 = target_step;
+    } else if (rs->smooth_step_q16 > target_step) {
+        uint32_t diff = rs->smooth_step_q16 - target_step;
+        rs->smooth_step_q16 -= (diff >> 8) + 1;
+        if (rs->smooth_step_q16 < target_step) rs->smooth_step_q16 = target_step;
+    }
+
+    if (!rs->phase_init) {
+        q16_phase_init(&rs->phase, rs->smooth_step_q16);
+        rs->phase_init = true;
+    }
+    q16_phase_set_step(&rs->phase, rs->smooth_step_q16);
+
+    // Integer part: middle-rate samples to produce (each takes fr.dec
+    // host frames); the fraction stays behind as the Farrow mu
+    uint32_t phase_q16 = q16_phase_advance(&rs->phase);
+    for (uint32_t k = phase_q16 >> 16; k; k--) {
+        bool done;
+        do {
+            stereo16_t s;
+            if (usb_rb_pop(&g_usb_rb, &s)) rs->last = s;   // Hold last value if empty
+            done = farrow_push(&rs->fr, ((float)rs->last.l + (float)rs->last.r) * 0.5f);
+        } while (!done);
+    }
+
+    float mono = farrow_out(&rs->fr, (float)(phase_q16 & 0xFFFFu) * (1.0f / 65536.0f));
     return clamp16((int32_t)mono);
 }
 
 // ==========================================================
 // MIC audio: pop from timer-driven ring buffer + apply AGC/gate.
 // Analogous to usb_audio_get_mono_8k() but for ADC microphone.
-// DC removal is done in timer ISR; AGC + gate are done here
-// so they can use runtime-configurable params from cfg_local.
+// DC removal is done in timer ISR; AGC + gate (dsp.c) are done here
+// so they can use runtime-configurable params from the chain's cfg.
 // Returns float in ±1.0 range, or 0.0 if no sample available.
 // ==========================================================
-static float adc_mic_get_sample(float agc_target, float agc_max_gain,
-                                float agc_attack, float agc_release,
-                                float gate_thresh) {
-    // AGC: envelope follower + gain (persistent across calls)
-    static float agc_env = 0.0f;
-    static float agc_gain = 1.0f;
-
-    const float AGC_MIN_GAIN = 0.1f;
+static mic_agc_t g_mic_agc = { 0.0f, 1.0f };
 
+static float adc_mic_get_sample(const audio_cfg_t *cfg) {
     // Pop from mic ring buffer (filled by timer ISR)
     int16_t raw16;
-    if (!mic_rb_pop(&raw16)) {
+    if (!mic_rb_pop(&g_mic_rb, &raw16)) {
         return 0.0f;  // No sample available — return silence
     }
 
-    float y = (float)raw16 / 32767.0f;
-
-    // AGC envelope follower (peak detector)
-    float abs_y = (y >= 0.0f) ? y : -y;
-    if (abs_y > agc_env) {
-        agc_env += agc_attack * (abs_y - agc_env);
-    } else {
-        agc_env += agc_release * (abs_y - agc_env);
-    }
-
-    // Noise gate: if envelope is below threshold, output silence
-    if (agc_env < gate_thresh) {
-        return 0.0f;
-    }
-
-    // Compute gain from envelope
-    if (agc_env > 1e-6f) {
-        agc_gain = agc_target / agc_env;
-        if (agc_gain > agc_max_gain) agc_gain = agc_max_gain;
-        if (agc_gain < AGC_MIN_GAIN) agc_gain = AGC_MIN_GAIN;
-    }
-
-    float out = y * agc_gain;
-
-    // Hard limiter to prevent clipping
-    if (out > 1.0f) out = 1.0f;
-    if (out < -1.0f) out = -1.0f;
-
-    return out;
+    return mic_agc_process(&g_mic_agc, (float)raw16 / 32767.0f, cfg);
 }
 
 // ==========================================================
@@ -752,7 +677,8 @@ bool tud_audio_set_req_ep_cb(uint8_t rhport, tusb_control_request_t const *p_req
         p_request->bRequest == AUDIO10_CS_REQ_SET_CUR) {
         TU_VERIFY(p_request->wLength == 3);
         uint32_t sr = tu_unaligned_read32(pBuff) & 0x00FFFFFF;
-        if (sr) g_usb_sample_rate_hz = sr;
+        TU_VERIFY(farrow_rate_ok(sr));      // only the advertised rates
+        g_usb_sample_rate_hz = sr;
         return true;
     }
     return false;
@@ -852,6 +778,115 @@ void tud_audio_feedback_params_cb(uint8_t func_id, uint8_t alt_itf, audio_feedba
 }
 #endif
 
+// ==========================================================
+// USB MSC: FAT volume in flash below the config sector (mscdisk.c)
+// ==========================================================
+#if CFG_TUD_MSC
+#define MSC_FLASH_OFFSET   (CFG_FLASH_OFFSET - MSC_VOLUME_BYTES)
+
+extern char __flash_binary_end;     // linker: end of the firmware image
+
+typedef struct {
+    uint32_t       offset;
+    const uint8_t *data;
+} msc_flash_req_t;
+
+// Same rules as persist_flash_op: RAM only, XIP is off while it runs
+static void SX_RAMFUNC(msc_flash_op)(void *param) {
+    const msc_flash_req_t *r = (const msc_flash_req_t *)param;
+    flash_range_erase(r->offset, FLASH_SECTOR_SIZE);
+    flash_range_program(r->offset, r->data, FLASH_SECTOR_SIZE);
+}
+
+static bool msc_flash_program(uint32_t sector, const uint8_t *data, void *ctx) {
+    (void)ctx;
+    msc_flash_req_t r = { MSC_FLASH_OFFSET + sector * MSC_SECTOR_SIZE, data };
+    return flash_exec_locked(msc_flash_op, &r) == PICO_OK;
+}
+
+static const msc_backend_t g_msc_be = {
+    .base    = (const uint8_t *)(XIP_BASE + MSC_FLASH_OFFSET),
+    .program = msc_flash_program,
+    .ctx     = NULL,
+};
+
+// The volume only exists if the firmware image ends below it
+static void msc_init(void) {
+    uint32_t img_end = (uint32_t)((uintptr_t)&__flash_binary_end - XIP_BASE);
+    if (img_end > MSC_FLASH_OFFSET) {
+        printf("[MSC] image ends at 0x%lx, overlaps volume: disabled\n", (unsigned long)img_end);
+        return;
+    }
+    mscdisk_init(&g_msc_be);
+}
+
+// Anything on air: producer keying, GUI TX / PTT, TUNE / CW carrier,
+// or a tx_at transmission scheduled or under way
+static inline bool msc_tx_active(void) {
+    return g_dbg_prod_txon || g_tx_enabled || g_ptt_key || g_cw_test_mode || txsched_busy() || afsk_active();
+}
+
+// The cache is shared with the MSC callbacks, which run in the USB worker;
+// the lock is only taken when there is something to flush
+static void msc_poll(void) {
+    const bool tx = msc_tx_active();
+    if (!mscdisk_pending(tx)) return;
+    const bool locked = usb_lock();
+    mscdisk_poll(tx);
+    usb_unlock(locked);
+}
+
+void tud_msc_inquiry_cb(uint8_t lun, uint8_t vendor_id[8], uint8_t product_id[16], uint8_t product_rev[4]) {
+    (void)lun;
+    memcpy(vendor_id,   "SP8ESA  ", 8);
+    memcpy(product_id,  "SX1280 Storage  ", 16);
+    memcpy(product_rev, "1.0 ", 4);
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+    (void)lun;
+    if (mscdisk_ready()) return true;
+    tud_msc_set_sense(lun, SCSI_SENSE_NOT_READY, 0x3A, 0x00);  // medium not present
+    return false;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t *block_count, uint16_t *block_size) {
+    (void)lun;
+    *block_count = mscdisk_ready() ? MSC_BLOCKS : 0;
+    *block_size  = MSC_BLOCK_SIZE;
+}
+
+bool tud_msc_start_stop_cb(uint8_t lun, uint8_t power_condition, bool start, bool load_eject) {
+    (void)lun; (void)power_condition;
+    if (load_eject && !start) mscdisk_sync();   // eject: get it onto flash
+    return true;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void *buffer, uint32_t bufsize) {
+    (void)lun;
+    return mscdisk_read(lba, offset, buffer, bufsize);
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t *buffer, uint32_t bufsize) {
+    (void)lun;
+    return mscdisk_write(lba, offset, buffer, bufsize);   // 0 = busy, host retries
+}
+
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void *buffer, uint16_t bufsize) {
+    (void)buffer; (void)bufsize;
+    switch (scsi_cmd[0]) {
+        case 0x35:                                  // SYNCHRONIZE CACHE (10)
+            mscdisk_sync();
+            return 0;
+        case SCSI_CMD_PREVENT_ALLOW_MEDIUM_REMOVAL:
+            return 0;
+        default:
+            tud_msc_set_sense(lun, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00);
+            return -1;
+    }
+}
+#endif
+
 // ==========================================================
 // SX1280 low-level radio I/O (CORE1 ONLY)
 // ==========================================================
@@ -873,10 +908,6 @@ static inline void sx_wait_busy(void) {
     }
 }
 
-// Forward declarations for CDC functions
-static void cdc_printf(const char *fmt, ...);
-static void cdc_write_str(const char *s);
-
 static void sx_write_cmd(uint8_t opcode, const uint8_t *params, size_t len) {
     extern volatile uint32_t g_dbg_core1_bc;
     uint32_t save_bc = g_dbg_core1_bc;
@@ -935,29 +966,6 @@ static inline void sx_set_rf_frequency_steps(uint32_t steps) {
     sx_write_cmd(OPCODE_SET_RF_FREQUENCY, p, 3);
 }
 
-static inline uint32_t hz_to_steps(uint32_t freq_hz) {
-    return (uint32_t)((double)freq_hz / (double)PLL_STEP_HZ);
-}
-
-// Calculate corrected frequency with PPM
-static inline double get_corrected_freq_hz(void) {
-    return g_target_freq_hz * (1.0 + (double)g_ppm_correction / 1000000.0);
-}
-
-// Get base PLL steps (integer part)
-static inline uint32_t get_base_steps(void) {
-    double corrected_hz = get_corrected_freq_hz();
-    return (uint32_t)(corrected_hz / (double)PLL_STEP_HZ);
-}
-
-// Get fine tune offset in Hz (fractional part that PLL can't reach)
-static inline float get_fine_tune_hz(void) {
-    double corrected_hz = get_corrected_freq_hz();
-    uint32_t base_steps = (uint32_t)(corrected_hz / (double)PLL_STEP_HZ);
-    double base_hz = (double)base_steps * (double)PLL_STEP_HZ;
-    return (float)(corrected_hz - base_hz);
-}
-
 // Get SX1280 status byte
 static uint8_t sx_get_status(void) {
     sx_wait_busy();
@@ -1009,10 +1017,15 @@ static void sx_print_diag(void) {
     cdc_printf("Underruns: %lu\r\n", (unsigned long)g_underruns);
     
     // USB audio buffer
-    uint32_t usb_w = g_usb_w;
-    uint32_t usb_r = g_usb_r;
-    uint32_t usb_fill = (usb_w >= usb_r) ? (usb_w - usb_r) : (USB_RB_FRAMES - usb_r + usb_w);
-    cdc_printf("USB ringbuf: %lu/%lu frames\r\n", (unsigned long)usb_fill, (unsigned long)USB_RB_FRAMES);
+    cdc_printf("USB ringbuf: %lu/%lu frames hw=%lu drop=%lu\r\n",
+               (unsigned long)usb_rb_fill(&g_usb_rb), (unsigned long)USB_RB_FRAMES,
+               (unsigned long)g_usb_rb.q.hw, (unsigned long)g_usb_rb.q.drops);
+    cdc_printf("MIC ringbuf: %lu/%lu hw=%lu drop=%lu\r\n",
+               (unsigned long)mic_rb_fill(&g_mic_rb), (unsigned long)MIC_RB_SIZE,
+               (unsigned long)g_mic_rb.q.hw, (unsigned long)g_mic_rb.q.drops);
+    cdc_printf("CDC rx: %lu/%lu hw=%lu\r\n",
+               (unsigned long)cdc_rx_fill(&g_cdc_rx), (unsigned long)CDC_RX_SIZE,
+               (unsigned long)g_cdc_rx.q.hw);
     cdc_printf("==========================\r\n");
 #endif
 }
@@ -1042,14 +1055,6 @@ static void tune_apply_settings(void) {
     sx_set_tx_params_dbm(g_tx_power_max_dbm);
 }
 
-// Pump USB while waiting (keep USB alive during short delays)
-static void usb_aware_delay_ms(uint32_t ms) {
-    uint32_t start = to_ms_since_boot(get_absolute_time());
-    while ((to_ms_since_boot(get_absolute_time()) - start) < ms) {
-        tud_task();
-    }
-}
-
 // Smoothly ramp the transmitter power between two levels by stepping
 // sx_set_tx_params_dbm() with a raised-cosine envelope.  This prevents
 // key-click in CW and PTT-click in FM.  Runs on Core0 and blocks for
@@ -1077,10 +1082,10 @@ static void sx_carrier_ramp_power(int8_t from_dbm, int8_t to_dbm, uint32_t ms) {
 // Start CW/TUNE carrier (Core0 only).
 // PRECONDITION: g_cw_test_mode must already be 1 and Core1 must be idle.
 static void sx_start_carrier(void) {
-    // Ensure TCXO is on (pump USB while waiting)
+    // Ensure TCXO is on
 #if USE_TCXO_MODULE
     gpio_put(PIN_TCXO_EN, 1);
-    usb_aware_delay_ms(5);
+    sleep_ms(5);
 #endif
 
     // Full clean init: standby -> packet type -> freq -> power -> CW
@@ -1102,7 +1107,8 @@ static void sx_start_carrier(void) {
     gpio_put(PIN_RX_EN, 0);
 
     sx_start_tx_continuous_wave();
-    usb_aware_delay_ms(2);
+    if (!g_boot.first_tx_ms) g_boot.first_tx_ms = to_ms_since_boot(get_absolute_time());
+    sleep_ms(2);
 
     // Safety: re-apply frequency AFTER CW start
     sx_set_rf_frequency_steps(steps);
@@ -1149,7 +1155,7 @@ static void sx_test_cw(void) {
     if (!g_cw_test_mode) {
         g_cw_test_mode = 1;
         __compiler_memory_barrier();
-        usb_aware_delay_ms(CW_ARM_WAIT_MS);
+        sleep_ms(CW_ARM_WAIT_MS);
     }
     sx_start_carrier();
 #if CFG_TUD_CDC
@@ -1168,21 +1174,71 @@ static void sx_stop_cw(void) {
 #endif
 }
 
+// ==========================================================
+// RSSI band scan (rssiscan.c): Core0 owns SPI in CR_ST_ARMED
+// ==========================================================
+static void scan_xfer(const uint8_t *tx, uint8_t *rx, uint32_t n, void *ctx) {
+    (void)ctx;
+    cs_select();
+    if (rx) spi_write_read_blocking(SX_SPI, tx, rx, n);
+    else    spi_write_blocking(SX_SPI, tx, n);
+    cs_deselect();
+}
+
+static bool scan_busy(void *ctx) { (void)ctx; return gpio_get(PIN_BUSY); }
+
+static const scan_backend_t g_scan_be = { scan_xfer, scan_busy, NULL };
+static bool g_scan_rx;          // RF path switched to RX
+static bool g_scan_tx_en;       // PA enable to put back
+
+// Run a slice of the scan; once it is no longer wanted, put the radio
+// back in standby on the TX path.  True while scanning.
+static bool scan_radio_poll(void) {
+    scan_stats_t s;
+    rssiscan_stats(&s);
+    if (s.want) {
+        if (!g_scan_rx) {
+            g_scan_tx_en = gpio_get(PIN_TX_EN);
+            gpio_put(PIN_TX_EN, 0);
+            gpio_put(PIN_RX_EN, 1);
+            g_scan_rx = true;
+        }
+        if (!s.active) rssiscan_begin(&g_scan_be);
+        rssiscan_poll();
+        return true;
+    }
+    if (g_scan_rx) {
+        rssiscan_end();
+#if USE_TCXO_MODULE
+        sx_set_standby_xosc();
+#else
+        sx_set_standby_rc();
+#endif
+        sx_set_packet_type_gfsk();
+        gpio_put(PIN_RX_EN, 0);
+        gpio_put(PIN_TX_EN, g_scan_tx_en);
+        g_scan_rx = false;
+    }
+    return false;
+}
+
 // ==========================================================
 // Unified carrier state machine (runs on Core0 in polling loop)
 //
-// Inputs:  g_tx_mode (0=USB/SSB, 1=CW, 2=FM), g_tune_active, g_ptt_key
-// Outputs: g_cw_test_mode, SPI carrier on/off
+// Inputs:  g_tx_mode (0=USB/SSB, 1=CW, 2=FM), g_tune_active, g_ptt_key,
+//          rssiscan_wanted()
+// Outputs: g_cw_test_mode, SPI carrier on/off, RSSI scan
 //
 // Logic:
-//   need_idle  = (g_tx_mode==1) || g_tune_active     → Core1 must idle
+//   need_idle  = (g_tx_mode==1) || g_tune_active || scan → Core1 must idle
 //   need_carrier = g_tune_active || (g_tx_mode==1 && g_ptt_key)  → CW on
 //   FM mode (g_tx_mode==2) behaves like SSB — Core1 owns SPI, blocks flow.
 //
 // States:
 //   IDLE    → need_idle? set g_cw_test_mode=1, go ARMING
 //   ARMING  → wait 35ms for Core1, go ARMED
-//   ARMED   → need_carrier? sx_start_carrier → CARRIER_ON
+//   ARMED   → scan? run a scan slice, stay ARMED
+//             need_carrier? sx_start_carrier → CARRIER_ON
 //   CARRIER_ON → !need_carrier? standby → ARMED
 //   any     → !need_idle? stop carrier if on, clear g_cw_test_mode → IDLE
 // ==========================================================
@@ -1201,7 +1257,13 @@ static void carrier_poll(void) {
     bool tune        = (bool)g_tune_active;
     bool key         = (bool)g_ptt_key;
 
-    bool need_idle    = mode_cw || tune;
+    // Keying in any form ends a band scan
+    if (rssiscan_wanted() && (g_tx_enabled || key || tune || txsched_busy() || afsk_active())) {
+        rssiscan_stop("tx");
+    }
+    bool scan        = rssiscan_wanted();
+
+    bool need_idle    = mode_cw || tune || scan;
     bool need_carrier = tune || (mode_cw && key);
 
     // Guard window after mode change: force carrier off so CW/TUNE
@@ -1242,6 +1304,7 @@ static void carrier_poll(void) {
         break;
 
     case CR_ST_ARMED:
+        if (scan_radio_poll()) break;
         if (!need_idle) {
             // Return to SSB — restore Core1
             g_cw_test_mode = 0;
@@ -1286,856 +1349,111 @@ static void carrier_poll(void) {
     }
 }
 
-// ==========================================================
-// DSP blocks (biquads + compressor + hilbert)
-// ==========================================================
-typedef struct {
-    float b0, b1, b2;
-    float a1, a2;
-    float z1, z2;
-} biquad_t;
+static void cdc_task(void) {
+#if CFG_TUD_CDC
+    static char line[CDC_LINE_MAX];
+    static uint32_t pos = 0;
 
-static inline void biquad_reset(biquad_t *q) { q->z1 = 0.0f; q->z2 = 0.0f; }
+    // Bytes were copied out of TinyUSB by the USB worker
+    // (one at a time: a command handler may run cdc_task() again)
+    uint8_t c;
+    while (cdc_rx_pop(&g_cdc_rx, &c)) {
+        char ch = (char)c;
 
-static inline float biquad_process(biquad_t *q, float x) {
-    float y = q->b0 * x + q->z1;
-    q->z1 = q->b1 * x - q->a1 * y + q->z2;
-    q->z2 = q->b2 * x - q->a2 * y;
-    return y;
+        if (ch == '\r' || ch == '\n') {
+            if (pos > 0) {
+                line[pos] = 0;
+                cdc_handle_line(line);
+                pos = 0;
+            }
+        } else {
+            if (pos < sizeof(line) - 1) {
+                line[pos++] = ch;
+            }
+        }
+    }
+#endif
 }
 
-static void biquad_init_lowpass_bw2(biquad_t *q, float fc, float fs) {
-    const float K  = tanf((float)M_PI * fc / fs);
-    const float K2 = K * K;
-    const float s2 = 1.41421356f;
-    const float norm = 1.0f / (1.0f + s2 * K + K2);
-
-    q->b0 = K2 * norm;
-    q->b1 = 2.0f * q->b0;
-    q->b2 = q->b0;
-
-    q->a1 = 2.0f * (K2 - 1.0f) * norm;
-    q->a2 = (1.0f - s2 * K + K2) * norm;
+// ==========================================================
+// OLED display — simple text, DMA transfer
+// ==========================================================
+#define QO100_DOWNLINK_OFFSET_HZ  8089500000.0
 
-    biquad_reset(q);
+// Helper: right-justify a 1x string ending at x_right edge
+static void draw_string_right(int x_right, int page, const char *str) {
+    int len = 0;
+    const char *p = str;
+    while (*p++) len++;
+    int x = x_right - len * 6;
+    ssd1306_draw_string(x, page, str);
 }
 
-static void biquad_init_highpass_bw2(biquad_t *q, float fc, float fs) {
-    const float K  = tanf((float)M_PI * fc / fs);
-    const float K2 = K * K;
-    const float s2 = 1.41421356f;
-    const float norm = 1.0f / (1.0f + s2 * K + K2);
-
-    q->b0 = 1.0f * norm;
-    q->b1 = -2.0f * q->b0;
-    q->b2 = q->b0;
-
-    q->a1 = 2.0f * (K2 - 1.0f) * norm;
-    q->a2 = (1.0f - s2 * K + K2) * norm;
-
-    biquad_reset(q);
+// Draw a 2x-height arrow-up glyph into framebuf at (x, page..page+1)
+static void draw_arrow_up_2x(int x, int page) {
+    static const uint8_t src[] = {0x04, 0x02, 0x7F, 0x02, 0x04};
+    uint8_t *fb = ssd1306_get_framebuf();
+    for (int c = 0; c < 5; c++) {
+        uint16_t expanded = 0;
+        for (int b = 0; b < 7; b++)
+            if (src[c] & (1 << b)) expanded |= (3u << (b * 2));
+        uint8_t lo = (uint8_t)(expanded & 0xFF);
+        uint8_t hi = (uint8_t)((expanded >> 8) & 0xFF);
+        for (int dx = 0; dx < 2; dx++) {
+            int px = x + c * 2 + dx;
+            if (px >= 0 && px < SSD1306_WIDTH) {
+                fb[page * SSD1306_WIDTH + px] = lo;
+                fb[(page + 1) * SSD1306_WIDTH + px] = hi;
+            }
+        }
+    }
 }
 
-static void biquad_init_low_shelf(biquad_t *q, float fc, float fs, float gain_db) {
-    const float A = powf(10.0f, gain_db / 40.0f);
-    const float w0 = 2.0f * (float)M_PI * fc / fs;
-    const float cw = cosf(w0);
-    const float sw = sinf(w0);
-    const float alpha = sw * 0.5f * 1.41421356f;
-
-    float b0 =    A*((A+1.0f) - (A-1.0f)*cw + 2.0f*sqrtf(A)*alpha);
-    float b1 =  2.0f*A*((A-1.0f) - (A+1.0f)*cw);
-    float b2 =    A*((A+1.0f) - (A-1.0f)*cw - 2.0f*sqrtf(A)*alpha);
-    float a0 =        (A+1.0f) + (A-1.0f)*cw + 2.0f*sqrtf(A)*alpha;
-    float a1 =   -2.0f*((A-1.0f) + (A+1.0f)*cw);
-    float a2 =        (A+1.0f) + (A-1.0f)*cw - 2.0f*sqrtf(A)*alpha;
-
-    q->b0 = b0 / a0; q->b1 = b1 / a0; q->b2 = b2 / a0;
-    q->a1 = a1 / a0; q->a2 = a2 / a0;
-    biquad_reset(q);
+// Draw a 2x-height arrow-down glyph into framebuf at (x, page..page+1)
+static void draw_arrow_down_2x(int x, int page) {
+    static const uint8_t src[] = {0x10, 0x20, 0x7F, 0x20, 0x10};
+    uint8_t *fb = ssd1306_get_framebuf();
+    for (int c = 0; c < 5; c++) {
+        uint16_t expanded = 0;
+        for (int b = 0; b < 7; b++)
+            if (src[c] & (1 << b)) expanded |= (3u << (b * 2));
+        uint8_t lo = (uint8_t)(expanded & 0xFF);
+        uint8_t hi = (uint8_t)((expanded >> 8) & 0xFF);
+        for (int dx = 0; dx < 2; dx++) {
+            int px = x + c * 2 + dx;
+            if (px >= 0 && px < SSD1306_WIDTH) {
+                fb[page * SSD1306_WIDTH + px] = lo;
+                fb[(page + 1) * SSD1306_WIDTH + px] = hi;
+            }
+        }
+    }
 }
 
-static void biquad_init_high_shelf(biquad_t *q, float fc, float fs, float gain_db) {
-    const float A = powf(10.0f, gain_db / 40.0f);
-    const float w0 = 2.0f * (float)M_PI * fc / fs;
-    const float cw = cosf(w0);
-    const float sw = sinf(w0);
-    const float alpha = sw * 0.5f * 1.41421356f;
-
-    float b0 =    A*((A+1.0f) + (A-1.0f)*cw + 2.0f*sqrtf(A)*alpha);
-    float b1 = -2.0f*A*((A-1.0f) + (A+1.0f)*cw);
-    float b2 =    A*((A+1.0f) + (A-1.0f)*cw - 2.0f*sqrtf(A)*alpha);
-    float a0 =        (A+1.0f) - (A-1.0f)*cw + 2.0f*sqrtf(A)*alpha;
-    float a1 =    2.0f*((A-1.0f) - (A+1.0f)*cw);
-    float a2 =        (A+1.0f) - (A-1.0f)*cw - 2.0f*sqrtf(A)*alpha;
-
-    q->b0 = b0 / a0; q->b1 = b1 / a0; q->b2 = b2 / a0;
-    q->a1 = a1 / a0; q->a2 = a2 / a0;
-    biquad_reset(q);
+// Draw radio-on icon at pixel (x, y): dot + 2 arcs, 7px tall, ~9px wide
+static void draw_radio_on_xy(int x, int y) {
+    // Dot 2x2 at center height (y+2, y+3)
+    ssd1306_set_pixel(x,   y+2, true); ssd1306_set_pixel(x,   y+3, true);
+    ssd1306_set_pixel(x+1, y+2, true); ssd1306_set_pixel(x+1, y+3, true);
+    // Arc 1
+    ssd1306_set_pixel(x+3, y+1, true);
+    ssd1306_set_pixel(x+3, y+2, true); ssd1306_set_pixel(x+3, y+3, true);
+    ssd1306_set_pixel(x+3, y+4, true);
+    // Arc 2
+    ssd1306_set_pixel(x+5, y+0, true);
+    ssd1306_set_pixel(x+5, y+1, true);
+    ssd1306_set_pixel(x+5, y+2, true); ssd1306_set_pixel(x+5, y+3, true);
+    ssd1306_set_pixel(x+5, y+4, true);
+    ssd1306_set_pixel(x+5, y+5, true);
 }
 
-typedef struct {
-    float env;
-    float a_att, a_rel;
-    float thr_db, ratio, makeup_lin, knee_db;
-} compressor_t;
-
-static inline float compressor_gain_db(const compressor_t *c, float in_db) {
-    const float thr = c->thr_db;
-    const float r = c->ratio;
-
-    if (c->knee_db <= 0.0f) {
-        if (in_db <= thr) return 0.0f;
-        float out_db = thr + (in_db - thr) / r;
-        return out_db - in_db;
-    }
-
-    const float k = c->knee_db;
-    const float x0 = thr - k * 0.5f;
-    const float x1 = thr + k * 0.5f;
-
-    if (in_db <= x0) return 0.0f;
-    if (in_db >= x1) {
-        float out_db = thr + (in_db - thr) / r;
-        return out_db - in_db;
-    }
-
-    const float t = (in_db - x0) / (x1 - x0);
-    float out1 = thr + (x1 - thr) / r;
-    float g1 = out1 - x1;
-    return g1 * t * t;
+// Draw radio-off icon at pixel (x, y): just a dot, 7px tall, 2px wide
+static void draw_radio_off_xy(int x, int y) {
+    ssd1306_set_pixel(x,   y+2, true); ssd1306_set_pixel(x,   y+3, true);
+    ssd1306_set_pixel(x+1, y+2, true); ssd1306_set_pixel(x+1, y+3, true);
 }
 
-static inline float compressor_process(compressor_t *c, float x) {
-    float ax = fabsf(x);
-    if (ax > c->env) c->env = c->a_att * c->env + (1.0f - c->a_att) * ax;
-    else            c->env = c->a_rel * c->env + (1.0f - c->a_rel) * ax;
-
-    float env = fmaxf(c->env, 1e-8f);
-    float in_db = 20.0f * log10f(env);
-
-    float g_db = compressor_gain_db(c, in_db);
-    float g_lin = powf(10.0f, g_db / 20.0f) * c->makeup_lin;
-
-    return x * g_lin;
-}
-
-// ==========================================================
-// Runtime-configurable DSP settings (over USB CDC)
-// ==========================================================
-typedef struct {
-    uint8_t enable_bandpass;
-    uint8_t enable_eq;
-    uint8_t enable_comp;
-
-    float bp_lo_hz;
-    float bp_hi_hz;
-    uint8_t bp_stages;      // 1-10, each stage = 12 dB/octave
-
-    float eq_low_hz;
-    float eq_low_db;
-    float eq_high_hz;
-    float eq_high_db;
-
-    float comp_thr_db;
-    float comp_ratio;
-    float comp_attack_ms;
-    float comp_release_ms;
-    float comp_makeup_db;
-    float comp_knee_db;
-    float comp_out_limit;
-
-    float amp_gain;
-    float amp_min_a;
-
-    // MIC AGC (for ADC microphone input)
-    float mic_agc_target;    // Target envelope level (0..1)
-    float mic_agc_max_gain;  // Maximum gain (prevents noise pumping in silence)
-    float mic_agc_attack;    // Attack coefficient (0..1, higher = faster)
-    float mic_agc_release;   // Release coefficient (0..1, higher = faster)
-    float mic_gate_thresh;   // Noise gate threshold — below this, output is zero
-} audio_cfg_t;
-
-static volatile audio_cfg_t g_cfg = {
-    .enable_bandpass = AUDIO_ENABLE_BANDPASS,
-    .enable_eq       = AUDIO_ENABLE_EQ,
-    .enable_comp     = AUDIO_ENABLE_COMPRESSOR,
-
-    .bp_lo_hz  = AUDIO_BP_LO_HZ,
-    .bp_hi_hz  = AUDIO_BP_HI_HZ,
-    .bp_stages = AUDIO_BP_DEFAULT_STAGES,
-
-    .eq_low_hz  = EQ_LOW_SHELF_HZ,
-    .eq_low_db  = EQ_LOW_SHELF_DB,
-    .eq_high_hz = EQ_HIGH_SHELF_HZ,
-    .eq_high_db = EQ_HIGH_SHELF_DB,
-
-    .comp_thr_db     = COMP_THRESHOLD_DB,
-    .comp_ratio      = COMP_RATIO,
-    .comp_attack_ms  = COMP_ATTACK_MS,
-    .comp_release_ms = COMP_RELEASE_MS,
-    .comp_makeup_db  = COMP_MAKEUP_DB,
-    .comp_knee_db    = COMP_KNEE_DB,
-    .comp_out_limit  = COMP_OUTPUT_LIMIT,
-
-    .amp_gain  = AMP_GAIN,
-    .amp_min_a = AMP_MIN_A,
-
-    .mic_agc_target   = 0.75f,
-    .mic_agc_max_gain = 1.0f,
-    .mic_agc_attack   = 0.01f,
-    .mic_agc_release  = 0.0001f,
-    .mic_gate_thresh  = 0.005f,   // Below this envelope, output is silenced
-};
-static volatile uint8_t g_cfg_dirty = 1;
-
-static void compressor_reconfig(compressor_t *c, float fs, const audio_cfg_t *cfg) {
-    c->env = 0.0f;
-
-    const float att_s = cfg->comp_attack_ms  * 0.001f;
-    const float rel_s = cfg->comp_release_ms * 0.001f;
-    c->a_att = expf(-1.0f / (fmaxf(att_s, 1e-4f) * fs));
-    c->a_rel = expf(-1.0f / (fmaxf(rel_s, 1e-4f) * fs));
-
-    c->thr_db = cfg->comp_thr_db;
-    c->ratio  = fmaxf(cfg->comp_ratio, 1.0f);
-    c->makeup_lin = powf(10.0f, cfg->comp_makeup_db / 20.0f);
-    c->knee_db    = fmaxf(cfg->comp_knee_db, 0.0f);
-}
-
-static void cfg_sanitize(audio_cfg_t *c, float fs) {
-    if (c->bp_lo_hz < 50.0f) c->bp_lo_hz = 50.0f;
-    float max_hi = fs * 0.45f;
-    if (c->bp_hi_hz > max_hi) c->bp_hi_hz = max_hi;
-    if (c->bp_hi_hz <= c->bp_lo_hz + 50.0f) c->bp_hi_hz = c->bp_lo_hz + 50.0f;
-
-    if (c->eq_low_hz < 50.0f) c->eq_low_hz = 50.0f;
-    if (c->eq_low_hz > fs * 0.45f) c->eq_low_hz = fs * 0.45f;
-
-    if (c->eq_high_hz < 50.0f) c->eq_high_hz = 50.0f;
-    if (c->eq_high_hz > fs * 0.45f) c->eq_high_hz = fs * 0.45f;
-
-    if (c->comp_ratio < 1.0f) c->comp_ratio = 1.0f;
-    if (c->comp_attack_ms < 0.1f) c->comp_attack_ms = 0.1f;
-    if (c->comp_release_ms < 1.0f) c->comp_release_ms = 1.0f;
-
-    if (c->comp_out_limit < 0.05f) c->comp_out_limit = 0.05f;
-    if (c->comp_out_limit > 0.999f) c->comp_out_limit = 0.999f;
-
-    if (c->amp_gain < 0.01f) c->amp_gain = 0.01f;
-    if (c->amp_min_a < 1e-9f) c->amp_min_a = 1e-9f;
-
-    // MIC AGC
-    if (c->mic_agc_target < 0.01f) c->mic_agc_target = 0.01f;
-    if (c->mic_agc_target > 1.0f) c->mic_agc_target = 1.0f;
-    if (c->mic_agc_max_gain < 1.0f) c->mic_agc_max_gain = 1.0f;
-    if (c->mic_agc_max_gain > 200.0f) c->mic_agc_max_gain = 200.0f;
-    if (c->mic_agc_attack < 0.0001f) c->mic_agc_attack = 0.0001f;
-    if (c->mic_agc_attack > 0.5f) c->mic_agc_attack = 0.5f;
-    if (c->mic_agc_release < 0.00001f) c->mic_agc_release = 0.00001f;
-    if (c->mic_agc_release > 0.1f) c->mic_agc_release = 0.1f;
-    if (c->mic_gate_thresh < 0.0f) c->mic_gate_thresh = 0.0f;
-    if (c->mic_gate_thresh > 0.5f) c->mic_gate_thresh = 0.5f;
-
-    // Clamp bp_stages to valid range
-    if (c->bp_stages < 1) c->bp_stages = 1;
-    if (c->bp_stages > AUDIO_BP_MAX_STAGES) c->bp_stages = AUDIO_BP_MAX_STAGES;
-}
-
-static void apply_cfg_if_dirty(float Fs,
-                              biquad_t *bp_hpf, biquad_t *bp_lpf,
-                              biquad_t *eq_low, biquad_t *eq_high,
-                              compressor_t *comp,
-                              audio_cfg_t *out_cfg)
-{
-    if (!g_cfg_dirty) return;
-
-    audio_cfg_t tmp;
-    __compiler_memory_barrier();
-    memcpy(&tmp, (const void*)&g_cfg, sizeof(tmp));
-    __compiler_memory_barrier();
-
-    cfg_sanitize(&tmp, Fs);
-
-#if AUDIO_BP_MAX_STAGES
-    for (int i = 0; i < AUDIO_BP_MAX_STAGES; i++) {
-        biquad_init_highpass_bw2(&bp_hpf[i], tmp.bp_lo_hz, Fs);
-        biquad_init_lowpass_bw2 (&bp_lpf[i], tmp.bp_hi_hz, Fs);
-    }
-#else
-    (void)bp_hpf; (void)bp_lpf;
-#endif
-
-    biquad_init_low_shelf (eq_low,  tmp.eq_low_hz,  Fs, tmp.eq_low_db);
-    biquad_init_high_shelf(eq_high, tmp.eq_high_hz, Fs, tmp.eq_high_db);
-
-    compressor_reconfig(comp, Fs, &tmp);
-
-    *out_cfg = tmp;
-
-    __compiler_memory_barrier();
-    g_cfg_dirty = 0;
-    __compiler_memory_barrier();
-}
-// ==========================================================
-// Simple USB CDC command interface (enabled only if CDC exists)
-// ==========================================================
-static int streqi(const char *a, const char *b) {
-    if (!a || !b) return 0;
-    while (*a && *b) {
-        char ca = *a++, cb = *b++;
-        if (ca >= 'A' && ca <= 'Z') ca = (char)(ca - 'A' + 'a');
-        if (cb >= 'A' && cb <= 'Z') cb = (char)(cb - 'A' + 'a');
-        if (ca != cb) return 0;
-    }
-    return (*a == 0 && *b == 0);
-}
-
-static void cdc_write_str(const char *s) {
-#if CFG_TUD_CDC
-    if (!tud_cdc_connected()) return;
-    tud_cdc_write_str(s);
-    tud_cdc_write_flush();
-#else
-    (void)s;
-#endif
-}
-
-static void cdc_printf(const char *fmt, ...) {
-#if CFG_TUD_CDC
-    if (!tud_cdc_connected()) return;
-    char b[256];
-    va_list ap;
-    va_start(ap, fmt);
-    vsnprintf(b, sizeof(b), fmt, ap);
-    va_end(ap);
-    tud_cdc_write_str(b);
-    tud_cdc_write_flush();
-#else
-    (void)fmt;
-#endif
-}
-
-static bool parse_bool(const char *s, uint8_t *out) {
-    if (!s) return false;
-    if (streqi(s, "1") || streqi(s, "on") || streqi(s, "true"))  { *out = 1; return true; }
-    if (streqi(s, "0") || streqi(s, "off")|| streqi(s, "false")) { *out = 0; return true; }
-    return false;
-}
-
-static bool parse_f(const char *s, float *out) {
-    if (!s) return false;
-    char *e = NULL;
-    float v = strtof(s, &e);
-    if (e == s) return false;
-    *out = v;
-    return true;
-}
-
-// Format large Hz value as "XXXXXXXXXX.X" into caller's buffer.
-// Needed because newlib-nano's printf uses scientific notation for big doubles.
-static void fmt_freq(char *buf, size_t len, double hz) {
-    uint64_t i = (uint64_t)hz;
-    uint32_t f = (uint32_t)((hz - (double)i) * 10.0 + 0.5);
-    if (f >= 10) { i++; f = 0; }
-    snprintf(buf, len, "%llu.%u", (unsigned long long)i, (unsigned)f);
-}
-
-static void cfg_print(void) {
-    audio_cfg_t c;
-    __compiler_memory_barrier();
-    memcpy(&c, (const void*)&g_cfg, sizeof(c));
-    __compiler_memory_barrier();
-
-    double corrected = get_corrected_freq_hz();
-    float fine = get_fine_tune_hz();
-
-    char freq_str[24], corr_str[24];
-    fmt_freq(freq_str, sizeof(freq_str), g_target_freq_hz);
-    fmt_freq(corr_str, sizeof(corr_str), corrected);
-
-    cdc_printf(
-        "CFG:\r\n"
-        "  freq=%s Hz (target)  ppm=%.3f  tx=%s  txpwr=%d dBm\r\n"
-        "  mode=%s  tune=%s\r\n"
-        "  corrected=%s Hz  base_steps=%lu  fine=%.1f Hz (auto)\r\n",
-        freq_str, g_ppm_correction, g_tx_enabled ? "ON" : "OFF", g_tx_power_max_dbm,
-        mode_label(g_tx_mode),
-        g_tune_active ? "ON" : "OFF",
-        corr_str, (unsigned long)get_base_steps(), fine);
-    cdc_printf(
-        "  enable bp=%u eq=%u comp=%u\r\n"
-        "  bp_lo=%.1f bp_hi=%.1f bp_stages=%u (%u dB/oct)\r\n"
-        "  eq_low_hz=%.1f eq_low_db=%.1f\r\n"
-        "  eq_high_hz=%.1f eq_high_db=%.1f\r\n"
-        "  comp_thr=%.1f ratio=%.2f att=%.2fms rel=%.2fms makeup=%.1f knee=%.1f outlim=%.3f\r\n"
-        "  amp_gain=%.3f amp_min_a=%.9f\r\n",
-        c.enable_bandpass, c.enable_eq, c.enable_comp,
-        c.bp_lo_hz, c.bp_hi_hz, c.bp_stages, c.bp_stages * 12,
-        c.eq_low_hz, c.eq_low_db,
-        c.eq_high_hz, c.eq_high_db,
-        c.comp_thr_db, c.comp_ratio, c.comp_attack_ms, c.comp_release_ms, c.comp_makeup_db, c.comp_knee_db, c.comp_out_limit,
-        c.amp_gain, c.amp_min_a
-    );
-    cdc_printf(
-        "  mic_agc_target=%.3f mic_agc_max_gain=%.1f mic_agc_attack=%.4f mic_agc_release=%.5f\r\n"
-        "  mic_gate_thresh=%.4f  src=%s\r\n"
-        "  fm_dev=%.0f Hz  ctcss=%.1f Hz\r\n",
-        c.mic_agc_target, c.mic_agc_max_gain, c.mic_agc_attack, c.mic_agc_release,
-        c.mic_gate_thresh, g_audio_src ? "MIC" : "PC",
-        g_fm_deviation_hz, g_ctcss_freq
-    );
-}
-
-static void cmd_help(void) {
-    cdc_write_str(
-        "Commands:\r\n"
-        "  help\r\n"
-        "  get\r\n"
-        "  diag          - show SX1280 status\r\n"
-        "  tx 0|1        - enable/disable TX (SSB modulation)\r\n"
-        "  mode usb|cw|fm - set modulation mode\r\n"
-        "  src pc|mic    - audio source (PC=USB audio, MIC=ADC0)\r\n"
-        "  tune 0|1      - toggle TUNE carrier\r\n"
-        "  cw            - start CW test transmission\r\n"
-        "  stop          - stop CW transmission\r\n"
-        "  freq <Hz>     - set frequency with sub-Hz precision (e.g. freq 2400100050.5)\r\n"
-        "  ppm <value>   - set PPM correction (e.g. ppm -0.5)\r\n"
-        "  txpwr <-18..13> - set max TX power in dBm\r\n"
-        "  enable <bp|eq|comp> <0|1|on|off>\r\n"
-        "  set bp_lo <Hz>\r\n"
-        "  set bp_hi <Hz>\r\n"
-        "  set bp_stages <1-10>  (filter steepness: 12dB/oct per stage)\r\n"
-        "  set eq_low_hz <Hz>\r\n"
-        "  set eq_low_db <dB>\r\n"
-        "  set eq_high_hz <Hz>\r\n"
-        "  set eq_high_db <dB>\r\n"
-        "  set comp_thr <dB>\r\n"
-        "  set comp_ratio <R>\r\n"
-        "  set comp_att <ms>\r\n"
-        "  set comp_rel <ms>\r\n"
-        "  set comp_makeup <dB>\r\n"
-        "  set comp_knee <dB>\r\n"
-        "  set comp_outlim <0..1>\r\n"
-        "  set amp_gain <float>\r\n"
-        "  set amp_min_a <float>\r\n"
-        "  set mic_agc_target <0..1>   (MIC AGC target level)\r\n"
-        "  set mic_agc_max_gain <1..200> (MIC AGC max gain)\r\n"
-        "  set mic_agc_attack <coeff>  (MIC AGC attack speed)\r\n"
-        "  set mic_agc_release <coeff> (MIC AGC release speed)\r\n"
-        "  set mic_gate <0..0.5>       (noise gate threshold, 0=off)\r\n"
-        "  set fm_dev <200..100000>    (FM deviation in Hz)\r\n"
-        "  set ctcss <freq|0>          (CTCSS tone Hz, 0=off)\r\n"
-        "\r\n"
-        "Frequency is automatically split into PLL steps + fine DSP offset.\r\n"
-    );
-}
-
-static void cfg_commit(const audio_cfg_t *c) {
-    __compiler_memory_barrier();
-    memcpy((void*)&g_cfg, c, sizeof(*c));
-    g_cfg_dirty = 1;
-    __compiler_memory_barrier();
-}
-
-// Periodic status push to CDC for GUI synchronization.
-// Sends a compact line that the GUI can parse to update its widgets.
-// Only sends when something changed, at most every 250 ms.
-#if CFG_TUD_CDC
-static void cdc_status_push_ex(bool force) {
-    static uint32_t last_push_ms = 0;
-    static uint8_t  last_mode = 0xFF;
-    static uint8_t  last_tune = 0xFF;
-    static uint8_t  last_tx   = 0xFF;
-    static uint8_t  last_src  = 0xFF;
-    static int8_t   last_pwr  = 127;
-    static float    last_ppm  = 9999.0f;
-    static double   last_freq = 0.0;
-    static float    last_fm_dev = -1.0f;
-    static float    last_ctcss  = -1.0f;
-
-    if (!tud_cdc_connected()) return;
-
-    uint8_t  cur_mode = g_tx_mode;
-    uint8_t  cur_tune = g_tune_active;
-    uint8_t  cur_tx   = g_tx_enabled;
-    uint8_t  cur_src  = g_audio_src;
-    int8_t   cur_pwr  = g_tx_power_max_dbm;
-    float    cur_ppm  = g_ppm_correction;
-    double   cur_freq = (double)g_target_freq_hz;
-    float    cur_fm_dev = g_fm_deviation_hz;
-    float    cur_ctcss  = g_ctcss_freq;
-
-    if (!force) {
-        // Check if anything changed
-        bool changed = (cur_mode != last_mode) || (cur_tune != last_tune) ||
-                       (cur_tx != last_tx) || (cur_src != last_src) ||
-                       (cur_pwr != last_pwr) ||
-                       (cur_ppm != last_ppm) || (cur_freq != last_freq) ||
-                       (cur_fm_dev != last_fm_dev) || (cur_ctcss != last_ctcss);
-
-        if (!changed) return;
-
-        uint32_t now = to_ms_since_boot(get_absolute_time());
-        if ((now - last_push_ms) < 100) return;
-    }
-
-    // Format freq with fmt_freq to avoid newlib-nano scientific notation
-    char freq_str[24];
-    fmt_freq(freq_str, sizeof(freq_str), cur_freq);
-
-    // PPM: format as fixed-point (4 decimals) to avoid float formatting issues
-    int ppm_neg = (cur_ppm < 0.0f);
-    float ppm_abs = ppm_neg ? -cur_ppm : cur_ppm;
-    uint32_t ppm_int = (uint32_t)ppm_abs;
-    uint32_t ppm_frac = (uint32_t)((ppm_abs - (float)ppm_int) * 10000.0f + 0.5f);
-    if (ppm_frac >= 10000) { ppm_int++; ppm_frac = 0; }
-
-    char status_buf[160];
-    // fm_dev: format as integer (no fractional Hz needed)
-    uint32_t fm_dev_int = (uint32_t)(cur_fm_dev + 0.5f);
-    // ctcss: format as X.Y (one decimal place)
-    uint32_t ctcss_int = (uint32_t)cur_ctcss;
-    uint32_t ctcss_frac = (uint32_t)((cur_ctcss - (float)ctcss_int) * 10.0f + 0.5f);
-    if (ctcss_frac >= 10) { ctcss_int++; ctcss_frac = 0; }
-
-    snprintf(status_buf, sizeof(status_buf),
-             "!S mode=%u tune=%u tx=%u src=%u pwr=%d ppm=%s%lu.%04lu freq=%s fm_dev=%lu ctcss=%lu.%lu\r\n",
-             cur_mode, cur_tune, cur_tx, cur_src, cur_pwr,
-             ppm_neg ? "-" : "", (unsigned long)ppm_int, (unsigned long)ppm_frac,
-             freq_str,
-             (unsigned long)fm_dev_int,
-             (unsigned long)ctcss_int, (unsigned long)ctcss_frac);
-    cdc_write_str(status_buf);
-
-    last_mode = cur_mode;
-    last_tune = cur_tune;
-    last_tx   = cur_tx;
-    last_src  = cur_src;
-    last_pwr  = cur_pwr;
-    last_ppm  = cur_ppm;
-    last_freq = cur_freq;
-    last_fm_dev = cur_fm_dev;
-    last_ctcss  = cur_ctcss;
-    last_push_ms = to_ms_since_boot(get_absolute_time());
-}
-
-static inline void cdc_status_push(void) { cdc_status_push_ex(false); }
-#endif
-
-static void cdc_handle_line(char *line) {
-    char *argv[6] = {0};
-    int argc = 0;
-
-    for (char *t = strtok(line, " \t\r\n"); t && argc < 6; t = strtok(NULL, " \t\r\n")) {
-        argv[argc++] = t;
-    }
-    if (argc == 0) return;
-
-    if (streqi(argv[0], "help")) { cmd_help(); return; }
-    if (streqi(argv[0], "get"))  { cfg_print(); return; }
-    if (streqi(argv[0], "status")) { cdc_status_push_ex(true); return; }
-    if (streqi(argv[0], "diag")) { sx_print_diag(); return; }
-    if (streqi(argv[0], "cw"))   { g_tune_active = 1; cdc_printf("OK tune=ON (carrier_poll handles SPI)\r\n"); return; }
-    if (streqi(argv[0], "stop")) { g_tune_active = 0; cdc_printf("OK tune=OFF\r\n"); return; }
-
-    // Mode: mode usb|cw|fm
-    if (streqi(argv[0], "mode") && argc >= 2) {
-        uint8_t new_mode = g_tx_mode;
-        if (streqi(argv[1], "usb") || streqi(argv[1], "ssb")) {
-            new_mode = 0;
-            cdc_printf("OK mode=USB\r\n");
-        } else if (streqi(argv[1], "cw")) {
-            new_mode = 1;
-            cdc_printf("OK mode=CW\r\n");
-        } else if (streqi(argv[1], "fm")) {
-            new_mode = 2;
-            cdc_printf("OK mode=FM\r\n");
-        } else {
-            cdc_write_str("ERR: mode usb|cw|fm\r\n");
-            return;
-        }
-        if (new_mode != g_tx_mode) {
-            g_tx_mode = new_mode;
-            g_mode_change_at_ms = to_ms_since_boot(get_absolute_time());
-        }
-        return;
-    }
-
-    // Audio source: src pc|mic|adc
-    if (streqi(argv[0], "src") && argc >= 2) {
-        if (streqi(argv[1], "pc") || streqi(argv[1], "usb")) {
-            g_audio_src = 0;
-            mic_timer_stop();
-            cdc_printf("OK src=PC\r\n");
-        } else if (streqi(argv[1], "mic") || streqi(argv[1], "adc")) {
-            g_audio_src = 1;
-            mic_timer_start();
-            cdc_printf("OK src=MIC\r\n");
-        } else {
-            cdc_write_str("ERR: src pc|mic\r\n");
-        }
-        return;
-    }
-
-    // Tune carrier: tune 0|1
-    if (streqi(argv[0], "tune") && argc >= 2) {
-        uint8_t v;
-        if (!parse_bool(argv[1], &v)) {
-            cdc_write_str("ERR: tune 0|1|on|off\r\n");
-            return;
-        }
-        g_tune_active = v;
-        // carrier_poll() will handle SPI transitions
-        cdc_printf("OK tune=%s\r\n", g_tune_active ? "ON" : "OFF");
-        return;
-    }
-
-    // TX enable/disable: tx 0|1
-    if (streqi(argv[0], "tx") && argc >= 2) {
-        uint8_t v;
-        if (!parse_bool(argv[1], &v)) { 
-            cdc_write_str("ERR: tx 0|1|on|off\r\n"); 
-            return; 
-        }
-        g_tx_enabled = v;
-        cdc_printf("OK tx=%s\r\n", g_tx_enabled ? "ON" : "OFF");
-        return;
-    }
-
-    // Frequency command: freq <Hz> (supports decimal for sub-Hz precision)
-    if (streqi(argv[0], "freq") && argc >= 2) {
-        char *e = NULL;
-        double f = strtod(argv[1], &e);
-        if (e == argv[1] || f < 2300000000.0 || f > 2450000000.0) {
-            cdc_write_str("ERR: freq must be 2300000000-2450000000 Hz\r\n");
-            return;
-        }
-        g_target_freq_hz = f;
-        double corrected = get_corrected_freq_hz();
-        float fine = get_fine_tune_hz();
-        cdc_printf("OK freq=%.1f Hz (corrected=%.1f, steps=%lu, fine=%.1f Hz)\r\n", 
-                   g_target_freq_hz, corrected,
-                   (unsigned long)get_base_steps(), fine);
-        if (g_tune_active) tune_apply_settings();
-        return;
-    }
-
-    // PPM correction command: ppm <value>
-    if (streqi(argv[0], "ppm") && argc >= 2) {
-        float ppm;
-        if (!parse_f(argv[1], &ppm)) { 
-            cdc_write_str("ERR: bad PPM value\r\n"); 
-            return; 
-        }
-        if (ppm < -100.0f || ppm > 100.0f) {
-            cdc_write_str("ERR: ppm must be -100 to +100\r\n");
-            return;
-        }
-        g_ppm_correction = ppm;
-        double corrected = get_corrected_freq_hz();
-        float fine = get_fine_tune_hz();
-        cdc_printf("OK ppm=%.3f (corrected=%.1f Hz, steps=%lu, fine=%.1f Hz)\r\n", 
-                   g_ppm_correction, corrected,
-                   (unsigned long)get_base_steps(), fine);
-        if (g_tune_active) tune_apply_settings();
-        return;
-    }
-
-    // TX power command: txpwr <-18..13>
-    if (streqi(argv[0], "txpwr") && argc >= 2) {
-        float pwr;
-        if (!parse_f(argv[1], &pwr)) { 
-            cdc_write_str("ERR: bad txpwr value\r\n"); 
-            return; 
-        }
-        if (pwr < (float)PWR_MIN_DBM) pwr = (float)PWR_MIN_DBM;
-        if (pwr > (float)PWR_MAX_DBM) pwr = (float)PWR_MAX_DBM;
-        g_tx_power_max_dbm = (int8_t)pwr;
-        cdc_printf("OK txpwr=%d dBm\r\n", g_tx_power_max_dbm);
-        if (g_tune_active) tune_apply_settings();
-        return;
-    }
-
-    audio_cfg_t c;
-    __compiler_memory_barrier();
-    memcpy(&c, (const void*)&g_cfg, sizeof(c));
-    __compiler_memory_barrier();
-
-    if (streqi(argv[0], "enable") && argc >= 3) {
-        uint8_t v;
-        if (!parse_bool(argv[2], &v)) { cdc_write_str("ERR: bad bool\r\n"); return; }
-
-        if (streqi(argv[1], "bp")) c.enable_bandpass = v;
-        else if (streqi(argv[1], "eq")) c.enable_eq = v;
-        else if (streqi(argv[1], "comp")) c.enable_comp = v;
-        else { cdc_write_str("ERR: enable bp|eq|comp\r\n"); return; }
-
-        cfg_commit(&c);
-        cdc_write_str("OK\r\n");
-        return;
-    }
-
-    if (streqi(argv[0], "set") && argc >= 3) {
-        float f;
-        if (!parse_f(argv[2], &f)) { cdc_write_str("ERR: bad number\r\n"); return; }
-
-        // FM deviation and CTCSS are volatile globals, not in audio_cfg_t
-        if (streqi(argv[1], "fm_dev")) {
-            if (f < 200.0f) f = 200.0f;
-            if (f > 100000.0f) f = 100000.0f;
-            g_fm_deviation_hz = f;
-            cdc_printf("OK fm_dev=%.0f Hz\r\n", g_fm_deviation_hz);
-            return;
-        }
-        if (streqi(argv[1], "ctcss")) {
-            if (f < 0.0f) f = 0.0f;
-            if (f > 300.0f) f = 300.0f;
-            g_ctcss_freq = f;
-            cdc_printf("OK ctcss=%.1f Hz\r\n", g_ctcss_freq);
-            return;
-        }
-        if (streqi(argv[1], "roger")) {
-            g_roger_beep = (f != 0.0f) ? 1 : 0;
-            cdc_printf("OK roger=%s\r\n", g_roger_beep ? "on" : "off");
-            return;
-        }
-
-        if      (streqi(argv[1], "bp_lo"))       c.bp_lo_hz = f;
-        else if (streqi(argv[1], "bp_hi"))       c.bp_hi_hz = f;
-        else if (streqi(argv[1], "bp_stages"))   c.bp_stages = (uint8_t)f;
-        else if (streqi(argv[1], "eq_low_hz"))   c.eq_low_hz = f;
-        else if (streqi(argv[1], "eq_low_db"))   c.eq_low_db = f;
-        else if (streqi(argv[1], "eq_high_hz"))  c.eq_high_hz = f;
-        else if (streqi(argv[1], "eq_high_db"))  c.eq_high_db = f;
-        else if (streqi(argv[1], "comp_thr"))    c.comp_thr_db = f;
-        else if (streqi(argv[1], "comp_ratio"))  c.comp_ratio = f;
-        else if (streqi(argv[1], "comp_att"))    c.comp_attack_ms = f;
-        else if (streqi(argv[1], "comp_rel"))    c.comp_release_ms = f;
-        else if (streqi(argv[1], "comp_makeup")) c.comp_makeup_db = f;
-        else if (streqi(argv[1], "comp_knee"))   c.comp_knee_db = f;
-        else if (streqi(argv[1], "comp_outlim")) c.comp_out_limit = f;
-        else if (streqi(argv[1], "amp_gain"))    c.amp_gain = f;
-        else if (streqi(argv[1], "amp_min_a"))   c.amp_min_a = f;
-        else if (streqi(argv[1], "mic_agc_target"))   c.mic_agc_target = f;
-        else if (streqi(argv[1], "mic_agc_max_gain")) c.mic_agc_max_gain = f;
-        else if (streqi(argv[1], "mic_agc_attack"))   c.mic_agc_attack = f;
-        else if (streqi(argv[1], "mic_agc_release"))  c.mic_agc_release = f;
-        else if (streqi(argv[1], "mic_gate"))         c.mic_gate_thresh = f;
-        else { cdc_write_str("ERR: unknown key\r\n"); return; }
-
-        cfg_commit(&c);
-        cdc_write_str("OK\r\n");
-        return;
-    }
-
-    cdc_write_str("ERR: unknown command (type 'help')\r\n");
-}
-
-static void cdc_task(void) {
-#if CFG_TUD_CDC
-    static char line[128];
-    static uint32_t pos = 0;
-
-    if (!tud_cdc_connected()) return;
-
-    while (tud_cdc_available()) {
-        char ch = (char)tud_cdc_read_char();
-
-        if (ch == '\r' || ch == '\n') {
-            if (pos > 0) {
-                line[pos] = 0;
-                cdc_handle_line(line);
-                pos = 0;
-            }
-        } else {
-            if (pos < sizeof(line) - 1) {
-                line[pos++] = ch;
-            }
-        }
-    }
-#endif
-}
-
-// ==========================================================
-// OLED display — simple text, DMA transfer
-// ==========================================================
-#define QO100_DOWNLINK_OFFSET_HZ  8089500000.0
-
-// Helper: right-justify a 1x string ending at x_right edge
-static void draw_string_right(int x_right, int page, const char *str) {
-    int len = 0;
-    const char *p = str;
-    while (*p++) len++;
-    int x = x_right - len * 6;
-    ssd1306_draw_string(x, page, str);
-}
-
-// Draw a 2x-height arrow-up glyph into framebuf at (x, page..page+1)
-static void draw_arrow_up_2x(int x, int page) {
-    static const uint8_t src[] = {0x04, 0x02, 0x7F, 0x02, 0x04};
-    uint8_t *fb = ssd1306_get_framebuf();
-    for (int c = 0; c < 5; c++) {
-        uint16_t expanded = 0;
-        for (int b = 0; b < 7; b++)
-            if (src[c] & (1 << b)) expanded |= (3u << (b * 2));
-        uint8_t lo = (uint8_t)(expanded & 0xFF);
-        uint8_t hi = (uint8_t)((expanded >> 8) & 0xFF);
-        for (int dx = 0; dx < 2; dx++) {
-            int px = x + c * 2 + dx;
-            if (px >= 0 && px < SSD1306_WIDTH) {
-                fb[page * SSD1306_WIDTH + px] = lo;
-                fb[(page + 1) * SSD1306_WIDTH + px] = hi;
-            }
-        }
-    }
-}
-
-// Draw a 2x-height arrow-down glyph into framebuf at (x, page..page+1)
-static void draw_arrow_down_2x(int x, int page) {
-    static const uint8_t src[] = {0x10, 0x20, 0x7F, 0x20, 0x10};
-    uint8_t *fb = ssd1306_get_framebuf();
-    for (int c = 0; c < 5; c++) {
-        uint16_t expanded = 0;
-        for (int b = 0; b < 7; b++)
-            if (src[c] & (1 << b)) expanded |= (3u << (b * 2));
-        uint8_t lo = (uint8_t)(expanded & 0xFF);
-        uint8_t hi = (uint8_t)((expanded >> 8) & 0xFF);
-        for (int dx = 0; dx < 2; dx++) {
-            int px = x + c * 2 + dx;
-            if (px >= 0 && px < SSD1306_WIDTH) {
-                fb[page * SSD1306_WIDTH + px] = lo;
-                fb[(page + 1) * SSD1306_WIDTH + px] = hi;
-            }
-        }
-    }
-}
-
-// Draw radio-on icon at pixel (x, y): dot + 2 arcs, 7px tall, ~9px wide
-static void draw_radio_on_xy(int x, int y) {
-    // Dot 2x2 at center height (y+2, y+3)
-    ssd1306_set_pixel(x,   y+2, true); ssd1306_set_pixel(x,   y+3, true);
-    ssd1306_set_pixel(x+1, y+2, true); ssd1306_set_pixel(x+1, y+3, true);
-    // Arc 1
-    ssd1306_set_pixel(x+3, y+1, true);
-    ssd1306_set_pixel(x+3, y+2, true); ssd1306_set_pixel(x+3, y+3, true);
-    ssd1306_set_pixel(x+3, y+4, true);
-    // Arc 2
-    ssd1306_set_pixel(x+5, y+0, true);
-    ssd1306_set_pixel(x+5, y+1, true);
-    ssd1306_set_pixel(x+5, y+2, true); ssd1306_set_pixel(x+5, y+3, true);
-    ssd1306_set_pixel(x+5, y+4, true);
-    ssd1306_set_pixel(x+5, y+5, true);
-}
-
-// Draw radio-off icon at pixel (x, y): just a dot, 7px tall, 2px wide
-static void draw_radio_off_xy(int x, int y) {
-    ssd1306_set_pixel(x,   y+2, true); ssd1306_set_pixel(x,   y+3, true);
-    ssd1306_set_pixel(x+1, y+2, true); ssd1306_set_pixel(x+1, y+3, true);
-}
-
-// Forward declaration — defined below, after OLED drawing helpers
-static void oled_prepare_frame(void);
+// Forward declaration — defined below, after OLED drawing helpers
+static void oled_prepare_frame(void);
 
 // ==========================================================
 // Central OLED refresh — single rate-limited entry point.
@@ -2152,17 +1470,6 @@ static void oled_poll(void) {
     oled_next = make_timeout_time_ms(200);
 }
 
-// ==========================================================
-// Small UI helpers
-// ==========================================================
-static const char *mode_label(uint8_t m) {
-    switch (m) {
-        case TXM_CW:     return "CW";
-        case TXM_FM:     return "FM";
-        default:         return "USB";
-    }
-}
-
 // Return true when `item` should be visible for the current configuration.
 // (some menu items depend on the selected TX mode)
 static bool menu_item_visible(menu_item_t item) {
@@ -2450,6 +1757,7 @@ static void menu_edit_apply(menu_item_t item, int step) {
             g_tune_active = g_tune_active ? 0 : 1;
             break;
         case MENU_SRC:
+            g_audio_src_auto = 0;
             g_audio_src = g_audio_src ? 0 : 1;
             if (g_audio_src) mic_timer_start(); else mic_timer_stop();
             break;
@@ -2622,66 +1930,69 @@ static void button_poll(void) {
 }
 
 // ==========================================================
-// Hilbert
+// IRQ affinity
 // ==========================================================
-static float hilb_h[HILBERT_TAPS];
-static float hilb_buf[HILBERT_TAPS];
-static uint32_t hilb_idx = 0;
-
-static void hilbert_reset(void) {
-    for (int i = 0; i < HILBERT_TAPS; i++) hilb_buf[i] = 0.0f;
-    hilb_idx = 0;
-}
-
-static void hilbert_init(void) {
-    const int M = (HILBERT_TAPS - 1) / 2;
-
-    for (int n = 0; n < HILBERT_TAPS; n++) {
-        int k = n - M;
-
-        float h = 0.0f;
-        if (k != 0 && (k & 1)) h = 2.0f / ((float)M_PI * (float)k);
-
-        float w = 0.54f - 0.46f *
-                  cosf(2.0f * (float)M_PI * (float)n /
-                       (float)(HILBERT_TAPS - 1));
+// An IRQ is taken by the core whose NVIC enables it, so the plan is
+// "enable everything from Core0": USBCTRL (TinyUSB + the SOF stamp) is
+// enabled by tusb_init(), the USB worker's spare IRQ by usb_worker_start(),
+// and the MIC and worker repeating timers fire from the default alarm
+// pool, all on Core0.  The OLED DMA, I2C, SPI and PIO are
+// polled and never enable an IRQ.  Core1 paces samples by polling the
+// timer, so the only IRQ it may take is the SIO FIFO lockout that parks
+// it during flash writes; irq_plan_core1() turns off anything else in
+// Core1's NVIC, at start and every IRQ_AUDIT_BLOCKS blocks.
+#if PICO_RP2040
+#define IRQ_LOCKOUT     SIO_IRQ_PROC1
+#else
+#define IRQ_LOCKOUT     SIO_IRQ_FIFO
+#endif
 
-        hilb_h[n] = h * w;
-        hilb_buf[n] = 0.0f;
+// NVIC enables of the calling core
+static uint64_t irq_enabled_mask(void) {
+    uint64_t m = 0;
+    for (uint n = 0; n < NUM_IRQS && n < 64u; n++) {
+        if (irq_is_enabled(n)) m |= 1ull << n;
     }
+    return m;
 }
 
-static inline float hilbert_process(float x, float *i_delayed) {
-    const int M = (HILBERT_TAPS - 1) / 2;
-
-    hilb_buf[hilb_idx] = x;
+static void irq_plan_core0(void) {
+    uint core = alarm_pool_core_num(alarm_pool_get_default());
+    if (core != 0) printf("[IRQ] default alarm pool on core%u: MIC timer IRQ not on Core0\n", core);
+    printf("[IRQ] core0 enabled 0x%016llx\n", (unsigned long long)irq_enabled_mask());
+}
 
-    float y = 0.0f;
-    uint32_t idx = hilb_idx;
-    for (int n = 0; n < HILBERT_TAPS; n++) {
-        y += hilb_h[n] * hilb_buf[idx];
-        if (idx == 0) idx = HILBERT_TAPS - 1;
-        else idx--;
+static void irq_plan_core1(void) {
+    uint64_t m = 0;
+    for (uint n = 0; n < NUM_IRQS && n < 64u; n++) {
+        if (!irq_is_enabled(n)) continue;
+        if (n != IRQ_LOCKOUT) {
+            irq_set_enabled(n, false);
+            g_irq_c1_stray++;
+            continue;
+        }
+        m |= 1ull << n;
     }
-
-    uint32_t id = (hilb_idx + HILBERT_TAPS - (uint32_t)M) % HILBERT_TAPS;
-    *i_delayed = hilb_buf[id];
-
-    hilb_idx++;
-    if (hilb_idx >= HILBERT_TAPS) hilb_idx = 0;
-
-    return y;
+    g_irq_c1_en = m;
 }
 
-static inline float duty_from_A(float A) {
-    if (A <= 0.0f) return 0.0f;
-    float r = A / GATE_A_REF;
-    if (r >= 1.0f) return 1.0f;
-#if GATE_SHAPE == 2
-    return r * r;
-#else
-    return r;
-#endif
+void plat_irq_print(bool reset) {
+    if (reset) {
+        g_irq_usb_n[0] = g_irq_usb_n[1] = g_irq_usb_max_us = 0;
+        g_irq_tmr_n[0] = g_irq_tmr_n[1] = g_irq_tmr_max_us = 0;
+        g_irq_lock_n = g_irq_lock_max_us = 0;
+        g_irq_c1_over_n = g_irq_c1_over_max_us = 0;
+    }
+    cdc_printf("!I why=%s usb=%lu/%lu usb_us=%lu tmr=%lu/%lu tmr_us=%lu lock=%lu lock_us=%lu "
+               "over=%lu over_us=%lu stray=%lu c0en=0x%llx c1en=0x%llx\r\n",
+               reset ? "reset" : "status",
+               (unsigned long)g_irq_usb_n[0], (unsigned long)g_irq_usb_n[1], (unsigned long)g_irq_usb_max_us,
+               (unsigned long)g_irq_tmr_n[0], (unsigned long)g_irq_tmr_n[1], (unsigned long)g_irq_tmr_max_us,
+               (unsigned long)g_irq_lock_n, (unsigned long)g_irq_lock_max_us,
+               (unsigned long)g_irq_c1_over_n, (unsigned long)g_irq_c1_over_max_us,
+               (unsigned long)g_irq_c1_stray,
+               (unsigned long long)irq_enabled_mask(), (unsigned long long)g_irq_c1_en);
+    usb_worker_print(reset);
 }
 
 // ==========================================================
@@ -2698,6 +2009,8 @@ static void core1_radio_apply_loop(void) {
     // time out trying to park Core1 and the save would fail (and previously
     // the manual lockout sequence would hang forever).
     flash_safe_execute_core_init();
+    irq_plan_core1();
+    uint32_t audit_blocks = 0;
 
 #if UNDERRUN_LED_ENABLE
     const uint led_pin = PICO_DEFAULT_LED_PIN;
@@ -2711,9 +2024,12 @@ static void core1_radio_apply_loop(void) {
 #endif
 
     int32_t last_steps = 0x7FFFFFFF;
+    uint32_t f_acc = 0;       // frequency sigma-delta, Q8, runs at the substep rate
     int32_t last_p_dbm = 9999;
     bool last_tx_on = false;  // Start with TX off
     bool tx_en_activated = false;  // Track if we've enabled the PA
+    uint32_t spi_n = 0, spi_sum = 0, spi_max = 0;
+    plat_cycles_init();
 
     g_dbg_core1_alive = 1;
     while (true) {
@@ -2734,6 +2050,10 @@ static void core1_radio_apply_loop(void) {
                 __compiler_memory_barrier();
                 g_cons_block = (b + 1u) % NUM_BLOCKS;
             }
+            if (++audit_blocks >= IRQ_AUDIT_BLOCKS) {
+                audit_blocks = 0;
+                irq_plan_core1();
+            }
             sleep_ms(10);
             continue;
         }
@@ -2771,11 +2091,13 @@ static void core1_radio_apply_loop(void) {
             gpio_put(PIN_TX_EN, 1);
             tx_en_activated = true;
             sleep_ms(1);  // Short delay for PA to stabilize
+            g_boot.rf_ready_ms = to_ms_since_boot(get_absolute_time());
         }
 
         g_dbg_core1_bc = 2;
         sample_cmd_t *blk = g_blocks[b];
         uint64_t next_us = time_us_64();
+        cmdlat_air(b);
 
         for (uint32_t i = 0; i < BLOCK_SAMPLES; i++) {
             next_us += sample_period_us;
@@ -2783,23 +2105,40 @@ static void core1_radio_apply_loop(void) {
 
             for (uint32_t k = 0; k < substeps; k++) {
                 sample_cmd_t c = blk[i];
+                // tx_at window: keyed samples before the start are held back
+                const bool tx_on = txsched_gate(time_us_32(), c.tx_on);
 
-                if ((bool)c.tx_on != last_tx_on) {
+                if (tx_on != last_tx_on) {
                     g_dbg_core1_bc = 4;
-                    if (c.tx_on) { sx_start_tx_continuous_wave(); g_dbg_core1_txcw++; }
+                    if (tx_on) {
+                        sx_start_tx_continuous_wave();
+                        g_dbg_core1_txcw++;
+                        if (!g_boot.first_tx_ms) g_boot.first_tx_ms = to_ms_since_boot(get_absolute_time());
+                    }
 #if USE_TCXO_MODULE
                     else         sx_set_standby_xosc();
 #else
                     else         sx_set_standby_rc();
 #endif
-                    last_tx_on = (bool)c.tx_on;
+                    last_tx_on = tx_on;
                     g_dbg_core1_bc = 40;  // after tx toggle
                 }
 
-                if (c.freq_steps != last_steps) {
+                const int32_t steps = sample_cmd_dither(&c, &f_acc);
+                if (steps != last_steps) {
                     g_dbg_core1_bc = 5;
-                    sx_set_rf_frequency_steps((uint32_t)c.freq_steps);
-                    last_steps = c.freq_steps;
+                    uint32_t c0 = plat_cycles();
+                    sx_set_rf_frequency_steps((uint32_t)steps);
+                    uint32_t dc = plat_cycles() - c0;
+                    spi_sum += dc;
+                    if (dc > spi_max) spi_max = dc;
+                    if (++spi_n == SPI_WIN) {
+                        g_spi_win_sum = spi_sum;
+                        g_spi_win_max = spi_max;
+                        g_spi_win_n = spi_n;
+                        spi_n = spi_sum = spi_max = 0;
+                    }
+                    last_steps = steps;
                     g_dbg_core1_bc = 50;
                 }
 
@@ -2828,7 +2167,11 @@ static void core1_radio_apply_loop(void) {
                 if (next_us > now && (next_us - now) < 1000u) {
                     busy_wait_us_32((uint32_t)(next_us - now));
                 } else if (next_us <= now) {
-                    // We're behind — resync to avoid chasing forever.
+                    // We're behind (SPI overrun or the lockout) — count
+                    // it, then resync to avoid chasing forever.
+                    uint32_t over = (uint32_t)(now - next_us);
+                    g_irq_c1_over_n++;
+                    if (over > g_irq_c1_over_max_us) g_irq_c1_over_max_us = over;
                     next_us = now;
                 }
             }
@@ -2848,28 +2191,19 @@ static void core1_radio_apply_loop(void) {
 
         g_cons_block = (b + 1u) % NUM_BLOCKS;
         g_dbg_cons_blocks++;
+        if (++audit_blocks >= IRQ_AUDIT_BLOCKS) {
+            audit_blocks = 0;
+            irq_plan_core1();
+        }
     }
 }
 
 // ==========================================================
-// USB audio pump (TinyUSB task + UAC RX read)
+// USB worker (TinyUSB task + UAC RX read + CDC RX copy)
 // ==========================================================
-static void usb_audio_pump(void) {
-    // utrzymuj TinyUSB — but rate-limit when no host is connected
-    // to avoid wasting CPU cycles polling dead USB PHY
-    static absolute_time_t tud_next = {0};
-    if (tud_connected()) {
-        tud_task();
-        cdc_task();
-    } else {
-        // No USB host — call tud_task() at reduced rate (every 10ms)
-        if (absolute_time_diff_us(get_absolute_time(), tud_next) <= 0) {
-            tud_task();
-            tud_next = make_timeout_time_ms(10);
-        }
-        return;  // No audio to read without USB host
-    }
-
+// Host audio (PCM16LE stereo) -> g_usb_rb; at most one 512 B read per
+// run (2.6 ms at 48 kHz stereo, the worker runs at least every 1 ms).
+static void usb_audio_drain(void) {
     const uint32_t frame_bytes =
         (uint32_t)CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX *
         (uint32_t)CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_RX;
@@ -2892,23 +2226,294 @@ static void usb_audio_pump(void) {
     uint32_t frames = got / frame_bytes;
     const uint8_t *p = tmp;
 
-    for (uint32_t i = 0; i < frames; i++) {
-        int16_t l = (int16_t)(p[0] | (p[1] << 8));
-        int16_t r = l;
-        if (CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX >= 2) {
-            r = (int16_t)(p[2] | (p[3] << 8));
+    // Straight into the ring, one span (two at the wrap), one commit each
+    while (frames) {
+        stereo16_t *d;
+        const uint32_t n = usb_rb_reserve(&g_usb_rb, frames, &d);
+        if (!n) {
+            g_usb_rb.q.drops += frames;                     // full: drop the rest
+            return;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            int16_t l = (int16_t)(p[0] | (p[1] << 8));
+            int16_t r = l;
+            if (CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX >= 2) {
+                r = (int16_t)(p[2] | (p[3] << 8));
+            }
+            p += frame_bytes;
+            d[i] = (stereo16_t){ .l = l, .r = r };
         }
-        p += frame_bytes;
-        (void) usb_rb_push((stereo16_t){ .l = l, .r = r }); // drop if full
+        usb_rb_commit(&g_usb_rb, n);
+        frames -= n;
+    }
+}
+
+// CDC OUT -> g_cdc_rx, only as much as fits: the rest stays in TinyUSB's
+// FIFO and the host is NAKed until cdc_task() catches up.
+static void usb_cdc_rx_copy(void) {
+#if CFG_TUD_CDC
+    for (;;) {
+        uint8_t *p;
+        uint32_t n = cdc_rx_reserve(&g_cdc_rx, CDC_RX_SIZE, &p);   // contiguous
+        if (!n) return;
+        n = tud_cdc_read(p, n);
+        if (!n) return;
+        cdc_rx_commit(&g_cdc_rx, n);
     }
+#endif
+}
+
+static void usb_worker_irq(void) {
+    const uint32_t t0 = time_us_32();
+    if (g_usbw_kicked) {
+        g_usbw_kicked = false;
+        uint32_t lat = t0 - g_usbw_kick_t;
+        if (lat > g_usbw_lat_max_us) g_usbw_lat_max_us = lat;
+    }
+    if (!mutex_try_enter(&g_usb_mutex, NULL)) {
+        g_usbw_skips++;                 // usb_unlock() kicks us again
+        return;
+    }
+    g_usbw_busy = true;
+    tud_task_ext(0, true);              // never waits: one pass over the queued events
+    if (tud_connected()) {
+        usb_audio_drain();
+        usb_cdc_rx_copy();
+    }
+    g_usbw_busy = false;
+    mutex_exit(&g_usb_mutex);
+
+    const uint32_t dt = time_us_32() - t0;
+    g_usbw_runs++;
+    g_usbw_sum_us += dt;
+    if (dt > g_usbw_max_us) g_usbw_max_us = dt;
+    if (dt > USB_WORKER_BUDGET_US) g_usbw_over++;
+}
+
+static bool usb_worker_tick(struct repeating_timer *t) {
+    (void)t;
+    usb_worker_kick();
+    return true;
+}
+
+// After tusb_init(), on Core0: the spare IRQ and the tick's alarm IRQ are
+// both enabled in Core0's NVIC, so Core1 stays IRQ-free.
+static void usb_worker_start(void) {
+    mutex_init(&g_usb_mutex);
+    g_usbw_irq = user_irq_claim_unused(true);
+    irq_set_exclusive_handler((uint)g_usbw_irq, usb_worker_irq);
+    irq_set_priority((uint)g_usbw_irq, PICO_LOWEST_IRQ_PRIORITY);
+    irq_set_enabled((uint)g_usbw_irq, true);
+    add_repeating_timer_us(-USB_WORKER_TICK_US, usb_worker_tick, NULL, &g_usbw_timer);
+    usb_worker_kick();
 }
 
 // ==========================================================
-// PIO Frequency Counter for TCXO on GP26
-// Uses PIO state machine to count edges in 1-second window
+// Platform hooks for the portable modules (control.c, txchain.c)
 // ==========================================================
+bool plat_cdc_connected(void) {
+#if CFG_TUD_CDC
+    return tud_cdc_connected();
+#else
+    return false;
+#endif
+}
+
+void plat_cdc_write(const char *s) {
+#if CFG_TUD_CDC
+    const bool locked = usb_lock();
+    tud_cdc_write_str(s);
+    tud_cdc_write_flush();
+    usb_unlock(locked);
+#else
+    (void)s;
+#endif
+}
+
+static void core0_poll(void);
+
+void plat_mic_start(void)  { mic_timer_start(); }
+void plat_mic_stop(void)   { mic_timer_stop(); }
+void plat_tune_apply(void) { tune_apply_settings(); }
+void plat_radio_diag(void) { sx_print_diag(); }
+
+// Producer audio source: USB (PC) or ADC (MIC) at 8 kHz.
+float plat_audio_sample(uint32_t n, const audio_cfg_t *cfg) {
+    if (g_audio_src == 0) {
+        // PC mode: USB audio → downsample → mono
+        int16_t s = usb_audio_get_mono_8k();
+        return (float)s / 32768.0f;
+    }
+
+    // MIC mode: wait for sample from timer-driven ring buffer.
+    // Timer ISR fills mic_rb at 8 kHz; we block here until a sample
+    // is available — this naturally paces Core0 at 8 kHz.
+    // While waiting, run the Core0 polls so everything stays responsive
+    // (the queue never fills in MIC mode, so this is their only caller).
+    // Also check g_audio_src: if user switches to PC mid-block,
+    // break out immediately to avoid deadlock (timer is stopped).
+    while (!mic_rb_fill(&g_mic_rb)) {
+        if (g_audio_src == 0) break;  // Source switched — bail out
+        core0_poll();
+    }
+    // If source changed mid-block, fill rest with silence
+    if (g_audio_src == 0) return 0.0f;
+
+    return adc_mic_get_sample(cfg);
+}
 
 // ==========================================================
+// PPM discipline references: USB SOF timestamps + PIO PPS capture
+// ==========================================================
+static PIO      g_pps_pio = pio0;
+static int      g_pps_sm = -1;
+static uint     g_pps_offset;
+static uint32_t g_pps_tick_hz;
+
+// SOF timestamps must be taken in the IRQ: TinyUSB defers tud_sof_cb()
+// to tud_task(), which the worker runs behind anything of higher priority.  This
+// handler is added after tusb_init() so it runs ahead of TinyUSB's at the
+// same order priority; reading SOF_RD acks the SOF, which is fine because
+// nothing else in this firmware consumes SOF.  The tx_at time base counts
+// frames from boot, so SOF stays enabled whatever the discipline source.
+static void SX_RAMFUNC(usb_sof_isr)(void) {
+    g_irq_usb_t0 = time_us_32();
+    g_irq_usb_n[get_core_num()]++;
+    if (!(usb_hw->ints & USB_INTS_DEV_SOF_BITS)) return;
+    uint64_t now = time_us_64();
+    uint32_t frame = usb_hw->sof_rd & USB_SOF_RD_BITS;
+    freqdisc_sof(frame, now);
+    txsched_sof(frame, now);
+}
+
+// Last in the chain, after TinyUSB's handler: whole USB IRQ time ("irq"),
+// then hand the events TinyUSB queued to the worker
+static void SX_RAMFUNC(usb_irq_exit)(void) {
+    uint32_t dt = time_us_32() - g_irq_usb_t0;
+    if (dt > g_irq_usb_max_us) g_irq_usb_max_us = dt;
+    usb_worker_kick();
+}
+
+static void sof_hook(void) {
+    irq_add_shared_handler(USBCTRL_IRQ, usb_sof_isr,
+                           PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY);
+    irq_add_shared_handler(USBCTRL_IRQ, usb_irq_exit,
+                           PICO_SHARED_IRQ_HANDLER_LOWEST_ORDER_PRIORITY);
+    tud_sof_cb_enable(true);
+}
+
+static void pps_capture_start(void) {
+    if (g_pps_sm >= 0) return;
+    g_pps_sm = pio_claim_unused_sm(g_pps_pio, false);
+    if (g_pps_sm < 0 || !pio_can_add_program(g_pps_pio, &pps_capture_program)) {
+        if (g_pps_sm >= 0) pio_sm_unclaim(g_pps_pio, (uint)g_pps_sm);
+        g_pps_sm = -1;
+        printf("[DISC] no free PIO resources for PPS capture\n");
+        return;
+    }
+    g_pps_offset = pio_add_program(g_pps_pio, &pps_capture_program);
+    pps_capture_program_init(g_pps_pio, (uint)g_pps_sm, g_pps_offset, PIN_PPS);
+    g_pps_tick_hz = clock_get_hz(clk_sys) / PPS_CAPTURE_CYCLES;
+}
+
+static void pps_capture_stop(void) {
+    if (g_pps_sm < 0) return;
+    pio_sm_set_enabled(g_pps_pio, (uint)g_pps_sm, false);
+    pio_remove_program(g_pps_pio, &pps_capture_program, g_pps_offset);
+    pio_sm_unclaim(g_pps_pio, (uint)g_pps_sm);
+    g_pps_sm = -1;
+}
+
+void plat_bench_spi(void) {
+    uint32_t n = g_spi_win_n;
+    if (!n) {
+        cdc_write_str("!K k=spi n=0 (no SetRfFrequency timed yet: transmit first)\r\n");
+        return;
+    }
+    const double ns_per_cyc = 1e9 / (double)plat_cpu_hz();
+    kbench_print("spi", n, (uint64_t)((double)g_spi_win_sum * ns_per_cyc));
+    kbench_print("spi_max", 1u, (uint64_t)((double)g_spi_win_max * ns_per_cyc));
+}
+
+void plat_usb_rs_print(void) { farrow_print(&g_usb_rs.fr, "status"); }
+
+void plat_disc_select(uint8_t src) {
+    if (src == FD_SRC_PPS) pps_capture_start();
+    else                   pps_capture_stop();
+}
+
+// Drain PPS captures and run the discipline loop.  core0_poll(); the
+// joined RX FIFO holds 8 edges, after that new ones are lost.
+static void disc_poll(void) {
+    if (g_pps_sm >= 0) {
+        while (!pio_sm_is_rx_fifo_empty(g_pps_pio, (uint)g_pps_sm)) {
+            // X counts down; invert for an up-counting timestamp
+            uint32_t x = pio_sm_get(g_pps_pio, (uint)g_pps_sm);
+            freqdisc_pps(~x, g_pps_tick_hz);
+        }
+    }
+    freqdisc_poll();
+}
+
+// tx_at window and reports.  core0_poll().
+static void sched_poll(void) {
+    if (!txsched_busy()) return;
+    uint32_t ready = 0;
+    for (uint32_t i = 0; i < NUM_BLOCKS; i++) if (g_block_ready[i]) ready++;
+    txsched_poll(ready * TXS_BLOCK_MS);
+}
+
+// ==========================================================
+// Boot helpers
+// ==========================================================
+// Wait for a deadline (USB enumeration carries on in the worker IRQ).
+static void boot_wait_until(absolute_time_t t) {
+    sleep_until(t);
+}
+
+// Record USB enumeration and end the boot-time MIC fallback once the host
+// is there.  Cheap; called from core0_poll().
+static void boot_usb_poll(void) {
+    if (g_boot.usb_ms || !tud_ready()) return;
+
+    g_boot.usb_ms = to_ms_since_boot(get_absolute_time());
+    printf("[BOOT] USB ready after %lu ms\n", (unsigned long)g_boot.usb_ms);
+
+    if (g_audio_src_auto) {
+        g_audio_src_auto = 0;
+        g_audio_src = 0;
+        mic_timer_stop();
+        printf("[BOOT] Audio source back to PC\n");
+    }
+}
+
+// Everything Core0 services between blocks: UI, CDC, USB/MSC, PPM
+// discipline, tx_at, latency and mask guard.  Called from every place
+// Core0 waits (a full queue, the MIC sample wait, CW/TUNE), so no poll
+// depends on which of them the current mode spends its time in.
+static void core0_poll(void) {
+    cdc_task();
+    oled_poll();
+
+    // Poll encoder + buttons + carrier state machine
+    encoder_poll();
+    button_poll();
+    carrier_poll();
+    persist_maybe_autosave();
+#if CFG_TUD_MSC
+    msc_poll();
+#endif
+    boot_usb_poll();
+    disc_poll();
+    sched_poll();
+    cmdlat_poll();
+    specmask_poll();
+
+#if CFG_TUD_CDC
+    cdc_status_push();
+#endif
+}
+
 // ==========================================================
 // MAIN (CORE0): init + DSP producer
 // ==========================================================
@@ -2920,30 +2525,44 @@ int main(void) {
     // Done early so SX1280 setup below picks up the saved frequency.
     persist_load();
 
-    // ---- USB device init ----
-    board_init();
-    tusb_rhport_init_t dev_init = {
-        .role  = TUSB_ROLE_DEVICE,
-        .speed = TUSB_SPEED_FULL  // UAC1-only: Full-Speed dla Windows/Linux
-    };
-    tusb_init(BOARD_TUD_RHPORT, &dev_init);
-    board_init_after_tusb();
-
-    // ---- SX1280 GPIO/SPI init ----
+    // ---- SX1280 control lines first: TCXO on, chip held in reset ----
+    // TCXO settling and the reset pulse run concurrently with the USB,
+    // ADC, OLED and DSP init below instead of in dedicated sleeps.
     // CRITICAL FOR TCXO MODULE: Enable TCXO FIRST, before any SPI/reset!
 #if USE_TCXO_MODULE
     gpio_init(PIN_TCXO_EN);
     gpio_set_dir(PIN_TCXO_EN, GPIO_OUT);
     gpio_put(PIN_TCXO_EN, 1);  // Enable TCXO FIRST!
-    sleep_ms(5);               // Wait for TCXO to stabilize (min 3ms)
+    absolute_time_t tcxo_ready = make_timeout_time_ms(5);  // min 3ms
     printf("[SX1280] TCXO enabled (GPIO%d=HIGH)\n", PIN_TCXO_EN);
 #endif
 
     gpio_init(PIN_NSS);   gpio_set_dir(PIN_NSS, GPIO_OUT);   gpio_put(PIN_NSS, 1);
     gpio_init(PIN_RX_EN); gpio_set_dir(PIN_RX_EN, GPIO_OUT); gpio_put(PIN_RX_EN, 0);
     gpio_init(PIN_TX_EN); gpio_set_dir(PIN_TX_EN, GPIO_OUT); gpio_put(PIN_TX_EN, 0);  // Start with TX disabled!
-    gpio_init(PIN_RESET); gpio_set_dir(PIN_RESET, GPIO_OUT); gpio_put(PIN_RESET, 1);
+    gpio_init(PIN_RESET); gpio_set_dir(PIN_RESET, GPIO_OUT); gpio_put(PIN_RESET, 0);  // Hold in reset
     gpio_init(PIN_BUSY);  gpio_set_dir(PIN_BUSY, GPIO_IN);
+    absolute_time_t reset_release = make_timeout_time_ms(2);
+    printf("[SX1280] Resetting...\n");
+
+    // ---- USB device init (enumeration proceeds while the rest boots) ----
+    board_init();
+    tusb_rhport_init_t dev_init = {
+        .role  = TUSB_ROLE_DEVICE,
+        .speed = TUSB_SPEED_FULL  // UAC1-only: Full-Speed dla Windows/Linux
+    };
+#if CFG_TUD_MSC
+    msc_init();             // before tusb_init: the host may read it at once
+#endif
+    tusb_init(BOARD_TUD_RHPORT, &dev_init);
+    board_init_after_tusb();
+
+    // SOF timestamps + PPM discipline reference (the SOF hook needs
+    // TinyUSB's IRQ handler in place)
+    sof_hook();
+    usb_worker_start();
+    freqdisc_select(g_persist_disc_src);
+    if (g_persist_alc_on) alc_enable(true);
 
     // --- Encoder + button GPIO init (input with pull-up, active LOW) ---
     gpio_init(PIN_ENC_A);   gpio_set_dir(PIN_ENC_A, GPIO_IN);   gpio_pull_up(PIN_ENC_A);
@@ -2964,6 +2583,7 @@ int main(void) {
     gpio_set_function(PIN_SCK,  GPIO_FUNC_SPI);
 
     // --- OLED I2C init ---
+    // Splash goes out via DMA; the first oled_poll() waits for it to finish.
     i2c_init(OLED_I2C, OLED_I2C_BAUD);
     gpio_set_function(PIN_OLED_SDA, GPIO_FUNC_I2C);
     gpio_set_function(PIN_OLED_SCL, GPIO_FUNC_I2C);
@@ -2973,12 +2593,21 @@ int main(void) {
     ssd1306_clear();
     ssd1306_draw_string(0, 0, "SX1280 SSB TX");
     ssd1306_draw_string(0, 2, "Booting...");
-    ssd1306_display(OLED_I2C);
+    ssd1306_display_dma(OLED_I2C);
 
-    // Hardware reset SX1280
-    printf("[SX1280] Resetting...\n");
-    gpio_put(PIN_RESET, 0); sleep_ms(2);
-    gpio_put(PIN_RESET, 1); sleep_ms(10);
+    // --- DSP: Hilbert taps from flash, filters designed from g_cfg ---
+    txchain_init();
+    g_boot.dsp_ms = to_ms_since_boot(get_absolute_time());
+
+    // Release reset once the pulse (and TCXO settling) has elapsed, then
+    // wait for BUSY to drop instead of a fixed 10 ms.
+#if USE_TCXO_MODULE
+    boot_wait_until(tcxo_ready);
+#endif
+    boot_wait_until(reset_release);
+    gpio_put(PIN_RESET, 1);
+    sleep_ms(1);
+    sx_wait_busy();
     printf("[SX1280] Reset complete, BUSY=%d\n", gpio_get(PIN_BUSY));
 
 #if USE_TCXO_MODULE
@@ -3001,126 +2630,33 @@ int main(void) {
     // Use 'cw' command via CDC to test transmission
     // DON'T start TX yet - wait for USB to enumerate and audio to start
     // sx_start_tx_continuous_wave();  -- moved to core1 when audio starts
+    g_boot.radio_ms = to_ms_since_boot(get_absolute_time());
 
 #if FIXED_POWER_CW_MODE
     // For CW mode, wait for USB then start TX
-    while (!tud_ready()) { tud_task(); sleep_ms(10); }
+    while (!tud_ready()) sleep_ms(10);
     sleep_ms(500);  // Extra delay for USB stability
     gpio_put(PIN_TX_EN, 1);
     sx_start_tx_continuous_wave();
-    while (true) { tud_task(); tight_loop_contents(); }
+    while (true) tight_loop_contents();
 #endif
 
     // *** Start Core1 early so it can idle and drain blocks immediately ***
+    irq_plan_core0();
     multicore_launch_core1(core1_radio_apply_loop);
 
-    // Wait for USB — or timeout after 3 seconds (for powerbank / MIC-only use).
-    // Meanwhile handle encoder, buttons, OLED, CW keying.
-    {
-        printf("[BOOT] Waiting for USB connection (max 3s, encoder+CW active)...\n");
-        absolute_time_t usb_deadline = make_timeout_time_ms(3000);
-
-        while (!tud_ready()) {
-            tud_task();
-            encoder_poll();
-            button_poll();
-            carrier_poll();
-            oled_poll();
-
-            // Timeout: proceed without USB (powerbank / MIC-only mode)
-            if (absolute_time_diff_us(get_absolute_time(), usb_deadline) <= 0) {
-                printf("[BOOT] USB timeout — starting without USB host (MIC mode available)\n");
-                if (g_audio_src == 0) {
-                    g_audio_src = 1;  // Auto-switch to MIC if USB not present
-                    mic_timer_start();
-                    printf("[BOOT] Auto-switched to MIC audio source\n");
-                }
-                break;
-            }
-
-            sleep_ms(1);
-        }
-        if (tud_ready()) {
-            printf("[BOOT] USB connected, starting normal SSB mode\n");
-        }
+    // Audio source: no waiting for USB.  MIC runs from the start; a saved
+    // PC source uses MIC as a fallback until USB enumerates, then
+    // boot_usb_poll() hands over (or never, on a powerbank).
+    if (g_audio_src == 0 && !tud_ready()) {
+        g_audio_src_auto = 1;
+        g_audio_src = 1;
+        printf("[BOOT] USB not ready — MIC until host enumerates\n");
     }
-
-    // Honour persisted audio source: if MIC was saved, start the mic timer
-    // regardless of how USB negotiation went above.
     if (g_audio_src == 1 && !g_mic_timer_running) {
         mic_timer_start();
     }
-
-    hilbert_init();
-
-    const float Fs = (float)WAV_SAMPLE_RATE;
-
-    float theta_prev = 0.0f;
-    float f_acc = 0.0f;
-    float fine_tune_phase = 0.0f;  // Phase accumulator for fine frequency tuning
-    float ctcss_phase = 0.0f;     // Phase accumulator for CTCSS tone generator
-
-    // --- Roger beep (FM mode) state ---
-    // When TX de-asserts while g_roger_beep is enabled, we emit a short
-    // tone by holding tx_on=1 and overriding the audio sample for
-    // ROGER_BEEP_SAMPLES ticks (~100 ms @ 8 kHz).
-    #define ROGER_BEEP_SAMPLES  800u     // 100 ms
-    #define ROGER_BEEP_FREQ_HZ  1000.0f
-    uint32_t roger_beep_left = 0;         // samples remaining
-    float    roger_beep_phase = 0.0f;
-    uint8_t  fm_prev_tx_req  = 0;         // previous "user wants TX" state
-
-    // --- FM TX envelope ramping (anti-click) ---
-    // When tx_on flips we smoothly ramp power + modulation depth with a
-    // raised-cosine envelope so the carrier fades in/out instead of
-    // hard-switching (which produces an audible "thump" in receivers).
-    #define FM_RAMP_SAMPLES  40u   // 40 samples @ 8 kHz = 5 ms
-    uint32_t fm_ramp_pos    = 0;        // 0..FM_RAMP_SAMPLES
-    int8_t   fm_ramp_dir    = 0;        // +1 = ramp up, -1 = ramp down, 0 = idle
-    uint8_t  fm_carrier_on  = 0;        // 1 while carrier is currently emitting
-
-    float p_acc = 0.0f;
-    float tx_acc = 0.0f;
-
-    const float phi = (float)IQ_PHASE_CORR_DEG * (float)M_PI / 180.0f;
-    const float cphi = cosf(phi);
-    const float sphi = sinf(phi);
-
-#if AUDIO_ENABLE_BANDPASS
-    biquad_t bp_hpf[AUDIO_BP_MAX_STAGES];
-    biquad_t bp_lpf[AUDIO_BP_MAX_STAGES];
-    // init via apply_cfg_if_dirty()
-#endif
-
-#if AUDIO_ENABLE_EQ
-    biquad_t eq_low, eq_high;
-    // init via apply_cfg_if_dirty()
-#endif
-
-#if AUDIO_ENABLE_COMPRESSOR
-    compressor_t comp;
-    // init via apply_cfg_if_dirty()
-#endif
-
-#if USE_TEST_TONE
-    float sine_phase1 = 0.0f;
-    const float sine_inc1 = 2.0f * (float)M_PI * (float)TEST_TONE_HZ / Fs;
-#if USE_TWO_TONE_TEST
-    float sine_phase2 = 0.0f;
-    const float sine_inc2 = 2.0f * (float)M_PI * (float)TEST_TONE2_HZ / Fs;
-#endif
-#endif
-
-    audio_cfg_t cfg_local;
-    memset(&cfg_local, 0, sizeof(cfg_local));
-
-    // PRE-BUFFERING: fill half of the blocks before starting consumer
-    // This prevents underruns at startup
-    const uint32_t prebuf_blocks = NUM_BLOCKS / 2;
-    
-    // silence reset counter
-    const uint32_t silence_samples = WAV_SAMPLE_RATE * SILENCE_SECONDS;
-    uint32_t silence_ctr = 0;
+    boot_usb_poll();
 
     // greet once if CDC is connected later
     uint8_t greeted = 0;
@@ -3137,36 +2673,13 @@ int main(void) {
         // Without this, Core1 drains so fast that the wait loop below
         // never executes, starving encoder/button/cw_keying polls.
         if (g_cw_test_mode) {
-            usb_audio_pump();
-            oled_poll();
-
-            encoder_poll();
-            button_poll();
-            carrier_poll();
-            persist_maybe_autosave();
-
-#if CFG_TUD_CDC
-            cdc_task();
-            cdc_status_push();
-#endif
+            core0_poll();
             tight_loop_contents();
             continue;   // Skip block production entirely
         }
 
         while (g_block_ready[b]) {
-            usb_audio_pump();
-            oled_poll();
-
-            // Poll encoder + buttons + carrier state machine
-            encoder_poll();
-            button_poll();
-            carrier_poll();
-            persist_maybe_autosave();
-
-#if CFG_TUD_CDC
-            cdc_status_push();
-#endif
-
+            core0_poll();
             tight_loop_contents();
         }
 
@@ -3175,373 +2688,12 @@ int main(void) {
             greeted = 1;
             cdc_write_str("\r\nSX1280_SDR control ready. Type 'help'.\r\n");
             cfg_print();
+            boot_print();
         }
 #endif
 
-        // Apply pending cfg on block boundary
-#if AUDIO_ENABLE_BANDPASS || AUDIO_ENABLE_EQ || AUDIO_ENABLE_COMPRESSOR
-        apply_cfg_if_dirty(
-            Fs,
-#if AUDIO_ENABLE_BANDPASS
-            bp_hpf, bp_lpf,
-#else
-            NULL, NULL,
-#endif
-#if AUDIO_ENABLE_EQ
-            &eq_low, &eq_high,
-#else
-            NULL, NULL,
-#endif
-#if AUDIO_ENABLE_COMPRESSOR
-            &comp,
-#else
-            NULL,
-#endif
-            &cfg_local
-        );
-#else
-        // still snapshot cfg (amp, etc.)
-        __compiler_memory_barrier();
-        memcpy(&cfg_local, (const void*)&g_cfg, sizeof(cfg_local));
-        __compiler_memory_barrier();
-#endif
-
-        // Get current base steps (with freq and PPM correction) at block boundary
-        int32_t base_steps = (int32_t)get_base_steps();
-
         sample_cmd_t *blk = g_blocks[b];
-
-        for (uint32_t n = 0; n < BLOCK_SAMPLES; n++) {
-            if ((n & 0x07u) == 0u) usb_audio_pump();
-
-            float x = 0.0f;
-
-#if USE_TEST_TONE
-#if USE_TWO_TONE_TEST
-            // Two-tone test: sum of two sinusoids
-            x = TEST_TONE_AMPL * (sinf(sine_phase1) + sinf(sine_phase2));
-            sine_phase1 += sine_inc1;
-            sine_phase2 += sine_inc2;
-            if (sine_phase1 > 2.0f * (float)M_PI) sine_phase1 -= 2.0f * (float)M_PI;
-            if (sine_phase2 > 2.0f * (float)M_PI) sine_phase2 -= 2.0f * (float)M_PI;
-#else
-            x = TEST_TONE_AMPL * sinf(sine_phase1);
-            sine_phase1 += sine_inc1;
-            if (sine_phase1 > 2.0f * (float)M_PI) sine_phase1 -= 2.0f * (float)M_PI;
-#endif
-#else
-            // Audio source: USB (PC) or ADC (MIC)
-            if (g_audio_src == 0) {
-                // PC mode: USB audio → downsample → mono
-                int16_t s = usb_audio_get_mono_8k();
-                x = (float)s / 32768.0f;
-            } else {
-                // MIC mode: wait for sample from timer-driven ring buffer.
-                // Timer ISR fills mic_rb at 8 kHz; we block here until a sample
-                // is available — this naturally paces Core0 at 8 kHz.
-                // While waiting, poll UI + refresh OLED so everything stays responsive.
-                // Also check g_audio_src: if user switches to PC mid-block,
-                // break out immediately to avoid deadlock (timer is stopped).
-                while (g_mic_r == g_mic_w) {
-                    if (g_audio_src == 0) break;  // Source switched — bail out
-                    usb_audio_pump();
-                    encoder_poll();
-                    button_poll();
-                    carrier_poll();
-                    oled_poll();
-#if CFG_TUD_CDC
-                    cdc_status_push();
-#endif
-                }
-                // If source changed mid-block, fill rest with silence
-                // If source changed mid-block, fill rest with silence
-                if (g_audio_src == 0) {
-                    x = 0.0f;
-                } else {
-                    x = adc_mic_get_sample(
-                        cfg_local.mic_agc_target,
-                        cfg_local.mic_agc_max_gain,
-                        cfg_local.mic_agc_attack,
-                        cfg_local.mic_agc_release,
-                        cfg_local.mic_gate_thresh);
-                }
-            }
-
-            if (fabsf(x) < 1e-5f) {
-                if (silence_ctr < silence_samples) silence_ctr++;
-            } else {
-                silence_ctr = 0;
-            }
-
-            if (silence_ctr == silence_samples) {
-                hilbert_reset();
-                theta_prev = 0.0f;
-                f_acc = 0.0f;
-                fine_tune_phase = 0.0f;
-                p_acc = 0.0f;
-                tx_acc = 0.0f;
-
-#if AUDIO_ENABLE_BANDPASS
-                for (int i = 0; i < AUDIO_BP_MAX_STAGES; i++) {
-                    biquad_reset(&bp_hpf[i]);
-                    biquad_reset(&bp_lpf[i]);
-                }
-#endif
-#if AUDIO_ENABLE_EQ
-                biquad_reset(&eq_low);
-                biquad_reset(&eq_high);
-#endif
-#if AUDIO_ENABLE_COMPRESSOR
-                comp.env = 0.0f;
-#endif
-                silence_ctr = silence_samples + 1u;
-            }
-#endif
-
-#if AUDIO_ENABLE_EQ
-            if (cfg_local.enable_eq) {
-                x = biquad_process(&eq_low,  x);
-                x = biquad_process(&eq_high, x);
-            }
-#endif
-
-#if AUDIO_ENABLE_COMPRESSOR
-            if (cfg_local.enable_comp) {
-                x = compressor_process(&comp, x);
-                // output limiter
-                if (x > cfg_local.comp_out_limit) x = cfg_local.comp_out_limit;
-                if (x < -cfg_local.comp_out_limit) x = -cfg_local.comp_out_limit;
-            }
-#endif
-
-#if AUDIO_ENABLE_BANDPASS
-            if (cfg_local.enable_bandpass) {
-                for (int i = 0; i < cfg_local.bp_stages; i++) x = biquad_process(&bp_hpf[i], x);
-                for (int i = 0; i < cfg_local.bp_stages; i++) x = biquad_process(&bp_lpf[i], x);
-            }
-#endif
-
-        after_dsp:
-            // ==================== FM MODE ====================
-            // Direct frequency modulation: audio sample → frequency offset.
-            // No Hilbert transform, no SSB I/Q, no amplitude shaping.
-            // Constant power, constant TX on (when gated).
-            if (g_tx_mode == TXM_FM) {
-                // User's "want TX" request (independent of roger-beep)
-                uint8_t tx_req = (g_tx_enabled || g_ptt_key) ? 1 : 0;
-                if (tx_mode_guard_active()) {
-                    tx_req = 0;
-                    roger_beep_left = 0;  // cancel any pending beep
-                }
-
-                // Detect falling edge of TX request → start roger beep
-                if (g_roger_beep && fm_prev_tx_req && !tx_req) {
-                    roger_beep_left = ROGER_BEEP_SAMPLES;
-                    roger_beep_phase = 0.0f;
-                }
-                fm_prev_tx_req = tx_req;
-
-                // "Keep carrier up" request — includes roger-beep tail
-                uint8_t want_carrier = tx_req || (roger_beep_left > 0);
-
-                // Manage envelope ramp state machine
-                if (want_carrier && !fm_carrier_on && fm_ramp_dir <= 0) {
-                    // Start ramp-up
-                    fm_ramp_dir = +1;
-                    fm_ramp_pos = 0;
-                    fm_carrier_on = 1;
-                } else if (!want_carrier && fm_carrier_on && fm_ramp_dir >= 0) {
-                    // Start ramp-down
-                    fm_ramp_dir = -1;
-                    fm_ramp_pos = FM_RAMP_SAMPLES;  // start from full
-                }
-
-                // Compute envelope value 0..1 for this sample
-                float env;
-                if (fm_ramp_dir > 0) {
-                    fm_ramp_pos++;
-                    if (fm_ramp_pos >= FM_RAMP_SAMPLES) {
-                        fm_ramp_pos = FM_RAMP_SAMPLES;
-                        fm_ramp_dir = 0;   // done
-                    }
-                    float frac = (float)fm_ramp_pos / (float)FM_RAMP_SAMPLES;
-                    env = 0.5f * (1.0f - cosf((float)M_PI * frac));
-                } else if (fm_ramp_dir < 0) {
-                    if (fm_ramp_pos > 0) fm_ramp_pos--;
-                    float frac = (float)fm_ramp_pos / (float)FM_RAMP_SAMPLES;
-                    env = 0.5f * (1.0f - cosf((float)M_PI * frac));
-                    if (fm_ramp_pos == 0) {
-                        fm_ramp_dir = 0;
-                        fm_carrier_on = 0;
-                    }
-                } else {
-                    env = fm_carrier_on ? 1.0f : 0.0f;
-                }
-
-                uint8_t tx_on = fm_carrier_on ? 1 : 0;
-
-                if (tx_on) {
-                    if (roger_beep_left > 0) {
-                        // Override audio with a sine tone, keep carrier up
-                        x = 0.7f * sinf(roger_beep_phase);
-                        roger_beep_phase += 2.0f * (float)M_PI * ROGER_BEEP_FREQ_HZ / Fs;
-                        if (roger_beep_phase >= 2.0f * (float)M_PI) roger_beep_phase -= 2.0f * (float)M_PI;
-                        roger_beep_left--;
-                    } else if (tx_req && g_ctcss_freq > 0.0f) {
-                        // Add CTCSS sub-audible tone if enabled
-                        float ctcss_amp = 0.15f;
-                        x = x * (1.0f - ctcss_amp) + ctcss_amp * sinf(ctcss_phase);
-                        ctcss_phase += 2.0f * (float)M_PI * g_ctcss_freq / Fs;
-                        if (ctcss_phase >= 2.0f * (float)M_PI) ctcss_phase -= 2.0f * (float)M_PI;
-                    }
-                    // Fade modulation depth with envelope so deviation
-                    // also grows/shrinks smoothly, not just RF amplitude.
-                    x *= env;
-                } else {
-                    x = 0.0f;
-                }
-
-                float fm_offset_hz = x * g_fm_deviation_hz;
-                float fm_steps = fm_offset_hz / PLL_STEP_HZ;
-                int32_t fm_int = (int32_t)floorf(fm_steps);
-                float fm_frac = fm_steps - (float)fm_int;
-
-                // Sigma-delta dithering for fractional step
-                f_acc += fm_frac;
-                int32_t fm_chosen = fm_int;
-                if (f_acc >= 1.0f)       { fm_chosen += 1; f_acc -= 1.0f; }
-                else if (f_acc <= -1.0f)  { fm_chosen -= 1; f_acc += 1.0f; }
-
-                int32_t cur_steps = base_steps + fm_chosen;
-
-                // Apply fine frequency tuning (sub-PLL-step correction)
-                float fine_hz = get_fine_tune_hz();
-                if (fine_hz != 0.0f) {
-                    float fine_steps = fine_hz / PLL_STEP_HZ;
-                    cur_steps += (int32_t)roundf(fine_steps);
-                }
-
-                // Power envelope: map env (0..1) from PWR_MIN..target linearly in dB
-                int8_t target_dbm = g_tx_power_max_dbm;
-                int8_t pwr_dbm;
-                if (tx_on) {
-                    float dbm_f = (float)PWR_MIN_DBM +
-                                  env * ((float)target_dbm - (float)PWR_MIN_DBM);
-                    int32_t pi = (int32_t)(dbm_f + 0.5f);
-                    if (pi < PWR_MIN_DBM) pi = PWR_MIN_DBM;
-                    if (pi > PWR_MAX_DBM) pi = PWR_MAX_DBM;
-                    pwr_dbm = (int8_t)pi;
-                } else {
-                    pwr_dbm = PWR_MIN_DBM;
-                }
-
-                blk[n].freq_steps = cur_steps;
-                blk[n].p_dbm      = pwr_dbm;
-                blk[n].tx_on      = tx_on;
-                continue;  // Skip SSB path below
-            }
-
-            // ==================== SSB MODE ====================
-            float I;
-            float Q = hilbert_process(x, &I);
-
-            float Iq = I;
-            float Qq = Q * (float)IQ_GAIN_CORR;
-
-            float I2 = Iq * cphi - Qq * sphi;
-            float Q2 = Iq * sphi + Qq * cphi;
-
-            // Apply fine frequency tuning via complex carrier multiplication
-            // Fine tune is calculated automatically from fractional Hz that PLL can't reach
-            float fine_hz = get_fine_tune_hz();  // Auto-calculated from target freq + PPM
-            if (fine_hz != 0.0f) {
-                float fine_cos = cosf(fine_tune_phase);
-                float fine_sin = sinf(fine_tune_phase);
-                float I3 = I2 * fine_cos - Q2 * fine_sin;
-                float Q3 = I2 * fine_sin + Q2 * fine_cos;
-                I2 = I3;
-                Q2 = Q3;
-                fine_tune_phase += 2.0f * (float)M_PI * fine_hz / Fs;
-                // Keep phase in [-π, π] to avoid precision loss
-                if (fine_tune_phase > (float)M_PI)   fine_tune_phase -= 2.0f * (float)M_PI;
-                if (fine_tune_phase < -(float)M_PI) fine_tune_phase += 2.0f * (float)M_PI;
-            }
-
-            float A = sqrtf(I2 * I2 + Q2 * Q2);
-
-            float theta = atan2f(Q2, I2);
-
-            float dtheta = theta - theta_prev;
-            if (dtheta > (float)M_PI)   dtheta -= 2.0f * (float)M_PI;
-            if (dtheta < -(float)M_PI) dtheta += 2.0f * (float)M_PI;
-            theta_prev = theta;
-
-            float f_off = dtheta * Fs / (2.0f * (float)M_PI);
-            if (f_off > (float)F_OFF_LIMIT_HZ)  f_off = (float)F_OFF_LIMIT_HZ;
-            if (f_off < -(float)F_OFF_LIMIT_HZ) f_off = -(float)F_OFF_LIMIT_HZ;
-
-            float want_steps = f_off / PLL_STEP_HZ;
-            int32_t Nf = (int32_t)floorf(want_steps);
-            float ffrac = want_steps - (float)Nf;
-
-            f_acc += ffrac;
-            int32_t f_chosen = Nf;
-            if (f_acc >= 1.0f) { f_chosen = Nf + 1; f_acc -= 1.0f; }
-
-            int32_t cur_steps = base_steps + f_chosen;
-
-            float duty = duty_from_A(A);
-
-            int32_t p_chosen = PWR_MIN_DBM;
-            uint8_t tx_on = 1;
-
-            if (duty < 1.0f) {
-                p_chosen = PWR_MIN_DBM;
-                tx_acc += duty;
-                if (tx_acc >= 1.0f) { tx_on = 1; tx_acc -= 1.0f; }
-                else                { tx_on = 0; }
-            } else {
-                tx_on = 1;
-
-                int8_t pwr_max = g_tx_power_max_dbm;  // Local copy for this sample
-                float Aeff = A * cfg_local.amp_gain;
-                if (Aeff < cfg_local.amp_min_a) Aeff = cfg_local.amp_min_a;
-
-                float p_raw = (float)pwr_max + 20.0f * log10f(Aeff);
-
-                float p_des = p_raw;
-                if (p_des > (float)pwr_max) p_des = (float)pwr_max;
-                if (p_des < (float)PWR_MIN_DBM) p_des = (float)PWR_MIN_DBM;
-
-                int32_t p_low  = (int32_t)floorf(p_des);
-                int32_t p_high = p_low + 1;
-
-                if (p_low  < PWR_MIN_DBM) p_low  = PWR_MIN_DBM;
-                if (p_high > pwr_max) p_high = pwr_max;
-
-                float frac = p_des - (float)p_low;
-                if (frac < 0.0f) frac = 0.0f;
-                if (frac > 1.0f) frac = 1.0f;
-
-                p_acc += frac;
-                p_chosen = p_low;
-                if (p_acc >= 1.0f && p_high != p_low) { p_chosen = p_high; p_acc -= 1.0f; }
-            }
-
-            // SSB TX gating: transmit if GUI TX=ON *or* PTT pressed.
-            // Either source alone is sufficient (OR logic).
-            // CW mode PTT is handled separately by carrier_poll.
-            // Applies to USB-SSB (mode 0) only.
-            if (g_tx_mode == TXM_USB && !g_tx_enabled && !g_ptt_key) {
-                tx_on = 0;
-            }
-            // Hard-gate TX during mode-change guard window to avoid clicks
-            if (tx_mode_guard_active()) tx_on = 0;
-
-            blk[n].freq_steps = cur_steps;
-            blk[n].p_dbm      = (int8_t)p_chosen;
-            blk[n].tx_on      = tx_on;
-        }
+        txchain_fill_block(blk);
 
         // Diagnostic: count samples in this block that asked for TX
         {
@@ -0,0 +1,254 @@
+// mscdisk.c - FAT volume in a reserved flash region, for the USB MSC function
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "mscdisk.h"
+#include "control.h"
+#include "platform.h"
+
+// FAT12 geometry: 4 KB clusters so a cluster is exactly one flash sector,
+// metadata (boot, 2 FATs, 128 root entries) padded to two sectors.
+#define FAT_RESERVED        6u
+#define FAT_COPIES          2u
+#define FAT_BLOCKS          1u
+#define FAT_ROOT_ENTRIES    128u
+#define FAT_ROOT_BLOCKS     (FAT_ROOT_ENTRIES * 32u / MSC_BLOCK_SIZE)
+#define FAT_DATA_START      (FAT_RESERVED + FAT_COPIES * FAT_BLOCKS + FAT_ROOT_BLOCKS)
+
+_Static_assert(FAT_DATA_START % MSC_BLOCKS_PER_SECTOR == 0, "data region must be sector aligned");
+
+enum { SLOT_FREE = 0, SLOT_CLEAN, SLOT_DIRTY };
+
+typedef struct {
+    uint32_t sector;
+    uint32_t stamp;         // last use, for LRU
+    uint8_t  state;
+} slot_t;
+
+static const msc_backend_t *be;
+static slot_t   slots[MSC_CACHE_SECTORS];
+static uint8_t  cache[MSC_CACHE_SECTORS][MSC_SECTOR_SIZE];
+static uint32_t stamp;
+static uint32_t last_write_ms;
+static volatile bool sync_req;
+static volatile bool tx_hold;           // TX is off at boot; every poll updates it
+static msc_stats_t st;
+
+static inline void put16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void put32(uint8_t *p, uint32_t v) { put16(p, (uint16_t)v); put16(p + 2, (uint16_t)(v >> 16)); }
+static inline uint16_t get16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t get32(const uint8_t *p) { return get16(p) | ((uint32_t)get16(p + 2) << 16); }
+
+static int find_slot(uint32_t sector) {
+    for (uint32_t i = 0; i < MSC_CACHE_SECTORS; i++)
+        if (slots[i].state != SLOT_FREE && slots[i].sector == sector) return (int)i;
+    return -1;
+}
+
+static uint8_t count_state(uint8_t state) {
+    uint8_t n = 0;
+    for (uint32_t i = 0; i < MSC_CACHE_SECTORS; i++) n += (slots[i].state == state);
+    return n;
+}
+
+// Write one slot back; it stays cached as clean
+static bool flush_slot(uint32_t i) {
+    slot_t *s = &slots[i];
+    const uint8_t *cur = be->base + s->sector * MSC_SECTOR_SIZE;
+    if (!memcmp(cur, cache[i], MSC_SECTOR_SIZE)) {
+        st.skipped++;
+    } else if (be->program(s->sector, cache[i], be->ctx)) {
+        st.programs++;
+    } else {
+        st.fails++;
+        return false;
+    }
+    s->state = SLOT_CLEAN;
+    return true;
+}
+
+static int oldest(uint8_t state) {
+    int best = -1;
+    for (uint32_t i = 0; i < MSC_CACHE_SECTORS; i++) {
+        if (slots[i].state != state) continue;
+        if (best < 0 || (int32_t)(slots[i].stamp - slots[best].stamp) < 0) best = (int)i;
+    }
+    return best;
+}
+
+// Slot holding `sector` for writing: cached, a free or clean slot
+// reloaded from flash, or -1 when every slot is dirty and TX forbids a
+// flush to make room.
+static int slot_for_write(uint32_t sector) {
+    int i = find_slot(sector);
+    if (i >= 0) return i;
+
+    i = oldest(SLOT_FREE);
+    if (i < 0) i = oldest(SLOT_CLEAN);
+    if (i < 0) {
+        if (tx_hold) return -1;
+        i = oldest(SLOT_DIRTY);
+        if (!flush_slot((uint32_t)i)) return -1;
+    }
+    slots[i].sector = sector;
+    slots[i].state = SLOT_CLEAN;
+    memcpy(cache[i], be->base + sector * MSC_SECTOR_SIZE, MSC_SECTOR_SIZE);
+    return i;
+}
+
+static bool volume_ok(const uint8_t *b) {
+    if (b[510] != 0x55 || b[511] != 0xAA) return false;
+    if (get16(b + 11) != MSC_BLOCK_SIZE) return false;
+    const uint32_t total = get16(b + 19) ? get16(b + 19) : get32(b + 32);
+    return total == MSC_BLOCKS;
+}
+
+static void format(void) {
+    static uint8_t blk[MSC_BLOCK_SIZE];
+
+    for (uint32_t lba = 0; lba < FAT_DATA_START; lba++) {
+        memset(blk, 0, sizeof(blk));
+        if (lba == 0) {
+            static const uint8_t jmp[3] = { 0xEB, 0x3C, 0x90 };
+            memcpy(blk, jmp, 3);
+            memcpy(blk + 3, "MSDOS5.0", 8);
+            put16(blk + 11, MSC_BLOCK_SIZE);
+            blk[13] = MSC_BLOCKS_PER_SECTOR;
+            put16(blk + 14, FAT_RESERVED);
+            blk[16] = FAT_COPIES;
+            put16(blk + 17, FAT_ROOT_ENTRIES);
+            put16(blk + 19, MSC_BLOCKS);
+            blk[21] = 0xF8;                         // fixed disk
+            put16(blk + 22, FAT_BLOCKS);
+            put16(blk + 24, 1);                     // sectors per track
+            put16(blk + 26, 1);                     // heads
+            blk[36] = 0x80;
+            blk[38] = 0x29;                         // extended boot signature
+            put32(blk + 39, (uint32_t)plat_us());   // volume serial
+            memcpy(blk + 43, "SX1280     ", 11);
+            memcpy(blk + 54, "FAT12   ", 8);
+            blk[510] = 0x55;
+            blk[511] = 0xAA;
+        } else if (lba >= FAT_RESERVED && lba < FAT_RESERVED + FAT_COPIES * FAT_BLOCKS &&
+                   (lba - FAT_RESERVED) % FAT_BLOCKS == 0) {
+            blk[0] = 0xF8; blk[1] = 0xFF; blk[2] = 0xFF;   // media + end-of-chain
+        } else if (lba == FAT_RESERVED + FAT_COPIES * FAT_BLOCKS) {
+            memcpy(blk, "SX1280     ", 11);
+            blk[11] = 0x08;                         // volume label entry
+        }
+        (void)mscdisk_write(lba, 0, blk, MSC_BLOCK_SIZE);
+    }
+    last_write_ms = plat_ms() - MSC_FLUSH_IDLE_MS;  // flush at the first chance
+}
+
+void mscdisk_init(const msc_backend_t *backend) {
+    memset(slots, 0, sizeof(slots));
+    memset(&st, 0, sizeof(st));
+    be = backend;
+    sync_req = false;
+    tx_hold = false;
+    if (!volume_ok(be->base)) {
+        format();
+        st.formatted = true;
+    }
+}
+
+bool mscdisk_ready(void) { return be != NULL; }
+
+static bool in_range(uint32_t lba, uint32_t offset, uint32_t n) {
+    const uint64_t start = (uint64_t)lba * MSC_BLOCK_SIZE + offset;
+    return be && start + n <= MSC_VOLUME_BYTES;
+}
+
+int32_t mscdisk_read(uint32_t lba, uint32_t offset, void *buf, uint32_t n) {
+    if (!in_range(lba, offset, n)) return -1;
+    uint32_t pos = lba * MSC_BLOCK_SIZE + offset;
+    uint8_t *out = (uint8_t *)buf;
+
+    for (uint32_t left = n; left; ) {
+        const uint32_t sector = pos / MSC_SECTOR_SIZE, at = pos % MSC_SECTOR_SIZE;
+        uint32_t chunk = MSC_SECTOR_SIZE - at;
+        if (chunk > left) chunk = left;
+
+        const int i = find_slot(sector);
+        if (i >= 0) {
+            memcpy(out, &cache[i][at], chunk);
+            slots[i].stamp = ++stamp;
+        } else {
+            memcpy(out, be->base + pos, chunk);
+        }
+        out += chunk; pos += chunk; left -= chunk;
+    }
+    st.blocks_rd += n / MSC_BLOCK_SIZE;
+    return (int32_t)n;
+}
+
+int32_t mscdisk_write(uint32_t lba, uint32_t offset, const void *buf, uint32_t n) {
+    if (!in_range(lba, offset, n)) return -1;
+    uint32_t pos = lba * MSC_BLOCK_SIZE + offset;
+    const uint8_t *in = (const uint8_t *)buf;
+    uint32_t done = 0;
+
+    while (done < n) {
+        const uint32_t sector = pos / MSC_SECTOR_SIZE, at = pos % MSC_SECTOR_SIZE;
+        uint32_t chunk = MSC_SECTOR_SIZE - at;
+        if (chunk > n - done) chunk = n - done;
+
+        const int i = slot_for_write(sector);
+        if (i < 0) {
+            st.busy++;
+            break;                                  // partial (or 0 = busy)
+        }
+        memcpy(&cache[i][at], in, chunk);
+        slots[i].state = SLOT_DIRTY;
+        slots[i].stamp = ++stamp;
+        in += chunk; pos += chunk; done += chunk;
+    }
+    if (done) last_write_ms = plat_ms();
+    st.blocks_wr += done / MSC_BLOCK_SIZE;
+    return (int32_t)done;
+}
+
+void mscdisk_sync(void) { sync_req = true; }
+
+void mscdisk_poll(bool tx_active) {
+    tx_hold = tx_active;
+    if (!be || tx_active) return;
+
+    const int i = oldest(SLOT_DIRTY);
+    if (i < 0) { sync_req = false; return; }
+
+    const bool full = count_state(SLOT_DIRTY) == MSC_CACHE_SECTORS;
+    const bool idle = (uint32_t)(plat_ms() - last_write_ms) >= MSC_FLUSH_IDLE_MS;
+    if (sync_req || idle || full) (void)flush_slot((uint32_t)i);
+}
+
+// Slot states are single bytes, so a racing write is seen here or at the
+// next pass
+bool mscdisk_pending(bool tx_active) {
+    tx_hold = tx_active;
+    if (!be || tx_active) return false;
+    return sync_req || count_state(SLOT_DIRTY) > 0;
+}
+
+void mscdisk_stats(msc_stats_t *out) {
+    *out = st;
+    out->dirty = count_state(SLOT_DIRTY);
+    out->cached = (uint8_t)(out->dirty + count_state(SLOT_CLEAN));
+}
+
+void mscdisk_print(const char *why) {
+    if (!be) {
+        cdc_printf("!M why=%s ready=0\r\n", why);
+        return;
+    }
+    msc_stats_t s;
+    mscdisk_stats(&s);
+    cdc_printf("!M why=%s ready=1 kb=%lu dirty=%u cached=%u prog=%lu same=%lu fail=%lu rd=%lu wr=%lu busy=%lu fmt=%u\r\n",
+               why, (unsigned long)(MSC_VOLUME_BYTES / 1024u), s.dirty, s.cached,
+               (unsigned long)s.programs, (unsigned long)s.skipped, (unsigned long)s.fails,
+               (unsigned long)s.blocks_rd, (unsigned long)s.blocks_wr, (unsigned long)s.busy,
+               s.formatted ? 1u : 0u);
+}
@@ -0,0 +1,78 @@
+// mscdisk.h - FAT volume in a reserved flash region, for the USB MSC function
+//
+// The host sees a 1 MB removable disk (512-byte blocks, FAT12, label
+// SX1280) for presets, voice clips, logs and coefficient banks, at bulk
+// USB speed instead of through the CDC text protocol.
+//
+// Flash is erased in 4 KB sectors, so host writes land in a small RAM
+// cache of whole sectors and reach flash later:
+//
+//   - never while transmitting: an erase stalls Core0 and parks Core1
+//     for ~30 ms (flash_safe_execute), which would gap the RF;
+//   - after MSC_FLUSH_IDLE_MS without writes, on SYNCHRONIZE CACHE /
+//     eject, or when every cache slot is dirty; one sector per poll;
+//   - only if the sector changed (rewriting the same FAT costs nothing).
+//
+// With the cache full of dirty sectors during TX, writes report busy and
+// the host retries.  Portable: the backing store comes in through
+// msc_backend_t; host/mscheck runs it on a RAM image.
+
+#ifndef MSCDISK_H
+#define MSCDISK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MSC_BLOCK_SIZE          512u
+#define MSC_SECTOR_SIZE         4096u           // flash erase unit
+#define MSC_BLOCKS_PER_SECTOR   (MSC_SECTOR_SIZE / MSC_BLOCK_SIZE)
+#define MSC_VOLUME_BYTES        (1024u * 1024u)
+#define MSC_BLOCKS              (MSC_VOLUME_BYTES / MSC_BLOCK_SIZE)
+#define MSC_SECTORS             (MSC_VOLUME_BYTES / MSC_SECTOR_SIZE)
+
+#define MSC_CACHE_SECTORS       8u              // 32 KB RAM
+#define MSC_FLUSH_IDLE_MS       1500u
+
+typedef struct {
+    const uint8_t *base;    // volume image, read directly (XIP on the device)
+    // Erase and program one MSC_SECTOR_SIZE sector of the volume
+    bool (*program)(uint32_t sector, const uint8_t *data, void *ctx);
+    void *ctx;
+} msc_backend_t;
+
+typedef struct {
+    uint32_t programs;      // sectors erased + programmed
+    uint32_t skipped;       // flushes that found flash already equal
+    uint32_t fails;         // backend program failures
+    uint32_t blocks_rd, blocks_wr;
+    uint32_t busy;          // writes refused: cache full of dirty sectors during TX
+    uint8_t  dirty, cached;
+    bool     formatted;     // no valid volume found at init
+} msc_stats_t;
+
+// Attach the backing store; formats (into the cache) if it holds no
+// volume of this geometry.  Before this, the disk reports not ready.
+void    mscdisk_init(const msc_backend_t *be);
+bool    mscdisk_ready(void);
+
+// Byte ranges starting at block lba + offset; return bytes done, 0 for
+// busy (write only: retry later), -1 outside the volume.
+int32_t mscdisk_read(uint32_t lba, uint32_t offset, void *buf, uint32_t n);
+int32_t mscdisk_write(uint32_t lba, uint32_t offset, const void *buf, uint32_t n);
+
+// Host asked for the data to be on the medium (SYNCHRONIZE CACHE, eject):
+// flush as soon as TX allows instead of waiting for the idle time.
+void    mscdisk_sync(void);
+
+// Main loop: flush at most one dirty sector unless tx_active.
+void    mscdisk_poll(bool tx_active);
+
+// Main loop, without the USB lock: records tx_active for the write path
+// and says whether mscdisk_poll() has anything to do (a dirty sector or
+// a sync, TX off).  A clean cache needs no poll and no lock.
+bool    mscdisk_pending(bool tx_active);
+
+void    mscdisk_stats(msc_stats_t *out);
+void    mscdisk_print(const char *why);     // "!M" line
+
+#endif // MSCDISK_H
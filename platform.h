@@ -0,0 +1,103 @@
+// platform.h - portability layer for firmware logic that also builds natively
+//
+// control.c / txchain.c / dsp.c include this instead of pico/*.h so the
+// same sources compile for the RP2350 and for the host tools in host/.
+// The plat_* hooks are implemented by main.c on the device and by the
+// simulator backends on the host.
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#if SX_HOST_BUILD
+
+#ifndef __not_in_flash_func
+#define __not_in_flash_func(func_name) func_name
+#endif
+#define __compiler_memory_barrier() __asm__ volatile ("" : : : "memory")
+#define tight_loop_contents() ((void)0)
+#define plat_dmb() __atomic_thread_fence(__ATOMIC_ACQ_REL)    // no store->load ordering needed
+
+uint32_t plat_ms(void);
+uint64_t plat_us(void);
+static inline uint32_t plat_cpu_hz(void) { return 0; }   // unknown: report ns only
+
+#else
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+
+// Data memory barrier: orders memory accesses against the other core
+// (DMB on the M33, FENCE on Hazard3)
+#define plat_dmb() __dmb()
+
+static inline uint32_t plat_ms(void) { return to_ms_since_boot(get_absolute_time()); }
+static inline uint64_t plat_us(void) { return time_us_64(); }
+static inline uint32_t plat_cpu_hz(void) { return clock_get_hz(clk_sys); }
+
+#endif
+
+// --- Core type ---
+// The RP2350 boots either its Cortex-M33 pair (PICO_BOARD pico2) or its
+// Hazard3 RISC-V pair (SX_TARGET pico2_riscv, see CMakeLists.txt).  The
+// DSP is single-precision float throughout: one instruction per operation
+// on the M33 FPU, a library call on Hazard3 (RV32IMAC + bitmanip, no F
+// extension).  Code that must not wait on the XIP cache goes in RAM with
+// SX_RAMFUNC, which the SDK maps to the right section on both.
+#if SX_HOST_BUILD
+#define SX_ISA          "host"
+#define SX_HAS_FPU      1
+#elif defined(__riscv)
+#define SX_ISA          "riscv"
+#define SX_HAS_FPU      0
+#else
+#define SX_ISA          "arm"
+#define SX_HAS_FPU      1
+#endif
+
+#define SX_RAMFUNC(func_name) __not_in_flash_func(func_name)
+
+#if !SX_HOST_BUILD
+// Per-core cycle counter for short intervals (wraps at 2^32 cycles):
+// Hazard3 mcycle, or the M33 DWT CYCCNT.  plat_cycles_init() once on
+// each core that reads it.
+#if defined(__riscv)
+static inline void plat_cycles_init(void) {
+    __asm volatile ("csrci 0x320, 1");          // mcountinhibit.CY = 0
+}
+static inline uint32_t plat_cycles(void) {
+    uint32_t c;
+    __asm volatile ("csrr %0, mcycle" : "=r" (c));
+    return c;
+}
+#else
+#define PLAT_DEMCR      (*(volatile uint32_t *)0xE000EDFCu)
+#define PLAT_DWT_CTRL   (*(volatile uint32_t *)0xE0001000u)
+#define PLAT_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004u)
+static inline void plat_cycles_init(void) {
+    PLAT_DEMCR |= 1u << 24;                     // TRCENA
+    PLAT_DWT_CTRL |= 1u;                        // CYCCNTENA
+}
+static inline uint32_t plat_cycles(void) { return PLAT_DWT_CYCCNT; }
+#endif
+#endif
+
+// --- CDC transport ---
+bool plat_cdc_connected(void);
+void plat_cdc_write(const char *s);        // write + flush
+
+// --- Hardware side effects requested by CDC commands ---
+void plat_mic_start(void);                 // start MIC sampling (src mic)
+void plat_mic_stop(void);                  // stop MIC sampling (src pc)
+void plat_tune_apply(void);                // re-apply carrier freq/power in TUNE
+void plat_radio_diag(void);                // print radio diagnostics ("diag")
+void plat_disc_select(uint8_t src);        // enable SOF callback / PPS capture (FD_SRC_*)
+void plat_usb_rs_print(void);              // USB resampler "!R" line ("rs")
+void plat_bench_spi(void);                 // Core1 SPI command timing "!K" line ("bench")
+void plat_irq_print(bool reset);           // IRQ affinity "!I" line ("irq")
+
+#endif // PLATFORM_H
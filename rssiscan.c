@@ -0,0 +1,267 @@
+// rssiscan.c - SX1280 RSSI band scan for picking a clear uplink spot
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "rssiscan.h"
+#include "control.h"
+#include "platform.h"
+
+#define SCAN_AVG_SHIFT          2       // level / occupancy average: 1/4 per sweep
+#define SCAN_BUSY_TIMEOUT_US    10000u
+
+static const scan_backend_t *be;
+static scan_stats_t st = {
+    .lo_khz = SCAN_LO_KHZ, .step_khz = SCAN_STEP_KHZ,
+    .settle_us = SCAN_SETTLE_US,
+};
+
+// SetRfFrequency per bin, opcode included, built once per scan
+static uint8_t fw[SCAN_MAX_BINS][4];
+
+static int32_t avg_q4[SCAN_MAX_BINS];      // dBm x 2, Q4
+static uint8_t occ[SCAN_MAX_BINS];
+static int16_t peak[SCAN_MAX_BINS];
+
+static uint32_t k;                  // bin being measured
+static uint64_t t_tune;             // its SetRfFrequency went out
+static uint64_t t_sweep0;
+static int16_t  sweep_min;
+static int16_t  occ_thr;
+
+// Last bin's reads, folded in while the next one settles
+static bool     pend;
+static uint32_t pend_bin;
+static int16_t  pend_rd[SCAN_READS];
+
+static uint32_t last_report_ms, reported;
+static bool     fault;
+
+static uint32_t bins_for(uint32_t lo, uint32_t hi, uint32_t step) {
+    return (hi - lo) / step + 1u;
+}
+
+bool rssiscan_start(uint32_t lo_khz, uint32_t hi_khz, uint32_t step_khz) {
+    if (!step_khz || hi_khz <= lo_khz) return false;
+    if (lo_khz < 2390000u || hi_khz > 2510000u) return false;
+    if (bins_for(lo_khz, hi_khz, step_khz) > SCAN_MAX_BINS) return false;
+    st.lo_khz = lo_khz;
+    st.step_khz = step_khz;
+    st.bins = bins_for(lo_khz, hi_khz, step_khz);
+    rssiscan_reset();
+    st.active = false;              // (re)configured by the next rssiscan_begin()
+    st.want = true;
+    return true;
+}
+
+void rssiscan_stop(const char *why) {
+    if (!st.want) return;
+    st.want = false;
+    rssiscan_print(why);
+}
+
+bool rssiscan_wanted(void) { return st.want; }
+
+void rssiscan_set_settle(uint32_t us) {
+    if (us > 1000u) us = 1000u;
+    st.settle_us = (uint16_t)us;
+}
+
+void rssiscan_reset(void) {
+    memset(avg_q4, 0, sizeof(avg_q4));
+    memset(occ, 0, sizeof(occ));
+    for (uint32_t i = 0; i < SCAN_MAX_BINS; i++) peak[i] = INT16_MIN;
+    st.sweeps = st.sweep_us = st.reads = st.busy_spins = 0;
+    st.floor_dbm2 = st.best_dbm2 = 0;
+    st.best_khz = 0;
+    sweep_min = INT16_MAX;
+    pend = false;
+    reported = 0;
+    t_sweep0 = plat_us();
+}
+
+// BUSY is only checked before a transaction, never waited out after one
+static bool ready(void) {
+    if (!be->busy(be->ctx)) return true;
+    st.busy_spins++;
+    const uint64_t t0 = plat_us();
+    while (be->busy(be->ctx)) {
+        if (plat_us() - t0 > SCAN_BUSY_TIMEOUT_US) return false;
+        tight_loop_contents();
+    }
+    return true;
+}
+
+static bool send(const uint8_t *tx, uint8_t *rx, uint32_t n) {
+    if (!ready()) { fault = true; return false; }
+    be->xfer(tx, rx, n, be->ctx);
+    return true;
+}
+
+void rssiscan_begin(const scan_backend_t *b) {
+    be = b;
+    fault = false;
+    if (!st.bins) st.bins = bins_for(st.lo_khz, SCAN_HI_KHZ, st.step_khz);
+
+    const double ppm = (double)g_ppm_correction + (double)g_ppm_disc;
+    for (uint32_t i = 0; i < st.bins; i++) {
+        const double hz = (double)(st.lo_khz + i * st.step_khz) * 1000.0 * (1.0 + ppm / 1000000.0);
+        const uint32_t steps = (uint32_t)(hz / (double)PLL_STEP_HZ + 0.5);
+        fw[i][0] = SX_OP_SET_RF_FREQUENCY;
+        fw[i][1] = (uint8_t)(steps >> 16);
+        fw[i][2] = (uint8_t)(steps >> 8);
+        fw[i][3] = (uint8_t)steps;
+    }
+
+    static const uint8_t pkt[2] = { SX_OP_SET_PACKET_TYPE, 0x00 };              // GFSK
+    static const uint8_t mod[4] = { SX_OP_SET_MOD_PARAMS, SX_GFSK_BR_0_125_BW_0_3, 0x00, 0x00 };
+    static const uint8_t rx[4]  = { SX_OP_SET_RX, 0x00, 0xFF, 0xFF };          // continuous
+    k = 0;
+    send(pkt, NULL, sizeof(pkt));
+    send(mod, NULL, sizeof(mod));
+    send(fw[0], NULL, 4);
+    send(rx, NULL, sizeof(rx));
+    t_tune = plat_us();
+    t_sweep0 = t_tune;
+    sweep_min = INT16_MAX;
+    pend = false;
+    last_report_ms = plat_ms();
+    st.active = true;
+}
+
+static void sweep_done(void) {
+    const uint64_t now = plat_us();
+    st.sweeps++;
+    st.sweep_us = (uint32_t)(now - t_sweep0);
+    t_sweep0 = now;
+    st.floor_dbm2 = sweep_min;
+    occ_thr = (int16_t)(sweep_min + 2 * SCAN_OCC_DB);
+    sweep_min = INT16_MAX;
+
+    // Quietest bin inside the NB uplink (anywhere if the range misses it)
+    bool nb = false;
+    for (uint32_t i = 0; i < st.bins; i++) {
+        const uint32_t f = st.lo_khz + i * st.step_khz;
+        if (f >= SCAN_NB_LO_KHZ && f <= SCAN_NB_HI_KHZ) { nb = true; break; }
+    }
+    int32_t best = INT32_MAX;
+    for (uint32_t i = 0; i < st.bins; i++) {
+        const uint32_t f = st.lo_khz + i * st.step_khz;
+        if (nb && (f < SCAN_NB_LO_KHZ || f > SCAN_NB_HI_KHZ)) continue;
+        if (avg_q4[i] < best) {
+            best = avg_q4[i];
+            st.best_khz = f;
+        }
+    }
+    st.best_dbm2 = (int16_t)(best / 16);
+}
+
+static void fold(void) {
+    pend = false;
+    const uint32_t i = pend_bin;
+    int32_t sum = 0;
+    uint32_t hits = 0;
+    for (uint32_t r = 0; r < SCAN_READS; r++) {
+        const int16_t x = pend_rd[r];
+        sum += x;
+        if (x > peak[i]) peak[i] = x;
+        if (st.sweeps && x > occ_thr) hits++;
+    }
+    const int32_t mean_q4 = sum * 16 / (int32_t)SCAN_READS;
+    const int32_t o = (int32_t)(hits * 255u / SCAN_READS);
+    if (!st.sweeps) {
+        avg_q4[i] = mean_q4;
+    } else {
+        avg_q4[i] += (mean_q4 - avg_q4[i]) / (1 << SCAN_AVG_SHIFT);
+        occ[i] = (uint8_t)(occ[i] + (o - occ[i]) / (1 << SCAN_AVG_SHIFT));
+    }
+    const int16_t mean = (int16_t)(sum / (int32_t)SCAN_READS);
+    if (mean < sweep_min) sweep_min = mean;
+    if (i == st.bins - 1u) sweep_done();
+}
+
+void rssiscan_poll(void) {
+    if (!st.active) return;
+    const uint64_t t_end = plat_us() + SCAN_SLICE_US;
+    do {
+        if (pend) fold();                               // under bin k's settle time
+        while (plat_us() - t_tune < st.settle_us) tight_loop_contents();
+
+        static const uint8_t get[3] = { SX_OP_GET_RSSI_INST, 0x00, 0x00 };
+        uint64_t t_rd = plat_us();
+        for (uint32_t r = 0; r < SCAN_READS; r++) {
+            if (r) {
+                t_rd += SCAN_READ_GAP_US;
+                while (plat_us() < t_rd) tight_loop_contents();
+            }
+            uint8_t in[3] = { 0 };
+            if (!send(get, in, sizeof(get))) break;
+            pend_rd[r] = (int16_t)-in[2];               // -RssiInst/2 dBm
+            st.reads++;
+        }
+        if (fault) break;
+        pend = true;
+        pend_bin = k;
+
+        k = (k + 1u == st.bins) ? 0u : k + 1u;
+        if (!send(fw[k], NULL, 4)) break;
+        t_tune = plat_us();
+    } while (plat_us() < t_end);
+    if (pend) fold();
+
+    if (fault) {
+        rssiscan_stop("busy");
+        return;
+    }
+    const uint32_t now = plat_ms();
+    if (st.sweeps != reported && now - last_report_ms >= SCAN_REPORT_MS) {
+        last_report_ms = now;
+        reported = st.sweeps;
+        rssiscan_print("sweep");
+    }
+}
+
+void rssiscan_end(void) {
+    st.active = false;
+    pend = false;
+}
+
+void rssiscan_stats(scan_stats_t *out) { *out = st; }
+
+void rssiscan_bin(uint32_t i, int16_t *avg_dbm2, uint8_t *o, int16_t *peak_dbm2) {
+    if (i >= SCAN_MAX_BINS) i = SCAN_MAX_BINS - 1u;
+    *avg_dbm2 = (int16_t)(avg_q4[i] / 16);
+    *o = occ[i];
+    *peak_dbm2 = peak[i];
+}
+
+void rssiscan_print(const char *why) {
+    // Histogram as hex: two digits of -dBm per bin, one of occupancy / 16
+    static char b[288 + 3u * SCAN_MAX_BINS + 8];
+    static const char hex[] = "0123456789ABCDEF";
+    int n = snprintf(b, sizeof(b),
+                     "!Q why=%s on=%u lo_khz=%lu step_khz=%lu bins=%lu sweeps=%lu sweep_us=%lu "
+                     "settle_us=%u busy=%lu floor_dbm=%d best_khz=%lu best_dbm=%d lvl=",
+                     why, st.want ? 1u : 0u, (unsigned long)st.lo_khz, (unsigned long)st.step_khz,
+                     (unsigned long)st.bins, (unsigned long)st.sweeps, (unsigned long)st.sweep_us,
+                     st.settle_us, (unsigned long)st.busy_spins, st.floor_dbm2 / 2,
+                     (unsigned long)st.best_khz, st.best_dbm2 / 2);
+    uint32_t p = (uint32_t)n;
+    const uint32_t nb = st.sweeps ? st.bins : 0u;
+    for (uint32_t i = 0; i < nb; i++) {
+        int32_t d = -avg_q4[i] / 32;                    // dBm x 2, Q4 -> -dBm
+        if (d < 0) d = 0;
+        if (d > 255) d = 255;
+        b[p++] = hex[d >> 4];
+        b[p++] = hex[d & 15];
+    }
+    memcpy(&b[p], " occ=", 5);
+    p += 5;
+    for (uint32_t i = 0; i < nb; i++) b[p++] = hex[occ[i] >> 4];
+    b[p++] = '\r';
+    b[p++] = '\n';
+    b[p] = 0;
+    cdc_write_str(b);
+}
@@ -0,0 +1,94 @@
+// rssiscan.h - SX1280 RSSI band scan for picking a clear uplink spot
+//
+// Local 2.4 GHz Wi-Fi, Bluetooth and ISM traffic around the QO-100
+// uplink is invisible while we only transmit.  "scan on" parks TX (the
+// carrier state machine idles Core1 exactly as for CW / TUNE), switches
+// the RF path to RX and puts the SX1280 in continuous GFSK RX with its
+// narrowest filter (~300 kHz).  Core0 then steps the synthesizer across
+// the range and reads GetRssiInst at every step:
+//
+//   retune    SetRfFrequency for bin k+1 is sent right after the last
+//             read of bin k, from a table of ready-made command words,
+//             without waiting for BUSY to drop afterwards
+//   settle    while the PLL locks, bin k's reads are folded into the
+//             histogram (the only bookkeeping per bin)
+//   dwell     SCAN_READS reads SCAN_READ_GAP_US apart, BUSY checked
+//             only before each transaction
+//
+// Each bin keeps an averaged level, the share of reads more than
+// SCAN_OCC_DB above the floor of the previous sweep (occupancy) and a
+// peak hold.  The histogram is streamed as "!Q" lines every
+// SCAN_REPORT_MS together with the quietest bin inside the narrowband
+// uplink.  Keying (PTT, tx 1, TUNE, tx_at) stops the scan.
+//
+// Portable: the SPI comes in through scan_backend_t; host/scancheck runs
+// it against an emulated SX1280 (host/sxemu.c), and sxsim answers "scan"
+// from the same emulator.
+
+#ifndef RSSISCAN_H
+#define RSSISCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCAN_MAX_BINS       128u
+#define SCAN_LO_KHZ         2399500u    // default range around the NB uplink
+#define SCAN_HI_KHZ         2401000u
+#define SCAN_STEP_KHZ       25u
+#define SCAN_NB_LO_KHZ      2400050u    // narrowband uplink, where "best" is picked
+#define SCAN_NB_HI_KHZ      2400300u
+#define SCAN_SETTLE_US      60u         // default PLL settle after a retune in RX
+#define SCAN_READS          4u          // GetRssiInst per bin and sweep
+#define SCAN_READ_GAP_US    4u
+#define SCAN_SLICE_US       1000u       // per rssiscan_poll(), then the main loop runs
+#define SCAN_OCC_DB         6           // occupied: this far above the sweep floor
+#define SCAN_REPORT_MS      250u
+
+// SX1280 commands used by the scan
+#define SX_OP_GET_RSSI_INST     0x1F
+#define SX_OP_SET_RX            0x82
+#define SX_OP_SET_RF_FREQUENCY  0x86
+#define SX_OP_SET_PACKET_TYPE   0x8A
+#define SX_OP_SET_MOD_PARAMS    0x8B
+#define SX_GFSK_BR_0_125_BW_0_3 0xEF    // narrowest GFSK receive filter
+
+typedef struct {
+    // One transaction with NSS held low: n bytes out, n bytes in (rx may be NULL)
+    void (*xfer)(const uint8_t *tx, uint8_t *rx, uint32_t n, void *ctx);
+    bool (*busy)(void *ctx);            // BUSY pin
+    void *ctx;
+} scan_backend_t;
+
+typedef struct {
+    bool     want, active;
+    uint32_t lo_khz, step_khz, bins;
+    uint16_t settle_us;
+    uint32_t sweeps;
+    uint32_t sweep_us;          // duration of the last full sweep
+    uint32_t reads;
+    uint32_t busy_spins;        // BUSY still high before a transaction
+    int16_t  floor_dbm2;        // last sweep's quietest bin, dBm x 2
+    uint32_t best_khz;
+    int16_t  best_dbm2;
+} scan_stats_t;
+
+// CDC: request a scan (false: bad range); the carrier state machine
+// parks TX and calls rssiscan_begin().  stop() also reports why.
+bool rssiscan_start(uint32_t lo_khz, uint32_t hi_khz, uint32_t step_khz);
+void rssiscan_stop(const char *why);
+bool rssiscan_wanted(void);
+void rssiscan_set_settle(uint32_t us);
+void rssiscan_reset(void);              // clear the histogram
+
+// Radio owner (Core0 with Core1 idle, radio in standby, RF path on RX):
+// configure continuous RX, then poll until !rssiscan_wanted(), then end.
+void rssiscan_begin(const scan_backend_t *be);
+void rssiscan_poll(void);
+void rssiscan_end(void);
+
+void rssiscan_stats(scan_stats_t *out);
+// Averaged level (dBm x 2), occupancy (0..255) and peak (dBm x 2) of bin i
+void rssiscan_bin(uint32_t i, int16_t *avg_dbm2, uint8_t *occ, int16_t *peak_dbm2);
+void rssiscan_print(const char *why);   // "!Q" line with the histogram
+
+#endif // RSSISCAN_H
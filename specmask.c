@@ -0,0 +1,242 @@
+// specmask.c - spectral mask guard computed from the sample commands
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "specmask.h"
+#include "alc.h"
+#include "control.h"
+#include "platform.h"
+#include "dsp.h"
+
+#define SM_SIN_LOG2     10u                     // Q15 sine, 1024 points
+#define SM_SIN_N        (1u << SM_SIN_LOG2)
+#define SM_TW_STEP      (SM_SIN_N / SM_N)       // table step for the FFT twiddles
+
+enum { SM_IDLE, SM_SYNTH, SM_FFT, SM_ACCUM };
+
+static bool     sm_on = true;
+static float    lim_db = SM_LIM_DB;
+static float    lo_hz = SM_LO_HZ, hi_hz = SM_HI_HZ;
+
+// Tables, built on first use
+static bool     tables_ready;
+static int16_t  sin_q15[SM_SIN_N];
+static int16_t  win_q15[SM_N];
+static int16_t  amp_q15[PWR_MAX_DBM - PWR_MIN_DBM + 1];
+static uint16_t bitrev[SM_N];
+static uint32_t q32_per_q8;                     // carrier phase per 1/256 PLL step per sample
+
+// Work
+static uint8_t      state = SM_IDLE;
+static sample_cmd_t cap[SM_N];                  // freq_steps relative to the carrier
+static uint32_t     block_ct;
+static int16_t      re[SM_N], im[SM_N];
+static uint32_t     pass;
+static float        psd[SM_N];
+static uint32_t     n_psd;
+
+// Bookkeeping
+static float    oob_db;
+static uint32_t n_spectra, n_decisions, n_trips, n_forced_bp, step_max_us;
+static float    backoff_db;
+
+static inline int16_t q15_sin(uint32_t i) { return sin_q15[i & (SM_SIN_N - 1u)]; }
+static inline int16_t q15_cos(uint32_t i) { return sin_q15[(i + SM_SIN_N / 4u) & (SM_SIN_N - 1u)]; }
+
+static void build_tables(void) {
+    for (uint32_t i = 0; i < SM_SIN_N; i++)
+        sin_q15[i] = (int16_t)lrintf(dsp_sin_lut[i * (SIN_LUT_SIZE / SM_SIN_N)] * 32767.0f);
+    for (uint32_t n = 0; n < SM_N; n++) {
+        win_q15[n] = (int16_t)((32767 - q15_cos(n * SM_TW_STEP)) / 2);
+        uint32_t r = 0;
+        for (uint32_t b = 0; b < SM_LOG2; b++) r |= ((n >> b) & 1u) << (SM_LOG2 - 1u - b);
+        bitrev[n] = (uint16_t)r;
+    }
+    for (int p = PWR_MIN_DBM; p <= PWR_MAX_DBM; p++)
+        amp_q15[p - PWR_MIN_DBM] = (int16_t)lrintf(32767.0f * powf(10.0f, (float)(p - PWR_MAX_DBM) / 20.0f));
+    q32_per_q8 = (uint32_t)lrintf(PLL_STEP_HZ / (float)WAV_SAMPLE_RATE / (float)FREQ_FRAC_ONE * 4294967296.0f);
+    tables_ready = true;
+}
+
+void specmask_capture(const sample_cmd_t *blk, int32_t base_steps, uint8_t mode) {
+    if (mode != TXM_USB || state != SM_IDLE) return;
+    uint32_t on = 0;
+    for (uint32_t i = 0; i < SM_N; i++) on += blk[i].tx_on;
+    if (on < SM_MIN_ON || ++block_ct % SM_DECIM) return;
+
+    memcpy(cap, blk, sizeof(cap));
+    for (uint32_t i = 0; i < SM_N; i++) cap[i].freq_steps -= base_steps;
+    state = SM_SYNTH;
+}
+
+// Envelope the commands key, windowed, into bit-reversed order
+static void synth(void) {
+    uint32_t ph = 0;
+    for (uint32_t n = 0; n < SM_N; n++) {
+        const sample_cmd_t *c = &cap[n];
+        int32_t a = 0;
+        if (c->tx_on) {
+            int32_t p = c->p_dbm;
+            if (p < PWR_MIN_DBM) p = PWR_MIN_DBM;
+            if (p > PWR_MAX_DBM) p = PWR_MAX_DBM;
+            a = ((int32_t)amp_q15[p - PWR_MIN_DBM] * win_q15[n]) >> 15;
+        }
+        const uint32_t k = ph >> (32u - SM_SIN_LOG2);
+        re[bitrev[n]] = (int16_t)((a * q15_cos(k)) >> 15);
+        im[bitrev[n]] = (int16_t)((a * q15_sin(k)) >> 15);
+        ph += (uint32_t)sample_cmd_q8(c, 0) * q32_per_q8;     // Core1's dither averages out here
+    }
+    pass = 0;
+}
+
+// One radix-2 pass, halved so the Q15 values cannot overflow
+static void fft_pass(uint32_t s) {
+    const uint32_t half = 1u << s;
+    const uint32_t tw = (SM_N >> (s + 1u)) * SM_TW_STEP;
+    for (uint32_t j = 0; j < half; j++) {
+        const int32_t wr = q15_cos(j * tw);
+        const int32_t wi = -(int32_t)q15_sin(j * tw);     // e^(-i 2 pi j / 2 half)
+        for (uint32_t k = j; k < SM_N; k += 2u * half) {
+            const uint32_t m = k + half;
+            const int32_t tr = (re[m] * wr - im[m] * wi) >> 15;
+            const int32_t ti = (re[m] * wi + im[m] * wr) >> 15;
+            const int32_t ar = re[k], ai = im[k];
+            re[k] = (int16_t)((ar + tr) >> 1);
+            im[k] = (int16_t)((ai + ti) >> 1);
+            re[m] = (int16_t)((ar - tr) >> 1);
+            im[m] = (int16_t)((ai - ti) >> 1);
+        }
+    }
+}
+
+static const char *act(void) {
+    audio_cfg_t c;
+    cfg_snapshot(&c);
+    if (!c.enable_bandpass) {
+        c.enable_bandpass = 1;
+        n_forced_bp++;
+        cfg_commit(&c);
+        return "bp";
+    }
+    if (backoff_db + SM_STEP_DB <= SM_MAX_BACKOFF_DB) {
+        c.amp_gain *= powf(10.0f, -SM_STEP_DB / 20.0f);
+        backoff_db += SM_STEP_DB;
+        cfg_commit(&c);
+        // The RF ALC would raise its gain into the room this leaves
+        alc_stats_t a;
+        alc_stats(&a);
+        if (a.gain_db < a.ceiling_db) alc_set_ceiling(a.gain_db);
+        return "gain";
+    }
+    return "max";
+}
+
+static void decide(void) {
+    const float bin_hz = (float)WAV_SAMPLE_RATE / (float)SM_N;
+    float total = 0.0f, in = 0.0f;
+    for (uint32_t k = 0; k < SM_N; k++) {
+        const float f = (float)(k < SM_N / 2u ? (int32_t)k : (int32_t)k - (int32_t)SM_N) * bin_hz;
+        total += psd[k];
+        if (f >= lo_hz && f <= hi_hz) in += psd[k];
+    }
+    memset(psd, 0, sizeof(psd));
+    n_psd = 0;
+    if (total <= 0.0f) return;
+
+    oob_db = 10.0f * log10f(fmaxf(total - in, total * 1e-9f) / total);
+    n_decisions++;
+    if (oob_db <= lim_db) return;
+
+    n_trips++;
+    specmask_print(sm_on ? act() : "over");
+}
+
+void specmask_poll(void) {
+    if (state == SM_IDLE) return;
+    const uint64_t t0 = plat_us();
+    if (!tables_ready) build_tables();
+
+    switch (state) {
+    case SM_SYNTH:
+        synth();
+        state = SM_FFT;
+        break;
+    case SM_FFT:
+        for (uint32_t k = 0; k < SM_PASSES_PER_POLL && pass < SM_LOG2; k++) fft_pass(pass++);
+        if (pass == SM_LOG2) state = SM_ACCUM;
+        break;
+    case SM_ACCUM:
+        for (uint32_t k = 0; k < SM_N; k++)
+            psd[k] += (float)((int32_t)re[k] * re[k] + (int32_t)im[k] * im[k]);
+        n_spectra++;
+        if (++n_psd >= SM_AVG) decide();
+        state = SM_IDLE;
+        break;
+    default:
+        state = SM_IDLE;
+        break;
+    }
+
+    const uint32_t dt = (uint32_t)(plat_us() - t0);
+    if (dt > step_max_us) step_max_us = dt;
+}
+
+void specmask_enable(bool on) {
+    sm_on = on;
+    specmask_print(on ? "on" : "off");
+}
+
+bool specmask_enabled(void) { return sm_on; }
+
+bool specmask_set_limit(float db) {
+    if (!(db >= -60.0f && db <= 0.0f)) return false;
+    lim_db = db;
+    return true;
+}
+
+bool specmask_set_band(float lo, float hi) {
+    const float nyq = 0.5f * (float)WAV_SAMPLE_RATE;
+    if (!(lo >= -nyq && hi <= nyq && hi > lo)) return false;
+    lo_hz = lo;
+    hi_hz = hi;
+    return true;
+}
+
+void specmask_reset(void) {
+    memset(psd, 0, sizeof(psd));
+    n_psd = 0;
+    oob_db = 0.0f;
+    n_spectra = n_decisions = n_trips = n_forced_bp = step_max_us = 0;
+    backoff_db = 0.0f;
+    alc_set_ceiling(ALC_MAX_DB);
+    specmask_print("reset");
+}
+
+void specmask_stats(specmask_stats_t *out) {
+    out->on          = sm_on;
+    out->lim_db      = lim_db;
+    out->lo_hz       = lo_hz;
+    out->hi_hz       = hi_hz;
+    out->oob_db      = oob_db;
+    out->spectra     = n_spectra;
+    out->decisions   = n_decisions;
+    out->trips       = n_trips;
+    out->backoff_db  = backoff_db;
+    out->forced_bp   = n_forced_bp;
+    out->step_max_us = step_max_us;
+}
+
+void specmask_print(const char *why) {
+    audio_cfg_t c;
+    cfg_snapshot(&c);
+    alc_stats_t a;
+    alc_stats(&a);
+    cdc_printf("!E on=%u why=%s oob=%.1f lim=%.1f lo=%.0f hi=%.0f n=%lu trips=%lu bp=%u "
+               "amp_gain=%.3f backoff=%.1f alc_max=%+.1f step_us=%lu\r\n",
+               sm_on ? 1u : 0u, why, (double)oob_db, (double)lim_db, (double)lo_hz, (double)hi_hz,
+               (unsigned long)n_decisions, (unsigned long)n_trips, (unsigned)c.enable_bandpass,
+               (double)c.amp_gain, (double)backoff_db, (double)a.ceiling_db, (unsigned long)step_max_us);
+}
@@ -0,0 +1,78 @@
+// specmask.h - spectral mask guard computed from the sample commands
+//
+// Nothing upstream stops a setting (amp_gain far too high, extreme EQ,
+// bandpass off) from splattering across the narrowband transponder.
+// The producer hands every SM_DECIM-th keyed SSB block to this monitor
+// (a copy of the commands, nothing else on its path).  The rest runs
+// from core0_poll() wherever Core0 waits (a full queue, the MIC sample
+// timer), one bounded step per call:
+//
+//   synth     rebuild the complex envelope the commands key: phase from
+//             the PLL steps, amplitude from the power code and TX gate,
+//             Hann window, Q15, in bit-reversed order
+//   fft       256-point radix-2 decimation-in-time FFT in Q15, halved
+//             every pass so it cannot overflow (31.25 Hz bins)
+//   accum     |X|^2 into the running spectrum
+//
+// After SM_AVG spectra (about 1 s of speech) the share of power outside
+// [lo, hi] Hz around the carrier is compared with the mask limit.  Above
+// it, with the guard on, the bandpass is forced on if it was off, else
+// amp_gain backs off SM_STEP_DB, at most SM_MAX_BACKOFF_DB below where
+// the guard found it, and the RF ALC's ceiling comes down to its gain
+// at that moment so the ALC cannot rise back over the back-off.  Every
+// decision over the limit is an "!E" line.
+//
+// The commands run at 8 kHz, so the estimate covers +-4 kHz; power
+// further out folds back in and still counts as out of band.  USB only:
+// FM deviation spans more than the window, CW and TUNE are a carrier.
+// Portable: host/maskcheck drives it through the real chain.
+
+#ifndef SPECMASK_H
+#define SPECMASK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "txchain.h"
+
+#define SM_LOG2             8u
+#define SM_N                (1u << SM_LOG2)     // one block
+#define SM_DECIM            4u      // analyse one keyed block in 4
+#define SM_AVG              8u      // spectra per decision
+#define SM_MIN_ON           (SM_N / 2u)     // keyed samples for a block to count
+#define SM_PASSES_PER_POLL  2u      // FFT passes per specmask_poll()
+
+#define SM_LO_HZ            (-250.0f)   // default mask: in-channel band ...
+#define SM_HI_HZ            3250.0f
+#define SM_LIM_DB           (-14.0f)    // ... and the most power allowed outside, dBc
+#define SM_STEP_DB          1.0f        // amp_gain back-off per decision
+#define SM_MAX_BACKOFF_DB   12.0f
+
+typedef struct {
+    bool     on;            // act on a trip (off: measure and report only)
+    float    lim_db;
+    float    lo_hz, hi_hz;
+    float    oob_db;        // last decision: power outside [lo, hi], dBc
+    uint32_t spectra;       // analysed since reset
+    uint32_t decisions;
+    uint32_t trips;         // decisions over the limit
+    float    backoff_db;    // amp_gain taken off so far
+    uint32_t forced_bp;     // times the bandpass was switched back on
+    uint32_t step_max_us;   // longest specmask_poll()
+} specmask_stats_t;
+
+// Producer, after each block: keep a copy of this one if it is due
+void specmask_capture(const sample_cmd_t *blk, int32_t base_steps, uint8_t mode);
+
+// Core0, core0_poll(): one step (synth, SM_PASSES_PER_POLL FFT passes or accum)
+void specmask_poll(void);
+
+void specmask_enable(bool on);
+bool specmask_enabled(void);
+bool specmask_set_limit(float db);              // -60..0 dBc
+bool specmask_set_band(float lo_hz, float hi_hz);
+void specmask_reset(void);                      // spectra, bookkeeping, ALC ceiling
+void specmask_stats(specmask_stats_t *out);
+void specmask_print(const char *why);           // "!E why=..."
+
+#endif // SPECMASK_H
@@ -0,0 +1,191 @@
+// spscring.h - lock-free single-producer / single-consumer ring
+//
+// One writer (an ISR, the USB worker, a core) and one reader, each the
+// only one to move its own index.  Indices run free and wrap at 2^32, so
+// the fill is w - r and every slot is usable; the capacity is a power of
+// two and an index maps to slot index & (cap - 1).
+//
+// SPSC_DEFINE(name, T, cap) declares name_t (indices + T buf[cap]) and
+// its functions; a zeroed name_t (a static) is an empty ring.  Both
+// sides work on contiguous spans of buf:
+//
+//   producer   n = name_reserve(rb, want, &p)   room for n at p[0..n)
+//              ... write ...
+//              name_commit(rb, n)               publish them
+//   consumer   n = name_peek(rb, want, &p)      n queued at p[0..n)
+//              ... read ...
+//              name_release(rb, n)              hand the slots back
+//
+// A span stops at the end of buf; call again for the part after the
+// wrap.  name_write() / name_read() copy in and out that way,
+// name_push() / name_pop() move one element.
+//
+// Ordering between the RP2350 cores (and ISRs): each side reads the
+// other's index, then plat_dmb(), then touches the slots; and touches
+// the slots, then plat_dmb(), then moves its own index.  The consumer
+// keeps the last producer index it saw and only reloads it when that
+// runs out, so a per-element pop is one shared load per batch.
+//
+// Stats: hw is the highest fill seen at commit, drops the elements the
+// producer could not place (push / write into a full ring).  Both are
+// written by the producer; name_clear_stats() from elsewhere may lose
+// a concurrent update, which is fine for diagnostics.
+//
+// Header only: everything is static inline so cap folds into the masks.
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "platform.h"
+
+typedef struct {
+    volatile uint32_t w;        // producer: elements ever committed
+    volatile uint32_t r;        // consumer: elements ever released
+    uint32_t r_seen;            // producer's copy of r at reserve
+    uint32_t w_seen;            // consumer's copy of w
+    volatile uint32_t hw;       // highest fill at commit
+    volatile uint32_t drops;    // elements lost to a full ring
+} spsc_t;
+
+// ---- Index core (cap is a compile-time power of two in SPSC_DEFINE) ----
+
+static inline void spsc_init(spsc_t *q) {
+    q->w = q->r = 0;
+    q->r_seen = q->w_seen = 0;
+    q->hw = q->drops = 0;
+}
+
+static inline uint32_t spsc_fill(const spsc_t *q) { return q->w - q->r; }
+
+// Producer: contiguous free span at slot *at, at most want
+static inline uint32_t spsc_reserve(spsc_t *q, uint32_t cap, uint32_t want, uint32_t *at) {
+    const uint32_t w = q->w;
+    const uint32_t r = q->r;
+    plat_dmb();                             // consumer done with the slots before we write them
+    q->r_seen = r;
+    const uint32_t i = w & (cap - 1u);
+    uint32_t n = cap - (w - r);
+    if (n > cap - i) n = cap - i;
+    if (n > want) n = want;
+    *at = i;
+    return n;
+}
+
+static inline void spsc_commit(spsc_t *q, uint32_t n) {
+    if (!n) return;
+    plat_dmb();                             // slots written before the index moves
+    const uint32_t w = q->w + n;
+    q->w = w;
+    const uint32_t fill = w - q->r_seen;
+    if (fill > q->hw) q->hw = fill;
+}
+
+// Consumer: contiguous queued span at slot *at, at most want
+static inline uint32_t spsc_peek(spsc_t *q, uint32_t cap, uint32_t want, uint32_t *at) {
+    const uint32_t r = q->r;
+    uint32_t avail = q->w_seen - r;
+    if (avail < want) {
+        q->w_seen = q->w;
+        plat_dmb();                         // slots read only after the index that published them
+        avail = q->w_seen - r;
+    }
+    const uint32_t i = r & (cap - 1u);
+    uint32_t n = avail;
+    if (n > cap - i) n = cap - i;
+    if (n > want) n = want;
+    *at = i;
+    return n;
+}
+
+static inline void spsc_release(spsc_t *q, uint32_t n) {
+    if (!n) return;
+    plat_dmb();                             // slots read before the producer may reuse them
+    q->r = q->r + n;
+}
+
+// Consumer: discard everything queued so far
+static inline void spsc_flush(spsc_t *q) {
+    const uint32_t w = q->w;
+    plat_dmb();
+    q->w_seen = w;
+    q->r = w;
+}
+
+// ---- Typed ring ----
+
+#define SPSC_DEFINE(name, T, cap)                                                   \
+    _Static_assert((cap) >= 2u && ((cap) & ((cap) - 1u)) == 0u,                    \
+                   #name ": capacity must be a power of two");                     \
+    typedef struct { spsc_t q; T buf[cap]; } name##_t;                              \
+                                                                                    \
+    static inline void name##_init(name##_t *rb) { spsc_init(&rb->q); }             \
+    static inline uint32_t name##_cap(void) { return (cap); }                       \
+    static inline uint32_t name##_fill(const name##_t *rb) { return spsc_fill(&rb->q); } \
+    static inline void name##_clear_stats(name##_t *rb) { rb->q.hw = rb->q.drops = 0; } \
+                                                                                    \
+    static inline uint32_t name##_reserve(name##_t *rb, uint32_t want, T **p) {     \
+        uint32_t at;                                                                \
+        const uint32_t n = spsc_reserve(&rb->q, (cap), want, &at);                  \
+        *p = &rb->buf[at];                                                          \
+        return n;                                                                   \
+    }                                                                               \
+    static inline void name##_commit(name##_t *rb, uint32_t n) { spsc_commit(&rb->q, n); } \
+                                                                                    \
+    static inline uint32_t name##_peek(name##_t *rb, uint32_t want, T **p) {        \
+        uint32_t at;                                                                \
+        const uint32_t n = spsc_peek(&rb->q, (cap), want, &at);                     \
+        *p = &rb->buf[at];                                                          \
+        return n;                                                                   \
+    }                                                                               \
+    static inline void name##_release(name##_t *rb, uint32_t n) { spsc_release(&rb->q, n); } \
+    static inline void name##_flush(name##_t *rb) { spsc_flush(&rb->q); }           \
+                                                                                    \
+    static inline bool name##_push(name##_t *rb, T v) {                             \
+        T *p;                                                                       \
+        if (!name##_reserve(rb, 1u, &p)) { rb->q.drops++; return false; }          \
+        *p = v;                                                                     \
+        spsc_commit(&rb->q, 1u);                                                    \
+        return true;                                                                \
+    }                                                                               \
+    static inline bool name##_pop(name##_t *rb, T *out) {                           \
+        T *p;                                                                       \
+        if (!name##_peek(rb, 1u, &p)) return false;                                 \
+        *out = *p;                                                                  \
+        spsc_release(&rb->q, 1u);                                                   \
+        return true;                                                                \
+    }                                                                               \
+    /* Copy in up to n (both spans, one commit); the rest counts as drops */        \
+    static inline uint32_t name##_write(name##_t *rb, const T *src, uint32_t n) {   \
+        T *p;                                                                       \
+        uint32_t a = name##_reserve(rb, n, &p);                                     \
+        memcpy(p, src, a * sizeof(T));                                              \
+        if (a < n && a == (cap) - (rb->q.w & ((cap) - 1u))) {                       \
+            const uint32_t b = (cap) - (rb->q.w - rb->q.r_seen) - a;                \
+            const uint32_t m = b < n - a ? b : n - a;                               \
+            memcpy(rb->buf, src + a, m * sizeof(T));                                \
+            a += m;                                                                 \
+        }                                                                           \
+        spsc_commit(&rb->q, a);                                                     \
+        rb->q.drops += n - a;                                                       \
+        return a;                                                                   \
+    }                                                                               \
+    /* Copy out up to n (both spans, one release) */                                \
+    static inline uint32_t name##_read(name##_t *rb, T *dst, uint32_t n) {          \
+        T *p;                                                                       \
+        uint32_t a = name##_peek(rb, n, &p);                                        \
+        memcpy(dst, p, a * sizeof(T));                                              \
+        if (a < n && a == (cap) - (rb->q.r & ((cap) - 1u))) {                       \
+            const uint32_t b = rb->q.w_seen - rb->q.r - a;                          \
+            const uint32_t m = b < n - a ? b : n - a;                               \
+            memcpy(dst + a, rb->buf, m * sizeof(T));                                \
+            a += m;                                                                 \
+        }                                                                           \
+        spsc_release(&rb->q, a);                                                    \
+        return a;                                                                   \
+    }
+
+#endif // SPSCRING_H
@@ -0,0 +1,811 @@
+#!/usr/bin/env python3
+"""
+SX1280 network bridge
+=====================
+Owns the transmitter's CDC port and shares it with any number of clients:
+
+  TCP        the CDC line protocol as-is, so scripts and gui.py work
+             unchanged (SX1280_PORT=socket://host:7355 python gui.py)
+  WebSocket  one text message per line, for browser front ends
+
+Telemetry ("!" lines) fans out to every client that subscribed to it.
+Replies go to the client whose command caused them: commands from one
+client are pipelined, and the bridge only waits for the device to go
+quiet (or say OK / ERR) when the next command comes from someone else.
+Commands that change the station (freq, tx, set, ...) need control,
+which the first client to send one takes; everyone else is read-only
+until it is released, or taken over with "@ctl take".  If the
+controller leaves (or loses control) while the carrier is on, the
+bridge sends "tx 0" / "tune 0" itself.
+
+Bridge commands start with "@":
+  @auth <token>                              first line when --token is set
+  @sub all | none | <prefix>[,<prefix>...]   telemetry filter, e.g. !S,!L
+  @ctl [take | release]                      control status / arbitration
+  @name <name>                               label shown to other clients
+  @who                                       list the clients
+Bridge events are reported as "!B ctl=<name> clients=<n> why=<event>".
+
+Anything but a loopback --bind needs --token (or SX1280_TOKEN): a client
+then sees nothing and can send nothing until its first line is
+"@auth <token>", and is dropped on a wrong token or after AUTH_S.
+
+  python3 sxbridge.py --port /dev/ttyACM0 [--tcp 7355] [--ws 7356] [--bind ADDR --token T]
+  python3 sxbridge.py --check [--port PATH]   # self-test against host/build/sxsim
+
+Author: SP8ESA
+License: CC BY-NC 4.0
+"""
+
+import argparse
+import asyncio
+import base64
+import hashlib
+import hmac
+import ipaddress
+import os
+import select
+import socket
+import statistics
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+from collections import deque
+from typing import Deque, Optional, Set, Tuple
+
+try:
+    import termios
+    import tty
+    HAS_TERMIOS = True
+except ImportError:
+    HAS_TERMIOS = False
+
+try:
+    import serial
+    HAS_SERIAL = True
+except ImportError:
+    serial = None
+    HAS_SERIAL = False
+
+TCP_PORT = 7355
+WS_PORT = 7356
+QUIET_S = 0.03          # reply finished: this long without a line
+REPLY_MAX_S = 1.0       # give up on a reply
+AUTH_S = 10.0           # a client has this long to send @auth
+CLIENT_BUF_MAX = 1 << 20    # a client this far behind is dropped
+LINE_MAX = 384          # CDC_LINE_MAX in control.h
+
+# First words that only read state; anything else needs control.  The
+# second set is read-only without arguments ("gov" vs "gov 2").
+READ_ONLY = {"help", "get", "status", "diag", "boot", "irq"}
+READ_ONLY_BARE = {"disc", "gov", "alc", "rs", "msc", "testsig", "tx_at", "tsync", "lat", "pkt"}
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+
+def is_loopback(host: str) -> bool:
+    if host == "localhost":
+        return True
+    try:
+        return ipaddress.ip_address(host).is_loopback
+    except ValueError:
+        return False            # a host name: could resolve anywhere
+
+
+def needs_control(line: str) -> bool:
+    words = line.split()
+    if not words or words[0].startswith("#"):
+        return False
+    cmd = words[0].lower()
+    if cmd in READ_ONLY:
+        return False
+    if cmd in READ_ONLY_BARE and len(words) == 1:
+        return False
+    if cmd == "tsync" and words[1].lower() == "ping":
+        return False
+    if cmd == "pkt" and words[1].lower() == "status":
+        return False
+    return True
+
+
+# ============================================================
+# DEVICE PORT
+# ============================================================
+
+class Device:
+    """The CDC port: raw tty through the event loop on POSIX, pyserial in
+    a reader thread elsewhere.  Lines go to on_line()."""
+
+    def __init__(self, path: str, loop: asyncio.AbstractEventLoop, on_line):
+        self.path = path
+        self.loop = loop
+        self.on_line = on_line
+        self.lost = loop.create_future()        # set when the port goes away
+        self.fd: Optional[int] = None
+        self.ser = None
+        self.buf = bytearray()
+
+    def open(self):
+        if HAS_TERMIOS and not self.path.startswith(("socket://", "rfc2217://")):
+            self.fd = os.open(self.path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+            tty.setraw(self.fd)
+            attrs = termios.tcgetattr(self.fd)
+            attrs[2] |= termios.CLOCAL
+            termios.tcsetattr(self.fd, termios.TCSANOW, attrs)
+            self.loop.add_reader(self.fd, self._on_readable)
+            return
+        if not HAS_SERIAL:
+            raise RuntimeError("pyserial not installed (pip install pyserial)")
+        self.ser = serial.serial_for_url(self.path, baudrate=115200, timeout=0.1, write_timeout=0.5)
+        threading.Thread(target=self._rx_thread, daemon=True).start()
+
+    def close(self):
+        if self.fd is not None:
+            self.loop.remove_reader(self.fd)
+            os.close(self.fd)
+            self.fd = None
+        if self.ser is not None:
+            self.ser.close()
+            self.ser = None
+
+    def write_line(self, line: str):
+        data = (line + "\r\n").encode("utf-8", errors="replace")
+        if self.fd is not None:
+            while data:
+                try:
+                    n = os.write(self.fd, data)
+                except BlockingIOError:
+                    time.sleep(0.001)
+                    continue
+                data = data[n:]
+        elif self.ser is not None:
+            self.ser.write(data)
+            self.ser.flush()
+
+    def _feed(self, chunk: bytes):
+        self.buf.extend(chunk)
+        while b"\n" in self.buf:
+            line, _, rest = self.buf.partition(b"\n")
+            self.buf = bytearray(rest)
+            self.on_line(line.decode("utf-8", errors="replace").rstrip("\r"))
+
+    def _on_readable(self):
+        try:
+            chunk = os.read(self.fd, 4096)
+        except BlockingIOError:
+            return
+        except OSError as e:
+            # A pty with no peer reads EIO; a vanished ACM device too
+            self._lost(str(e))
+            return
+        if not chunk:
+            self._lost("hangup")
+            return
+        self._feed(chunk)
+
+    def _lost(self, why: str):
+        if not self.lost.done():
+            self.lost.set_result(why)
+
+    def _rx_thread(self):
+        while self.ser is not None:
+            try:
+                chunk = self.ser.read(self.ser.in_waiting or 1)
+            except Exception as e:
+                self.loop.call_soon_threadsafe(self._lost, str(e))
+                return
+            if chunk:
+                self.loop.call_soon_threadsafe(self._feed, chunk)
+
+
+# ============================================================
+# CLIENTS
+# ============================================================
+
+class Client:
+    seq = 0
+
+    def __init__(self, bridge: "Bridge", writer: asyncio.StreamWriter, kind: str):
+        Client.seq += 1
+        self.bridge = bridge
+        self.writer = writer
+        self.kind = kind
+        peer = writer.get_extra_info("peername")
+        self.name = f"{kind}{Client.seq}@{peer[0] if peer else '?'}"
+        self.subs: Optional[Tuple[str, ...]] = ()   # () = all, None = none
+        self.authed = bridge.token is None
+        self.closed = False
+        sock = writer.get_extra_info("socket")
+        if sock is not None:
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+    def wants(self, line: str) -> bool:
+        if self.subs is None:
+            return False
+        return not self.subs or line.startswith(self.subs)
+
+    def send(self, line: str):
+        if self.closed:
+            return
+        if self.writer.transport.get_write_buffer_size() > CLIENT_BUF_MAX:
+            print(f"[BRIDGE] {self.name} too slow, dropped", file=sys.stderr)
+            self.close()
+            return
+        self._write(line)
+
+    def _write(self, line: str):
+        self.writer.write((line + "\r\n").encode("utf-8", errors="replace"))
+
+    def close(self):
+        if not self.closed:
+            self.closed = True
+            self.writer.close()
+
+
+class WsClient(Client):
+    def _write(self, line: str):
+        data = line.encode("utf-8", errors="replace")
+        n = len(data)
+        if n < 126:
+            head = struct.pack("!BB", 0x81, n)
+        elif n < 65536:
+            head = struct.pack("!BBH", 0x81, 126, n)
+        else:
+            head = struct.pack("!BBQ", 0x81, 127, n)
+        self.writer.write(head + data)
+
+
+# ============================================================
+# BRIDGE
+# ============================================================
+
+class Bridge:
+    def __init__(self, loop: asyncio.AbstractEventLoop, port: str, token: Optional[str] = None):
+        self.loop = loop
+        self.token = token
+        self.dev = Device(port, loop, self._on_device_line)
+        self.clients: Set[Client] = set()
+        self.ctl: Optional[Client] = None
+        self.queue: Deque[Tuple[Optional[Client], str]] = deque()
+        self.owner: Optional[Client] = None     # replies go here
+        self.busy = False                       # reply to owner in progress
+        self.pending = 0                        # owner's commands without OK / ERR yet
+        self.t_last = 0.0
+        self.t_sent = 0.0
+        self.keyed = False                      # carrier on, from "!S"
+        self.tuned = False
+        self.timer: Optional[asyncio.TimerHandle] = None
+
+    # ---- events ----
+    def _event(self, why: str):
+        line = f"!B ctl={self.ctl.name if self.ctl else '-'} clients={len(self.clients)} why={why}"
+        for c in list(self.clients):
+            if c.wants(line):
+                c.send(line)
+
+    def accept(self, c: Client):
+        # With a token, a client only joins once it has sent it
+        if c.authed:
+            self.add(c)
+        else:
+            self.loop.call_later(AUTH_S, lambda: c.authed or c.close())
+
+    def add(self, c: Client):
+        self.clients.add(c)
+        self._event(f"join:{c.name}")
+
+    def _auth(self, c: Client, line: str):
+        words = line.split()
+        if (len(words) == 2 and words[0] == "@auth" and
+                hmac.compare_digest(words[1].encode(), self.token.encode())):
+            c.authed = True
+            c.send("OK bridge auth")
+            self.add(c)
+            return
+        print(f"[BRIDGE] {c.name} refused: bad or missing @auth", file=sys.stderr)
+        c.send("ERR: bridge: @auth <token> required")
+        c.close()
+
+    def remove(self, c: Client):
+        if c not in self.clients:
+            c.close()
+            return
+        self.clients.discard(c)
+        self.queue = deque(q for q in self.queue if q[0] is not c)
+        if self.owner is c:
+            self.owner = None
+        if self.ctl is c:
+            self._drop_control("left")
+        else:
+            self._event(f"leave:{c.name}")
+        c.close()
+
+    def _drop_control(self, why: str):
+        # Nobody is left to unkey a carrier the old controller keyed
+        if self.keyed:
+            self.queue.append((None, "tx 0"))
+        if self.tuned:
+            self.queue.append((None, "tune 0"))
+        self.ctl = None
+        self._event(why)
+        self._dispatch()
+
+    # ---- lines from clients ----
+    def client_line(self, c: Client, line: str):
+        line = line.strip()
+        if not line:
+            return
+        if not c.authed:
+            self._auth(c, line)
+            return
+        if len(line) >= LINE_MAX:
+            c.send(f"ERR: bridge: line longer than {LINE_MAX - 1}")
+            return
+        if line.startswith("@"):
+            self._meta(c, line[1:].split())
+            return
+        if needs_control(line):
+            if self.ctl is None:
+                self.ctl = c
+                self._event("take")
+            elif self.ctl is not c:
+                c.send(f"ERR: bridge: control held by {self.ctl.name} (@ctl take)")
+                return
+        self.queue.append((c, line))
+        self._dispatch()
+
+    def _meta(self, c: Client, words):
+        cmd = words[0].lower() if words else ""
+        arg = words[1] if len(words) > 1 else ""
+        if cmd == "sub":
+            if arg == "all" or not arg:
+                c.subs = ()
+            elif arg == "none":
+                c.subs = None
+            else:
+                c.subs = tuple(p for p in arg.split(",") if p)
+            c.send(f"OK bridge sub={arg or 'all'}")
+        elif cmd == "ctl":
+            if arg == "take":
+                if self.ctl is not c:
+                    old = self.ctl
+                    if old is not None:
+                        self._drop_control(f"taken:{old.name}")
+                    self.ctl = c
+                    self._event("take")
+            elif arg == "release":
+                if self.ctl is c:
+                    self._drop_control("release")
+            elif arg:
+                c.send("ERR: bridge: @ctl [take|release]")
+                return
+            c.send(f"OK bridge ctl={self.ctl.name if self.ctl else '-'} you={c.name}")
+        elif cmd == "name" and arg:
+            old = c.name
+            c.name = arg[:24]
+            c.send(f"OK bridge name={c.name}")
+            self._event(f"rename:{old}")
+        elif cmd == "auth":
+            c.send("OK bridge auth")
+        elif cmd == "who":
+            for o in sorted(self.clients, key=lambda o: o.name):
+                tag = " ctl" if o is self.ctl else ""
+                c.send(f"OK bridge client={o.name} kind={o.kind}{tag}")
+        else:
+            c.send("ERR: bridge: @sub | @ctl | @name | @who")
+
+    # ---- device side ----
+    def _dispatch(self):
+        # Same owner: pipeline.  Different owner: wait for the reply to end.
+        while self.queue:
+            c, line = self.queue[0]
+            if self.busy and c is not self.owner:
+                return
+            self.queue.popleft()
+            if c is not self.owner:
+                self.pending = 0
+            self.owner = c
+            self.busy = True
+            self.pending += 1
+            self.t_sent = self.t_last = time.monotonic()
+            self.dev.write_line(line)
+        self._arm()
+
+    def _arm(self):
+        if self.timer is not None:
+            self.timer.cancel()
+            self.timer = None
+        if self.busy:
+            self.timer = self.loop.call_later(QUIET_S, self._quiet)
+
+    def _quiet(self):
+        self.timer = None
+        now = time.monotonic()
+        if now - self.t_last >= QUIET_S or now - self.t_sent >= REPLY_MAX_S:
+            self._reply_done()
+        else:
+            self._arm()
+
+    def _reply_done(self):
+        self.busy = False
+        self.pending = 0
+        self._dispatch()
+
+    def _on_device_line(self, line: str):
+        if line.startswith("!S "):
+            kv = dict(p.split("=", 1) for p in line.split()[1:] if "=" in p)
+            self.keyed = kv.get("tx") == "1"
+            self.tuned = kv.get("tune") == "1"
+        if line.startswith("!"):
+            for c in list(self.clients):
+                if c.wants(line) or (self.busy and c is self.owner):
+                    c.send(line)
+            return
+        if self.busy:
+            self.t_last = time.monotonic()
+            if self.owner is not None:
+                self.owner.send(line)
+            # Commands without an OK / ERR (help, get) end on the quiet timer
+            if line.startswith(("OK", "ERR")):
+                self.pending -= 1
+                if self.pending <= 0:
+                    self._reply_done()
+            return
+        # Unsolicited text (greeting, config dump after a reconnect)
+        for c in list(self.clients):
+            c.send(line)
+
+    # ---- servers ----
+    async def serve_tcp(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter):
+        c = Client(self, writer, "tcp")
+        self.accept(c)
+        try:
+            while not c.closed:
+                raw = await reader.readline()
+                if not raw:
+                    break
+                self.client_line(c, raw.decode("utf-8", errors="replace"))
+        except (ConnectionError, asyncio.LimitOverrunError, ValueError):
+            pass
+        finally:
+            self.remove(c)
+
+    async def serve_ws(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter):
+        try:
+            head = await reader.readuntil(b"\r\n\r\n")
+        except (asyncio.IncompleteReadError, asyncio.LimitOverrunError, ConnectionError):
+            writer.close()
+            return
+        hdr = {}
+        for ln in head.decode("latin-1").split("\r\n")[1:]:
+            if ":" in ln:
+                k, v = ln.split(":", 1)
+                hdr[k.strip().lower()] = v.strip()
+        key = hdr.get("sec-websocket-key")
+        if not key or "websocket" not in hdr.get("upgrade", "").lower():
+            writer.write(b"HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n")
+            writer.close()
+            return
+        accept = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+        writer.write(("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                      f"Connection: Upgrade\r\nSec-WebSocket-Accept: {accept}\r\n\r\n").encode())
+
+        c = WsClient(self, writer, "ws")
+        self.accept(c)
+        try:
+            while not c.closed:
+                b0, b1 = await reader.readexactly(2)
+                op, n = b0 & 0x0F, b1 & 0x7F
+                if n == 126:
+                    n = struct.unpack("!H", await reader.readexactly(2))[0]
+                elif n == 127:
+                    n = struct.unpack("!Q", await reader.readexactly(8))[0]
+                if n > 65536:
+                    break
+                mask = await reader.readexactly(4) if b1 & 0x80 else b"\0\0\0\0"
+                data = bytearray(await reader.readexactly(n))
+                for i in range(n):
+                    data[i] ^= mask[i & 3]
+                if op == 0x8:                   # close
+                    writer.write(b"\x88\x00")
+                    break
+                if op == 0x9:                   # ping
+                    if n < 126:
+                        writer.write(bytes([0x8A, n]) + bytes(data))
+                    continue
+                if op in (0x1, 0x2, 0x0):
+                    for ln in data.decode("utf-8", errors="replace").splitlines():
+                        self.client_line(c, ln)
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            self.remove(c)
+
+
+async def run_bridge(port: str, bind: str, tcp_port: int, ws_port: int,
+                     ready: Optional[asyncio.Future] = None, token: Optional[str] = None):
+    loop = asyncio.get_running_loop()
+    bridge = Bridge(loop, port, token)
+    bridge.dev.open()
+    servers = [await asyncio.start_server(bridge.serve_tcp, bind, tcp_port, limit=LINE_MAX * 4)]
+    if ws_port >= 0:
+        servers.append(await asyncio.start_server(bridge.serve_ws, bind, ws_port))
+    ports = [s.sockets[0].getsockname()[1] for s in servers]
+    print(f"[BRIDGE] {port}: tcp {bind}:{ports[0]}" + (f", ws {bind}:{ports[1]}" if len(ports) > 1 else "") +
+          (", token required" if token else ""), file=sys.stderr)
+    if ready is not None:
+        ready.set_result((bridge, ports))
+    try:
+        serving = [asyncio.ensure_future(s.serve_forever()) for s in servers]
+        await asyncio.wait([bridge.dev.lost, *serving], return_when=asyncio.FIRST_COMPLETED)
+        for t in serving:
+            t.cancel()
+        if bridge.dev.lost.done():
+            print(f"[BRIDGE] device lost: {bridge.dev.lost.result()}", file=sys.stderr)
+            return False
+        return True
+    finally:
+        for c in list(bridge.clients):
+            c.close()
+        bridge.dev.close()
+
+
+# ============================================================
+# SELF-TEST (against host/build/sxsim)
+# ============================================================
+
+class TestClient:
+    def __init__(self, reader, writer, ws=False):
+        self.r, self.w, self.ws = reader, writer, ws
+        self.lines: Deque[str] = deque()
+
+    @classmethod
+    async def tcp(cls, port):
+        return cls(*await asyncio.open_connection("127.0.0.1", port))
+
+    @classmethod
+    async def websocket(cls, port):
+        r, w = await asyncio.open_connection("127.0.0.1", port)
+        key = base64.b64encode(os.urandom(16)).decode()
+        w.write((f"GET / HTTP/1.1\r\nHost: x\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                 f"Sec-WebSocket-Key: {key}\r\nSec-WebSocket-Version: 13\r\n\r\n").encode())
+        head = await r.readuntil(b"\r\n\r\n")
+        want = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+        assert b"101" in head.split(b"\r\n")[0] and want.encode() in head, "websocket handshake"
+        return cls(r, w, ws=True)
+
+    def send(self, line: str):
+        if not self.ws:
+            self.w.write((line + "\r\n").encode())
+            return
+        data = line.encode()
+        mask = os.urandom(4)
+        self.w.write(struct.pack("!BB", 0x81, 0x80 | len(data)) + mask +
+                     bytes(b ^ mask[i & 3] for i, b in enumerate(data)))
+
+    async def line(self, timeout: float) -> Optional[str]:
+        if self.lines:
+            return self.lines.popleft()
+        try:
+            if self.ws:
+                b0, n = await asyncio.wait_for(self.r.readexactly(2), timeout)
+                if n == 126:
+                    n = struct.unpack("!H", await self.r.readexactly(2))[0]
+                return (await self.r.readexactly(n)).decode()
+            raw = await asyncio.wait_for(self.r.readline(), timeout)
+            return raw.decode().rstrip("\r\n") if raw else None
+        except asyncio.TimeoutError:
+            return None
+
+    async def expect(self, pred, timeout: float = 1.0) -> Optional[str]:
+        end = time.monotonic() + timeout
+        while True:
+            left = end - time.monotonic()
+            if left <= 0:
+                return None
+            ln = await self.line(left)
+            if ln is None:
+                return None
+            if pred(ln):
+                return ln
+
+    async def drain(self, quiet: float = 0.2):
+        while await self.line(quiet) is not None:
+            pass
+
+    def close(self):
+        self.w.close()
+
+
+def direct_rtt(path: str, n: int):
+    """Command round trips straight on the port, before the bridge opens it."""
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    buf = b""
+
+    def read_until_ok(timeout: float) -> bool:
+        nonlocal buf
+        end = time.monotonic() + timeout
+        while time.monotonic() < end:
+            while b"\n" in buf:
+                ln, _, buf = buf.partition(b"\n")
+                if ln.startswith((b"OK", b"ERR")):
+                    return True
+            if select.select([fd], [], [], 0.05)[0]:
+                buf += os.read(fd, 4096)
+        return False
+
+    read_until_ok(0.3)      # greeting and config dump
+    buf = b""
+    rtt = []
+    for i in range(n):
+        t0 = time.perf_counter()
+        os.write(fd, f"ppm {0.1 * (i & 1):.1f}\r\n".encode())
+        if read_until_ok(1.0):
+            rtt.append(time.perf_counter() - t0)
+    os.close(fd)
+    return rtt
+
+
+async def self_test(port: str, n: int) -> int:
+    fails = []
+
+    def check(ok, what):
+        print(f"  {'ok  ' if ok else 'FAIL'} {what}")
+        if not ok:
+            fails.append(what)
+
+    direct = direct_rtt(port, n)
+
+    loop = asyncio.get_running_loop()
+    ready = loop.create_future()
+    task = asyncio.ensure_future(run_bridge(port, "127.0.0.1", 0, 0, ready))
+    bridge, (tcp_port, ws_port) = await ready
+
+    a = await TestClient.tcp(tcp_port)
+    b = await TestClient.tcp(tcp_port)
+    w = await TestClient.websocket(ws_port)
+    for c in (a, b, w):
+        await c.drain()
+
+    # Telemetry fans out to everyone
+    a.send("status")
+    got = [await c.expect(lambda l: l.startswith("!S ")) for c in (a, b, w)]
+    check(all(got), "!S status push reaches both TCP clients and the WebSocket client")
+
+    # Replies go to the sender only
+    b.send("get")
+    check(await b.expect(lambda l: not l.startswith("!")) is not None, "read-only 'get' from a viewer is answered")
+    check(await a.expect(lambda l: not l.startswith("!"), 0.3) is None, "the reply is not copied to other clients")
+
+    # Control: first writer takes it, others are refused
+    a.send("freq 2400200000")
+    check(await a.expect(lambda l: l.startswith("OK")) is not None, "first control command takes control")
+    b.send("txpwr 5")
+    check(await b.expect(lambda l: l.startswith("ERR: bridge: control held")) is not None,
+          "control command from a viewer is refused")
+
+    # Subscriptions
+    b.send("@sub !L")
+    await b.expect(lambda l: l.startswith("OK bridge sub"))
+    a.send("status")
+    check(await b.expect(lambda l: l.startswith("!S "), 0.3) is None, "@sub filters telemetry")
+
+    # The controller leaves with the carrier keyed: the bridge unkeys
+    a.send("tx 1")
+    check(await w.expect(lambda l: l.startswith("!S ") and " tx=1 " in l) is not None, "tx 1 reported to all")
+    a.close()
+    check(await w.expect(lambda l: l.startswith("!S ") and " tx=0 " in l) is not None,
+          "controller left keyed: bridge sent tx 0")
+    await w.drain()
+
+    # Takeover from the WebSocket client
+    w.send("@ctl take")
+    check(await w.expect(lambda l: l.startswith("OK bridge ctl=ws")) is not None, "@ctl take")
+    w.send("ppm 0")
+    check(await w.expect(lambda l: l.startswith("OK")) is not None, "new controller's command accepted")
+
+    # Added latency: command round trips through the bridge vs direct
+    await b.drain()
+    b.send("@ctl take")
+    await b.expect(lambda l: l.startswith("OK bridge ctl="))
+    await w.drain()
+    await b.drain()
+    bridged = []
+    for i in range(n):
+        t0 = time.perf_counter()
+        b.send(f"ppm {0.1 * (i & 1):.1f}")
+        if await b.expect(lambda l: l.startswith(("OK", "ERR"))) is not None:
+            bridged.append(time.perf_counter() - t0)
+    if direct and bridged:
+        d50, b50 = statistics.median(direct) * 1e3, statistics.median(bridged) * 1e3
+        print(f"  rtt ms: direct p50 {d50:.2f}  bridge p50 {b50:.2f}  added {b50 - d50:.2f}"
+              f"  bridge max {max(bridged) * 1e3:.2f}")
+        check(b50 - d50 < 5.0, "bridge adds < 5 ms to a command round trip")
+    else:
+        check(False, "round trips measured")
+
+    # With a token: nothing in or out before @auth, a wrong one is dropped
+    for c in (b, w):
+        c.close()
+    bridge.token = "s3cret"
+    await asyncio.sleep(0.1)
+    n0 = len(bridge.clients)
+
+    async def dropped(c: TestClient) -> bool:
+        try:
+            return await asyncio.wait_for(c.r.read(), 1.0) == b""
+        except asyncio.TimeoutError:
+            return False
+    x = await TestClient.tcp(tcp_port)
+    x.send("tx 1")
+    check(await x.expect(lambda l: l.startswith("ERR: bridge: @auth")) is not None and await dropped(x), "token set: a command before @auth is refused and the client dropped")
+    y = await TestClient.tcp(tcp_port)
+    y.send("@auth wrong")
+    check(await y.expect(lambda l: l.startswith("ERR: bridge: @auth")) is not None and await dropped(y), "wrong token dropped")
+    z = await TestClient.websocket(ws_port)
+    z.send("@auth s3cret")
+    check(await z.expect(lambda l: l.startswith("OK bridge auth")) is not None, "right token accepted")
+    z.send("status")
+    check(await z.expect(lambda l: l.startswith("!S ")) is not None, "authenticated client gets telemetry")
+    check(len(bridge.clients) == n0 + 1, "only the authenticated client joined")
+    z.close()
+
+    task.cancel()
+    try:
+        await task
+    except asyncio.CancelledError:
+        pass
+    print("FAIL" if fails else "PASS")
+    return 1 if fails else 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description="SX1280 network bridge (TCP / WebSocket)")
+    ap.add_argument("--port", default=os.environ.get("SX1280_PORT"), help="CDC port (or SX1280_PORT)")
+    ap.add_argument("--bind", default="127.0.0.1", help="listen address (0.0.0.0 for remote clients)")
+    ap.add_argument("--token", default=os.environ.get("SX1280_TOKEN"),
+                    help="shared secret clients send as '@auth <token>' (or SX1280_TOKEN); "
+                         "required unless --bind is loopback")
+    ap.add_argument("--tcp", type=int, default=TCP_PORT, help="TCP line port")
+    ap.add_argument("--ws", type=int, default=WS_PORT, help="WebSocket port (-1 = off)")
+    ap.add_argument("--check", action="store_true", help="self-test; starts host/build/sxsim without --port")
+    ap.add_argument("--count", type=int, default=200, help="round trips timed by --check")
+    args = ap.parse_args()
+
+    if args.check:
+        if not HAS_TERMIOS:
+            sys.exit("--check needs a POSIX host")
+        sim = None
+        port = args.port
+        if not port:
+            exe = os.path.join(os.path.dirname(os.path.abspath(__file__)), "host", "build", "sxsim")
+            port = os.path.join(tempfile.mkdtemp(prefix="sxbridge"), "sx1280")
+            sim = subprocess.Popen([exe, "--link", port], stderr=subprocess.DEVNULL)
+            for _ in range(50):
+                if os.path.exists(port):
+                    break
+                time.sleep(0.05)
+        try:
+            rc = asyncio.run(self_test(port, args.count))
+        finally:
+            if sim:
+                sim.terminate()
+                sim.wait()
+        sys.exit(rc)
+
+    if not args.port:
+        ap.error("--port (or SX1280_PORT) is required")
+    if not is_loopback(args.bind) and not args.token:
+        ap.error(f"--bind {args.bind} is reachable from the network: set --token (or SX1280_TOKEN)")
+    try:
+        if not asyncio.run(run_bridge(args.port, args.bind, args.tcp, args.ws, token=args.token)):
+            sys.exit(1)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,376 @@
+#!/usr/bin/env python3
+"""
+SX1280 local DSP preview
+========================
+Runs audio through the firmware's own TX chain on the PC, so EQ,
+compressor, bandpass and power settings can be heard before anything is
+transmitted.  The chain is host/build/libsxdsp (host/sxdsp.c), built from
+the same C sources as the firmware; the samples it would key are received
+again the way the downlink would sound (SSB receive filter, or FM
+discriminator), including PLL steps, the power floor and clipping.
+
+Settings are the CDC lines the GUI sends ("set comp_thr -10",
+"enable eq 0", "mode fm", "txpwr 10", "src mic"); the GUI mirrors every
+command it sends into its preview chain.
+
+  python3 sxdsp.py voice.wav [-o out.wav] [--play] [-c "set comp_thr -10"]...
+  python3 sxdsp.py --bench [--seconds S]     # times real time, through ctypes
+  python3 sxdsp.py --check                   # self-test
+
+Build the library first: cmake -S host -B host/build && cmake --build host/build
+(SXDSP_LIB=/path/to/libsxdsp.so overrides the search.)  Live microphone
+monitoring needs the optional sounddevice module; everything else is the
+standard library.
+
+Author: SP8ESA
+License: CC BY-NC 4.0
+"""
+
+import argparse
+import ctypes
+import math
+import os
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import wave
+from array import array
+from typing import Optional
+
+RATE = 8000
+BLOCK = 256     # firmware block: the preview is one block behind
+
+try:
+    import sounddevice
+    HAS_SOUNDDEVICE = True
+except ImportError:
+    sounddevice = None
+    HAS_SOUNDDEVICE = False
+
+
+class _Stats(ctypes.Structure):
+    _fields_ = [
+        ("samples", ctypes.c_uint32),
+        ("on", ctypes.c_uint32),
+        ("voiced", ctypes.c_uint32),
+        ("clipped", ctypes.c_uint32),
+        ("at_min", ctypes.c_uint32),
+        ("mean_dbm", ctypes.c_float),
+        ("peak", ctypes.c_float),
+        ("ns", ctypes.c_uint64),
+    ]
+
+
+def _lib_path() -> str:
+    env = os.environ.get("SXDSP_LIB")
+    if env:
+        return env
+    here = os.path.dirname(os.path.abspath(__file__))
+    for name in ("libsxdsp.so", "libsxdsp.dylib", "sxdsp.dll", "libsxdsp.dll"):
+        p = os.path.join(here, "host", "build", name)
+        if os.path.exists(p):
+            return p
+    raise OSError("libsxdsp not found: cmake -S host -B host/build && cmake --build host/build")
+
+
+_lib = None
+
+
+def _load():
+    global _lib
+    if _lib is not None:
+        return _lib
+    lib = ctypes.CDLL(_lib_path())
+    fp = ctypes.POINTER(ctypes.c_float)
+    lib.sxdsp_new.restype = ctypes.c_void_p
+    lib.sxdsp_free.argtypes = [ctypes.c_void_p]
+    lib.sxdsp_reset.argtypes = [ctypes.c_void_p]
+    lib.sxdsp_cmd.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+    lib.sxdsp_cmd.restype = ctypes.c_int
+    lib.sxdsp_get.argtypes = [ctypes.c_void_p, ctypes.c_char_p, fp]
+    lib.sxdsp_get.restype = ctypes.c_int
+    lib.sxdsp_process.argtypes = [ctypes.c_void_p, fp, fp, ctypes.c_uint32]
+    lib.sxdsp_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(_Stats)]
+    lib.sxdsp_wav_load.argtypes = [ctypes.c_char_p, ctypes.POINTER(ctypes.c_uint32)]
+    lib.sxdsp_wav_load.restype = fp
+    lib.sxdsp_wav_free.argtypes = [fp]
+    _lib = lib
+    return lib
+
+
+def available() -> bool:
+    try:
+        _load()
+        return True
+    except OSError:
+        return False
+
+
+class Chain:
+    """One firmware TX chain instance plus the downlink receiver.
+    Thread-safe: the GUI changes settings while the audio callback runs."""
+
+    def __init__(self):
+        self._lib = _load()
+        self._lock = threading.Lock()
+        self._h = self._lib.sxdsp_new()
+        if not self._h:
+            raise MemoryError("sxdsp_new")
+
+    def close(self):
+        if self._h:
+            self._lib.sxdsp_free(self._h)
+            self._h = None
+
+    def __del__(self):
+        try:
+            self.close()
+        except Exception:
+            pass
+
+    def cmd(self, line: str) -> int:
+        """1 applied, 0 not a chain setting (ignored), -1 bad value."""
+        with self._lock:
+            return self._lib.sxdsp_cmd(self._h, line.encode())
+
+    def get(self, key: str) -> Optional[float]:
+        v = ctypes.c_float()
+        return v.value if self._lib.sxdsp_get(self._h, key.encode(), ctypes.byref(v)) else None
+
+    def reset(self):
+        with self._lock:
+            self._lib.sxdsp_reset(self._h)
+
+    def process(self, x) -> array:
+        """8 kHz samples (+-1.0) in, as many out; accepts array('f') or any sequence."""
+        a = x if isinstance(x, array) and x.typecode == "f" else array("f", x)
+        out = array("f", bytes(4 * len(a)))
+        if a:
+            fp = ctypes.POINTER(ctypes.c_float)
+            src = ctypes.cast((ctypes.c_float * len(a)).from_buffer(a), fp)
+            dst = ctypes.cast((ctypes.c_float * len(out)).from_buffer(out), fp)
+            with self._lock:
+                self._lib.sxdsp_process(self._h, src, dst, len(a))
+        return out
+
+    def stats(self) -> dict:
+        s = _Stats()
+        self._lib.sxdsp_stats(self._h, ctypes.byref(s))
+        d = {f: getattr(s, f) for f, _ in _Stats._fields_}
+        d["on_pct"] = 100.0 * s.on / s.samples if s.samples else 0.0
+        d["clip_pct"] = 100.0 * s.clipped / s.voiced if s.voiced else 0.0
+        d["floor_pct"] = 100.0 * s.at_min / s.on if s.on else 0.0
+        d["x_realtime"] = (s.samples / RATE) / (s.ns * 1e-9) if s.ns else 0.0
+        return d
+
+
+def load_wav(path: str) -> array:
+    """Any 16-bit PCM / float WAV as 8 kHz mono (resampled by the C side)."""
+    lib = _load()
+    n = ctypes.c_uint32()
+    p = lib.sxdsp_wav_load(path.encode(), ctypes.byref(n))
+    if not p:
+        raise OSError(f"{path}: cannot read WAV")
+    try:
+        return array("f", ctypes.string_at(p, 4 * n.value))
+    finally:
+        lib.sxdsp_wav_free(p)
+
+
+def write_wav(path: str, x, rate: int = RATE):
+    pcm = array("h", (max(-32768, min(32767, int(round(v * 32767.0)))) for v in x))
+    if sys.byteorder != "little":
+        pcm.byteswap()
+    with wave.open(path, "wb") as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(rate)
+        w.writeframes(pcm.tobytes())
+
+
+def play(x) -> Optional[subprocess.Popen]:
+    """Play 8 kHz samples: sounddevice if present, else the system player on a temp WAV."""
+    if HAS_SOUNDDEVICE:
+        sounddevice.play(array("f", x), RATE)
+        return None
+    fd, path = tempfile.mkstemp(suffix=".wav", prefix="sxdsp_")
+    os.close(fd)
+    write_wav(path, x)
+    if sys.platform.startswith("win"):
+        import winsound
+        winsound.PlaySound(path, winsound.SND_FILENAME | winsound.SND_ASYNC)
+        return None
+    for player in (["afplay"], ["paplay"], ["aplay", "-q"]):
+        try:
+            return subprocess.Popen(player + [path])
+        except OSError:
+            continue
+    raise OSError("no audio player found (install sounddevice, or aplay / paplay / afplay)")
+
+
+def stop_playback(proc: Optional[subprocess.Popen]):
+    if HAS_SOUNDDEVICE:
+        sounddevice.stop()
+    elif sys.platform.startswith("win"):
+        import winsound
+        winsound.PlaySound(None, 0)
+    if proc is not None and proc.poll() is None:
+        proc.terminate()
+
+
+class LiveMonitor:
+    """Microphone -> chain -> speakers in real time (needs sounddevice)."""
+
+    def __init__(self, chain: Chain):
+        if not HAS_SOUNDDEVICE:
+            raise OSError("live monitoring needs the sounddevice module")
+        self.chain = chain
+        self.stream = None
+        self.level = 0.0
+
+    def _cb(self, indata, outdata, frames, _time, _status):
+        y = self.chain.process(array("f", indata[:, 0].tobytes()))
+        outdata[:, 0] = y
+        self.level = max(abs(v) for v in y) if frames else 0.0
+
+    def start(self):
+        self.stream = sounddevice.Stream(samplerate=RATE, blocksize=BLOCK, channels=1,
+                                         dtype="float32", callback=self._cb)
+        self.stream.start()
+
+    def stop(self):
+        if self.stream is not None:
+            self.stream.stop()
+            self.stream.close()
+            self.stream = None
+
+
+# ============================================================
+# CLI: render / bench / self-test
+# ============================================================
+
+def _tone(hz: float, secs: float, amp: float) -> array:
+    return array("f", (amp * math.sin(2 * math.pi * hz * n / RATE) for n in range(int(secs * RATE))))
+
+
+def _goertzel_db(x, hz: float) -> float:
+    k = 2.0 * math.cos(2 * math.pi * hz / RATE)
+    s1 = s2 = 0.0
+    for v in x:
+        s1, s2 = v + k * s1 - s2, s1
+    p = s1 * s1 + s2 * s2 - k * s1 * s2
+    return 10.0 * math.log10(p / (len(x) ** 2) + 1e-20)
+
+
+def _run(chain: Chain, x, chunk: int = BLOCK) -> array:
+    out = array("f")
+    for i in range(0, len(x), chunk):
+        out.extend(chain.process(x[i:i + chunk]))
+    return out
+
+
+def bench(seconds: float) -> float:
+    ch = Chain()
+    x = _tone(700, 1.0, 0.3)
+    x.extend(_tone(1900, 1.0, 0.3))
+    n = 0
+    t0 = time.perf_counter()
+    while n < seconds * RATE:
+        _run(ch, x)
+        n += len(x)
+    wall = time.perf_counter() - t0
+    st = ch.stats()
+    print(f"sxdsp: {n / RATE:.0f} s of audio in {wall:.3f} s: {n / RATE / wall:.0f}x real time "
+          f"through ctypes ({st['x_realtime']:.0f}x in C), {BLOCK}-sample calls")
+    return n / RATE / wall
+
+
+def check() -> bool:
+    fails = 0
+
+    def ok(cond, what):
+        nonlocal fails
+        if not cond:
+            fails += 1
+            print(f"  FAIL: {what}")
+
+    ch = Chain()
+    ok(ch.cmd("set comp_thr -12") == 1 and abs(ch.get("comp_thr") + 12.0) < 1e-3, "set reaches the chain")
+    ok(ch.cmd("enable eq 0") == 1, "enable")
+    ok(ch.cmd("set nosuchkey 1") == 0 and ch.cmd("freq 2400100000") == 0, "other commands ignored")
+    ok(ch.cmd("set comp_thr abc") == -1 and ch.cmd("mode xyz") == -1, "bad values refused")
+
+    # USB: a tone comes back at its own frequency, one block late
+    ch.reset()
+    y = _run(ch, _tone(1000, 2.0, 0.3))
+    ok(all(v == 0.0 for v in y[:BLOCK]), "one block of latency")
+    tail = y[RATE:]
+    p1k = _goertzel_db(tail, 1000)
+    ok(p1k - max(_goertzel_db(tail, 500), _goertzel_db(tail, 2000)) > 20.0, "USB: tone at 1000 Hz")
+    st = ch.stats()
+    ok(st["on_pct"] > 90.0 and st["peak"] > 0.3, "USB: keyed, audible")
+
+    # More amp_gain -> more power on air
+    lo = Chain()
+    lo.cmd("set amp_gain 0.3")
+    _run(lo, _tone(1000, 1.0, 0.3))
+    ok(lo.stats()["mean_dbm"] < st["mean_dbm"] - 3.0, "amp_gain lowers mean power")
+
+    # FM: discriminator gives the tone back
+    fm = Chain()
+    fm.cmd("mode fm")
+    y = _run(fm, _tone(800, 1.0, 0.3))[RATE // 2:]
+    ok(_goertzel_db(y, 800) - _goertzel_db(y, 1600) > 15.0, "FM: tone at 800 Hz")
+
+    # Odd chunk sizes give the same output as block-sized ones
+    a, b = Chain(), Chain()
+    x = _tone(700, 0.5, 0.3)
+    ya, yb = _run(a, x), _run(b, x, 37)
+    ok(max(abs(p - q) for p, q in zip(ya, yb)) < 1e-6, "chunking does not change the output")
+
+    rt = bench(20.0)
+    ok(rt > 20.0, "at least 20x real time through ctypes")
+    print("PASS" if not fails else "FAIL")
+    return not fails
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Firmware TX chain preview on the PC")
+    ap.add_argument("wav", nargs="?", help="input WAV (any rate)")
+    ap.add_argument("-o", "--out", help="write the received audio here (8 kHz WAV)")
+    ap.add_argument("-c", "--cmd", action="append", default=[], help='setting, e.g. "set comp_thr -10"')
+    ap.add_argument("--play", action="store_true", help="play the result")
+    ap.add_argument("--bench", action="store_true", help="time the chain against real time")
+    ap.add_argument("--seconds", type=float, default=60.0, help="audio length for --bench")
+    ap.add_argument("--check", action="store_true", help="self-test")
+    args = ap.parse_args()
+
+    if args.check:
+        sys.exit(0 if check() else 1)
+    if args.bench:
+        bench(args.seconds)
+        return
+    if not args.wav:
+        ap.error("give a WAV file, --bench or --check")
+
+    ch = Chain()
+    for c in args.cmd:
+        if ch.cmd(c) != 1:
+            ap.error(f"not a chain setting: {c}")
+    y = ch.process(load_wav(args.wav))
+    st = ch.stats()
+    print(f"{args.wav}: {st['samples'] / RATE:.1f} s, on {st['on_pct']:.0f} %, mean {st['mean_dbm']:.1f} dBm, "
+          f"clip {st['clip_pct']:.1f} %, floor {st['floor_pct']:.1f} %, peak {st['peak']:.2f}, "
+          f"{st['x_realtime']:.0f}x real time")
+    if args.out:
+        write_wav(args.out, y)
+    if args.play:
+        p = play(y)
+        if p is not None:
+            p.wait()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,243 @@
+// testsig.c - runtime test-signal generator with a quick on-air self-check
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "testsig.h"
+#include "control.h"
+#include "platform.h"
+#include "dsp.h"
+
+#define Q32_PER_HZ      (4294967296.0f / (float)WAV_SAMPLE_RATE)
+#define P_BINS          (PWR_MAX_DBM - PWR_MIN_DBM + 1)
+
+static const char *const sig_names[] = { "off", "tone", "two", "multi", "sweep", "noise" };
+
+static uint8_t  ts_sig = TS_OFF;
+static uint8_t  ts_at = TS_AT_SRC;
+static float    ts_f1, ts_f2, ts_sweep_s, ts_amp;
+
+// NCOs: Q32 phase and step per tone (tone 0 doubles as the sweep NCO)
+static uint8_t  n_tones;
+static uint32_t nco_ph[TS_MAX_TONES];
+static uint32_t nco_step[TS_MAX_TONES];
+static float    tone_amp;
+static uint32_t sw_lo, sw_hi, sw_inc;
+static uint32_t rng = 0x9E3779B9u;
+
+// Measurement window over the producer's own commands
+static uint32_t settle_left, blocks_left;
+static uint32_t w_n, w_on;
+static uint32_t w_hist[P_BINS];
+static int64_t  w_sum, w_sumsq;     // frequency offset, Q8 PLL steps
+static int32_t  w_min, w_max;
+
+static inline uint32_t hz_step(float hz) { return (uint32_t)(hz * Q32_PER_HZ); }
+
+static bool hz_ok(float hz) { return hz >= 10.0f && hz <= 3500.0f; }
+
+bool testsig_start(uint8_t sig, float f1, float f2, float sweep_s, float amp) {
+    if (amp <= 0.0f) amp = TS_DEFAULT_AMPL;
+    if (amp > 1.0f) return false;
+
+    switch (sig) {
+        case TS_TONE:
+            if (!hz_ok(f1)) return false;
+            n_tones = 1;
+            nco_step[0] = hz_step(f1);
+            break;
+        case TS_TWO:
+            if (!hz_ok(f1) || !hz_ok(f2) || f1 == f2) return false;
+            n_tones = 2;
+            nco_step[0] = hz_step(f1);
+            nco_step[1] = hz_step(f2);
+            break;
+        case TS_MULTI: {
+            uint32_t n = (uint32_t)f1;
+            if (n < 2u || n > TS_MAX_TONES) return false;
+            n_tones = (uint8_t)n;
+            float df = (TS_MULTI_HI_HZ - TS_MULTI_LO_HZ) / (float)(n - 1u);
+            for (uint32_t k = 0; k < n; k++)
+                nco_step[k] = hz_step(TS_MULTI_LO_HZ + df * (float)k);
+            break;
+        }
+        case TS_SWEEP:
+            if (!hz_ok(f1) || !hz_ok(f2) || f2 <= f1 || sweep_s < 0.1f || sweep_s > 600.0f) return false;
+            n_tones = 1;
+            sw_lo = hz_step(f1);
+            sw_hi = hz_step(f2);
+            sw_inc = (uint32_t)((float)(sw_hi - sw_lo) / (sweep_s * (float)WAV_SAMPLE_RATE));
+            if (sw_inc == 0) sw_inc = 1;
+            nco_step[0] = sw_lo;
+            break;
+        case TS_NOISE:
+            n_tones = 0;
+            break;
+        default:
+            return false;
+    }
+
+    // Schroeder phases keep the multitone crest factor low; the sum of
+    // the tone amplitudes never exceeds amp, so nothing clips.
+    for (uint32_t k = 0; k < n_tones; k++)
+        nco_ph[k] = (n_tones > 2u) ? (uint32_t)((uint64_t)k * k * 0x80000000u / n_tones) : 0u;
+    tone_amp = n_tones ? amp / (float)n_tones : amp;
+
+    ts_f1 = f1;
+    ts_f2 = f2;
+    ts_sweep_s = sweep_s;
+    ts_amp = amp;
+
+    __compiler_memory_barrier();
+    ts_sig = sig;
+    __compiler_memory_barrier();
+
+    testsig_check(TS_CHECK_MS);
+    return true;
+}
+
+void testsig_stop(void) {
+    ts_sig = TS_OFF;
+    settle_left = blocks_left = 0;
+}
+
+void testsig_set_point(uint8_t at) {
+    ts_at = (at == TS_AT_MOD) ? TS_AT_MOD : TS_AT_SRC;
+    if (ts_sig != TS_OFF) testsig_check(TS_CHECK_MS);
+}
+
+uint8_t testsig_point(void) { return ts_at; }
+uint8_t testsig_active(void) { return ts_sig; }
+
+void testsig_check(uint32_t ms) {
+    if (ms > TS_CHECK_MAX_MS) ms = TS_CHECK_MAX_MS;
+    uint32_t blocks = (uint32_t)((uint64_t)ms * WAV_SAMPLE_RATE / (1000u * BLOCK_SAMPLES));
+    if (blocks == 0) blocks = 1;
+
+    w_n = w_on = 0;
+    memset(w_hist, 0, sizeof(w_hist));
+    w_sum = w_sumsq = 0;
+    w_min = INT32_MAX;
+    w_max = INT32_MIN;
+    settle_left = TS_SETTLE_BLOCKS;
+    blocks_left = blocks;
+}
+
+float testsig_sample(void) {
+    switch (ts_sig) {
+        case TS_NOISE:
+            rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+            return ts_amp * ((float)rng * (1.0f / 2147483648.0f) - 1.0f);
+
+        case TS_SWEEP: {
+            float v = lut_sin(nco_ph[0]);
+            nco_ph[0] += nco_step[0];
+            nco_step[0] += sw_inc;
+            if (nco_step[0] > sw_hi) nco_step[0] = sw_lo;
+            return ts_amp * v;
+        }
+
+        case TS_OFF:
+            return 0.0f;
+
+        default: {
+            float v = 0.0f;
+            for (uint32_t k = 0; k < n_tones; k++) {
+                v += lut_sin(nco_ph[k]);
+                nco_ph[k] += nco_step[k];
+            }
+            return tone_amp * v;
+        }
+    }
+}
+
+static const char *point_name(uint8_t at) { return at == TS_AT_MOD ? "mod" : "src"; }
+
+void testsig_print(void) {
+    cdc_printf("!T sig=%s f1=%.0f f2=%.0f sweep=%.1f amp=%.2f at=%s win=%s\r\n",
+               sig_names[ts_sig], (double)ts_f1, (double)ts_f2, (double)ts_sweep_s,
+               (double)ts_amp, point_name(ts_at),
+               (settle_left || blocks_left) ? "armed" : "idle");
+}
+
+static void report(void) {
+    const float on = w_n ? 100.0f * (float)w_on / (float)w_n : 0.0f;
+    const int8_t pmax = g_tx_power_max_dbm;
+    float pmean = 0.0f, clip = 0.0f, dip = 0.0f, fmean = 0.0f, fstd = 0.0f;
+
+    if (w_on) {
+        int64_t psum = 0;
+        for (int i = 0; i < P_BINS; i++) psum += (int64_t)w_hist[i] * (PWR_MIN_DBM + i);
+        pmean = (float)psum / (float)w_on;
+        clip = 100.0f * (float)w_hist[pmax - PWR_MIN_DBM] / (float)w_on;
+
+        double m = (double)w_sum / w_on;
+        double var = (double)w_sumsq / w_on - m * m;
+        fmean = (float)(m * PLL_STEP_HZ / FREQ_FRAC_ONE);
+        fstd = (float)(sqrt(var > 0.0 ? var : 0.0) * PLL_STEP_HZ / FREQ_FRAC_ONE);
+    }
+    // Envelope nulls: carrier at the floor or gated off by the duty regime
+    if (w_n) dip = 100.0f * (float)(w_n - w_on + w_hist[0]) / (float)w_n;
+
+    // Verdicts only where the expected result is known, USB mode:
+    //   tone      frequency within a PLL step (fine-tune offset included)
+    //             and no more spread than the step dither gives;
+    //   two-tone  no flat-topping (IMD3) and the envelope reaches its
+    //             nulls.  The mean frequency of two tones follows the
+    //             stronger one, so it is reported but not judged.
+    const char *check = "-";
+    if (g_tx_mode == TXM_USB && (ts_sig == TS_TONE || ts_sig == TS_TWO)) {
+        float want = ts_f1 + get_fine_tune_hz();
+        if (on < 50.0f)                                       check = "notx";
+        else if (ts_sig == TS_TONE && fabsf(fmean - want) > PLL_STEP_HZ) check = "freq";
+        else if (ts_sig == TS_TONE && fstd > PLL_STEP_HZ)    check = "spread";
+        else if (ts_sig == TS_TWO && clip > TS_CLIP_MAX_PCT) check = "clip";
+        else if (ts_sig == TS_TWO && dip < TS_DIP_MIN_PCT)   check = "nodip";
+        else                                                  check = "ok";
+    }
+
+    cdc_printf("!T report sig=%s at=%s n=%lu on=%.1f pmean=%.1f clip=%.1f dip=%.1f "
+               "fmean=%.0f fstd=%.0f fmin=%.0f fmax=%.0f check=%s\r\n",
+               sig_names[ts_sig], point_name(ts_at), (unsigned long)w_n, (double)on,
+               (double)pmean, (double)clip, (double)dip, (double)fmean, (double)fstd,
+               w_on ? (double)((float)w_min * PLL_STEP_HZ / FREQ_FRAC_ONE) : 0.0,
+               w_on ? (double)((float)w_max * PLL_STEP_HZ / FREQ_FRAC_ONE) : 0.0, check);
+
+    // Power-code histogram, % of on-air samples, non-empty bins only
+    char line[240];
+    size_t len = (size_t)snprintf(line, sizeof(line), "!T hist");
+    for (int i = 0; i < P_BINS && w_on; i++) {
+        if (!w_hist[i]) continue;
+        if (len + 16u >= sizeof(line)) break;
+        len += (size_t)snprintf(line + len, sizeof(line) - len, " %d:%.1f",
+                                PWR_MIN_DBM + i, (double)(100.0f * (float)w_hist[i] / (float)w_on));
+    }
+    cdc_printf("%s\r\n", line);
+}
+
+void testsig_measure(const sample_cmd_t *blk, int32_t base_steps) {
+    if (ts_sig == TS_OFF || blocks_left == 0) return;
+    if (settle_left) { settle_left--; return; }
+
+    for (uint32_t i = 0; i < BLOCK_SAMPLES; i++) {
+        w_n++;
+        if (!blk[i].tx_on) continue;
+        w_on++;
+
+        int p = blk[i].p_dbm;
+        if (p < PWR_MIN_DBM) p = PWR_MIN_DBM;
+        if (p > PWR_MAX_DBM) p = PWR_MAX_DBM;
+        w_hist[p - PWR_MIN_DBM]++;
+
+        int32_t d = sample_cmd_q8(&blk[i], base_steps);
+        w_sum += d;
+        w_sumsq += (int64_t)d * d;
+        if (d < w_min) w_min = d;
+        if (d > w_max) w_max = d;
+    }
+
+    if (--blocks_left == 0) report();
+}
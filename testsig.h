@@ -0,0 +1,64 @@
+// testsig.h - runtime test-signal generator with a quick on-air self-check
+//
+// Replaces the old compile-time USE_TEST_TONE / USE_TWO_TONE_TEST.
+// Single tone, two-tone, multitone, linear sweep or white noise from
+// sine-LUT NCOs (Q32 phase), injected either in place of the audio input
+// (runs through EQ / compressor / bandpass) or straight into the
+// modulator (tests the SSB/FM path alone).  While armed, the producer's
+// own sample commands are measured for a couple of seconds -- power-code
+// histogram, frequency-offset mean and spread -- and reported as "!T"
+// lines with a pass/fail verdict for tone and two-tone in USB mode.
+// Portable: sxsim exercises it through the CDC command.
+
+#ifndef TESTSIG_H
+#define TESTSIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "txchain.h"
+
+// Signals
+#define TS_OFF          0
+#define TS_TONE         1
+#define TS_TWO          2
+#define TS_MULTI        3
+#define TS_SWEEP        4
+#define TS_NOISE        5
+
+// Injection points
+#define TS_AT_SRC       0   // replaces the audio input
+#define TS_AT_MOD       1   // after the audio DSP, into Hilbert / FM
+
+#define TS_MAX_TONES    8
+#define TS_DEFAULT_AMPL 0.25f   // peak of the composite signal
+#define TS_MULTI_LO_HZ  300.0f  // multitone spread, equal spacing
+#define TS_MULTI_HI_HZ  2700.0f
+
+// Self-check window
+#define TS_SETTLE_BLOCKS    8u      // let filters / compressor settle first
+#define TS_CHECK_MS         2000u
+#define TS_CHECK_MAX_MS     30000u
+#define TS_CLIP_MAX_PCT     10.0f   // two-tone flat-topping (IMD3) limit
+#define TS_DIP_MIN_PCT      1.0f    // two-tone must reach the envelope nulls
+
+// Start a signal; f1/f2 in Hz (sweep: f1..f2 over sweep_s seconds,
+// multi: f1 = number of tones).  amp <= 0 selects TS_DEFAULT_AMPL.
+// Returns false on out-of-range parameters.
+bool    testsig_start(uint8_t sig, float f1, float f2, float sweep_s, float amp);
+void    testsig_stop(void);
+void    testsig_set_point(uint8_t at);
+uint8_t testsig_point(void);
+uint8_t testsig_active(void);       // TS_OFF or the running signal
+
+void    testsig_check(uint32_t ms); // (re)arm the measurement window
+
+// Producer hooks: next sample (TS_AT_* decides where), and the finished
+// block with the base PLL steps it was computed against.
+float   testsig_sample(void);
+void    testsig_measure(const sample_cmd_t *blk, int32_t base_steps);
+
+// "!T" status / report lines
+void    testsig_print(void);
+
+#endif // TESTSIG_H
@@ -74,7 +74,11 @@ extern "C" {
 // >>> WŁĄCZAMY CDC (Serial po USB)
 #define CFG_TUD_CDC               1
 
+// USB mass storage: FAT volume in flash (mscdisk.c).  CMake option
+// SX_USB_MSC sets this; 0 leaves the device UAC1 + CDC only.
+#ifndef CFG_TUD_MSC
 #define CFG_TUD_MSC               0
+#endif
 #define CFG_TUD_MIDI              0
 #define CFG_TUD_VENDOR            0
 
@@ -90,6 +94,13 @@ extern "C" {
 #define CFG_TUD_CDC_TX_BUFSIZE    512
 #endif
 
+//--------------------------------------------------------------------+
+// MSC CLASS DRIVER CONFIGURATION
+//--------------------------------------------------------------------+
+
+// One flash sector per transfer callback where the host allows it
+#define CFG_TUD_MSC_EP_BUFSIZE    4096
+
 //--------------------------------------------------------------------+
 // AUDIO CLASS DRIVER CONFIGURATION (UAC1 Speaker OUT + Feedback)
 //--------------------------------------------------------------------+
@@ -98,9 +109,11 @@ extern "C" {
 #define CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_RX      2
 #define CFG_TUD_AUDIO_FUNC_1_RESOLUTION_RX              16
 
-// UAC1 Full-Speed endpoint size: 48kHz * 2ch * 2bytes / 1000 = 192 bytes per frame
-#define CFG_TUD_AUDIO_FUNC_1_MAX_SAMPLE_RATE_FS     48000
-#define CFG_TUD_AUDIO_FUNC_1_EP_OUT_SZ_FS           192
+// UAC1 Full-Speed endpoint size, sized for the highest advertised rate:
+// (96kHz / 1000 + 1) * 2ch * 2bytes = 388 bytes per frame (the +1 covers
+// 44.1/22.05 kHz frames that carry one extra sample)
+#define CFG_TUD_AUDIO_FUNC_1_MAX_SAMPLE_RATE_FS     96000
+#define CFG_TUD_AUDIO_FUNC_1_EP_OUT_SZ_FS           388
 
 // Provide compatibility define expected by newer audio_device.h
 #ifndef CFG_TUD_AUDIO_FUNC_1_EP_OUT_SZ_MAX
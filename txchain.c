@@ -0,0 +1,511 @@
+// txchain.c - Core0 block producer: audio -> DSP -> SSB/FM -> sample commands
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <string.h>
+
+#include "txchain.h"
+#include "control.h"
+#include "platform.h"
+#include "dspgov.h"
+#include "alc.h"
+#include "testsig.h"
+#include "txsched.h"
+#include "afsk.h"
+#include "cmdlat.h"
+#include "specmask.h"
+
+#define F_OFF_LIMIT_HZ      3500.0f
+#define SILENCE_SECONDS     2u
+
+#define IQ_GAIN_CORR        1.00f
+#define IQ_PHASE_CORR_DEG   0.0f
+
+// --- Roger beep (FM mode) ---
+// When TX de-asserts while g_roger_beep is enabled, we emit a short
+// tone by holding tx_on=1 and overriding the audio sample for
+// ROGER_BEEP_SAMPLES ticks (~100 ms @ 8 kHz).
+#define ROGER_BEEP_SAMPLES  800u     // 100 ms
+#define ROGER_BEEP_FREQ_HZ  1000.0f
+
+// --- FM TX envelope ramping (anti-click) ---
+// When tx_on flips we smoothly ramp power + modulation depth with a
+// raised-cosine envelope so the carrier fades in/out instead of
+// hard-switching (which produces an audible "thump" in receivers).
+#define FM_RAMP_SAMPLES  40u   // 40 samples @ 8 kHz = 5 ms
+
+// ---------------- Block queue (Core0 -> Core1) ----------------
+sample_cmd_t g_blocks[NUM_BLOCKS][BLOCK_SAMPLES];
+
+volatile uint32_t g_prod_block = 0;
+volatile uint32_t g_cons_block = 0;
+volatile uint8_t  g_block_ready[NUM_BLOCKS] = {0};
+volatile uint32_t g_underruns = 0;
+volatile uint8_t  g_core1_start = 0;
+
+// ---------------- Chain instances ----------------
+static const float Fs = (float)WAV_SAMPLE_RATE;
+
+// Tone/rotator phases are Q32 fractions of a turn: the wrap is the
+// integer overflow, and (int32_t) gives the angle in [-pi, pi).
+#define Q32_PER_HZ      (4294967296.0f / (float)WAV_SAMPLE_RATE)
+#define Q32_TO_RAD      (2.0f * (float)M_PI / 4294967296.0f)
+
+static inline uint32_t q32_step(float hz) { return (uint32_t)(int32_t)(hz * Q32_PER_HZ); }
+static inline float    q32_rad(uint32_t ph) { return (float)(int32_t)ph * Q32_TO_RAD; }
+
+// silence reset threshold
+static const uint32_t silence_samples = WAV_SAMPLE_RATE * SILENCE_SECONDS;
+
+// The firmware's producer
+static txchain_t g_tx;
+
+void txchain_ctx_set_cfg(txchain_t *t, const audio_cfg_t *cfg) {
+    audio_cfg_t tmp = *cfg;
+    cfg_sanitize(&tmp, Fs);
+
+#if AUDIO_ENABLE_BANDPASS
+    for (int i = 0; i < AUDIO_BP_MAX_STAGES; i++) {
+        biquad_init_highpass_bw2(&t->bp_hpf[i], tmp.bp_lo_hz, Fs);
+        biquad_init_lowpass_bw2 (&t->bp_lpf[i], tmp.bp_hi_hz, Fs);
+    }
+#endif
+#if AUDIO_ENABLE_EQ
+    biquad_init_low_shelf (&t->eq_low,  tmp.eq_low_hz,  Fs, tmp.eq_low_db);
+    biquad_init_high_shelf(&t->eq_high, tmp.eq_high_hz, Fs, tmp.eq_high_db);
+#endif
+#if AUDIO_ENABLE_COMPRESSOR
+    compressor_reconfig(&t->comp, Fs, &tmp);
+    limiter_reconfig(&t->lim, Fs, &tmp);
+#endif
+    weaver_init(&t->weav, tmp.bp_lo_hz, tmp.bp_hi_hz, Fs);
+
+    t->cfg = tmp;
+}
+
+void txchain_ctx_init(txchain_t *t, const audio_cfg_t *cfg) {
+    memset(t, 0, sizeof(*t));
+    hilbert_init(&t->hilb);
+
+    const float phi = (float)IQ_PHASE_CORR_DEG * (float)M_PI / 180.0f;
+    t->cphi = cosf(phi);
+    t->sphi = sinf(phi);
+
+    t->bp_max     = AUDIO_BP_MAX_STAGES;
+    t->hilb_taps  = HILBERT_TAPS;
+    t->comp_decim = 1u;
+    t->alc_gain   = 1.0f;
+    t->ts_sig     = TS_OFF;
+    t->ts_at      = TS_AT_SRC;
+    t->reset_carry = BLOCK_SAMPLES;
+
+    static const audio_cfg_t defaults = AUDIO_CFG_DEFAULTS;
+    txchain_ctx_set_cfg(t, cfg ? cfg : &defaults);
+}
+
+void txchain_params_snapshot(tx_params_t *p) {
+    p->mode        = g_tx_mode;
+    p->tx_req      = (g_tx_enabled || g_ptt_key || txsched_keyed()) ? 1 : 0;
+    p->guard       = tx_mode_guard_active() ? 1 : 0;
+    p->roger_beep  = g_roger_beep;
+    p->pwr_max_dbm = g_tx_power_max_dbm;
+    p->fm_dev_hz   = g_fm_deviation_hz;
+    p->ctcss_hz    = g_ctcss_freq;
+    p->base_steps  = (int32_t)get_base_steps();    // freq + PPM correction
+    p->fine_hz     = get_fine_tune_hz();
+}
+
+void txchain_ctx_block(txchain_t *t, const tx_params_t *p,
+                       const float *audio, sample_cmd_t *blk) {
+    // Quality profile, test signal and ALC gain are fixed for the block
+    hilbert_set_len(&t->hilb, t->hilb_taps);
+#if AUDIO_ENABLE_BANDPASS
+    const int bp_n = (t->cfg.bp_stages < t->bp_max) ? t->cfg.bp_stages : t->bp_max;
+#endif
+#if AUDIO_ENABLE_COMPRESSOR
+    const uint32_t comp_decim = t->comp_decim ? t->comp_decim : 1u;
+#endif
+    const uint8_t ts_sig = t->ts_sig;
+    const uint8_t ts_at  = t->ts_at;
+
+    memset(&t->alc, 0, sizeof(t->alc));
+    t->t_audio_us = 0;
+
+    // ---- Audio front for the whole block: source, EQ, compressor ----
+    // The look-ahead limiter needs the block before the modulator runs;
+    // a silence reset of the modulator state is replayed where the silent
+    // sample leaves the limiter, lim_delay later (maybe in the next block).
+    float *xa = t->xa;
+    uint32_t reset_at = t->reset_carry;
+    t->reset_carry = BLOCK_SAMPLES;
+#if AUDIO_ENABLE_COMPRESSOR
+    const uint32_t lim_delay = t->cfg.enable_comp ? t->lim.la : 0u;
+#else
+    const uint32_t lim_delay = 0u;
+#endif
+
+    for (uint32_t n = 0; n < BLOCK_SAMPLES; n++) {
+        // Audio source: USB (PC) or ADC (MIC), provided by the platform.
+        // Time spent here (MIC pacing, USB pump) is not DSP load.
+        float x;
+        if (audio) {
+            x = audio[n];
+        } else {
+            uint64_t t_a = plat_us();
+            x = plat_audio_sample(n, &t->cfg);
+            t->t_audio_us += plat_us() - t_a;
+        }
+
+        if (ts_sig != TS_OFF) {
+            // Runtime test signal (testsig.c): replaces the audio here
+            // (src) or after the audio DSP (mod); no silence reset meanwhile.
+            if (ts_at == TS_AT_SRC) x = testsig_sample();
+        } else {
+            if (fabsf(x) < 1e-5f) {
+                if (t->silence_ctr < silence_samples) t->silence_ctr++;
+            } else {
+                t->silence_ctr = 0;
+            }
+
+            if (t->silence_ctr == silence_samples) {
+                if (n + lim_delay < BLOCK_SAMPLES) reset_at = n + lim_delay;
+                else t->reset_carry = n + lim_delay - BLOCK_SAMPLES;
+#if AUDIO_ENABLE_EQ
+                biquad_reset(&t->eq_low);
+                biquad_reset(&t->eq_high);
+#endif
+#if AUDIO_ENABLE_COMPRESSOR
+                t->comp.env = 0.0f;
+#endif
+                t->silence_ctr = silence_samples + 1u;
+            }
+        }
+
+#if AUDIO_ENABLE_EQ
+        if (t->cfg.enable_eq) {
+            x = biquad_process(&t->eq_low,  x);
+            x = biquad_process(&t->eq_high, x);
+        }
+#endif
+
+#if AUDIO_ENABLE_COMPRESSOR
+        if (t->cfg.enable_comp) {
+            x = compressor_process_cr(&t->comp, x, (n % comp_decim) == 0u);
+        }
+#endif
+        xa[n] = x;
+    }
+
+#if AUDIO_ENABLE_COMPRESSOR
+    // Output limiter: look-ahead (delays by comp_la) or hard clip
+    if (t->cfg.enable_comp) limiter_block(&t->lim, xa, BLOCK_SAMPLES, t->cfg.comp_out_limit);
+#endif
+
+    // ---- Bandpass, modulator and power, per sample ----
+    for (uint32_t n = 0; n < BLOCK_SAMPLES; n++) {
+        float x = xa[n];
+
+        if (n == reset_at) {
+            hilbert_reset(&t->hilb);
+            weaver_reset(&t->weav);
+            t->theta_prev = 0.0f;
+            t->fine_tune_phase = 0;
+            t->p_acc = 0.0f;
+            t->tx_acc = 0.0f;
+
+#if AUDIO_ENABLE_BANDPASS
+            for (int i = 0; i < AUDIO_BP_MAX_STAGES; i++) {
+                biquad_reset(&t->bp_hpf[i]);
+                biquad_reset(&t->bp_lpf[i]);
+            }
+#endif
+        }
+
+#if AUDIO_ENABLE_BANDPASS
+        if (t->cfg.enable_bandpass) {
+            for (int i = 0; i < bp_n; i++) x = biquad_process(&t->bp_hpf[i], x);
+            for (int i = 0; i < bp_n; i++) x = biquad_process(&t->bp_lpf[i], x);
+        }
+#endif
+
+        if (ts_sig != TS_OFF && ts_at == TS_AT_MOD) x = testsig_sample();
+
+        // ==================== FM MODE ====================
+        // Direct frequency modulation: audio sample → frequency offset.
+        // No Hilbert transform, no SSB I/Q, no amplitude shaping.
+        // Constant power, constant TX on (when gated).
+        if (p->mode == TXM_FM) {
+            // User's "want TX" request (independent of roger-beep);
+            // a queued packet keys the carrier too, without a beep after it
+            uint8_t user_req = p->tx_req;
+            uint8_t tx_req = user_req || t->afsk_on;
+            if (p->guard) {
+                user_req = tx_req = 0;
+                t->roger_beep_left = 0;  // cancel any pending beep
+            }
+
+            // Detect falling edge of TX request → start roger beep
+            if (p->roger_beep && t->fm_prev_tx_req && !user_req) {
+                t->roger_beep_left = ROGER_BEEP_SAMPLES;
+                t->roger_beep_phase = 0;
+            }
+            t->fm_prev_tx_req = user_req;
+
+            // "Keep carrier up" request — includes roger-beep tail
+            uint8_t want_carrier = tx_req || (t->roger_beep_left > 0);
+
+            // Manage envelope ramp state machine
+            if (want_carrier && !t->fm_carrier_on && t->fm_ramp_dir <= 0) {
+                // Start ramp-up
+                t->fm_ramp_dir = +1;
+                t->fm_ramp_pos = 0;
+                t->fm_carrier_on = 1;
+            } else if (!want_carrier && t->fm_carrier_on && t->fm_ramp_dir >= 0) {
+                // Start ramp-down
+                t->fm_ramp_dir = -1;
+                t->fm_ramp_pos = FM_RAMP_SAMPLES;  // start from full
+            }
+
+            // Compute envelope value 0..1 for this sample
+            float env;
+            if (t->fm_ramp_dir > 0) {
+                t->fm_ramp_pos++;
+                if (t->fm_ramp_pos >= FM_RAMP_SAMPLES) {
+                    t->fm_ramp_pos = FM_RAMP_SAMPLES;
+                    t->fm_ramp_dir = 0;   // done
+                }
+                float frac = (float)t->fm_ramp_pos / (float)FM_RAMP_SAMPLES;
+                env = 0.5f * (1.0f - cosf((float)M_PI * frac));
+            } else if (t->fm_ramp_dir < 0) {
+                if (t->fm_ramp_pos > 0) t->fm_ramp_pos--;
+                float frac = (float)t->fm_ramp_pos / (float)FM_RAMP_SAMPLES;
+                env = 0.5f * (1.0f - cosf((float)M_PI * frac));
+                if (t->fm_ramp_pos == 0) {
+                    t->fm_ramp_dir = 0;
+                    t->fm_carrier_on = 0;
+                }
+            } else {
+                env = t->fm_carrier_on ? 1.0f : 0.0f;
+            }
+
+            uint8_t tx_on = t->fm_carrier_on ? 1 : 0;
+
+            if (tx_on) {
+                if (t->roger_beep_left > 0) {
+                    // Override audio with a sine tone, keep carrier up
+                    x = 0.7f * sinf(q32_rad(t->roger_beep_phase));
+                    t->roger_beep_phase += q32_step(ROGER_BEEP_FREQ_HZ);
+                    t->roger_beep_left--;
+                } else if (t->afsk_on) {
+                    // AFSK tones replace the audio, full deviation
+                    x = afsk_sample();
+                } else if (tx_req && p->ctcss_hz > 0.0f) {
+                    // Add CTCSS sub-audible tone if enabled
+                    float ctcss_amp = 0.15f;
+                    x = x * (1.0f - ctcss_amp) + ctcss_amp * sinf(q32_rad(t->ctcss_phase));
+                    t->ctcss_phase += q32_step(p->ctcss_hz);
+                }
+                // Fade modulation depth with envelope so deviation
+                // also grows/shrinks smoothly, not just RF amplitude.
+                x *= env;
+            } else {
+                x = 0.0f;
+            }
+
+            // Deviation plus fine tuning, in fractional PLL steps;
+            // Core1 dithers the fraction
+            float fm_offset_hz = x * p->fm_dev_hz + p->fine_hz;
+            float fm_steps = fm_offset_hz / PLL_STEP_HZ;
+
+            // Power envelope: map env (0..1) from PWR_MIN..target linearly in dB
+            int8_t target_dbm = p->pwr_max_dbm;
+            int8_t pwr_dbm;
+            if (tx_on) {
+                float dbm_f = (float)PWR_MIN_DBM +
+                              env * ((float)target_dbm - (float)PWR_MIN_DBM);
+                int32_t pi = (int32_t)(dbm_f + 0.5f);
+                if (pi < PWR_MIN_DBM) pi = PWR_MIN_DBM;
+                if (pi > PWR_MAX_DBM) pi = PWR_MAX_DBM;
+                pwr_dbm = (int8_t)pi;
+            } else {
+                pwr_dbm = PWR_MIN_DBM;
+            }
+
+            sample_cmd_set_freq(&blk[n], p->base_steps, fm_steps);
+            blk[n].p_dbm      = pwr_dbm;
+            blk[n].tx_on      = tx_on;
+            continue;  // Skip SSB path below
+        }
+
+        // ==================== SSB MODE ====================
+        float I;
+        float Q = (t->cfg.ssb_engine == SSB_WEAVER) ? weaver_process(&t->weav, x, &I)
+                                                    : hilbert_process(&t->hilb, x, &I);
+
+        float Iq = I;
+        float Qq = Q * (float)IQ_GAIN_CORR;
+
+        float I2 = Iq * t->cphi - Qq * t->sphi;
+        float Q2 = Iq * t->sphi + Qq * t->cphi;
+
+        // Apply fine frequency tuning via complex carrier multiplication
+        // Fine tune is calculated automatically from fractional Hz that PLL can't reach
+        float fine_hz = p->fine_hz;  // Auto-calculated from target freq + PPM
+        if (fine_hz != 0.0f) {
+            float fine_rad = q32_rad(t->fine_tune_phase);
+            float fine_cos = cosf(fine_rad);
+            float fine_sin = sinf(fine_rad);
+            float I3 = I2 * fine_cos - Q2 * fine_sin;
+            float Q3 = I2 * fine_sin + Q2 * fine_cos;
+            I2 = I3;
+            Q2 = Q3;
+            t->fine_tune_phase += q32_step(fine_hz);
+        }
+
+        float A_raw = sqrtf(I2 * I2 + Q2 * Q2);
+        float A = A_raw * t->alc_gain;
+
+        float theta = atan2f(Q2, I2);
+
+        float dtheta = theta - t->theta_prev;
+        if (dtheta > (float)M_PI)   dtheta -= 2.0f * (float)M_PI;
+        if (dtheta < -(float)M_PI) dtheta += 2.0f * (float)M_PI;
+        t->theta_prev = theta;
+
+        float f_off = dtheta * Fs / (2.0f * (float)M_PI);
+        if (f_off > (float)F_OFF_LIMIT_HZ)  f_off = (float)F_OFF_LIMIT_HZ;
+        if (f_off < -(float)F_OFF_LIMIT_HZ) f_off = -(float)F_OFF_LIMIT_HZ;
+
+        float want_steps = f_off / PLL_STEP_HZ;
+
+        float duty = duty_from_A(A);
+
+        int32_t p_chosen = PWR_MIN_DBM;
+        uint8_t tx_on = 1;
+        bool    clipped = false;
+        float   lvl_db = (float)(PWR_MIN_DBM - p->pwr_max_dbm);  // rel. max power
+
+        if (duty < 1.0f) {
+            p_chosen = PWR_MIN_DBM;
+            t->tx_acc += duty;
+            if (t->tx_acc >= 1.0f) { tx_on = 1; t->tx_acc -= 1.0f; }
+            else                { tx_on = 0; }
+        } else {
+            tx_on = 1;
+
+            int8_t pwr_max = p->pwr_max_dbm;  // Local copy for this sample
+            float Aeff = A * t->cfg.amp_gain;
+            if (Aeff < t->cfg.amp_min_a) Aeff = t->cfg.amp_min_a;
+
+            float p_raw = (float)pwr_max + 20.0f * log10f(Aeff);
+
+            float p_des = p_raw;
+            if (p_des > (float)pwr_max) { p_des = (float)pwr_max; clipped = true; }
+            if (p_des < (float)PWR_MIN_DBM) p_des = (float)PWR_MIN_DBM;
+            lvl_db = p_des - (float)pwr_max;
+
+            int32_t p_low  = (int32_t)floorf(p_des);
+            int32_t p_high = p_low + 1;
+
+            if (p_low  < PWR_MIN_DBM) p_low  = PWR_MIN_DBM;
+            if (p_high > pwr_max) p_high = pwr_max;
+
+            float frac = p_des - (float)p_low;
+            if (frac < 0.0f) frac = 0.0f;
+            if (frac > 1.0f) frac = 1.0f;
+
+            t->p_acc += frac;
+            p_chosen = p_low;
+            if (t->p_acc >= 1.0f && p_high != p_low) { p_chosen = p_high; t->p_acc -= 1.0f; }
+        }
+
+        // SSB TX gating: transmit if GUI TX=ON *or* PTT pressed.
+        // Either source alone is sufficient (OR logic).
+        // CW mode PTT is handled separately by carrier_poll.
+        // Applies to USB-SSB (mode 0) only.
+        bool keyed = (p->mode == TXM_USB) && p->tx_req;
+        if (p->mode == TXM_USB && !keyed) {
+            tx_on = 0;
+        }
+        // Hard-gate TX during mode-change guard window to avoid clicks
+        if (p->guard) { tx_on = 0; keyed = false; }
+
+        // ALC statistics: voiced samples that actually go on air
+        if (keyed && A_raw >= ALC_VOICE_A) {
+            t->alc.n_voice++;
+            if (clipped)     t->alc.n_clip++;
+            if (duty < 1.0f) t->alc.n_duty++;
+            t->alc.sum_db += lvl_db;
+        }
+
+        sample_cmd_set_freq(&blk[n], p->base_steps, want_steps);
+        blk[n].p_dbm      = (int8_t)p_chosen;
+        blk[n].tx_on      = tx_on;
+    }
+
+}
+
+// ---------------- Firmware producer ----------------
+void txchain_init(void) {
+    // Design filters now rather than on the first block, so the first
+    // block after boot costs no more than any other.
+    audio_cfg_t c;
+    cfg_snapshot(&c);
+    txchain_ctx_init(&g_tx, &c);
+    __compiler_memory_barrier();
+    g_cfg_dirty = 0;
+    __compiler_memory_barrier();
+}
+
+void txchain_fill_block(sample_cmd_t *blk) {
+    uint64_t t_start = plat_us();
+    const uint32_t lat_id = cmdlat_begin();     // changes this block carries
+
+    // Queue slack at block start: how far ahead of Core1 we still are
+    uint32_t ready = NUM_BLOCKS;
+    if (g_core1_start) {
+        ready = 0;
+        for (uint32_t i = 0; i < NUM_BLOCKS; i++) if (g_block_ready[i]) ready++;
+    }
+
+    // Apply pending cfg (filter/compressor designs) on block boundary
+    if (g_cfg_dirty) {
+        audio_cfg_t c;
+        cfg_snapshot(&c);
+        txchain_ctx_set_cfg(&g_tx, &c);
+        __compiler_memory_barrier();
+        g_cfg_dirty = 0;
+        __compiler_memory_barrier();
+    }
+
+    // Quality level chosen by the governor for this block
+    const dspgov_profile_t *qp = dspgov_profile();
+    g_tx.bp_max     = qp->bp_max;
+    g_tx.hilb_taps  = qp->hilb_taps;
+    g_tx.comp_decim = qp->comp_decim;
+
+    // Runtime test signal and RF ALC
+    g_tx.ts_sig   = testsig_active();
+    g_tx.ts_at    = testsig_point();
+    g_tx.alc_gain = alc_gain();
+
+    tx_params_t p;
+    txchain_params_snapshot(&p);
+
+    // Packets only go out in FM; drop them if the mode changed under them
+    if (p.mode != TXM_FM && afsk_active()) afsk_flush("mode");
+    g_tx.afsk_on = afsk_active() ? 1u : 0u;
+
+    txchain_ctx_block(&g_tx, &p, NULL, blk);
+
+    alc_block(&g_tx.alc);
+    testsig_measure(blk, p.base_steps);
+    specmask_capture(blk, p.base_steps, p.mode);
+    afsk_block();
+    cmdlat_commit(g_prod_block, lat_id);
+
+    uint64_t busy = plat_us() - t_start - g_tx.t_audio_us;
+    dspgov_block((uint32_t)busy, (uint32_t)(BLOCK_SAMPLES * 1000000ull / WAV_SAMPLE_RATE),
+                 ready, g_underruns);
+}
@@ -0,0 +1,162 @@
+// txchain.h - Core0 block producer: audio -> DSP -> SSB/FM -> sample commands
+//
+// Turns 8 kHz mono audio into per-sample SX1280 commands (PLL steps,
+// power, TX gate) and owns the block queue Core1 consumes.  Portable:
+// the same code runs in the firmware and in the host simulator.
+//
+// All chain state lives in a txchain_t and the radio settings it reads
+// come in a tx_params_t, so independent instances can run in parallel
+// (host/sxrender).  The firmware's producer is one static instance
+// behind txchain_init() / txchain_fill_block(), fed from the globals.
+
+#ifndef TXCHAIN_H
+#define TXCHAIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "dsp.h"
+#include "alc.h"
+
+// ================== DITHER SPEED-UP ==================
+#define DITHER_SUBSTEPS     4
+// ===============================================
+
+// ================== BUFFERING ==================
+#define BLOCK_SAMPLES       256u
+#define NUM_BLOCKS          8u   // increased from 2 to prevent underruns
+// ===============================================
+
+// ---------------- Command buffer ----------------
+// The wanted frequency is freq_steps + freq_frac / 256 PLL steps.  The
+// producer does not dither: Core1 runs the sigma-delta over the fraction
+// at every substep (sample_cmd_dither()), which puts the quantisation
+// noise DITHER_SUBSTEPS times higher than dithering once per sample.
+#define FREQ_FRAC_BITS      8u
+#define FREQ_FRAC_ONE       (1u << FREQ_FRAC_BITS)
+
+typedef struct {
+    int32_t  freq_steps;            // whole PLL steps (floor)
+    int8_t   p_dbm;
+    uint8_t  tx_on;
+    uint8_t  freq_frac;             // Q8 fraction of a step on top
+} sample_cmd_t;
+
+// Producer: hold `steps` (fractional) above base_steps, rounded to Q8
+static inline void sample_cmd_set_freq(sample_cmd_t *c, int32_t base_steps, float steps) {
+    const int32_t q = (int32_t)floorf(steps * (float)FREQ_FRAC_ONE + 0.5f);
+    const int32_t n = (q >= 0) ? q / (int32_t)FREQ_FRAC_ONE
+                               : -(((int32_t)FREQ_FRAC_ONE - 1 - q) / (int32_t)FREQ_FRAC_ONE);
+    c->freq_steps = base_steps + n;
+    c->freq_frac  = (uint8_t)(q - n * (int32_t)FREQ_FRAC_ONE);
+}
+
+// Wanted frequency above base_steps, Q8 PLL steps
+static inline int32_t sample_cmd_q8(const sample_cmd_t *c, int32_t base_steps) {
+    return (c->freq_steps - base_steps) * (int32_t)FREQ_FRAC_ONE + (int32_t)c->freq_frac;
+}
+
+// Core1, once per substep: the whole step to key.  *acc is the caller's
+// first-order sigma-delta state, 0..FREQ_FRAC_ONE-1.
+static inline int32_t sample_cmd_dither(const sample_cmd_t *c, uint32_t *acc) {
+    *acc += c->freq_frac;
+    if (*acc >= FREQ_FRAC_ONE) { *acc -= FREQ_FRAC_ONE; return c->freq_steps + 1; }
+    return c->freq_steps;
+}
+
+extern sample_cmd_t g_blocks[NUM_BLOCKS][BLOCK_SAMPLES];
+
+extern volatile uint32_t g_prod_block;
+extern volatile uint32_t g_cons_block;
+extern volatile uint8_t  g_block_ready[NUM_BLOCKS];
+extern volatile uint32_t g_underruns;
+extern volatile uint8_t  g_core1_start;
+
+// ---------------- Radio settings for one block ----------------
+typedef struct {
+    uint8_t  mode;          // TXM_*
+    uint8_t  tx_req;        // GUI TX or PTT
+    uint8_t  guard;         // mode-change guard window: TX forced off
+    uint8_t  roger_beep;    // FM roger beep on TX release
+    int8_t   pwr_max_dbm;
+    float    fm_dev_hz;
+    float    ctcss_hz;      // 0 = off
+    int32_t  base_steps;    // PLL steps of the carrier
+    float    fine_hz;       // sub-step remainder: SSB rotates the IQ, FM adds it to the command
+} tx_params_t;
+
+// ---------------- One chain instance ----------------
+typedef struct {
+    audio_cfg_t cfg;        // sanitised; filters below are designed from it
+
+#if AUDIO_ENABLE_BANDPASS
+    biquad_t bp_hpf[AUDIO_BP_MAX_STAGES];
+    biquad_t bp_lpf[AUDIO_BP_MAX_STAGES];
+#endif
+#if AUDIO_ENABLE_EQ
+    biquad_t eq_low, eq_high;
+#endif
+#if AUDIO_ENABLE_COMPRESSOR
+    compressor_t comp;
+    limiter_t    lim;               // output limiter, look-ahead comp_lookahead_ms
+#endif
+    hilbert_t hilb;
+    weaver_t  weav;                 // cfg.ssb_engine == SSB_WEAVER
+
+    float    cphi, sphi;            // IQ phase correction
+    float    theta_prev;
+    float    p_acc;                 // power sigma-delta
+    float    tx_acc;                // duty-regime pulse density
+    uint32_t fine_tune_phase;       // Q32 turn
+    uint32_t ctcss_phase;
+    uint32_t roger_beep_left;       // samples remaining
+    uint32_t roger_beep_phase;
+    uint8_t  fm_prev_tx_req;        // previous "user wants TX" state
+    uint8_t  fm_carrier_on;         // 1 while the carrier is emitting
+    int8_t   fm_ramp_dir;           // +1 up, -1 down, 0 idle
+    uint32_t fm_ramp_pos;           // 0..FM_RAMP_SAMPLES
+    uint32_t silence_ctr;
+    uint32_t reset_carry;           // silence reset due at this sample of the next block, BLOCK_SAMPLES = none
+
+    // Per-block knobs: DSP governor profile, ALC gain, test signal, packet.
+    // txchain_ctx_init() sets full quality, unity gain, no test signal.
+    uint8_t  bp_max;
+    uint16_t hilb_taps;
+    uint8_t  comp_decim;
+    float    alc_gain;
+    uint8_t  ts_sig, ts_at;         // TS_* / TS_AT_* (testsig.h)
+    uint8_t  afsk_on;               // FM: packet tones from afsk_sample(), keyed
+
+    float    xa[BLOCK_SAMPLES];     // audio front output for the block
+
+    // Per-block results
+    alc_meas_t alc;
+    uint64_t   t_audio_us;          // time spent in plat_audio_sample()
+} txchain_t;
+
+void txchain_ctx_init(txchain_t *t, const audio_cfg_t *cfg);    // cfg NULL = defaults
+void txchain_ctx_set_cfg(txchain_t *t, const audio_cfg_t *cfg); // redesign filters
+
+// Produce BLOCK_SAMPLES commands from BLOCK_SAMPLES audio samples (+-1.0);
+// audio NULL pulls them from plat_audio_sample().
+void txchain_ctx_block(txchain_t *t, const tx_params_t *p,
+                       const float *audio, sample_cmd_t *blk);
+
+// Radio settings from the runtime globals (control.h)
+void txchain_params_snapshot(tx_params_t *p);
+
+// ---------------- Firmware producer ----------------
+// One-time init (Hilbert taps, IQ correction constants).
+void txchain_init(void);
+
+// Produce BLOCK_SAMPLES commands into blk.  Applies pending g_cfg changes
+// on entry and samples the frequency plan once per block.
+void txchain_fill_block(sample_cmd_t *blk);
+
+// Audio source hook, implemented by the platform: return the next 8 kHz
+// mono sample in ±1.0 for sample index n of the current block.  May block
+// (MIC path paces the producer) and may service USB/UI while waiting.
+float plat_audio_sample(uint32_t n, const audio_cfg_t *cfg);
+
+#endif // TXCHAIN_H
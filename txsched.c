@@ -0,0 +1,363 @@
+// txsched.c - host-synchronised time base and scheduled TX start (tx_at)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "txsched.h"
+#include "control.h"
+#include "platform.h"
+
+// ==========================================================
+// SOF time base (edges may arrive in IRQ context)
+// ==========================================================
+// phase = local - device time, 1/256 us, smoothed over TB_AVG edges.
+// Device time of an edge is exact by construction (frames x 1000 us);
+// the local stamp carries IRQ latency, which can only make it late, so
+// edges well above the smoothed phase are dropped rather than averaged.
+#define TB_AVG  16
+
+static volatile uint32_t tb_seq;
+static volatile int64_t  tb_phase_q8;
+static volatile uint32_t tb_edges, tb_late, tb_rebases;
+
+static bool     tb_valid;
+static uint32_t tb_frame;
+static uint64_t tb_loc_prev;
+static uint64_t tb_dev_edge;
+
+static void tb_publish(int64_t ph) {
+    tb_seq++;
+    __compiler_memory_barrier();
+    tb_phase_q8 = ph;
+    __compiler_memory_barrier();
+    tb_seq++;
+}
+
+static int64_t tb_phase(void) {
+    uint32_t s;
+    int64_t ph;
+    do {
+        s = tb_seq;
+        __compiler_memory_barrier();
+        ph = tb_phase_q8;
+        __compiler_memory_barrier();
+    } while ((s & 1u) || s != tb_seq);
+    return ph;
+}
+
+void txsched_sof(uint32_t frame_no, uint64_t local_us) {
+    frame_no &= 0x7FFu;
+    const int64_t ph = tb_phase_q8;
+
+    // First edge, or a gap the 11-bit frame number cannot bridge: count
+    // on from here, continuous with the time so far.
+    if (!tb_valid || (local_us - tb_loc_prev) > TXS_SOF_GAP_US) {
+        if (tb_valid) tb_rebases++;
+        tb_valid = true;
+        tb_frame = frame_no;
+        tb_loc_prev = local_us;
+        tb_dev_edge = (uint64_t)((int64_t)local_us - ph / 256);
+        return;
+    }
+
+    const uint32_t df = (frame_no - tb_frame) & 0x7FFu;
+    if (df == 0) return;
+    tb_frame = frame_no;
+    tb_loc_prev = local_us;
+    tb_dev_edge += (uint64_t)df * 1000u;
+
+    const int64_t e = (int64_t)(local_us - tb_dev_edge) * 256 - ph;
+    if (e > (int64_t)TXS_SOF_JITTER_US * 256) {
+        tb_late++;
+        return;
+    }
+    tb_edges++;
+    tb_publish(ph + e / TB_AVG);
+}
+
+uint64_t txsched_dev_us(void) {
+    return (uint64_t)((int64_t)plat_us() - tb_phase() / 256);
+}
+
+// Device time <-> local us (Core1's 32-bit clock)
+static uint32_t dev_to_local32(uint64_t dev) {
+    return (uint32_t)((int64_t)dev + tb_phase() / 256);
+}
+
+// ==========================================================
+// Host offset
+// ==========================================================
+// host = dev + off + rate * (dev - sync_dev).  The rate comes from the
+// first sync of the current chain, so its baseline grows with every
+// resync; a SOF rebase or an implausible rate starts a new chain.
+static bool     sy_valid;
+static uint64_t sy_dev;
+static int64_t  sy_off;
+static float    sy_rate_ppm;
+static uint64_t sy_dev0;
+static int64_t  sy_off0;
+static uint32_t sy_rebases;
+static uint32_t sy_rtt_us;
+static uint32_t sy_ms;
+
+static uint64_t dev_to_host(uint64_t dev) {
+    const float d = (float)(int64_t)(dev - sy_dev);
+    return (uint64_t)((int64_t)dev + sy_off + (int64_t)(d * sy_rate_ppm * 1e-6f));
+}
+
+static uint64_t host_to_dev(uint64_t host) {
+    const uint64_t d0 = (uint64_t)((int64_t)host - sy_off);
+    const float d = (float)(int64_t)(d0 - sy_dev);
+    return (uint64_t)((int64_t)d0 - (int64_t)(d * sy_rate_ppm * 1e-6f));
+}
+
+uint64_t txsched_host_us(void) {
+    const uint64_t dev = txsched_dev_us();
+    return sy_valid ? dev_to_host(dev) : dev;
+}
+
+// 64-bit decimal without relying on printf long long support
+static const char *u64s(char *buf, uint64_t v) {
+    char tmp[21];
+    int n = 0;
+    do { tmp[n++] = (char)('0' + v % 10u); v /= 10u; } while (v);
+    for (int i = 0; i < n; i++) buf[i] = tmp[n - 1 - i];
+    buf[n] = 0;
+    return buf;
+}
+
+static const char *i64s(char *buf, int64_t v) {
+    if (v < 0) {
+        buf[0] = '-';
+        u64s(buf + 1, (uint64_t)(-v));
+        return buf;
+    }
+    return u64s(buf, (uint64_t)v);
+}
+
+void txsched_ping(const char *host_us) {
+    char d[24];
+    cdc_printf("!C ping host=%s dev=%s\r\n", host_us, u64s(d, txsched_dev_us()));
+}
+
+const char *txsched_sync(uint64_t host_us, uint64_t dev_us, uint32_t rtt_us) {
+    const uint64_t now = txsched_dev_us();
+    if (dev_us > now || now - dev_us > 10000000u) return "stale or future device time";
+
+    const int64_t off = (int64_t)(host_us - dev_us);
+    const uint32_t rebases = tb_rebases;
+
+    if (sy_valid && rebases == sy_rebases && dev_us > sy_dev0) {
+        const uint64_t span = dev_us - sy_dev0;
+        if (span >= (uint64_t)TXS_RATE_MIN_S * 1000000u) {
+            const float r = (float)(off - sy_off0) * 1e6f / (float)span;
+            if (r > TXS_RATE_MAX_PPM || r < -TXS_RATE_MAX_PPM) {
+                sy_dev0 = dev_us;           // host clock stepped: new chain
+                sy_off0 = off;
+                sy_rate_ppm = 0.0f;
+            } else {
+                sy_rate_ppm = r;
+            }
+        }
+    } else {
+        sy_dev0 = dev_us;
+        sy_off0 = off;
+        sy_rate_ppm = 0.0f;
+        sy_rebases = rebases;
+    }
+
+    sy_valid = true;
+    sy_dev = dev_us;
+    sy_off = off;
+    sy_rtt_us = rtt_us;
+    sy_ms = plat_ms();
+    return NULL;
+}
+
+// ==========================================================
+// Schedule (Core0) and the Core1 window
+// ==========================================================
+static txsched_stats_t st;
+static bool     at_host;        // start follows host time (resyncs move it)
+static uint64_t at_host_us;
+static uint64_t at_dev;         // start, device time
+static uint64_t end_dev;        // 0 = open-ended
+
+// Core0 -> Core1
+static volatile uint8_t  gate_on;
+static volatile uint8_t  gate_has_end;
+static volatile uint32_t gate_start, gate_end;
+static volatile uint32_t gate_gen;
+// Core1 -> Core0
+static volatile uint32_t fire_gen;
+static volatile uint32_t fire_us;
+
+bool txsched_gate(uint32_t now_us, bool tx_on) {
+    if (!gate_on) return tx_on;
+    if ((int32_t)(now_us - gate_start) < 0) return false;
+    if (gate_has_end && (int32_t)(now_us - gate_end) >= 0) return false;
+    if (tx_on) {
+        const uint32_t gen = gate_gen;
+        if (fire_gen != gen) {
+            fire_us = now_us;
+            __compiler_memory_barrier();
+            fire_gen = gen;
+        }
+    }
+    return tx_on;
+}
+
+static void gate_refresh(void) {
+    gate_start = dev_to_local32(at_dev);
+    if (end_dev) gate_end = dev_to_local32(end_dev);
+}
+
+// A UTC start and end follow the host clock: resyncs and the learnt
+// rate move them in device time (the SOF runs off the host controller's
+// crystal, not the host's disciplined system time).
+static void at_follow(void) {
+    at_dev = host_to_dev(at_host_us);
+    if (st.len_ms) end_dev = host_to_dev(at_host_us + (uint64_t)st.len_ms * 1000u);
+    gate_refresh();
+}
+
+static const char *arm(uint64_t start_dev, uint32_t len_ms) {
+    if (st.state != TXS_IDLE) return "already scheduled (tx_at off first)";
+    if (len_ms > TXS_MAX_AHEAD_MS) return "length too long";
+
+    const uint64_t now = txsched_dev_us();
+    const int64_t ahead = (int64_t)(start_dev - now);
+    if (ahead < (int64_t)TXS_LEAD_MS * 1000) return "start too soon for the keying lead";
+    if (ahead > (int64_t)TXS_MAX_AHEAD_MS * 1000) return "start too far ahead";
+
+    at_dev = start_dev;
+    end_dev = len_ms ? start_dev + (uint64_t)len_ms * 1000u : 0;
+    at_host = false;
+    st.start_ms = (sy_valid ? dev_to_host(start_dev) : start_dev) / 1000u;
+    st.len_ms = len_ms;
+    st.fired = false;
+    st.err_us = 0;
+    st.queue_ms = 0;
+
+    gate_refresh();
+    gate_has_end = len_ms ? 1u : 0u;
+    __compiler_memory_barrier();
+    gate_gen++;
+    __compiler_memory_barrier();
+    gate_on = 1;
+    st.state = TXS_ARMED;
+    txsched_print("armed");
+    return NULL;
+}
+
+const char *txsched_arm_at(uint64_t start_ms, uint32_t len_ms) {
+    if (!sy_valid) return "no host time (tsync first)";
+    const char *err = arm(host_to_dev(start_ms * 1000u), len_ms);
+    if (!err) {
+        at_host = true;
+        at_host_us = start_ms * 1000u;
+        at_follow();
+    }
+    return err;
+}
+
+const char *txsched_arm_in(uint32_t rel_ms, uint32_t len_ms) {
+    return arm(txsched_dev_us() + (uint64_t)rel_ms * 1000u, len_ms);
+}
+
+const char *txsched_arm_next(uint32_t period_ms, uint32_t len_ms) {
+    if (!sy_valid) return "no host time (tsync first)";
+    if (period_ms == 0) return "bad period";
+    const uint64_t earliest = txsched_host_us() / 1000u + TXS_LEAD_MS + 1u;
+    const uint64_t t = (earliest + period_ms - 1u) / period_ms * period_ms;
+    return txsched_arm_at(t, len_ms);
+}
+
+void txsched_cancel(const char *why) {
+    if (st.state != TXS_ARMED && st.state != TXS_ON) return;
+    const uint64_t now = txsched_dev_us();
+    if (!end_dev || now < end_dev) {
+        end_dev = now;
+        gate_end = dev_to_local32(now);
+        __compiler_memory_barrier();
+        gate_has_end = 1;
+    }
+    st.state = TXS_DRAIN;
+    txsched_print(why);
+}
+
+bool txsched_keyed(void) {
+    if (st.state != TXS_ARMED && st.state != TXS_ON) return false;
+    const uint64_t now = txsched_dev_us();
+    if ((int64_t)(now - at_dev) < -(int64_t)TXS_LEAD_MS * 1000) return false;
+    return !end_dev || now < end_dev;
+}
+
+bool txsched_busy(void) { return st.state != TXS_IDLE; }
+
+void txsched_poll(uint32_t queue_ms) {
+    if (st.state == TXS_IDLE) return;
+    const uint64_t now = txsched_dev_us();
+
+    if (st.state == TXS_ARMED) {
+        // Follow resyncs and the SOF phase until the start
+        if (at_host) at_follow();
+        else         gate_refresh();
+        if (now >= at_dev) {
+            st.state = TXS_ON;
+            st.queue_ms = queue_ms;
+            st.count++;
+        }
+    }
+
+    if (!st.fired && fire_gen == gate_gen) {
+        __compiler_memory_barrier();
+        st.fired = true;
+        st.err_us = (int32_t)(fire_us - gate_start);
+        txsched_print("start");
+    }
+
+    if (st.state == TXS_ON && end_dev && now >= end_dev) {
+        st.state = TXS_DRAIN;
+        txsched_print("end");
+    }
+
+    // Keyed blocks produced before the end are still queued: keep the
+    // window closed on them until they have played out.
+    if (st.state == TXS_DRAIN && now >= end_dev + (uint64_t)TXS_LEAD_MS * 1000u) {
+        gate_on = 0;
+        st.state = TXS_IDLE;
+        txsched_print("done");
+    }
+}
+
+void txsched_stats(txsched_stats_t *out) {
+    *out = st;
+    out->synced = sy_valid;
+    out->sof = tb_valid;
+    out->off_us = sy_off;
+    out->rate_ppm = sy_rate_ppm;
+    out->rtt_us = sy_rtt_us;
+    out->sync_age_s = sy_valid ? (plat_ms() - sy_ms) / 1000u : 0;
+    out->edges = tb_edges;
+    out->late = tb_late;
+    out->rebases = tb_rebases;
+}
+
+void txsched_print(const char *why) {
+    static const char *const names[] = { "idle", "armed", "on", "drain" };
+    txsched_stats_t s;
+    txsched_stats(&s);
+    char off[24], at[24];
+    const int64_t in_ms = ((int64_t)at_dev - (int64_t)txsched_dev_us()) / 1000;
+
+    cdc_printf("!C why=%s st=%s sof=%u sync=%u off=%s rate=%.2f rtt=%lu age=%lu late=%lu "
+               "at=%s in=%ld len=%lu fired=%u err=%ld q=%lu n=%lu\r\n",
+               why, names[s.state], s.sof ? 1u : 0u, s.synced ? 1u : 0u,
+               i64s(off, s.off_us), (double)s.rate_ppm, (unsigned long)s.rtt_us,
+               (unsigned long)s.sync_age_s, (unsigned long)s.late,
+               u64s(at, s.start_ms), (long)(s.start_ms ? in_ms : 0), (unsigned long)s.len_ms,
+               s.fired ? 1u : 0u, (long)s.err_us, (unsigned long)s.queue_ms,
+               (unsigned long)s.count);
+}
@@ -0,0 +1,96 @@
+// txsched.h - host-synchronised time base and scheduled TX start (tx_at)
+//
+// FT8 / FT4 / WSPR slots start on UTC boundaries, but audio reaches the
+// radio through the USB ring and up to NUM_BLOCKS queued blocks, so
+// keying with "tx 1" lands wherever the queue happens to be.  Instead:
+//
+//   time base  device time counts USB SOF frames (1 ms of the host's
+//              clock each) and interpolates between them with the local
+//              us timer; without SOF it free-runs on the local timer.
+//   handshake  the host sends "tsync ping <host_us>", gets the device
+//              time back, and sends "tsync set <host_us> <dev_us> <rtt>"
+//              for its best round trip (midpoint = device stamp).  Two
+//              syncs a minute apart also give the host-clock vs SOF rate.
+//   tx_at      the producer keys the chain TXS_LEAD_MS before the start
+//              so the queue is full of keyed audio, and Core1 holds every
+//              tx_on sample back until its local clock reaches the start
+//              (and after the optional end), per dither substep.  The
+//              first sample that goes on air is timestamped and the
+//              achieved error reported as "!C" telemetry.
+//
+// Portable: host/schedcheck runs the handshake and a simulated Core1
+// against drifting clocks.
+
+#ifndef TXSCHED_H
+#define TXSCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "control.h"
+#include "txchain.h"
+
+#define TXS_BLOCK_MS        (BLOCK_SAMPLES * 1000u / WAV_SAMPLE_RATE)
+// Keying lead: a full queue plus the block in production, plus margin
+#define TXS_LEAD_MS         ((NUM_BLOCKS + 2u) * TXS_BLOCK_MS)
+#define TXS_MAX_AHEAD_MS    (30u * 60u * 1000u)     // Core1 compares 32-bit us
+#define TXS_SOF_GAP_US      1000000u    // longer SOF gap: frame count ambiguous
+#define TXS_SOF_JITTER_US   50          // edges this far off the phase are late IRQs
+#define TXS_RATE_MIN_S      60u         // sync span before the rate is estimated
+#define TXS_RATE_MAX_PPM    200.0f
+
+enum { TXS_IDLE = 0, TXS_ARMED, TXS_ON, TXS_DRAIN };
+
+typedef struct {
+    uint8_t  state;         // TXS_*
+    bool     synced;        // host offset known
+    bool     sof;           // SOF edges seen
+    int64_t  off_us;        // host - device time at the last sync
+    float    rate_ppm;      // host clock vs SOF, from the sync history
+    uint32_t rtt_us;        // round trip of the last sync
+    uint32_t sync_age_s;
+    uint32_t edges;         // SOF edges used
+    uint32_t late;          // SOF edges rejected as late IRQs
+    uint32_t rebases;       // SOF gaps that restarted frame counting
+    uint64_t start_ms;      // scheduled start, host ms (or device ms unsynced)
+    uint32_t len_ms;        // 0 = until tx off / tx_at off
+    bool     fired;         // a tx_on sample went out
+    int32_t  err_us;        // first tx_on sample minus requested start
+    uint32_t queue_ms;      // audio queued ahead of the RF at the start
+    uint32_t count;         // scheduled transmissions started
+} txsched_stats_t;
+
+// SOF edge with its local timestamp (IRQ context)
+void     txsched_sof(uint32_t frame_no, uint64_t local_us);
+
+// Device time (SOF-locked) and its host-time estimate, us
+uint64_t txsched_dev_us(void);
+uint64_t txsched_host_us(void);
+
+// Handshake: ping reply ("!C ping", host token echoed) and the offset
+// from the host's best pair.  Returns NULL or an error.
+void     txsched_ping(const char *host_us);
+const char *txsched_sync(uint64_t host_us, uint64_t dev_us, uint32_t rtt_us);
+
+// Schedule a start at host time start_ms (synced) or rel_ms from now;
+// len_ms 0 keeps transmitting until cancelled.  Returns NULL or an error.
+const char *txsched_arm_at(uint64_t start_ms, uint32_t len_ms);
+const char *txsched_arm_in(uint32_t rel_ms, uint32_t len_ms);
+// Next multiple of period_ms in host time that leaves the keying lead
+const char *txsched_arm_next(uint32_t period_ms, uint32_t len_ms);
+// Stop: RF off at once, queued keyed audio is held back
+void     txsched_cancel(const char *why);
+
+// Producer: key the chain for the block being produced
+bool     txsched_keyed(void);
+// Anything scheduled or still on air / draining
+bool     txsched_busy(void);
+// Core1, per substep: may this tx_on go out at local time now_us?
+bool     txsched_gate(uint32_t now_us, bool tx_on);
+// Core0 main loop: refines the Core1 window, reports start and end
+void     txsched_poll(uint32_t queue_ms);
+
+void     txsched_stats(txsched_stats_t *out);
+void     txsched_print(const char *why);    // "!C" line
+
+#endif // TXSCHED_H
@@ -29,7 +29,8 @@ static tusb_desc_device_t const desc_device =
     .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
     .idVendor           = 0xCafe,
     .idProduct          = USB_PID,
-    .bcdDevice          = 0x0100,
+    // New interface set = new bcdDevice, or Windows keeps its cached one
+    .bcdDevice          = CFG_TUD_MSC ? 0x0110 : 0x0100,
 
     .iManufacturer      = 0x01,
     .iProduct           = 0x02,
@@ -75,6 +76,9 @@ uint8_t const * tud_hid_descriptor_report_cb(uint8_t itf)
   #define EPNUM_CDC_OUT       0x02
   #define EPNUM_CDC_IN        0x82
 
+  #define EPNUM_MSC_OUT       0x05
+  #define EPNUM_MSC_IN        0x85
+
   #define EPNUM_DEBUG         0x04
 
 #elif TU_CHECK_MCU(OPT_MCU_NRF5X)
@@ -85,6 +89,9 @@ uint8_t const * tud_hid_descriptor_report_cb(uint8_t itf)
   #define EPNUM_CDC_OUT       0x02
   #define EPNUM_CDC_IN        0x82
 
+  #define EPNUM_MSC_OUT       0x05
+  #define EPNUM_MSC_IN        0x85
+
   #define EPNUM_DEBUG         0x04
 
 #elif defined(TUD_ENDPOINT_ONE_DIRECTION_ONLY)
@@ -96,6 +103,9 @@ uint8_t const * tud_hid_descriptor_report_cb(uint8_t itf)
   #define EPNUM_CDC_OUT       0x04
   #define EPNUM_CDC_IN        0x84
 
+  #define EPNUM_MSC_OUT       0x06
+  #define EPNUM_MSC_IN        0x87
+
   #define EPNUM_DEBUG         0x05
 
 #else
@@ -106,6 +116,9 @@ uint8_t const * tud_hid_descriptor_report_cb(uint8_t itf)
   #define EPNUM_CDC_IN        0x82
   #define EPNUM_CDC_NOTIF     0x83
 
+  #define EPNUM_MSC_OUT       0x05
+  #define EPNUM_MSC_IN        0x85
+
   #define EPNUM_DEBUG         0x84
 #endif
 
@@ -113,10 +126,16 @@ uint8_t const * tud_hid_descriptor_report_cb(uint8_t itf)
 // Configuration Descriptor (UAC1 + CDC (+ optional HID))
 //--------------------------------------------------------------------+
 
+#if CFG_TUD_MSC
+  #define MSC_DESC_LEN  TUD_MSC_DESC_LEN
+#else
+  #define MSC_DESC_LEN  0
+#endif
+
 #if CFG_AUDIO_DEBUG
-  #define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_AUDIO10_SPEAKER_STEREO_NOFB_DESC_LEN(1) + TUD_CDC_DESC_LEN + TUD_HID_DESC_LEN)
+  #define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_AUDIO10_SPEAKER_STEREO_NOFB_DESC_LEN(5) + TUD_CDC_DESC_LEN + MSC_DESC_LEN + TUD_HID_DESC_LEN)
 #else
-  #define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_AUDIO10_SPEAKER_STEREO_NOFB_DESC_LEN(1) + TUD_CDC_DESC_LEN)
+  #define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_AUDIO10_SPEAKER_STEREO_NOFB_DESC_LEN(5) + TUD_CDC_DESC_LEN + MSC_DESC_LEN)
 #endif
 
 uint8_t const desc_configuration[] =
@@ -125,7 +144,9 @@ uint8_t const desc_configuration[] =
   // Attribute: 0x80 = bus powered
   TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0x80, 100),
 
-  // ---- UAC1 Speaker stereo (NO feedback - Windows compatible), 48kHz only ----
+  // ---- UAC1 Speaker stereo (NO feedback - Windows compatible) ----
+  // Discrete rates must match farrow_rates[] (farrow.c); the host picks one
+  // with SET_CUR on the endpoint and the resampler is redesigned for it.
   TUD_AUDIO10_SPEAKER_STEREO_NOFB_DESCRIPTOR(
     ITF_NUM_AUDIO_CONTROL,
     2,
@@ -133,7 +154,7 @@ uint8_t const desc_configuration[] =
       CFG_TUD_AUDIO_FUNC_1_RESOLUTION_RX,
       EPNUM_AUDIO,
       CFG_TUD_AUDIO_FUNC_1_EP_OUT_SZ_FS,
-      48000
+      22050, 32000, 44100, 48000, 96000
   ),
 
   // ---- CDC ACM (Serial) ----
@@ -146,6 +167,11 @@ uint8_t const desc_configuration[] =
     EPNUM_CDC_IN, 64
   ),
 
+#if CFG_TUD_MSC
+  // ---- MSC (flash FAT volume), stridx = 6 ----
+  TUD_MSC_DESCRIPTOR(ITF_NUM_MSC, 6, EPNUM_MSC_OUT, EPNUM_MSC_IN, 64),
+#endif
+
 #if CFG_AUDIO_DEBUG
   // ---- Optional HID debug ----
   TUD_HID_DESCRIPTOR(ITF_NUM_DEBUG, 0, HID_ITF_PROTOCOL_NONE,
@@ -173,6 +199,7 @@ enum {
   STRID_SERIAL,
   STRID_CDC,       // 4
   STRID_UAC1,      // 5
+  STRID_MSC,       // 6
 };
 
 static char const *string_desc_arr[] =
@@ -183,6 +210,7 @@ static char const *string_desc_arr[] =
   NULL,                                 // 3: Serial (generated)
   "TX Console",                     // 4: CDC interface string
   "SSB Audio Input",                    // 5: UAC1 (optional use)
+  "SX1280 Storage",                     // 6: MSC interface string
 };
 
 static uint16_t _desc_str[32 + 1];
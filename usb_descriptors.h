@@ -20,6 +20,10 @@ enum
   ITF_NUM_CDC_COMM,
   ITF_NUM_CDC_DATA,
 
+#if CFG_TUD_MSC
+  ITF_NUM_MSC,
+#endif
+
 #if CFG_AUDIO_DEBUG
   ITF_NUM_DEBUG,
 #endif
@@ -123,8 +127,8 @@ enum
   TUD_AUDIO10_DESC_TYPE_I_FORMAT(/*_nrchannels*/ 0x02, /*_subframesize*/ _nBytesPerSample, /*_bitresolution*/ _nBitsUsedPerSample, /*_freqs*/ __VA_ARGS__),\
   /* Standard AS Isochronous Audio Data Endpoint Descriptor(4.6.1.1) - Synchronous for Windows */\
   TUD_AUDIO10_DESC_STD_AS_ISO_EP(/*_ep*/ _epout, /*_attr*/ (uint8_t) ((uint8_t)TUSB_XFER_ISOCHRONOUS | (uint8_t)TUSB_ISO_EP_ATT_SYNCHRONOUS), /*_maxEPsize*/ _epoutsize, /*_interval*/ 0x01, /*_sync_ep*/ 0x00),\
-  /* Class-Specific AS Isochronous Audio Data Endpoint Descriptor(4.6.1.2) - no special attributes */\
-  TUD_AUDIO10_DESC_CS_AS_ISO_EP(/*_attr*/ 0x00, /*_lockdelayunits*/ AUDIO10_CS_AS_ISO_DATA_EP_LOCK_DELAY_UNIT_UNDEFINED, /*_lockdelay*/ 0x0000)
+  /* Class-Specific AS Isochronous Audio Data Endpoint Descriptor(4.6.1.2) - sampling frequency control */\
+  TUD_AUDIO10_DESC_CS_AS_ISO_EP(/*_attr*/ AUDIO10_CS_AS_ISO_DATA_EP_ATT_SAMPLING_FRQ, /*_lockdelayunits*/ AUDIO10_CS_AS_ISO_DATA_EP_LOCK_DELAY_UNIT_UNDEFINED, /*_lockdelay*/ 0x0000)
 
 #ifdef __cplusplus
 }